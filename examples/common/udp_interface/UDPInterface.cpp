@@ -4,6 +4,7 @@
 #include <microReticulum/Log.h>
 
 #include <memory>
+#include <string.h>
 
 #ifndef ARDUINO
 #include <sys/ioctl.h>
@@ -12,6 +13,7 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <errno.h>
+#include <poll.h>
 #endif
 
 using namespace RNS;
@@ -186,16 +188,41 @@ UDPInterface::UDPInterface(const char* name /*= "UDPInterface"*/) : RNS::Interfa
 		ERRORF("Unable to bind socket with error %d", errno);
 		return false;
 	}
+
+#if UDP_HAS_MMSG
+	// Preallocate batch state so loop() and flush() don't allocate per call
+	if (_batch_size > 1) {
+		_rx_buffers.resize(_batch_size);
+		_rx_iovecs.resize(_batch_size);
+		_rx_messages.resize(_batch_size);
+		_tx_queue.reserve(_batch_size);
+		_tx_iovecs.resize(_batch_size);
+		_tx_messages.resize(_batch_size);
+	}
+#endif
 #endif
 
 	_online = true;
 
+#if UDP_READER_THREAD
+	_reader_running = true;
+	_reader = std::thread(&UDPInterface::read_loop, this);
+#endif
+
 	return true;
 }
 
 /*virtual*/ void UDPInterface::stop() {
 #ifdef ARDUINO
 #else
+#if UDP_READER_THREAD
+	// Before closing the socket it waits on
+	_reader_running = false;
+	if (_reader.joinable()) {
+		_reader.join();
+	}
+#endif
+	flush();
 	if (_socket > -1) {
 		close(_socket);
 		_socket = -1;
@@ -216,33 +243,101 @@ UDPInterface::UDPInterface(const char* name /*= "UDPInterface"*/) : RNS::Interfa
 			_buffer.resize(len);
 			on_incoming(_buffer);
 		}
-#else
-		// Drain all queued datagrams in one loop tick. The previous
-		// ioctl(FIONREAD)+read pattern returned a stale/zero `available`
-		// count on macOS for a UDP socket carrying back-to-back datagrams,
-		// which caused larger packets (~470B resource parts) to appear
-		// "lost" — they'd sit in the kernel queue while smaller follow-up
-		// packets were drained instead. recvfrom() with MSG_DONTWAIT reads
-		// exactly one datagram per call, sized to fit any link-layer MTU,
-		// and lets us loop until the queue is empty.
+#elif !UDP_READER_THREAD
+		receive();
+#endif
+	}
+}
+
+#ifndef ARDUINO
+void UDPInterface::receive() {
+#if UDP_HAS_MMSG
+	if (_batch_size > 1) {
+		// Drain queued datagrams a batch per syscall, straight into buffers that are passed on to
+		// transport without copying
 		while (true) {
-			sockaddr_in src_addr{};
-			socklen_t src_addr_len = sizeof(src_addr);
-			ssize_t len = recvfrom(_socket,
-			                       _buffer.writable(_HW_MTU),
-			                       _HW_MTU,
-			                       MSG_DONTWAIT,
-			                       (struct sockaddr*)&src_addr,
-			                       &src_addr_len);
-			if (len <= 0) {
+			for (size_t i = 0; i < _batch_size; ++i) {
+				_rx_iovecs[i].iov_base = _rx_buffers[i].writable(_HW_MTU);
+				_rx_iovecs[i].iov_len = _HW_MTU;
+				memset(&_rx_messages[i], 0, sizeof(_rx_messages[i]));
+				_rx_messages[i].msg_hdr.msg_iov = &_rx_iovecs[i];
+				_rx_messages[i].msg_hdr.msg_iovlen = 1;
+			}
+			int count = recvmmsg(_socket, _rx_messages.data(), _batch_size, MSG_DONTWAIT, nullptr);
+			if (count <= 0) {
+				break;
+			}
+			for (int i = 0; i < count; ++i) {
+				_rx_buffers[i].resize(_rx_messages[i].msg_len);
+				on_incoming(_rx_buffers[i]);
+#if UDP_READER_THREAD
+				// Transport releases its reference on another thread, so rather than reusing a buffer
+				// that may still be in use, drop it and receive the next one into a new one
+				_rx_buffers[i] = Bytes();
+#endif
+			}
+			if ((size_t)count < _batch_size) {
+				// socket is drained
 				break;
 			}
-			_buffer.resize(static_cast<size_t>(len));
-			on_incoming(_buffer);
 		}
+		return;
+	}
+#endif
+	// Drain all queued datagrams in one loop tick. The previous
+	// ioctl(FIONREAD)+read pattern returned a stale/zero `available`
+	// count on macOS for a UDP socket carrying back-to-back datagrams,
+	// which caused larger packets (~470B resource parts) to appear
+	// "lost" — they'd sit in the kernel queue while smaller follow-up
+	// packets were drained instead. recvfrom() with MSG_DONTWAIT reads
+	// exactly one datagram per call, sized to fit any link-layer MTU,
+	// and lets us loop until the queue is empty.
+	while (true) {
+		sockaddr_in src_addr{};
+		socklen_t src_addr_len = sizeof(src_addr);
+		ssize_t len = recvfrom(_socket,
+		                       _buffer.writable(_HW_MTU),
+		                       _HW_MTU,
+		                       MSG_DONTWAIT,
+		                       (struct sockaddr*)&src_addr,
+		                       &src_addr_len);
+		if (len <= 0) {
+			break;
+		}
+		_buffer.resize(static_cast<size_t>(len));
+		on_incoming(_buffer);
+#if UDP_READER_THREAD
+		_buffer = Bytes();
+#endif
+	}
+}
 #endif
+
+#if UDP_READER_THREAD
+void UDPInterface::read_loop() {
+	pollfd pfd = {_socket, POLLIN, 0};
+	while (_reader_running) {
+		// Timeout so stop() is noticed without anything arriving
+		int ready = poll(&pfd, 1, 100);
+		if (ready < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			ERRORF("%s: Reader failed waiting on socket with error %d", toString().c_str(), errno);
+			break;
+		}
+		if (ready == 0) {
+			continue;
+		}
+		try {
+			receive();
+		}
+		catch (const std::exception& e) {
+			ERRORF("%s: Reader failed receiving: %s", toString().c_str(), e.what());
+		}
 	}
 }
+#endif
 
 /*virtual*/ bool UDPInterface::send_outgoing(const Bytes& data) {
 	DEBUGF("%s.on_outgoing: data: %s", toString().c_str(), data.toHex().c_str());
@@ -255,6 +350,17 @@ UDPInterface::UDPInterface(const char* name /*= "UDPInterface"*/) : RNS::Interfa
 			udp.write(data.data(), data.size());
 			udp.endPacket();
 #else
+#if UDP_HAS_MMSG
+			if (_batch_size > 1) {
+				// Held for flush(), which transport calls once it is done sending for now
+				_tx_queue.push_back(data);
+				if (_tx_queue.size() >= _batch_size) {
+					flush();
+				}
+				InterfaceImpl::handle_outgoing(data);
+				return true;
+			}
+#endif
 			TRACEF("Sending UDP packet to %s:%d", _remote_host.c_str(), _remote_port);
 			sockaddr_in sock_addr;
 			sock_addr.sin_family = AF_INET;
@@ -279,8 +385,53 @@ UDPInterface::UDPInterface(const char* name /*= "UDPInterface"*/) : RNS::Interfa
 	return success;
 }
 
+/*virtual*/ void UDPInterface::flush() {
+#if UDP_HAS_MMSG
+	if (_tx_queue.empty()) {
+		return;
+	}
+	if (_socket < 0) {
+		_tx_queue.clear();
+		return;
+	}
+	TRACEF("Sending %zu UDP packets to %s:%d", _tx_queue.size(), _remote_host.c_str(), _remote_port);
+	sockaddr_in sock_addr;
+	sock_addr.sin_family = AF_INET;
+	sock_addr.sin_addr.s_addr = _remote_address;
+	sock_addr.sin_port = htons(_remote_port);
+	size_t queued = _tx_queue.size();
+	for (size_t i = 0; i < queued; ++i) {
+		_tx_iovecs[i].iov_base = (void*)_tx_queue[i].data();
+		_tx_iovecs[i].iov_len = _tx_queue[i].size();
+		memset(&_tx_messages[i], 0, sizeof(_tx_messages[i]));
+		_tx_messages[i].msg_hdr.msg_name = &sock_addr;
+		_tx_messages[i].msg_hdr.msg_namelen = sizeof(sock_addr);
+		_tx_messages[i].msg_hdr.msg_iov = &_tx_iovecs[i];
+		_tx_messages[i].msg_hdr.msg_iovlen = 1;
+	}
+	size_t sent = 0;
+	while (sent < queued) {
+		int count = sendmmsg(_socket, &_tx_messages[sent], queued - sent, 0);
+		if (count <= 0) {
+			WARNINGF("Failed sending %zu of %zu UDP packets to %s:%d with error %d", queued - sent, queued, _remote_host.c_str(), _remote_port, errno);
+			break;
+		}
+		sent += count;
+	}
+	_tx_queue.clear();
+#endif
+}
+
 void UDPInterface::on_incoming(const Bytes& data) {
 	DEBUGF("%s.on_incoming: data: %s", toString().c_str(), data.toHex().c_str());
+#if UDP_READER_THREAD
+	// Transport handles it on the Reticulum thread, a full queue drops the datagram like a full socket
+	// buffer would
+	if (!queue_incoming(data)) {
+		DEBUGF("%s: Ingress queue full, dropped %zu bytes", toString().c_str(), data.size());
+	}
+#else
 	// Pass received data on to transport
-	InterfaceImpl::handle_incoming(data);
+	handle_incoming(data);
+#endif
 }
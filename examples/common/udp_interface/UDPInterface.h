@@ -10,8 +10,10 @@
 //#include <AsyncUDP.h>
 #else
 #include <netinet/in.h>
+#include <sys/socket.h>
 #endif
 
+#include <vector>
 #include <stdint.h>
 
 #ifndef DEFAULT_UDP_PORT
@@ -32,6 +34,29 @@
 #ifndef DEFAULT_UDP_REMOTE_HOST
 #define DEFAULT_UDP_REMOTE_HOST	"255.255.255.255"
 #endif
+// Datagrams moved per recvmmsg/sendmmsg call on Linux (1 reads and sends one datagram per syscall)
+#ifndef DEFAULT_UDP_BATCH_SIZE
+#define DEFAULT_UDP_BATCH_SIZE	32
+#endif
+#if defined(__linux__) && !defined(ARDUINO)
+#define UDP_HAS_MMSG 1
+#else
+#define UDP_HAS_MMSG 0
+#endif
+// Receive on a thread of its own that hands datagrams to transport through its ingress queue, instead
+// of reading from loop() on the Reticulum thread
+#ifndef UDP_READER_THREAD
+	#if defined(ARDUINO)
+		#define UDP_READER_THREAD 0
+	#else
+		#define UDP_READER_THREAD 1
+	#endif
+#endif
+
+#if UDP_READER_THREAD
+#include <thread>
+#include <atomic>
+#endif
 
 class UDPInterface : public RNS::InterfaceImpl {
 
@@ -50,17 +75,43 @@ public:
 	virtual bool start();
 	virtual void stop();
 	virtual void loop();
+	virtual void flush();
+#ifndef ARDUINO
+#if UDP_READER_THREAD
+	// Reader thread waits on the socket itself
+	virtual int poll_fd() const { return -1; }
+#else
+	// Socket becomes readable when loop() has datagrams to drain
+	virtual int poll_fd() const { return _socket; }
+#endif
+#endif
 
 	virtual inline std::string toString() const { return "UDPInterface[" + _name + "/" + _local_host + ":" + std::to_string(_local_port) + "]"; }
 	//virtual inline std::string toString() const { return "UDPInterface[" + name() + "]"; }
 
+	// Must be set before start()
+	inline void local_host(const char* local_host) { _local_host = local_host; }
+	inline void local_port(int local_port) { _local_port = local_port; }
+	inline void remote_host(const char* remote_host) { _remote_host = remote_host; }
+	inline void remote_port(int remote_port) { _remote_port = remote_port; }
+	inline void batch_size(size_t batch_size) { _batch_size = (batch_size > 0) ? batch_size : 1; }
+	inline size_t batch_size() const { return _batch_size; }
+
 protected:
 	virtual bool send_outgoing(const RNS::Bytes& data);
 	void on_incoming(const RNS::Bytes& data);
+#ifndef ARDUINO
+	// Drains all queued datagrams, from loop() or the reader thread
+	void receive();
+#endif
+#if UDP_READER_THREAD
+	void read_loop();
+#endif
 
 private:
 	//uint8_t buffer[Type::Reticulum::MTU] = {0};
 	RNS::Bytes _buffer;
+	size_t _batch_size = DEFAULT_UDP_BATCH_SIZE;
 
 	// WiFi network name and password
 	std::string _wifi_ssid;
@@ -82,6 +133,21 @@ private:
 	int _socket = -1;
 	in_addr_t _local_address = INADDR_ANY;
 	in_addr_t _remote_address = INADDR_NONE;
+#if UDP_HAS_MMSG
+	// Receive buffers are handed to transport as-is, a buffer it keeps a reference to is replaced
+	// rather than overwritten on the next receive
+	std::vector<RNS::Bytes> _rx_buffers;
+	std::vector<struct iovec> _rx_iovecs;
+	std::vector<struct mmsghdr> _rx_messages;
+	// Outgoing datagrams held until flush() or a full batch
+	std::vector<RNS::Bytes> _tx_queue;
+	std::vector<struct iovec> _tx_iovecs;
+	std::vector<struct mmsghdr> _tx_messages;
+#endif
+#if UDP_READER_THREAD
+	std::thread _reader;
+	std::atomic<bool> _reader_running{false};
+#endif
 #endif
 
 };
@@ -0,0 +1,127 @@
+// Loopback throughput of UDPInterface with one syscall per datagram (batch size 1, the behaviour
+// before recvmmsg/sendmmsg batching) against batched receive and send.
+//
+// Two interfaces exchange fixed-size datagrams over 127.0.0.1. The sender transmits a burst and
+// flushes it the way Transport::loop() does, then the receiver drains its socket the way
+// Reticulum::loop() does. Received frames are counted instead of being passed on to Transport so
+// only interface and syscall cost is measured.
+
+#include <UDPInterface.h>
+
+#include <microReticulum.h>
+
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef BENCHMARK_PACKETS
+#define BENCHMARK_PACKETS	200000
+#endif
+#ifndef BENCHMARK_PACKET_SIZE
+#define BENCHMARK_PACKET_SIZE	200
+#endif
+#ifndef BENCHMARK_BURST
+#define BENCHMARK_BURST	64
+#endif
+
+class BenchmarkUDPInterface : public UDPInterface {
+public:
+	BenchmarkUDPInterface(const char* name) : UDPInterface(name) {}
+	inline bool send(const RNS::Bytes& data) { return send_outgoing(data); }
+	size_t _received = 0;
+	size_t _received_bytes = 0;
+protected:
+	virtual void handle_incoming(const RNS::Bytes& data) {
+		++_received;
+		_received_bytes += data.size();
+	}
+};
+
+struct Result {
+	double _seconds = 0.0;
+	size_t _sent = 0;
+	size_t _received = 0;
+};
+
+Result run(size_t batch_size, int port) {
+	Result result;
+
+	BenchmarkUDPInterface* receiver_impl = new BenchmarkUDPInterface("receiver");
+	RNS::Interface receiver(receiver_impl);
+	receiver_impl->local_host("127.0.0.1");
+	receiver_impl->local_port(port);
+	receiver_impl->remote_host("127.0.0.1");
+	receiver_impl->remote_port(port + 1);
+	receiver_impl->batch_size(batch_size);
+
+	BenchmarkUDPInterface* sender_impl = new BenchmarkUDPInterface("sender");
+	RNS::Interface sender(sender_impl);
+	sender_impl->local_host("127.0.0.1");
+	sender_impl->local_port(port + 1);
+	sender_impl->remote_host("127.0.0.1");
+	sender_impl->remote_port(port);
+	sender_impl->batch_size(batch_size);
+
+	if (!receiver.start() || !sender.start()) {
+		printf("Unable to open loopback sockets on ports %d and %d\n", port, port + 1);
+		exit(1);
+	}
+
+	std::vector<uint8_t> payload(BENCHMARK_PACKET_SIZE);
+	for (size_t i = 0; i < payload.size(); ++i) {
+		payload[i] = (uint8_t)i;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	while (result._sent < BENCHMARK_PACKETS) {
+		for (size_t i = 0; i < BENCHMARK_BURST && result._sent < BENCHMARK_PACKETS; ++i) {
+			// fresh frame per packet as Transport would hand over
+			RNS::Bytes data(payload.data(), payload.size());
+			sender_impl->send(data);
+			++result._sent;
+		}
+		sender.flush();
+		// loopback delivery is synchronous, allow a few empty polls before counting a datagram lost
+		for (int empty = 0; receiver_impl->_received < result._sent && empty < 100; ) {
+			size_t before = receiver_impl->_received;
+			receiver.loop();
+			if (receiver_impl->_received == before) {
+				++empty;
+			}
+		}
+	}
+	result._seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result._received = receiver_impl->_received;
+
+	sender.stop();
+	receiver.stop();
+	return result;
+}
+
+int main(void) {
+	RNS::loglevel(RNS::LOG_WARNING);
+
+	printf("UDPInterface loopback: %u packets of %u bytes in bursts of %u\n",
+		(unsigned)BENCHMARK_PACKETS, (unsigned)BENCHMARK_PACKET_SIZE, (unsigned)BENCHMARK_BURST);
+	if (!UDP_HAS_MMSG) {
+		printf("recvmmsg/sendmmsg not available on this platform, both runs use one syscall per datagram\n");
+	}
+
+	const size_t batch_sizes[] = {1, 8, DEFAULT_UDP_BATCH_SIZE};
+	double baseline = 0.0;
+	int port = 47420;
+	for (size_t batch_size : batch_sizes) {
+		Result result = run(batch_size, port);
+		port += 2;
+		double rate = (double)result._received / result._seconds;
+		if (baseline == 0.0) {
+			baseline = rate;
+		}
+		printf("batch %3zu: %9.0f packets/s  %7.1f Mbit/s  lost %zu  (%.2fx)\n",
+			batch_size, rate, rate * BENCHMARK_PACKET_SIZE * 8.0 / 1e6,
+			result._sent - result._received, rate / baseline);
+	}
+	return 0;
+}
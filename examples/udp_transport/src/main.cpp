@@ -122,6 +122,11 @@ int main(void) {
 
 	setup();
 
+	// Wake for keypresses as well as network input
+	if (isatty(STDIN_FILENO)) {
+		RNS::Utilities::EventLoop::watch(STDIN_FILENO);
+	}
+
 	bool run = true;
 	while (run) {
 		loop();
@@ -133,7 +138,8 @@ int main(void) {
 				break;
 			}
 		}
-		RNS::Utilities::OS::sleep(0.01);
+		// Sleep until a datagram or keypress arrives or transport jobs are due
+		reticulum.wait();
 	}
 
 	reticulum_teardown();
@@ -15,12 +15,15 @@
 #pragma once
 
 #include "microReticulum/Utilities/OS.h"
+#include "microReticulum/Utilities/EventLoop.h"
 #include "microReticulum/Provisioning/Provisioning.h"
 #include "microReticulum/Transport.h"
 #include "microReticulum/Reticulum.h"
 #include "microReticulum/Link.h"
 #include "microReticulum/Resource.h"
 #include "microReticulum/Interface.h"
+#include "microReticulum/Interfaces/TCPInterface.h"
+#include "microReticulum/Interfaces/LocalInterface.h"
 #include "microReticulum/Packet.h"
 #include "microReticulum/Destination.h"
 #include "microReticulum/Identity.h"
@@ -41,97 +41,101 @@ void Bytes::newData(size_t capacity /*= 0*/) {
 	_data = SharedData(data);
 //MEM("newData: Assigned data to shared data pointer");
 	_exclusive = true;
+	_inline_size = 0;
 }
 
-// Ensures that instance has exclusive shared data
-// - If instance has no shared data then create new shared data
-// - If instance does not have exclusive on shared data that is not empty then make a copy of shared data (if requests) and reserve capacity (if requested)
-// - If instance does not have exclusive on shared data that is empty then create new shared data
-// - If instance already has exclusive on shared data then do nothing except reserve capacity (if requested)
-void Bytes::exclusiveData(bool copy /*= true*/, size_t capacity /*= 0*/) {
-	if (!_data) {
-		newData(capacity);
-	}
-	else if (!_exclusive) {
-		if (copy && !_data->empty()) {
-			//TRACE("Bytes is creating a writable copy of its shared data");
-			//Data* data = new Data(*_data.get());
-//MEM("exclusiveData: Creating new data...");
-			Data* data = new Data();
-			if (data == nullptr) {
-				ERROR("Bytes failed to duplicate data buffer");
-				throw std::runtime_error("Failed to duplicate data buffer");
-			}
-//MEM("exclusiveData: Created new data");
-			if (capacity > 0) {
-//MEMF("exclusiveData: Reserving data capacity of %u...", capacity);
-				// if requested capacity < existing size then reserve capacity for existing size instead
-				data->reserve((capacity > _data->size()) ? capacity : _data->size());
-//MEM("exclusiveData: Reserved data capacity");
-			}
-			else {
-				data->reserve(_data->size());
+// Ensures that instance has exclusive data of size newsize and returns a writable pointer to it
+// - If newsize (and capacity) fit inline and instance has no exclusive shared data then use inline data
+// - If instance already has exclusive on shared data then resize it in place (reserving capacity if requested)
+// - Otherwise create new shared data with reserved capacity
+// - If copy is requested then existing data (up to newsize) is preserved, and any growth is zero-filled
+uint8_t* Bytes::exclusiveData(size_t newsize, bool copy /*= true*/, size_t capacity /*= 0*/) {
+	// reclaim exclusivity if all copies/views that shared our data have since been released
+	if (_data && !_exclusive && _data.use_count() == 1) {
+		_exclusive = true;
+	}
+	if (_data && _exclusive) {
+		// keep using exclusive shared data since its capacity was explicitly requested or already grown into
+		if (capacity > _data->capacity()) {
+			_data->reserve(capacity);
+		}
+		_data->resize(newsize);
+		return _data->data();
+	}
+	size_t current_size = size();
+	if (newsize <= INLINE_CAPACITY && capacity <= INLINE_CAPACITY) {
+		if (_data) {
+			// shared data is not exclusive, so copy what we need inline and release our share
+			if (copy && current_size > 0) {
+				memcpy(_inline, _data->data(), (current_size < newsize) ? current_size : newsize);
 			}
-//MEM("exclusiveData: Copying existing data...");
-			data->insert(data->begin(), _data->begin(), _data->end());
-//MEM("exclusiveData: Copied existing data");
-//MEM("exclusiveData: Assigning data to shared data pointer...");
-			_data = SharedData(data);
-//MEM("exclusiveData: Assigned data to shared data pointer");
+			_data = nullptr;
 			_exclusive = true;
 		}
-		else {
-//MEM("Bytes is creating its own data because shared is empty");
-			//data = new Data();
-			//if (data == nullptr) {
-			//	ERROR("Bytes failed to allocate empty data buffer");
-			//	throw std::runtime_error("Failed to allocate empty data buffer");
-			//}
-			//_data = SharedData(data);
-			//_exclusive = true;
-//MEM("exclusiveData: Creating new empty data...");
-			newData(capacity);
-//MEM("exclusiveData: Created new empty data");
+		if (newsize > current_size) {
+			memset(_inline + current_size, 0, newsize - current_size);
 		}
+		_inline_size = (uint8_t)newsize;
+		return _inline;
+	}
+	// outgrowing inline data or shared data is not exclusive, so create new shared data
+//MEM("exclusiveData: Creating new data...");
+	Data* data = new Data();
+	if (data == nullptr) {
+		ERROR("Bytes failed to allocate data buffer");
+		throw std::runtime_error("Failed to allocate data buffer");
 	}
-	else if (capacity > 0 && capacity > size()) {
-		reserve(capacity);
+	data->reserve((capacity > newsize) ? capacity : newsize);
+	if (copy && current_size > 0) {
+//MEM("exclusiveData: Copying existing data...");
+		const uint8_t* current = this->data();
+		data->insert(data->begin(), current, current + ((current_size < newsize) ? current_size : newsize));
 	}
+	data->resize(newsize);
+	_data = SharedData(data);
+	_exclusive = true;
+	_inline_size = 0;
+	return _data->data();
 }
 
-int Bytes::compare(const Bytes& bytes) const {
-	if (_data == bytes._data) {
-		return 0;
-	}
-	else if (!_data) {
-		return -1;
-	}
-	else if (!bytes._data) {
-		return 1;
-	}
-	else if (*_data < *(bytes._data)) {
-		return -1;
+// Moves inline data out to new exclusive shared data (const since data content is unchanged)
+void Bytes::promoteData() const {
+	if (_data) {
+		return;
 	}
-	else if (*_data > *(bytes._data)) {
-		return 1;
+	Data* data = new Data(_inline, _inline + _inline_size);
+	if (data == nullptr) {
+		ERROR("Bytes failed to allocate data buffer");
+		throw std::runtime_error("Failed to allocate data buffer");
 	}
-	else {
+	_data = SharedData(data);
+	_exclusive = true;
+	_inline_size = 0;
+}
+
+int Bytes::compare(const Bytes& bytes) const {
+	if (_data && _data == bytes._data) {
 		return 0;
 	}
+	return compare(bytes.data(), bytes.size());
 }
 
 int Bytes::compare(const uint8_t* buf, size_t size) const {
-	if (!_data && size == 0) {
+	size_t this_size = this->size();
+	if (this_size == 0 && size == 0) {
 		return 0;
 	}
-	else if (!_data) {
+	else if (this_size == 0) {
 		return -1;
 	}
-	int cmp = memcmp(_data->data(), buf, (_data->size() < size) ? _data->size() : size);
-	if (cmp == 0 && _data->size() < size) {
+	else if (size == 0) {
+		return 1;
+	}
+	int cmp = memcmp(data(), buf, (this_size < size) ? this_size : size);
+	if (cmp == 0 && this_size < size) {
 		return -1;
 	}
-	else if (cmp == 0 && _data->size() > size) {
+	else if (cmp == 0 && this_size > size) {
 		return 1;
 	}
 	return cmp;
@@ -140,23 +144,18 @@ int Bytes::compare(const uint8_t* buf, size_t size) const {
 void Bytes::assignHex(const uint8_t* hex, size_t hex_size) {
 	// if assignment is empty then clear data and don't bother creating new
 	if (hex == nullptr || hex_size <= 0) {
-		_data = nullptr;
-		_exclusive = true;
+		clear();
 		return;
 	}
 	// Truncate to even length (hex bytes come in pairs)
 	hex_size &= ~(size_t)1;
 	if (hex_size == 0) {
-		_data = nullptr;
-		_exclusive = true;
+		clear();
 		return;
 	}
-	exclusiveData(false, hex_size / 2);
-	// need to clear data since we're appending below
-	_data->clear();
+	uint8_t* buffer = exclusiveData(hex_size / 2, false, hex_size / 2);
 	for (size_t i = 0; i < hex_size; i += 2) {
-		uint8_t byte = (hex[i] % 32 + 9) % 25 * 16 + (hex[i+1] % 32 + 9) % 25;
-		_data->push_back(byte);
+		*buffer++ = (hex[i] % 32 + 9) % 25 * 16 + (hex[i+1] % 32 + 9) % 25;
 	}
 }
 
@@ -170,10 +169,10 @@ void Bytes::appendHex(const uint8_t* hex, size_t hex_size) {
 	if (hex_size == 0) {
 		return;
 	}
-	exclusiveData(true, size() + (hex_size / 2));
+	size_t current_size = size();
+	uint8_t* buffer = exclusiveData(current_size + (hex_size / 2)) + current_size;
 	for (size_t i = 0; i < hex_size; i += 2) {
-		uint8_t byte = (hex[i] % 32 + 9) % 25 * 16 + (hex[i+1] % 32 + 9) % 25;
-		_data->push_back(byte);
+		*buffer++ = (hex[i] % 32 + 9) % 25 * 16 + (hex[i+1] % 32 + 9) % 25;
 	}
 }
 
@@ -194,11 +193,14 @@ std::string RNS::hexFromByte(uint8_t byte, bool upper /*= true*/) {
 }
 
 std::string Bytes::toHex(bool upper /*= false*/) const {
-	if (!_data) {
+	if (empty()) {
 		return "";
 	}
 	std::string hex;
-	for (uint8_t byte : *_data) {
+	hex.reserve(size() * 2);
+	const uint8_t* bytes = data();
+	for (size_t i = 0; i < size(); ++i) {
+		uint8_t byte = bytes[i];
 		if (upper) {
 			hex += hex_upper_chars[ (byte&  0xF0) >> 4];
 			hex += hex_upper_chars[ (byte&  0x0F) >> 0];
@@ -213,7 +215,7 @@ std::string Bytes::toHex(bool upper /*= false*/) const {
 
 // mid
 Bytes Bytes::mid(size_t beginpos, size_t len) const {
-	if (!_data || beginpos >= size()) {
+	if (beginpos >= size()) {
 		return NONE;
 	}
 	size_t remaining = size() - beginpos;
@@ -225,15 +227,15 @@ Bytes Bytes::mid(size_t beginpos, size_t len) const {
 
 // to end
 Bytes Bytes::mid(size_t beginpos) const {
-	if (!_data || beginpos >= size()) {
+	if (beginpos >= size()) {
 		return NONE;
 	}
 	 return {data() + beginpos, size() - beginpos};
 }
 
 void Bytes::to_msgpack(arduino::msgpack::Packer& packer) const {
-	if (_data && !_data->empty()) {
-		packer.packBinary(_data->data(), _data->size());
+	if (!empty()) {
+		packer.packBinary(data(), size());
 	} else {
 		packer.packBinary(static_cast<const uint8_t*>(nullptr), (size_t)0);
 	}
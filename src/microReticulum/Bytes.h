@@ -33,6 +33,12 @@
 #define RNS_BYTES_ALLOCATOR 1
 #endif
 
+// Payloads up to this many bytes (hashes, keys, short fields) are stored inline in Bytes instead of in
+// heap-allocated shared data. Set to 0 to always use shared data.
+#ifndef RNS_BYTES_INLINE_SIZE
+#define RNS_BYTES_INLINE_SIZE 32
+#endif
+
 // Forward declaration so Bytes can advertise a `to_msgpack` member without
 // dragging the full MsgPack.h into every translation unit that needs Bytes.
 namespace arduino { namespace msgpack { class Packer; } }
@@ -61,6 +67,8 @@ namespace RNS {
 
 	#define COW
 
+	class BytesView;
+
 	class Bytes {
 
 	private:
@@ -75,6 +83,10 @@ namespace RNS {
 		static Data _empty_data;
 
 	public:
+		// Payloads up to this size are held inline in the object itself (no shared data allocation)
+		static constexpr size_t INLINE_CAPACITY = RNS_BYTES_INLINE_SIZE;
+		static_assert(RNS_BYTES_INLINE_SIZE <= 255, "RNS_BYTES_INLINE_SIZE must fit in uint8_t");
+
 		enum NoneConstructor {
 			NONE
 		};
@@ -91,6 +103,10 @@ namespace RNS {
 			assign(bytes);
 			MEMF("Bytes object copy created from bytes \"%s\", this: %lu, data: %lu", toString().c_str(), this, _data.get());
 		}
+		Bytes(Bytes&& bytes) noexcept {
+			take(bytes);
+			MEMF("Bytes object move created, this: %lu, data: %lu", this, _data.get());
+		}
 		// Construct from std::vector<uint8_t>
 		Bytes(const Data& data) {
 MEM("Creating from data-copy...");
@@ -129,10 +145,15 @@ MEM("Creating from std-vector-copy...");
 			MEMF("Bytes object created from std::string \"%s\", this: %lu, data: %lu", toString().c_str(), this, _data.get());
 		}
 		Bytes(size_t capacity) {
-			newData(capacity);
+			// only allocate shared data if requested capacity exceeds inline capacity
+			if (capacity > INLINE_CAPACITY) {
+				newData(capacity);
+			}
 			MEMF("Bytes object created with capacity %u, this: %lu, data: %lu", capacity, this, _data.get());
 		}
-		virtual ~Bytes() {
+		// CBA Not virtual, Bytes is a value type that is never derived from or deleted through a base pointer
+		//  and a vtable pointer would only add to the size of every instance
+		~Bytes() {
 			MEMF("Bytes object destroyed \"%s\", this: %lu, data: %lu", toString().c_str(), this, _data.get());
 		}
 
@@ -140,6 +161,12 @@ MEM("Creating from std-vector-copy...");
 			assign(bytes);
 			return *this;
 		}
+		inline const Bytes& operator = (Bytes&& bytes) noexcept {
+			if (&bytes != this) {
+				take(bytes);
+			}
+			return *this;
+		}
 		inline const Bytes& operator += (const Bytes& bytes) {
 			append(bytes);
 			return *this;
@@ -194,25 +221,27 @@ MEM("Creating from std-vector-copy...");
 		}
 
 		inline uint8_t& operator[](size_t index) {
-			if (!_data || index >= _data->size()) {
+			if (index >= size()) {
 				throw std::out_of_range("Index out of bounds");
 			}
-			return (*_data)[index];
+			// through the active data pointer, indexing _inline directly lets the compiler see the small
+			// buffer bound on paths where the data is actually shared
+			return const_cast<uint8_t*>(data())[index];
 		}
 
 		inline const uint8_t& operator[](size_t index) const {
-			if (!_data || index >= _data->size()) {
+			if (index >= size()) {
 				throw std::out_of_range("Index out of bounds");
 			}
-			return (*_data)[index];
+			return data()[index];
 		}
 
 		inline explicit operator bool() const {
-			return (_data && !_data->empty());
+			return !empty();
 		}
 		inline operator const Data() const {
 			if (!_data)
-				return Data();
+				return Data(_inline, _inline + _inline_size);
 			return *_data.get();
 		}
 		// CBA NOTE: Following cast operators can cause issues with ambiguity from other libraries
@@ -235,78 +264,77 @@ MEM("Creating from std-vector-copy...");
 			_exclusive = false;
 			return _data;
 		}
+		// Takes over the contents of bytes (shared data by pointer, inline data by copy) leaving it empty
+		inline void take(Bytes& bytes) noexcept {
+			_data = std::move(bytes._data);
+			_exclusive = bytes._exclusive;
+			_inline_size = bytes._inline_size;
+			if (_inline_size > 0) {
+				memcpy(_inline, bytes._inline, _inline_size);
+			}
+			bytes._exclusive = true;
+			bytes._inline_size = 0;
+		}
 		void newData(size_t capacity = 0);
-		void exclusiveData(bool copy = true, size_t capacity = 0);
+		uint8_t* exclusiveData(size_t newsize, bool copy = true, size_t capacity = 0);
+		void promoteData() const;
 
 	public:
 		inline void clear() {
 			_data = nullptr;
 			_exclusive = true;
+			_inline_size = 0;
 		}
 
 		inline void assign(const Bytes& bytes) {
+			if (&bytes == this) {
+				return;
+			}
+			// small payloads are copied inline, no sharing required
+			if (!bytes._data) {
+				_data = nullptr;
+				_exclusive = true;
+				_inline_size = bytes._inline_size;
+				if (_inline_size > 0) {
+					memcpy(_inline, bytes._inline, _inline_size);
+				}
+				return;
+			}
 #ifdef COW
 			// shared_ptr copy only — O(1), no heap allocation
 			_data = bytes.shareData();
 			_exclusive = false;
+			_inline_size = 0;
 #else
-			// if assignment is empty then clear data and don't bother creating new
-			if (bytes.size() <= 0) {
-				_data = nullptr;
-				_exclusive = true;
-				return;
-			}
-			exclusiveData(false, bytes._data->size());
-			//_data->insert(_data->begin(), bytes._data->begin(), bytes._data->end());
-			//_data->assign(bytes._data->begin(), bytes._data->end());
-			*_data = bytes._data;
+			assign(bytes.data(), bytes.size());
 #endif
 		}
 #if RNS_BYTES_ALLOCATOR
 		// Data type is *not* plain std::vector<uint8_t> so we need an additional assign variant for it
 		inline void assign(const std::vector<uint8_t>& data) {
-			// if assignment is empty then clear data and don't bother creating new
-			if (data.size() <= 0) {
-				_data = nullptr;
-				_exclusive = true;
-				return;
-			}
-			exclusiveData(false, data.size());
-			_data->assign(data.begin(), data.end());
-			//*_data = data;
+			assign(data.data(), data.size());
 		}
 #endif
 		inline void assign(const Data& data) {
-			// if assignment is empty then clear data and don't bother creating new
-			if (data.size() <= 0) {
-				_data = nullptr;
-				_exclusive = true;
-				return;
-			}
-			exclusiveData(false, data.size());
-			//_data->assign(data.begin(), data.end());
-			*_data = data;
+			assign(data.data(), data.size());
 		}
+		void assign(const BytesView& view);
 		inline void assign(Data&& rdata) {
-			// if assignment is empty then clear data and don't bother creating new
-			if (rdata.size() <= 0) {
-				_data = nullptr;
-				_exclusive = true;
+			// if assignment is empty or fits inline then don't bother creating shared data
+			if (rdata.size() <= INLINE_CAPACITY) {
+				assign(rdata.data(), rdata.size());
 				return;
 			}
-			exclusiveData(false);
+			newData();
 			*_data = std::move(rdata);
 		}
 		inline void assign(const uint8_t* chunk, size_t chunk_size) {
 			// if assignment is empty then clear data and don't bother creating new
 			if (chunk == nullptr || chunk_size <= 0) {
-				_data = nullptr;
-				_exclusive = true;
+				clear();
 				return;
 			}
-			exclusiveData(false, chunk_size);
-			//_data->insert(_data->begin(), chunk, chunk + chunk_size);
-			_data->assign(chunk, chunk + chunk_size);
+			memcpy(exclusiveData(chunk_size, false, chunk_size), chunk, chunk_size);
 		}
 		inline void assign(const void* chunk, size_t chunk_size) {
 			assign((uint8_t*)chunk, chunk_size);
@@ -314,14 +342,10 @@ MEM("Creating from std-vector-copy...");
 		inline void assign(const char* string) {
 			// if assignment is empty then clear data and don't bother creating new
 			if (string == nullptr || string[0] == 0) {
-				_data = nullptr;
-				_exclusive = true;
+				clear();
 				return;
 			}
-			size_t string_size = strlen(string);
-			exclusiveData(false, string_size);
-			//_data->insert(_data->begin(), (uint8_t* )string, (uint8_t* )string + string_size);
-			_data->assign((uint8_t* )string, (uint8_t* )string + string_size);
+			assign((const uint8_t*)string, strlen(string));
 		}
 		//inline void assign(const std::string& string) { assign(string.c_str()); }
 		inline void assign(const std::string& string) { assign((uint8_t*)string.c_str(), string.length()); }
@@ -333,24 +357,25 @@ MEM("Creating from std-vector-copy...");
 			if (bytes.size() <= 0) {
 				return;
 			}
-			exclusiveData(true, size() + bytes.size());
-			_data->insert(_data->end(), bytes._data->begin(), bytes._data->end());
-		}
-		inline void append(const Data& data) {
-			// if append is empty then do nothing
-			if (data.size() <= 0) {
+			// appending to self may relocate the source, so append from a (cheap) copy
+			if (&bytes == this) {
+				Bytes copy(bytes);
+				append(copy.data(), copy.size());
 				return;
 			}
-			exclusiveData(true, size() + data.size());
-			_data->insert(_data->end(), data.begin(), data.end());
+			append(bytes.data(), bytes.size());
 		}
+		inline void append(const Data& data) {
+			append(data.data(), data.size());
+		}
+		void append(const BytesView& view);
 		inline void append(const uint8_t* chunk, size_t chunk_size) {
 			// if append is empty then do nothing
 			if (chunk == nullptr || chunk_size <= 0) {
 				return;
 			}
-			exclusiveData(true, size() + chunk_size);
-			_data->insert(_data->end(), chunk, chunk + chunk_size);
+			size_t current_size = size();
+			memcpy(exclusiveData(current_size + chunk_size) + current_size, chunk, chunk_size);
 		}
 		inline void append(const void* chunk, size_t chunk_size) {
 			append((uint8_t*)chunk, chunk_size);
@@ -360,13 +385,11 @@ MEM("Creating from std-vector-copy...");
 			if (string == nullptr || string[0] == 0) {
 				return;
 			}
-			size_t string_size = strlen(string);
-			exclusiveData(true, size() + string_size);
-			_data->insert(_data->end(), (uint8_t* )string, (uint8_t* )string + string_size);
+			append((const uint8_t*)string, strlen(string));
 		}
 		inline void append(uint8_t byte) {
-			exclusiveData(true, size() + 1);
-			_data->push_back(byte);
+			size_t current_size = size();
+			exclusiveData(current_size + 1)[current_size] = byte;
 		}
 		//inline void append(const std::string& string) { append(string.c_str()); }
 		inline void append(const std::string& string) { append((uint8_t*)string.c_str(), string.length()); }
@@ -375,19 +398,12 @@ MEM("Creating from std-vector-copy...");
 
 		inline uint8_t* writable(size_t size) {
 			if (size > 0) {
-				// create exclusive data with reserved capacity
-				exclusiveData(false, size);
-				// actually expand data to requested size
-				resize(size);
-				return _data->data();
+				// create exclusive data with reserved capacity and expand to requested size
+				return exclusiveData(size, false, size);
 			}
-			else if (_data) {
-				size_t current_size = _data->size();
-				// create exclusive data with reserved capacity
-				exclusiveData(false, current_size);
-				// actually expand data to current size
-				resize(current_size);
-				return _data->data();
+			else if (!empty()) {
+				// create exclusive data at current size
+				return exclusiveData(this->size());
 			}
 			return nullptr;
 		}
@@ -397,26 +413,22 @@ MEM("Creating from std-vector-copy...");
 			if (newsize == size()) {
 				return;
 			}
-			// CBA TODO Determine whether or not to reserve capacity here since when size is shrunk the call to
-			// exclusive data may copy all data firt which will effectively grow the data again before being
-			// shrunk below (inefficient).
-			exclusiveData(true);
-			_data->resize(newsize);
+			exclusiveData(newsize);
 		}
 
 	public:
 		int compare(const Bytes& bytes) const;
 		int compare(const uint8_t* buf, size_t size) const;
 		inline int compare(const char* str) const { if (!str) return empty() ? 0 : 1; return compare((const uint8_t*)str, strlen(str)); }
-		inline size_t size() const { if (!_data) return 0; return _data->size(); }
-		inline bool empty() const { if (!_data) return true; return _data->empty(); }
-		inline size_t capacity() const { if (!_data) return 0; return _data->capacity(); }
-		inline void reserve(size_t capacity) const { if (!_data) return; _data->reserve(capacity); }
-		inline const uint8_t* data() const { if (!_data) return nullptr; return _data->data(); }
-		//inline const Data& collection() const { if (!_data) return Data(); return *_data.get(); }
-		inline const Data& collection() const { if (!_data) return _empty_data; return *_data.get(); }
-
-		inline std::string toString() const { if (!_data) return ""; return {(const char*)data(), size()}; }
+		inline size_t size() const { if (!_data) return _inline_size; return _data->size(); }
+		inline bool empty() const { return size() == 0; }
+		inline size_t capacity() const { if (!_data) return INLINE_CAPACITY; return _data->capacity(); }
+		inline void reserve(size_t capacity) { if (capacity <= this->capacity()) return; exclusiveData(size(), true, capacity); }
+		inline const uint8_t* data() const { if (!_data) return (_inline_size > 0) ? _inline : nullptr; return _data->data(); }
+		// NOTE: Forces inline data out to shared data so a vector reference can be returned, prefer data()/size()
+		inline const Data& collection() const { if (!_data) { if (_inline_size == 0) return _empty_data; promoteData(); } return *_data.get(); }
+
+		inline std::string toString() const { if (empty()) return ""; return {(const char*)data(), size()}; }
 		std::string toHex(bool upper = false) const;
 
 		// MsgPack hook: detected by Packer's `has_to_msgpack` so that callers can
@@ -426,18 +438,22 @@ MEM("Creating from std-vector-copy...");
 		void to_msgpack(arduino::msgpack::Packer& packer) const;
 		Bytes mid(size_t beginpos, size_t len) const;
 		Bytes mid(size_t beginpos) const;
-		inline Bytes left(size_t len) const { if (!_data) return NONE; if (len > size()) len = size(); return {data(), len}; }
-		inline Bytes right(size_t len) const { if (!_data) return NONE; if (len > size()) len = size(); return {data() + (size() - len), len}; }
+		// Zero-copy slices (see BytesView), same bounds semantics as mid()
+		BytesView view() const;
+		BytesView view(size_t beginpos, size_t len) const;
+		BytesView view(size_t beginpos) const;
+		inline Bytes left(size_t len) const { if (empty()) return NONE; if (len > size()) len = size(); return {data(), len}; }
+		inline Bytes right(size_t len) const { if (empty()) return NONE; if (len > size()) len = size(); return {data() + (size() - len), len}; }
 		inline int find(int pos, const char* str) {
-			if (!str || !_data || _data->data() == nullptr || (size_t)pos >= _data->size()) {
+			if (!str || empty() || (size_t)pos >= size()) {
 				return -1;
 			}
-			//const char* ptr = strnstr((const char*)(_data->data() + pos), str, (_data->size() - pos));
-			void* ptr = memmem((const void*)(_data->data() + pos), (_data->size() - pos), (const void*)str, strlen(str));
+			//const char* ptr = strnstr((const char*)(data() + pos), str, (size() - pos));
+			void* ptr = memmem((const void*)(data() + pos), (size() - pos), (const void*)str, strlen(str));
 			if (ptr == nullptr) {
 				return -1;
 			}
-			return (int)((uint8_t*)ptr - _data->data());
+			return (int)((const uint8_t*)ptr - data());
 		}
 		inline int find(const char* str) { return find(0, str); }
 
@@ -464,11 +480,91 @@ MEM("Creating from std-vector-copy...");
 		//   second to last element
 
 	private:
-		SharedData _data;
+		// Shared (COW) data is only used for payloads larger than INLINE_CAPACITY (or explicitly reserved capacity),
+		// otherwise data lives in _inline and _data is null.
+		// CBA mutable only so that const collection() can promote inline data to shared data
+		mutable SharedData _data;
 		mutable bool _exclusive = true;
+		mutable uint8_t _inline_size = 0;
+		uint8_t _inline[INLINE_CAPACITY > 0 ? INLINE_CAPACITY : 1];
+
+	};
+
+	// Read-only slice of a Bytes that keeps the underlying data alive without copying it.
+	// The view holds a reference to the shared data of its owner (inline data is simply carried along),
+	// so creating and copying views never allocates. Later changes to the owner are not visible through
+	// the view since the owner then gets its own copy (COW).
+	class BytesView {
+
+	public:
+		BytesView() {}
+		BytesView(const Bytes& owner) : _owner(owner), _size(owner.size()) {}
+		BytesView(const Bytes& owner, size_t beginpos, size_t len) : _owner(owner) {
+			size_t owner_size = owner.size();
+			if (beginpos >= owner_size) {
+				_owner.clear();
+				return;
+			}
+			_offset = beginpos;
+			_size = (len > owner_size - beginpos) ? (owner_size - beginpos) : len;
+		}
+
+		inline const uint8_t* data() const { if (_size == 0) return nullptr; return _owner.data() + _offset; }
+		inline size_t size() const { return _size; }
+		inline bool empty() const { return _size == 0; }
+		inline explicit operator bool() const { return _size > 0; }
+
+		inline const uint8_t& operator[](size_t index) const {
+			if (index >= _size) {
+				throw std::out_of_range("Index out of bounds");
+			}
+			return data()[index];
+		}
+
+		inline BytesView mid(size_t beginpos, size_t len) const {
+			if (beginpos >= _size) return {};
+			return {_owner, _offset + beginpos, (len > _size - beginpos) ? (_size - beginpos) : len};
+		}
+		inline BytesView mid(size_t beginpos) const { return mid(beginpos, _size); }
+		inline BytesView left(size_t len) const { return mid(0, len); }
+		inline BytesView right(size_t len) const { if (len > _size) len = _size; return mid(_size - len, len); }
+
+		inline int compare(const BytesView& view) const { return compare(view.data(), view.size()); }
+		inline int compare(const uint8_t* buf, size_t size) const {
+			if (_size == 0 && size == 0) return 0;
+			if (_size == 0) return -1;
+			if (size == 0) return 1;
+			int cmp = memcmp(data(), buf, (_size < size) ? _size : size);
+			if (cmp == 0 && _size != size) return (_size < size) ? -1 : 1;
+			return cmp;
+		}
+		inline bool operator == (const BytesView& view) const { return _size == view._size && compare(view) == 0; }
+		inline bool operator != (const BytesView& view) const { return !(*this == view); }
+		inline bool operator < (const BytesView& view) const { return compare(view) < 0; }
+
+		// Copies the viewed data out into its own Bytes
+		inline Bytes bytes() const { return {data(), _size}; }
+		inline std::string toString() const { if (_size == 0) return ""; return {(const char*)data(), _size}; }
+		inline std::string toHex(bool upper = false) const { return bytes().toHex(upper); }
+
+	private:
+		Bytes _owner;
+		size_t _offset = 0;
+		size_t _size = 0;
 
 	};
 
+	inline BytesView Bytes::view() const { return {*this}; }
+	inline BytesView Bytes::view(size_t beginpos, size_t len) const { return {*this, beginpos, len}; }
+	inline BytesView Bytes::view(size_t beginpos) const { return {*this, beginpos, size()}; }
+	inline void Bytes::assign(const BytesView& view) { assign(view.data(), view.size()); }
+	inline void Bytes::append(const BytesView& view) { append(view.data(), view.size()); }
+
+	inline bool operator == (const Bytes& bytes, const BytesView& view) { return bytes.size() == view.size() && bytes.compare(view.data(), view.size()) == 0; }
+	inline bool operator == (const BytesView& view, const Bytes& bytes) { return bytes == view; }
+	inline bool operator != (const Bytes& bytes, const BytesView& view) { return !(bytes == view); }
+	inline bool operator != (const BytesView& view, const Bytes& bytes) { return !(bytes == view); }
+
 	// following array function doesn't work without size since it's passed as a pointer to the array so sizeof() is of the pointer
 	//inline Bytes bytesFromArray(const uint8_t arr[]) { return Bytes(arr, sizeof(arr)); }
 	//inline Bytes bytesFromChunk(const uint8_t* ptr, size_t len) { return Bytes(ptr, len); }
@@ -497,6 +593,11 @@ inline RNS::Bytes& operator << (RNS::Bytes& lhbytes, uint8_t rhbyte) {
 	return lhbytes;
 }
 
+inline RNS::Bytes& operator << (RNS::Bytes& lhbytes, const RNS::BytesView& rhview) {
+	lhbytes.append(rhview);
+	return lhbytes;
+}
+
 inline RNS::Bytes& operator << (RNS::Bytes& lhbytes, const char* rhstr) {
 //MEM("Appending right-hand str to left-hand Bytes");
 	lhbytes.append(rhstr);
@@ -504,6 +605,23 @@ inline RNS::Bytes& operator << (RNS::Bytes& lhbytes, const char* rhstr) {
 	return lhbytes;
 }
 
+// Hash support so Bytes can key std::unordered_map/std::unordered_set (FNV-1a)
+namespace std {
+	template<>
+	struct hash<RNS::Bytes> {
+		inline size_t operator()(const RNS::Bytes& bytes) const noexcept {
+			size_t hash = (sizeof(size_t) > 4) ? (size_t)14695981039346656037ULL : (size_t)2166136261UL;
+			const size_t prime = (sizeof(size_t) > 4) ? (size_t)1099511628211ULL : (size_t)16777619UL;
+			const uint8_t* data = bytes.data();
+			for (size_t i = 0; i < bytes.size(); ++i) {
+				hash ^= data[i];
+				hash *= prime;
+			}
+			return hash;
+		}
+	};
+}
+
 //CBA TODO Standardize where custom object de/serialization lives
 namespace ArduinoJson {
 	// Serialize
@@ -527,7 +645,8 @@ struct Codec<RNS::Bytes>
 	inline static std::vector<uint8_t> encode(const RNS::Bytes& entry) {
 		// CBA Following ok?
 		//return entry.collection();
-		return std::vector<uint8_t>(entry.collection().begin(), entry.collection().end());
+		if (entry.empty()) return {};
+		return std::vector<uint8_t>(entry.data(), entry.data() + entry.size());
 	}
 	inline static bool decode(const std::vector<uint8_t>& data, RNS::Bytes& entry) {
 		entry.assign(data);
@@ -14,90 +14,142 @@
 
 #pragma once
 
-#include "CBC.h"
+#include "AESBackend.h"
 
 #include "../Bytes.h"
 
 #include <AES.h>
+#include <memory>
+#include <stdexcept>
+#include <cassert>
+#include <string.h>
 
 namespace RNS { namespace Cryptography {
 
-	class AES_128_CBC {
+	// AES-CBC for many messages under the same key. The key schedule is expanded once up front
+	// instead of on every call, and output is written straight to the caller's buffer. Uses the
+	// hardware backend where there is one (see AESBackend), else the Crypto library block ciphers.
+	class AES_CBC {
 
 	public:
-		static inline const Bytes encrypt(const Bytes& plaintext, const Bytes& key, const Bytes& iv) {
-			CBC<AES128> cbc;
-			cbc.setKey(key.data(), key.size());
-			cbc.setIV(iv.data(), iv.size());
-			Bytes ciphertext;
-			cbc.encrypt(ciphertext.writable(plaintext.size()), plaintext.data(), plaintext.size());
-			return ciphertext;
-		}
+		static const size_t BLOCK_SIZE = 16;
 
-		static inline const Bytes decrypt(const Bytes& ciphertext, const Bytes& key, const Bytes& iv) {
-			CBC<AES128> cbc;
-			cbc.setKey(key.data(), key.size());
-			cbc.setIV(iv.data(), iv.size());
-			Bytes plaintext;
-			cbc.decrypt(plaintext.writable(ciphertext.size()), ciphertext.data(), ciphertext.size());
-			return plaintext;
+	public:
+		AES_CBC() {}
+		AES_CBC(const Bytes& key) { this->key(key.data(), key.size()); }
+
+		// 128 bit or 256 bit key
+		inline void key(const Bytes& key) { this->key(key.data(), key.size()); }
+		inline void key(const uint8_t* key, size_t key_size) {
+			if (key_size != 16 && key_size != 32) {
+				throw std::invalid_argument("AES key must be 128 or 256 bits, not " + std::to_string(key_size*8));
+			}
+			_cipher.reset();
+			_round_keys.reset(new AESRoundKeys());
+			if (aes_expand_key(*_round_keys, key, key_size)) {
+				return;
+			}
+			_round_keys.reset();
+			if (key_size == 16) {
+				_cipher.reset(new AES128());
+			}
+			else {
+				_cipher.reset(new AES256());
+			}
+			_cipher->setKey(key, key_size);
 		}
 
-		// EXPERIMENTAL - overwrites passed buffer
-		static inline void inplace_encrypt(Bytes& plaintext, const Bytes& key, const Bytes& iv) {
-			CBC<AES128> cbc;
-			cbc.setKey(key.data(), key.size());
-			cbc.setIV(iv.data(), iv.size());
-			cbc.encrypt((uint8_t*)plaintext.data(), plaintext.data(), plaintext.size());
+		// size must be a multiple of BLOCK_SIZE, output may be the same buffer as input
+		inline void encrypt(uint8_t* output, const uint8_t* input, size_t size, const uint8_t* iv) {
+			if (_round_keys) {
+				aes_cbc_encrypt(*_round_keys, output, input, size, iv);
+				return;
+			}
+			assert(_cipher);
+			const uint8_t* chain = iv;
+			for (size_t offset = 0; offset + BLOCK_SIZE <= size; offset += BLOCK_SIZE) {
+				uint8_t block[BLOCK_SIZE];
+				for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+					block[i] = input[offset + i] ^ chain[i];
+				}
+				_cipher->encryptBlock(output + offset, block);
+				chain = output + offset;
+			}
 		}
 
-		// EXPERIMENTAL - overwrites passed buffer
-		static inline void inplace_decrypt(Bytes& ciphertext, const Bytes& key, const Bytes& iv) {
-			CBC<AES128> cbc;
-			cbc.setKey(key.data(), key.size());
-			cbc.setIV(iv.data(), iv.size());
-			cbc.decrypt((uint8_t*)ciphertext.data(), ciphertext.data(), ciphertext.size());
+		// size must be a multiple of BLOCK_SIZE, output may be the same buffer as input or start before it
+		inline void decrypt(uint8_t* output, const uint8_t* input, size_t size, const uint8_t* iv) {
+			if (_round_keys) {
+				aes_cbc_decrypt(*_round_keys, output, input, size, iv);
+				return;
+			}
+			assert(_cipher);
+			uint8_t chain[BLOCK_SIZE];
+			memcpy(chain, iv, BLOCK_SIZE);
+			for (size_t offset = 0; offset + BLOCK_SIZE <= size; offset += BLOCK_SIZE) {
+				uint8_t block[BLOCK_SIZE];
+				_cipher->decryptBlock(block, input + offset);
+				for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+					uint8_t in = input[offset + i];
+					output[offset + i] = block[i] ^ chain[i];
+					chain[i] = in;
+				}
+			}
 		}
 
+		inline explicit operator bool() const { return _round_keys || _cipher; }
+
+	private:
+		std::unique_ptr<AESRoundKeys> _round_keys;
+		std::unique_ptr<BlockCipher> _cipher;
+
 	};
 
-	class AES_256_CBC {
+	// One-off AES-CBC with a key of fixed size
+	template <size_t KEY_SIZE>
+	class AES_CBC_FIXED {
 
 	public:
 		static inline const Bytes encrypt(const Bytes& plaintext, const Bytes& key, const Bytes& iv) {
-			CBC<AES256> cbc;
-			cbc.setKey(key.data(), key.size());
-			cbc.setIV(iv.data(), iv.size());
 			Bytes ciphertext;
-			cbc.encrypt(ciphertext.writable(plaintext.size()), plaintext.data(), plaintext.size());
+			cbc(key).encrypt(ciphertext.writable(plaintext.size()), plaintext.data(), plaintext.size(), checked_iv(iv));
 			return ciphertext;
 		}
 
 		static inline const Bytes decrypt(const Bytes& ciphertext, const Bytes& key, const Bytes& iv) {
-			CBC<AES256> cbc;
-			cbc.setKey(key.data(), key.size());
-			cbc.setIV(iv.data(), iv.size());
 			Bytes plaintext;
-			cbc.decrypt(plaintext.writable(ciphertext.size()), ciphertext.data(), ciphertext.size());
+			cbc(key).decrypt(plaintext.writable(ciphertext.size()), ciphertext.data(), ciphertext.size(), checked_iv(iv));
 			return plaintext;
 		}
 
 		// EXPERIMENTAL - overwrites passed buffer
 		static inline void inplace_encrypt(Bytes& plaintext, const Bytes& key, const Bytes& iv) {
-			CBC<AES256> cbc;
-			cbc.setKey(key.data(), key.size());
-			cbc.setIV(iv.data(), iv.size());
-			cbc.encrypt((uint8_t*)plaintext.data(), plaintext.data(), plaintext.size());
+			cbc(key).encrypt((uint8_t*)plaintext.data(), plaintext.data(), plaintext.size(), checked_iv(iv));
 		}
 
 		// EXPERIMENTAL - overwrites passed buffer
 		static inline void inplace_decrypt(Bytes& ciphertext, const Bytes& key, const Bytes& iv) {
-			CBC<AES256> cbc;
-			cbc.setKey(key.data(), key.size());
-			cbc.setIV(iv.data(), iv.size());
-			cbc.decrypt((uint8_t*)ciphertext.data(), ciphertext.data(), ciphertext.size());
+			cbc(key).decrypt((uint8_t*)ciphertext.data(), ciphertext.data(), ciphertext.size(), checked_iv(iv));
+		}
+
+	private:
+		static inline AES_CBC cbc(const Bytes& key) {
+			if (key.size() != KEY_SIZE) {
+				throw std::invalid_argument("AES key must be " + std::to_string(KEY_SIZE*8) + " bits, not " + std::to_string(key.size()*8));
+			}
+			return AES_CBC(key);
+		}
+
+		static inline const uint8_t* checked_iv(const Bytes& iv) {
+			if (iv.size() != AES_CBC::BLOCK_SIZE) {
+				throw std::invalid_argument("AES-CBC iv must be 128 bits, not " + std::to_string(iv.size()*8));
+			}
+			return iv.data();
 		}
 
 	};
 
+	using AES_128_CBC = AES_CBC_FIXED<16>;
+	using AES_256_CBC = AES_CBC_FIXED<32>;
+
 } }
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "AESBackend.h"
+
+// Set to 0 to always use the portable block ciphers
+#ifndef RNS_AES_ACCELERATION
+#define RNS_AES_ACCELERATION 1
+#endif
+
+#if RNS_AES_ACCELERATION && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RNS_AES_AESNI 1
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+
+using namespace RNS::Cryptography;
+
+#ifdef RNS_AES_AESNI
+// Blocks decrypted together, CBC decryption doesn't chain so these overlap in the AES pipeline
+static const size_t DECRYPT_LANES = 8;
+
+static bool aesni_supported() {
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		return false;
+	}
+	return (ecx & bit_AES) != 0;
+}
+
+// Next round key from the previous one and the (shuffled) aeskeygenassist word
+__attribute__((target("aes,sse2")))
+static inline __m128i expand_step(__m128i key, __m128i assist) {
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	return _mm_xor_si128(key, assist);
+}
+
+// aeskeygenassist takes its round constant as an immediate, hence the template
+template <int RCON>
+__attribute__((target("aes,sse2")))
+static inline __m128i expand_128(__m128i key) {
+	return expand_step(key, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, RCON), 0xff));
+}
+
+template <int RCON>
+__attribute__((target("aes,sse2")))
+static inline void expand_256(__m128i* rk, int i) {
+	rk[i] = expand_step(rk[i - 2], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(rk[i - 1], RCON), 0xff));
+	if (i + 1 < 15) {
+		rk[i + 1] = expand_step(rk[i - 1], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(rk[i], 0x00), 0xaa));
+	}
+}
+
+__attribute__((target("aes,sse2")))
+static bool aesni_expand_key(AESRoundKeys& round_keys, const uint8_t* key, size_t key_size) {
+	__m128i rk[15];
+	if (key_size == 16) {
+		round_keys.rounds = 10;
+		rk[0] = _mm_loadu_si128((const __m128i*)key);
+		rk[1] = expand_128<0x01>(rk[0]);
+		rk[2] = expand_128<0x02>(rk[1]);
+		rk[3] = expand_128<0x04>(rk[2]);
+		rk[4] = expand_128<0x08>(rk[3]);
+		rk[5] = expand_128<0x10>(rk[4]);
+		rk[6] = expand_128<0x20>(rk[5]);
+		rk[7] = expand_128<0x40>(rk[6]);
+		rk[8] = expand_128<0x80>(rk[7]);
+		rk[9] = expand_128<0x1b>(rk[8]);
+		rk[10] = expand_128<0x36>(rk[9]);
+	}
+	else if (key_size == 32) {
+		round_keys.rounds = 14;
+		rk[0] = _mm_loadu_si128((const __m128i*)key);
+		rk[1] = _mm_loadu_si128((const __m128i*)(key + 16));
+		expand_256<0x01>(rk, 2);
+		expand_256<0x02>(rk, 4);
+		expand_256<0x04>(rk, 6);
+		expand_256<0x08>(rk, 8);
+		expand_256<0x10>(rk, 10);
+		expand_256<0x20>(rk, 12);
+		expand_256<0x40>(rk, 14);
+	}
+	else {
+		return false;
+	}
+
+	// Equivalent inverse cipher keys for aesdec, in reverse order
+	int rounds = round_keys.rounds;
+	__m128i* encrypt = (__m128i*)round_keys.encrypt;
+	__m128i* decrypt = (__m128i*)round_keys.decrypt;
+	for (int i = 0; i <= rounds; ++i) {
+		_mm_store_si128(&encrypt[i], rk[i]);
+	}
+	_mm_store_si128(&decrypt[0], rk[rounds]);
+	for (int i = 1; i < rounds; ++i) {
+		_mm_store_si128(&decrypt[i], _mm_aesimc_si128(rk[rounds - i]));
+	}
+	_mm_store_si128(&decrypt[rounds], rk[0]);
+	return true;
+}
+
+__attribute__((target("aes,sse2")))
+static void aesni_cbc_encrypt(const AESRoundKeys& round_keys, uint8_t* output, const uint8_t* input, size_t size, const uint8_t* iv) {
+	const __m128i* rk = (const __m128i*)round_keys.encrypt;
+	const int rounds = round_keys.rounds;
+	__m128i block = _mm_loadu_si128((const __m128i*)iv);
+	for (size_t offset = 0; offset + 16 <= size; offset += 16) {
+		block = _mm_xor_si128(block, _mm_loadu_si128((const __m128i*)(input + offset)));
+		block = _mm_xor_si128(block, _mm_load_si128(&rk[0]));
+		for (int round = 1; round < rounds; ++round) {
+			block = _mm_aesenc_si128(block, _mm_load_si128(&rk[round]));
+		}
+		block = _mm_aesenclast_si128(block, _mm_load_si128(&rk[rounds]));
+		_mm_storeu_si128((__m128i*)(output + offset), block);
+	}
+}
+
+__attribute__((target("aes,sse2")))
+static void aesni_cbc_decrypt(const AESRoundKeys& round_keys, uint8_t* output, const uint8_t* input, size_t size, const uint8_t* iv) {
+	const __m128i* rk = (const __m128i*)round_keys.decrypt;
+	const int rounds = round_keys.rounds;
+	__m128i chain = _mm_loadu_si128((const __m128i*)iv);
+	size_t offset = 0;
+
+	// All ciphertext of a batch is loaded before any plaintext is stored, which keeps in place use safe
+	for (; offset + DECRYPT_LANES * 16 <= size; offset += DECRYPT_LANES * 16) {
+		__m128i ciphertext[DECRYPT_LANES];
+		__m128i block[DECRYPT_LANES];
+		for (size_t lane = 0; lane < DECRYPT_LANES; ++lane) {
+			ciphertext[lane] = _mm_loadu_si128((const __m128i*)(input + offset + 16 * lane));
+			block[lane] = _mm_xor_si128(ciphertext[lane], _mm_load_si128(&rk[0]));
+		}
+		for (int round = 1; round < rounds; ++round) {
+			__m128i key = _mm_load_si128(&rk[round]);
+			for (size_t lane = 0; lane < DECRYPT_LANES; ++lane) {
+				block[lane] = _mm_aesdec_si128(block[lane], key);
+			}
+		}
+		__m128i key = _mm_load_si128(&rk[rounds]);
+		for (size_t lane = 0; lane < DECRYPT_LANES; ++lane) {
+			block[lane] = _mm_aesdeclast_si128(block[lane], key);
+		}
+		block[0] = _mm_xor_si128(block[0], chain);
+		for (size_t lane = 1; lane < DECRYPT_LANES; ++lane) {
+			block[lane] = _mm_xor_si128(block[lane], ciphertext[lane - 1]);
+		}
+		chain = ciphertext[DECRYPT_LANES - 1];
+		for (size_t lane = 0; lane < DECRYPT_LANES; ++lane) {
+			_mm_storeu_si128((__m128i*)(output + offset + 16 * lane), block[lane]);
+		}
+	}
+
+	for (; offset + 16 <= size; offset += 16) {
+		__m128i ciphertext = _mm_loadu_si128((const __m128i*)(input + offset));
+		__m128i block = _mm_xor_si128(ciphertext, _mm_load_si128(&rk[0]));
+		for (int round = 1; round < rounds; ++round) {
+			block = _mm_aesdec_si128(block, _mm_load_si128(&rk[round]));
+		}
+		block = _mm_aesdeclast_si128(block, _mm_load_si128(&rk[rounds]));
+		_mm_storeu_si128((__m128i*)(output + offset), _mm_xor_si128(block, chain));
+		chain = ciphertext;
+	}
+}
+#endif
+
+static aes_backend best_backend() {
+	if (aes_backend_supported(AES_BACKEND_AESNI)) return AES_BACKEND_AESNI;
+	return AES_BACKEND_PORTABLE;
+}
+
+// Selected on first use rather than during static initialization
+static aes_backend& active_backend() {
+	static aes_backend backend = best_backend();
+	return backend;
+}
+
+bool RNS::Cryptography::aes_backend_supported(aes_backend backend) {
+	switch (backend) {
+	case AES_BACKEND_PORTABLE:
+		return true;
+#ifdef RNS_AES_AESNI
+	case AES_BACKEND_AESNI:
+		return aesni_supported();
+#endif
+	default:
+		return false;
+	}
+}
+
+aes_backend RNS::Cryptography::aes_active_backend() {
+	return active_backend();
+}
+
+bool RNS::Cryptography::aes_use_backend(aes_backend backend) {
+	if (!aes_backend_supported(backend)) {
+		return false;
+	}
+	active_backend() = backend;
+	return true;
+}
+
+const char* RNS::Cryptography::aes_backend_name(aes_backend backend) {
+	switch (backend) {
+	case AES_BACKEND_PORTABLE:
+		return "portable";
+	case AES_BACKEND_AESNI:
+		return "aes-ni";
+	default:
+		return "unknown";
+	}
+}
+
+bool RNS::Cryptography::aes_expand_key(AESRoundKeys& round_keys, const uint8_t* key, size_t key_size) {
+#ifdef RNS_AES_AESNI
+	if (active_backend() == AES_BACKEND_AESNI) {
+		return aesni_expand_key(round_keys, key, key_size);
+	}
+#endif
+	return false;
+}
+
+void RNS::Cryptography::aes_cbc_encrypt(const AESRoundKeys& round_keys, uint8_t* output, const uint8_t* input, size_t size, const uint8_t* iv) {
+#ifdef RNS_AES_AESNI
+	aesni_cbc_encrypt(round_keys, output, input, size, iv);
+#endif
+}
+
+void RNS::Cryptography::aes_cbc_decrypt(const AESRoundKeys& round_keys, uint8_t* output, const uint8_t* input, size_t size, const uint8_t* iv) {
+#ifdef RNS_AES_AESNI
+	aesni_cbc_decrypt(round_keys, output, input, size, iv);
+#endif
+}
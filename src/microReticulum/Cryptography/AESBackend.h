@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace RNS { namespace Cryptography {
+
+	// AES-CBC implementations. Hardware support is detected on first use, and the portable Crypto
+	// library block ciphers are used wherever it's missing.
+	enum aes_backend {
+		AES_BACKEND_PORTABLE = 0,
+		AES_BACKEND_AESNI,		// x86 AES-NI, detected at runtime by CPUID
+	};
+
+	bool aes_backend_supported(aes_backend backend);
+	aes_backend aes_active_backend();
+	// Switches the active backend for keys set from now on, for tests and benchmarks. Returns false
+	// if it isn't supported here.
+	bool aes_use_backend(aes_backend backend);
+	const char* aes_backend_name(aes_backend backend);
+
+	// AES-128 or AES-256 round keys expanded for a hardware backend
+	struct AESRoundKeys {
+		alignas(16) uint8_t encrypt[15 * 16];
+		alignas(16) uint8_t decrypt[15 * 16];
+		uint8_t rounds = 0;
+	};
+
+	// Expands key with the active hardware backend, false if the portable backend is active
+	bool aes_expand_key(AESRoundKeys& round_keys, const uint8_t* key, size_t key_size);
+	// CBC over whole 16 byte blocks, output may be the same buffer as input or start before it
+	void aes_cbc_encrypt(const AESRoundKeys& round_keys, uint8_t* output, const uint8_t* input, size_t size, const uint8_t* iv);
+	void aes_cbc_decrypt(const AESRoundKeys& round_keys, uint8_t* output, const uint8_t* input, size_t size, const uint8_t* iv);
+
+} }
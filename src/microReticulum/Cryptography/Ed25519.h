@@ -50,6 +50,12 @@ namespace RNS { namespace Cryptography {
 		}
 
 		inline bool verify(const Bytes& signature, const Bytes& message) {
+			return verify(signature.view(), message.view());
+		}
+		inline bool verify(const BytesView& signature, const BytesView& message) {
+			if (signature.size() < 64) {
+				return false;
+			}
 			return Ed25519::verify(signature.data(), _publicKey.data(), message.data(), message.size());
 		}
 
@@ -14,8 +14,7 @@
 
 #include "HKDF.h"
 
-#include <HKDF.h>
-#include <SHA256.h>
+#include <string.h>
 
 using namespace RNS;
 
@@ -29,14 +28,56 @@ const Bytes RNS::Cryptography::hkdf(size_t length, const Bytes& derive_from, con
 		throw std::invalid_argument("Cannot derive key from empty input material");
 	}
 
-	HKDF<SHA256> hkdf;
+	// CBA Context is not applied as HKDF info, same as before, since RNS always derives without one
+	SaltedHKDF hkdf(salt);
+	Bytes derived;
+	hkdf.derive(derived.writable(length), length, derive_from.data(), derive_from.size());
+	return derived;
+}
+
+void RNS::Cryptography::SaltedHKDF::salt(const Bytes& salt) {
 	if (salt) {
-		hkdf.setKey(derive_from.data(), derive_from.size(), salt.data(), salt.size());
+		_salt.key(salt.data(), salt.size());
 	}
 	else {
-		hkdf.setKey(derive_from.data(), derive_from.size());
+		// Same as hkdf() without salt, which uses a hash length of zeros
+		uint8_t zeros[32] = {0};
+		_salt.key(zeros, sizeof(zeros));
 	}
-	Bytes derived;
-	hkdf.extract(derived.writable(length), length);
-	return derived;
+}
+
+void RNS::Cryptography::SaltedHKDF::derive(uint8_t* output, size_t length, const uint8_t* derive_from, size_t derive_from_size) const {
+	if (!_salt) {
+		throw std::invalid_argument("HKDF salt not set");
+	}
+	if (length == 0 || length > 255 * 32) {
+		throw std::invalid_argument("Invalid output key length");
+	}
+
+	// Extract, pseudorandom_key = hmac_sha256(salt, derive_from)
+	uint8_t block[KeyedHMAC::DIGEST_SIZE];
+	_salt.digest(block, derive_from, derive_from_size);
+
+	// Expand, block = hmac_sha256(pseudorandom_key, block + bytes([i + 1]))
+	KeyedHMAC expand;
+	expand.key(block, sizeof(block));
+	uint8_t counter = 1;
+	size_t offset = 0;
+	while (offset < length) {
+		if (counter > 1) {
+			expand.digest(block, block, sizeof(block), &counter, 1);
+		}
+		else {
+			expand.digest(block, &counter, 1);
+		}
+
+		size_t size = length - offset;
+		if (size > sizeof(block)) {
+			size = sizeof(block);
+		}
+		memcpy(output + offset, block, size);
+		offset += size;
+		++counter;
+	}
+	memset(block, 0, sizeof(block));
 }
@@ -14,10 +14,32 @@
 
 #pragma once
 
+#include "HMAC.h"
 #include "../Bytes.h"
 
+#include <stdint.h>
+
 namespace RNS { namespace Cryptography {
 
 	const Bytes hkdf(size_t length, const Bytes& derive_from, const Bytes& salt = {Bytes::NONE}, const Bytes& context = {Bytes::NONE});
 
+	// HKDF-SHA256 for many derivations with the same salt. The salt's HMAC key schedule is hashed
+	// once up front, and output is written straight to the caller's buffer. Derives the same bytes
+	// as hkdf(length, derive_from, salt) without context.
+	class SaltedHKDF {
+
+	public:
+		SaltedHKDF() {}
+		SaltedHKDF(const Bytes& salt) { this->salt(salt); }
+
+		void salt(const Bytes& salt);
+		void derive(uint8_t* output, size_t length, const uint8_t* derive_from, size_t derive_from_size) const;
+
+		inline explicit operator bool() const { return (bool)_salt; }
+
+	private:
+		KeyedHMAC _salt;
+
+	};
+
 } }
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "Hashes.h"
 #include "../Bytes.h"
 
 #include <Hash.h>
@@ -22,6 +23,7 @@
 #include <stdexcept>
 #include <memory>
 #include <cassert>
+#include <string.h>
 
 namespace RNS { namespace Cryptography {
 
@@ -108,6 +110,64 @@ namespace RNS { namespace Cryptography {
 
 	};
 
+	// HMAC-SHA256 for many messages under the same key. The key's inner and outer pad blocks are
+	// hashed once up front, so each digest costs only the message and the final outer compression.
+	class KeyedHMAC {
+
+	public:
+		static const size_t DIGEST_SIZE = 32;
+		static const size_t BLOCK_SIZE = 64;
+
+	public:
+		KeyedHMAC() {}
+		KeyedHMAC(const Bytes& key) { this->key(key.data(), key.size()); }
+
+		inline void key(const uint8_t* key, size_t key_size) {
+			uint8_t block[BLOCK_SIZE] = {0};
+			if (key_size > BLOCK_SIZE) {
+				SHA256Context hash;
+				hash.update(key, key_size);
+				hash.finalize(block);
+			}
+			else {
+				memcpy(block, key, key_size);
+			}
+			for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+				block[i] ^= 0x36;
+			}
+			_inner.reset();
+			_inner.update(block, BLOCK_SIZE);
+			for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+				block[i] ^= 0x36 ^ 0x5c;
+			}
+			_outer.reset();
+			_outer.update(block, BLOCK_SIZE);
+			memset(block, 0, BLOCK_SIZE);
+			_valid = true;
+		}
+
+		// Writes DIGEST_SIZE bytes of hmac_sha256(key, data + tail) to output
+		inline void digest(uint8_t* output, const uint8_t* data, size_t size, const uint8_t* tail = nullptr, size_t tail_size = 0) const {
+			assert(_valid);
+			SHA256Context hash(_inner);
+			hash.update(data, size);
+			hash.update(tail, tail_size);
+			uint8_t inner[DIGEST_SIZE];
+			hash.finalize(inner);
+			hash = _outer;
+			hash.update(inner, DIGEST_SIZE);
+			hash.finalize(output);
+		}
+
+		inline explicit operator bool() const { return _valid; }
+
+	private:
+		SHA256Context _inner;
+		SHA256Context _outer;
+		bool _valid = false;
+
+	};
+
 	/*
 	Fast inline implementation of HMAC.
 	key: bytes or buffer, The key for the keyed hash object.
@@ -16,29 +16,197 @@
 
 #include "../Bytes.h"
 
-#include <SHA256.h>
 #include <SHA512.h>
+#include <string.h>
 
 using namespace RNS;
 
 /*
 The SHA primitives are abstracted here to allow platform-
-aware hardware acceleration in the future. Currently only
-uses Python's internal SHA-256 implementation. All SHA-256
-calls in RNS end up here.
+aware hardware acceleration. SHA-256 blocks are hashed by
+the fastest backend this machine supports, see
+SHA256Backend. All SHA-256 calls in RNS end up here.
 */
 
+void RNS::Cryptography::SHA256Context::reset() {
+	static const uint32_t INITIAL_STATE[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+	memcpy(_state, INITIAL_STATE, sizeof(_state));
+	_buffered = 0;
+	_length = 0;
+}
+
+void RNS::Cryptography::SHA256Context::update(const void* data, size_t size) {
+	if (size == 0) {
+		return;
+	}
+	const uint8_t* input = (const uint8_t*)data;
+	_length += size;
+	if (_buffered > 0) {
+		size_t fill = BLOCK_SIZE - _buffered;
+		if (fill > size) {
+			fill = size;
+		}
+		memcpy(_buffer + _buffered, input, fill);
+		_buffered += fill;
+		input += fill;
+		size -= fill;
+		if (_buffered < BLOCK_SIZE) {
+			return;
+		}
+		sha256_blocks(_state, _buffer, 1);
+		_buffered = 0;
+	}
+	// whole blocks straight from the input
+	size_t blocks = size / BLOCK_SIZE;
+	if (blocks > 0) {
+		sha256_blocks(_state, input, blocks);
+		input += blocks * BLOCK_SIZE;
+		size -= blocks * BLOCK_SIZE;
+	}
+	if (size > 0) {
+		memcpy(_buffer, input, size);
+		_buffered = size;
+	}
+}
+
+void RNS::Cryptography::SHA256Context::finalize(uint8_t* digest) {
+	uint64_t bits = _length * 8;
+	_buffer[_buffered++] = 0x80;
+	if (_buffered > BLOCK_SIZE - 8) {
+		memset(_buffer + _buffered, 0, BLOCK_SIZE - _buffered);
+		sha256_blocks(_state, _buffer, 1);
+		_buffered = 0;
+	}
+	memset(_buffer + _buffered, 0, BLOCK_SIZE - 8 - _buffered);
+	for (int i = 0; i < 8; ++i) {
+		_buffer[BLOCK_SIZE - 1 - i] = (uint8_t)(bits >> (8 * i));
+	}
+	sha256_blocks(_state, _buffer, 1);
+	for (int i = 0; i < 8; ++i) {
+		digest[4*i] = (uint8_t)(_state[i] >> 24);
+		digest[4*i+1] = (uint8_t)(_state[i] >> 16);
+		digest[4*i+2] = (uint8_t)(_state[i] >> 8);
+		digest[4*i+3] = (uint8_t)_state[i];
+	}
+}
+
 const Bytes RNS::Cryptography::sha256(const Bytes& data) {
 	//TRACEF("Cryptography::sha256: data: %s", data.toHex().c_str());
-	SHA256 digest;
-	digest.reset();
+	SHA256Context digest;
 	digest.update(data.data(), data.size());
 	Bytes hash;
-	digest.finalize(hash.writable(32), 32);
+	digest.finalize(hash.writable(32));
 	//TRACEF("Cryptography::sha256: hash: %s", hash.toHex().c_str());
 	return hash;
 }
 
+const Bytes RNS::Cryptography::sha256(const BytesView& data) {
+	SHA256Context digest;
+	digest.update(data.data(), data.size());
+	Bytes hash;
+	digest.finalize(hash.writable(32));
+	return hash;
+}
+
+const Bytes RNS::Cryptography::sha256(const BytesView& head, const BytesView& tail) {
+	SHA256Context digest;
+	digest.update(head.data(), head.size());
+	digest.update(tail.data(), tail.size());
+	Bytes hash;
+	digest.finalize(hash.writable(32));
+	return hash;
+}
+
+// Block index of the padded message data + suffix, copied to block unless it lies wholly within data
+static const uint8_t* message_block(uint8_t* block, const uint8_t* data, size_t size, const uint8_t* suffix, size_t suffix_size, size_t index, size_t blocks) {
+	const size_t BLOCK_SIZE = RNS::Cryptography::SHA256Context::BLOCK_SIZE;
+	size_t start = index * BLOCK_SIZE;
+	if (start + BLOCK_SIZE <= size) {
+		return data + start;
+	}
+	size_t length = size + suffix_size;
+	memset(block, 0, BLOCK_SIZE);
+	for (size_t i = 0; i < BLOCK_SIZE && start + i < length; ++i) {
+		block[i] = (start + i < size) ? data[start + i] : suffix[start + i - size];
+	}
+	if (length >= start && length < start + BLOCK_SIZE) {
+		block[length - start] = 0x80;
+	}
+	if (index == blocks - 1) {
+		uint64_t bits = (uint64_t)length * 8;
+		for (int i = 0; i < 8; ++i) {
+			block[BLOCK_SIZE - 1 - i] = (uint8_t)(bits >> (8 * i));
+		}
+	}
+	return block;
+}
+
+void RNS::Cryptography::sha256_many(uint8_t* digests, const uint8_t* const* data, const size_t* sizes, size_t count, const uint8_t* suffix, size_t suffix_size) {
+	if (count < 2 || sha256_lanes_active_backend() == SHA256_LANES_SERIAL) {
+		for (size_t i = 0; i < count; ++i) {
+			SHA256Context digest;
+			digest.update(data[i], sizes[i]);
+			digest.update(suffix, suffix_size);
+			digest.finalize(digests + i * SHA256Context::DIGEST_SIZE);
+		}
+		return;
+	}
+
+	static const uint32_t INITIAL_STATE[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+	uint32_t state[8][SHA256_LANES];
+	uint8_t buffers[SHA256_LANES][SHA256Context::BLOCK_SIZE];
+	const uint8_t* blocks[SHA256_LANES] = {nullptr};
+	size_t message[SHA256_LANES];
+	size_t index[SHA256_LANES];
+	size_t total[SHA256_LANES];
+	uint32_t mask = 0;
+	size_t next = 0;
+
+	// Each lane takes the next message as soon as it finishes one, so lengths needn't match
+	for (;;) {
+		for (size_t lane = 0; lane < SHA256_LANES; ++lane) {
+			if ((mask & (1u << lane)) || next >= count) {
+				continue;
+			}
+			message[lane] = next++;
+			index[lane] = 0;
+			// padding takes at least 9 more bytes
+			total[lane] = (sizes[message[lane]] + suffix_size + 8) / SHA256Context::BLOCK_SIZE + 1;
+			for (int i = 0; i < 8; ++i) {
+				state[i][lane] = INITIAL_STATE[i];
+			}
+			mask |= 1u << lane;
+		}
+		if (mask == 0) {
+			break;
+		}
+		for (size_t lane = 0; lane < SHA256_LANES; ++lane) {
+			if (mask & (1u << lane)) {
+				size_t m = message[lane];
+				blocks[lane] = message_block(buffers[lane], data[m], sizes[m], suffix, suffix_size, index[lane], total[lane]);
+			}
+		}
+		sha256_blocks_lanes(state, blocks, mask);
+		for (size_t lane = 0; lane < SHA256_LANES; ++lane) {
+			if (!(mask & (1u << lane)) || ++index[lane] < total[lane]) {
+				continue;
+			}
+			uint8_t* digest = digests + message[lane] * SHA256Context::DIGEST_SIZE;
+			for (int i = 0; i < 8; ++i) {
+				digest[4*i] = (uint8_t)(state[i][lane] >> 24);
+				digest[4*i+1] = (uint8_t)(state[i][lane] >> 16);
+				digest[4*i+2] = (uint8_t)(state[i][lane] >> 8);
+				digest[4*i+3] = (uint8_t)state[i][lane];
+			}
+			mask &= ~(1u << lane);
+		}
+	}
+}
+
 const Bytes RNS::Cryptography::sha512(const Bytes& data) {
 	SHA512 digest;
 	digest.reset();
@@ -14,13 +14,46 @@
 
 #pragma once
 
+#include "SHA256Backend.h"
 #include "../Bytes.h"
 
 #include <stdint.h>
+#include <string.h>
 
 namespace RNS { namespace Cryptography {
 
+	// Incremental SHA-256 over the active block function backend. Plain state, so partial hashes
+	// (such as HMAC pad states) can be copied and reused.
+	class SHA256Context {
+
+	public:
+		static const size_t DIGEST_SIZE = 32;
+		static const size_t BLOCK_SIZE = 64;
+
+	public:
+		SHA256Context() { reset(); }
+
+		void reset();
+		void update(const void* data, size_t size);
+		// Writes DIGEST_SIZE bytes, the context must be reset before reuse
+		void finalize(uint8_t* digest);
+
+	private:
+		uint32_t _state[8];
+		uint8_t _buffer[BLOCK_SIZE];
+		size_t _buffered = 0;
+		uint64_t _length = 0;
+
+	};
+
 	const Bytes sha256(const Bytes& data);
+	const Bytes sha256(const BytesView& data);
+	// Hashes head followed by tail without first concatenating them
+	const Bytes sha256(const BytesView& head, const BytesView& tail);
+	// Hashes count independent messages, data[i] (sizes[i] bytes) each followed by the same suffix,
+	// writing DIGEST_SIZE bytes per message to digests. Several messages are hashed at once by the
+	// active multi-buffer backend where there is one (see sha256_lanes_backend).
+	void sha256_many(uint8_t* digests, const uint8_t* const* data, const size_t* sizes, size_t count, const uint8_t* suffix = nullptr, size_t suffix_size = 0);
 	const Bytes sha512(const Bytes& data);
 
 } }
@@ -28,6 +28,11 @@ namespace RNS { namespace Cryptography {
         return rand;
     }
 
+    // fill buffer with specified length of random bytes
+	inline void random(uint8_t* output, size_t length) {
+        RNG.rand(output, length);
+    }
+
     // return 32 bit random unigned int
     inline uint32_t randomnum() {
         Bytes rand;
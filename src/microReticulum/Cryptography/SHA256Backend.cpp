@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "SHA256Backend.h"
+
+// Set to 0 to always use the portable block function
+#ifndef RNS_SHA256_ACCELERATION
+#define RNS_SHA256_ACCELERATION 1
+#endif
+
+#if RNS_SHA256_ACCELERATION && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RNS_SHA256_SHANI 1
+#define RNS_SHA256_AVX2 1
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+
+#if RNS_SHA256_ACCELERATION && defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define RNS_SHA256_ARMV8 1
+#include <arm_neon.h>
+#endif
+
+using namespace RNS::Cryptography;
+
+alignas(16) static const uint32_t K[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr(uint32_t x, int n) {
+	return (x >> n) | (x << (32 - n));
+}
+
+static void sha256_blocks_portable(uint32_t state[8], const uint8_t* data, size_t count) {
+	uint32_t w[16];
+	while (count--) {
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+		uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+		for (int t = 0; t < 64; ++t) {
+			// message schedule kept as a rolling window of 16 words
+			if (t < 16) {
+				w[t] = (uint32_t)data[4*t] << 24 | (uint32_t)data[4*t+1] << 16 | (uint32_t)data[4*t+2] << 8 | data[4*t+3];
+			}
+			else {
+				uint32_t w15 = w[(t - 15) & 15];
+				uint32_t w2 = w[(t - 2) & 15];
+				w[t & 15] += (rotr(w15, 7) ^ rotr(w15, 18) ^ (w15 >> 3)) + w[(t - 7) & 15] + (rotr(w2, 17) ^ rotr(w2, 19) ^ (w2 >> 10));
+			}
+			uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[t] + w[t & 15];
+			uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g; g = f; f = e; e = d + t1;
+			d = c; c = b; b = a; a = t1 + t2;
+		}
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+		state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+		data += 64;
+	}
+}
+
+#ifdef RNS_SHA256_SHANI
+static bool shani_supported() {
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1)) {
+		return false;
+	}
+	if (__get_cpuid_max(0, nullptr) < 7) {
+		return false;
+	}
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	// CPUID.(EAX=7,ECX=0):EBX.SHA[bit 29]
+	return (ebx & (1u << 29)) != 0;
+}
+
+// Hash state is kept as ABEF and CDGH for sha256rnds2, which does two rounds at a time
+__attribute__((target("sha,sse4.1,ssse3")))
+static void sha256_blocks_shani(uint32_t state[8], const uint8_t* data, size_t count) {
+	const __m128i BYTE_SWAP = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	__m128i tmp = _mm_loadu_si128((const __m128i*)&state[0]);		// DCBA
+	__m128i state1 = _mm_loadu_si128((const __m128i*)&state[4]);	// HGFE
+	tmp = _mm_shuffle_epi32(tmp, 0xb1);								// CDAB
+	state1 = _mm_shuffle_epi32(state1, 0x1b);						// EFGH
+	__m128i state0 = _mm_alignr_epi8(tmp, state1, 8);				// ABEF
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0);					// CDGH
+
+	while (count--) {
+		__m128i abef = state0;
+		__m128i cdgh = state1;
+		__m128i w[4];
+		for (int i = 0; i < 4; ++i) {
+			w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16*i)), BYTE_SWAP);
+		}
+		for (int i = 0; i < 16; ++i) {
+			__m128i msg = _mm_add_epi32(w[i & 3], _mm_load_si128((const __m128i*)&K[4*i]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			if (i < 12) {
+				// next four schedule words replace the ones just used
+				__m128i next = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+				next = _mm_add_epi32(next, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+				w[i & 3] = _mm_sha256msg2_epu32(next, w[(i + 3) & 3]);
+			}
+			msg = _mm_shuffle_epi32(msg, 0x0e);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		}
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+		data += 64;
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1b);							// FEBA
+	state1 = _mm_shuffle_epi32(state1, 0xb1);						// DCHG
+	state0 = _mm_blend_epi16(tmp, state1, 0xf0);					// DCBA
+	state1 = _mm_alignr_epi8(state1, tmp, 8);						// ABEF
+	_mm_storeu_si128((__m128i*)&state[0], state0);
+	_mm_storeu_si128((__m128i*)&state[4], state1);
+}
+#endif
+
+#ifdef RNS_SHA256_AVX2
+static bool avx2_supported() {
+	unsigned int eax, ebx, ecx, edx;
+	// CPUID.1:ECX.OSXSAVE[bit 27] and AVX[bit 28], then the OS must save YMM state (XCR0 bits 1 and 2)
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & (1u << 27)) || !(ecx & bit_AVX)) {
+		return false;
+	}
+	unsigned int xcr0_low, xcr0_high;
+	__asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+	if ((xcr0_low & 0x6) != 0x6) {
+		return false;
+	}
+	if (__get_cpuid_max(0, nullptr) < 7) {
+		return false;
+	}
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return (ebx & bit_AVX2) != 0;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i rotr_x8(__m256i x, int n) {
+	return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+// Eight rows of eight words become eight columns of one word per lane
+__attribute__((target("avx2")))
+static inline void transpose_x8(__m256i w[8]) {
+	__m256i t[8], u[8];
+	for (int i = 0; i < 8; i += 2) {
+		t[i] = _mm256_unpacklo_epi32(w[i], w[i + 1]);
+		t[i + 1] = _mm256_unpackhi_epi32(w[i], w[i + 1]);
+	}
+	for (int i = 0; i < 8; i += 4) {
+		u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+		u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+		u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+		u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+	}
+	for (int i = 0; i < 4; ++i) {
+		w[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+		w[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+	}
+}
+
+// The portable rounds with every word eight lanes wide
+__attribute__((target("avx2")))
+static void sha256_lanes_avx2(uint32_t state[8][SHA256_LANES], const uint8_t* const blocks[SHA256_LANES], uint32_t mask) {
+	static const uint8_t UNUSED_BLOCK[64] = {0};
+	const __m256i BYTE_SWAP = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL, 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	__m256i w[16];
+	for (int half = 0; half < 2; ++half) {
+		for (size_t lane = 0; lane < SHA256_LANES; ++lane) {
+			const uint8_t* block = (mask & (1u << lane)) ? blocks[lane] : UNUSED_BLOCK;
+			w[8*half + lane] = _mm256_loadu_si256((const __m256i*)(block + 32*half));
+		}
+		transpose_x8(&w[8*half]);
+		for (int i = 0; i < 8; ++i) {
+			w[8*half + i] = _mm256_shuffle_epi8(w[8*half + i], BYTE_SWAP);
+		}
+	}
+
+	__m256i initial[8];
+	for (int i = 0; i < 8; ++i) {
+		initial[i] = _mm256_loadu_si256((const __m256i*)state[i]);
+	}
+	__m256i a = initial[0], b = initial[1], c = initial[2], d = initial[3];
+	__m256i e = initial[4], f = initial[5], g = initial[6], h = initial[7];
+	for (int t = 0; t < 64; ++t) {
+		if (t >= 16) {
+			__m256i w15 = w[(t - 15) & 15];
+			__m256i w2 = w[(t - 2) & 15];
+			__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(w15, 7), rotr_x8(w15, 18)), _mm256_srli_epi32(w15, 3));
+			__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(w2, 17), rotr_x8(w2, 19)), _mm256_srli_epi32(w2, 10));
+			w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0), _mm256_add_epi32(w[(t - 7) & 15], s1));
+		}
+		__m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(e, 6), rotr_x8(e, 11)), rotr_x8(e, 25));
+		__m256i choose = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+		__m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, sigma1), _mm256_add_epi32(choose, _mm256_add_epi32(_mm256_set1_epi32((int)K[t]), w[t & 15])));
+		__m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(a, 2), rotr_x8(a, 13)), rotr_x8(a, 22));
+		__m256i majority = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+		__m256i t2 = _mm256_add_epi32(sigma0, majority);
+		h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+		d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+	}
+
+	// Lanes outside mask keep their state
+	const __m256i active = _mm256_cmpgt_epi32(_mm256_and_si256(_mm256_set1_epi32((int)mask), _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1)), _mm256_setzero_si256());
+	const __m256i result[8] = {a, b, c, d, e, f, g, h};
+	for (int i = 0; i < 8; ++i) {
+		__m256i updated = _mm256_add_epi32(initial[i], result[i]);
+		_mm256_storeu_si256((__m256i*)state[i], _mm256_blendv_epi8(initial[i], updated, active));
+	}
+}
+#endif
+
+#ifdef RNS_SHA256_ARMV8
+static void sha256_blocks_armv8(uint32_t state[8], const uint8_t* data, size_t count) {
+	uint32x4_t state0 = vld1q_u32(&state[0]);
+	uint32x4_t state1 = vld1q_u32(&state[4]);
+
+	while (count--) {
+		uint32x4_t abcd = state0;
+		uint32x4_t efgh = state1;
+		uint32x4_t w[4];
+		for (int i = 0; i < 4; ++i) {
+			w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16*i)));
+		}
+		for (int i = 0; i < 16; ++i) {
+			uint32x4_t wk = vaddq_u32(w[i & 3], vld1q_u32(&K[4*i]));
+			if (i < 12) {
+				// next four schedule words replace the ones just used
+				w[i & 3] = vsha256su1q_u32(vsha256su0q_u32(w[i & 3], w[(i + 1) & 3]), w[(i + 2) & 3], w[(i + 3) & 3]);
+			}
+			uint32x4_t previous = state0;
+			state0 = vsha256hq_u32(state0, state1, wk);
+			state1 = vsha256h2q_u32(state1, previous, wk);
+		}
+		state0 = vaddq_u32(state0, abcd);
+		state1 = vaddq_u32(state1, efgh);
+		data += 64;
+	}
+
+	vst1q_u32(&state[0], state0);
+	vst1q_u32(&state[4], state1);
+}
+#endif
+
+using sha256_blocks_function = void (*)(uint32_t state[8], const uint8_t* data, size_t count);
+
+static sha256_blocks_function backend_function(sha256_backend backend) {
+	switch (backend) {
+#ifdef RNS_SHA256_SHANI
+	case SHA256_BACKEND_SHANI:
+		return shani_supported() ? sha256_blocks_shani : nullptr;
+#endif
+#ifdef RNS_SHA256_ARMV8
+	case SHA256_BACKEND_ARMV8:
+		return sha256_blocks_armv8;
+#endif
+	case SHA256_BACKEND_PORTABLE:
+		return sha256_blocks_portable;
+	default:
+		return nullptr;
+	}
+}
+
+static sha256_backend best_backend() {
+	if (backend_function(SHA256_BACKEND_SHANI)) return SHA256_BACKEND_SHANI;
+	if (backend_function(SHA256_BACKEND_ARMV8)) return SHA256_BACKEND_ARMV8;
+	return SHA256_BACKEND_PORTABLE;
+}
+
+// Selected on first use rather than during static initialization, since static objects elsewhere may hash
+static sha256_backend& active_backend() {
+	static sha256_backend backend = best_backend();
+	return backend;
+}
+
+static sha256_blocks_function& active_function() {
+	static sha256_blocks_function function = backend_function(active_backend());
+	return function;
+}
+
+bool RNS::Cryptography::sha256_backend_supported(sha256_backend backend) {
+	return backend_function(backend) != nullptr;
+}
+
+sha256_backend RNS::Cryptography::sha256_active_backend() {
+	return active_backend();
+}
+
+bool RNS::Cryptography::sha256_use_backend(sha256_backend backend) {
+	sha256_blocks_function function = backend_function(backend);
+	if (!function) {
+		return false;
+	}
+	active_backend() = backend;
+	active_function() = function;
+	return true;
+}
+
+const char* RNS::Cryptography::sha256_backend_name(sha256_backend backend) {
+	switch (backend) {
+	case SHA256_BACKEND_PORTABLE:
+		return "portable";
+	case SHA256_BACKEND_SHANI:
+		return "sha-ni";
+	case SHA256_BACKEND_ARMV8:
+		return "armv8";
+	default:
+		return "unknown";
+	}
+}
+
+void RNS::Cryptography::sha256_blocks(uint32_t state[8], const uint8_t* blocks, size_t count) {
+	active_function()(state, blocks, count);
+}
+
+// One lane at a time through the single-buffer backend
+static void sha256_lanes_serial(uint32_t state[8][SHA256_LANES], const uint8_t* const blocks[SHA256_LANES], uint32_t mask) {
+	for (size_t lane = 0; lane < SHA256_LANES; ++lane) {
+		if (!(mask & (1u << lane))) {
+			continue;
+		}
+		uint32_t column[8];
+		for (int i = 0; i < 8; ++i) {
+			column[i] = state[i][lane];
+		}
+		sha256_blocks(column, blocks[lane], 1);
+		for (int i = 0; i < 8; ++i) {
+			state[i][lane] = column[i];
+		}
+	}
+}
+
+using sha256_lanes_function = void (*)(uint32_t state[8][SHA256_LANES], const uint8_t* const blocks[SHA256_LANES], uint32_t mask);
+
+static sha256_lanes_function lanes_backend_function(sha256_lanes_backend backend) {
+	switch (backend) {
+#ifdef RNS_SHA256_AVX2
+	case SHA256_LANES_AVX2:
+		return avx2_supported() ? sha256_lanes_avx2 : nullptr;
+#endif
+	case SHA256_LANES_SERIAL:
+		return sha256_lanes_serial;
+	default:
+		return nullptr;
+	}
+}
+
+// SHA extensions hash a single message faster than eight AVX2 lanes do
+static sha256_lanes_backend best_lanes_backend() {
+	if (active_backend() == SHA256_BACKEND_PORTABLE && lanes_backend_function(SHA256_LANES_AVX2)) return SHA256_LANES_AVX2;
+	return SHA256_LANES_SERIAL;
+}
+
+static sha256_lanes_backend& active_lanes_backend() {
+	static sha256_lanes_backend backend = best_lanes_backend();
+	return backend;
+}
+
+static sha256_lanes_function& active_lanes_function() {
+	static sha256_lanes_function function = lanes_backend_function(active_lanes_backend());
+	return function;
+}
+
+bool RNS::Cryptography::sha256_lanes_backend_supported(sha256_lanes_backend backend) {
+	return lanes_backend_function(backend) != nullptr;
+}
+
+sha256_lanes_backend RNS::Cryptography::sha256_lanes_active_backend() {
+	return active_lanes_backend();
+}
+
+bool RNS::Cryptography::sha256_lanes_use_backend(sha256_lanes_backend backend) {
+	sha256_lanes_function function = lanes_backend_function(backend);
+	if (!function) {
+		return false;
+	}
+	active_lanes_backend() = backend;
+	active_lanes_function() = function;
+	return true;
+}
+
+const char* RNS::Cryptography::sha256_lanes_backend_name(sha256_lanes_backend backend) {
+	switch (backend) {
+	case SHA256_LANES_SERIAL:
+		return "serial";
+	case SHA256_LANES_AVX2:
+		return "avx2";
+	default:
+		return "unknown";
+	}
+}
+
+void RNS::Cryptography::sha256_blocks_lanes(uint32_t state[8][SHA256_LANES], const uint8_t* const blocks[SHA256_LANES], uint32_t mask) {
+	active_lanes_function()(state, blocks, mask);
+}
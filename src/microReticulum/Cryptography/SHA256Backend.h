@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace RNS { namespace Cryptography {
+
+	// SHA-256 block function implementations. The fastest one this machine supports is selected
+	// on first use, with the portable implementation as fallback everywhere.
+	enum sha256_backend {
+		SHA256_BACKEND_PORTABLE = 0,
+		SHA256_BACKEND_SHANI,		// x86 SHA extensions, detected at runtime by CPUID
+		SHA256_BACKEND_ARMV8,		// ARMv8 cryptography extensions, when compiled for them
+	};
+
+	bool sha256_backend_supported(sha256_backend backend);
+	sha256_backend sha256_active_backend();
+	// Switches the active backend, for tests and benchmarks. Returns false if it isn't supported here.
+	bool sha256_use_backend(sha256_backend backend);
+	const char* sha256_backend_name(sha256_backend backend);
+
+	// Hashes count 64 byte blocks into state with the active backend
+	void sha256_blocks(uint32_t state[8], const uint8_t* blocks, size_t count);
+
+	// Multi-buffer implementations, which hash a block of several independent messages at once. Worth
+	// it only where there is no single-buffer hardware support, so that's the only place one is
+	// selected by default. Otherwise messages are hashed one after another (serial).
+	enum sha256_lanes_backend {
+		SHA256_LANES_SERIAL = 0,
+		SHA256_LANES_AVX2,			// x86 AVX2, 8 lanes, detected at runtime by CPUID
+	};
+
+	static const size_t SHA256_LANES = 8;
+
+	bool sha256_lanes_backend_supported(sha256_lanes_backend backend);
+	sha256_lanes_backend sha256_lanes_active_backend();
+	// Switches the active multi-buffer backend, for tests and benchmarks. Returns false if it isn't
+	// supported here.
+	bool sha256_lanes_use_backend(sha256_lanes_backend backend);
+	const char* sha256_lanes_backend_name(sha256_lanes_backend backend);
+
+	// Hashes blocks[lane] into column lane of state (state[word][lane]) for every lane set in mask.
+	// Pointers of lanes not in mask aren't read.
+	void sha256_blocks_lanes(uint32_t state[8][SHA256_LANES], const uint8_t* const blocks[SHA256_LANES], uint32_t mask);
+
+} }
@@ -20,6 +20,7 @@
 #include "../Log.h"
 
 #include <stdexcept>
+#include <string.h>
 #include <time.h>
 
 using namespace RNS;
@@ -36,16 +37,16 @@ Token::Token(const Bytes& key, token_mode mode /*= AES*/) {
 		if (key.size() == 32) {
 			_mode = MODE_AES_128_CBC;
 			//p self._signing_key = key[:16]
-			_signing_key = key.left(16);
+			_signing_hmac.key(key.data(), 16);
 			//p self._encryption_key = key[16:]
-			_encryption_key = key.mid(16);
+			_encryption_cipher.key(key.mid(16));
 		}
 		else if (key.size() == 64) {
 			_mode = MODE_AES_256_CBC;
 			//p self._signing_key = key[:32]
-			_signing_key = key.left(32);
+			_signing_hmac.key(key.data(), 32);
 			//p self._encryption_key = key[32:]
-			_encryption_key = key.mid(32);
+			_encryption_cipher.key(key.mid(32));
 		}
 		else {
 			throw std::invalid_argument("Token key must be 128 or 256 bits, not " + std::to_string(key.size()*8));
@@ -62,116 +63,100 @@ Token::~Token() {
 	MEM("Token object destroyed");
 }
 
-bool Token::verify_hmac(const Bytes& token) {
+bool Token::verify_hmac(const uint8_t* token, size_t size) {
 
-	if (token.size() <= 32) {
-		throw std::invalid_argument("Cannot verify HMAC on token of only " + std::to_string(token.size()) + " bytes");
+	if (size <= 32) {
+		throw std::invalid_argument("Cannot verify HMAC on token of only " + std::to_string(size) + " bytes");
 	}
 
 	//received_hmac = token[-32:]
-	Bytes received_hmac = token.right(32);
-	DEBUGF("Token::verify_hmac: received_hmac: %s", received_hmac.toHex().c_str());
+	const uint8_t* received_hmac = token + size - 32;
 	//expected_hmac = HMAC.new(self._signing_key, token[:-32]).digest()
-	Bytes expected_hmac = HMAC::generate(_signing_key, token.left(token.size()-32))->digest();
-	DEBUGF("Token::verify_hmac: expected_hmac: %s", expected_hmac.toHex().c_str());
+	uint8_t expected_hmac[KeyedHMAC::DIGEST_SIZE];
+	_signing_hmac.digest(expected_hmac, token, size - 32);
 
-	return (received_hmac == expected_hmac);
+	return (memcmp(received_hmac, expected_hmac, sizeof(expected_hmac)) == 0);
 }
 
 const Bytes Token::encrypt(const Bytes& data) {
+	Bytes token;
+	encrypt(token.writable(token_size(data.size())), data.data(), data.size());
+	return token;
+}
 
-	DEBUGF("Token::encrypt: plaintext length: %lu", data.size());
-	Bytes iv = random(16);
-	//double current_time = OS::time();
-	//TRACEF("Token::encrypt: iv:         %s", iv.toHex().c_str());
-
-	// CBA Note following doesn't use container allocator so could be an issue when using heap pool
-	//TRACEF("Token::encrypt: plaintext:  %s", data.toHex().c_str());
-	Bytes ciphertext;
-	if (_mode == MODE_AES_128_CBC) {
-		ciphertext = AES_128_CBC::encrypt(
-			PKCS7::pad(data),
-			_encryption_key,
-			iv
-		);
-	}
-	else if (_mode == MODE_AES_256_CBC) {
-		ciphertext = AES_256_CBC::encrypt(
-			PKCS7::pad(data),
-			_encryption_key,
-			iv
-		);
-	}
-	else {
+size_t Token::encrypt(uint8_t* output, const uint8_t* data, size_t size) {
+
+	DEBUGF("Token::encrypt: plaintext length: %lu", size);
+	if (_mode != MODE_AES_128_CBC && _mode != MODE_AES_256_CBC) {
 		throw std::invalid_argument("Invalid token mode "+std::to_string(_mode));
 	}
-	DEBUGF("Token::encrypt: padded ciphertext length: %lu", ciphertext.size());
-	// CBA Note following doesn't use container allocator so could be an issue when using heap pool
-	//TRACEF("Token::encrypt: ciphertext: %s", ciphertext.toHex().c_str());
 
-	Bytes signed_parts = iv + ciphertext;
+	// Token is built in place as iv + ciphertext + hmac, padding and encrypting the plaintext
+	// where the ciphertext goes and signing it from the same buffer
+	size_t padded_size = size + PKCS7::BLOCKSIZE - (size % PKCS7::BLOCKSIZE);
+	uint8_t* iv = output;
+	uint8_t* ciphertext = output + 16;
+	if (data != ciphertext) {
+		memmove(ciphertext, data, size);
+	}
+	random(iv, 16);
+
+	uint8_t padlen = (uint8_t)(padded_size - size);
+	memset(ciphertext + size, padlen, padlen);
+	_encryption_cipher.encrypt(ciphertext, ciphertext, padded_size, iv);
+	DEBUGF("Token::encrypt: padded ciphertext length: %lu", padded_size);
 
 	//return signed_parts + HMAC::generate(_signing_key, signed_parts)->digest();
-	Bytes sig(HMAC::generate(_signing_key, signed_parts)->digest());
-	TRACEF("Token::encrypt: sig:        %s", sig.toHex().c_str());
-	Bytes token(signed_parts + sig);
-	DEBUGF("Token::encrypt: token length: %lu", token.size());
-	return token;
+	_signing_hmac.digest(ciphertext + padded_size, iv, 16 + padded_size);
+	DEBUGF("Token::encrypt: token length: %lu", 16 + padded_size + 32);
+	return 16 + padded_size + 32;
 }
 
 
 const Bytes Token::decrypt(const Bytes& token) {
-
-	DEBUGF("Token::decrypt: token length: %lu", token.size());
 	if (token.size() < 48) {
 		throw std::invalid_argument("Cannot decrypt token of only " + std::to_string(token.size()) + " bytes");
 	}
+	Bytes plaintext;
+	size_t size = decrypt(plaintext.writable(token.size() - 48), token.data(), token.size());
+	plaintext.resize(size);
+	return plaintext;
+}
+
+size_t Token::decrypt(uint8_t* output, const uint8_t* token, size_t size) {
+
+	DEBUGF("Token::decrypt: token length: %lu", size);
+	if (size < 48) {
+		throw std::invalid_argument("Cannot decrypt token of only " + std::to_string(size) + " bytes");
+	}
 
-	if (!verify_hmac(token)) {
+	if (!verify_hmac(token, size)) {
 		throw std::invalid_argument("Token token HMAC was invalid");
 	}
 
-	//iv = token[:16]
-	Bytes iv = token.left(16);
-	TRACEF("Token::decrypt: iv:         %s", iv.toHex().c_str());
-
-	//ciphertext = token[16:-32]
-	Bytes ciphertext = token.mid(16, token.size()-48);
-	// CBA Note following doesn't use container allocator so could be an issue when using heap pool
-	//TRACEF("Token::decrypt: ciphertext: %s", ciphertext.toHex().c_str());
-
 	try {
-		Bytes plaintext;
-		if (_mode == MODE_AES_128_CBC) {
-			plaintext = PKCS7::unpad(
-				AES_128_CBC::decrypt(
-					ciphertext,
-					_encryption_key,
-					iv
-				)
-			);
-		}
-		else if (_mode == MODE_AES_256_CBC) {
-			plaintext = PKCS7::unpad(
-				AES_256_CBC::decrypt(
-					ciphertext,
-					_encryption_key,
-					iv
-				)
-			);
-		}
-		else {
+		if (_mode != MODE_AES_128_CBC && _mode != MODE_AES_256_CBC) {
 			throw std::invalid_argument("Invalid token mode "+std::to_string(_mode));
 		}
-		DEBUGF("Token::encrypt: unpadded plaintext length: %lu", plaintext.size());
-		// CBA Note following doesn't use container allocator so could be an issue when using heap pool
-		//TRACEF("Token::decrypt: plaintext:  %s", plaintext.toHex().c_str());
+		//iv = token[:16]
+		const uint8_t* iv = token;
+		//ciphertext = token[16:-32]
+		const uint8_t* ciphertext = token + 16;
+		size_t ciphertext_size = size - 48;
+		if (ciphertext_size == 0 || ciphertext_size % PKCS7::BLOCKSIZE != 0) {
+			throw std::invalid_argument("Invalid ciphertext length of " + std::to_string(ciphertext_size) + " bytes");
+		}
 
-		DEBUGF("Token::decrypt: plaintext length: %lu", plaintext.size());
-		return plaintext;
+		_encryption_cipher.decrypt(output, ciphertext, ciphertext_size, iv);
+		size_t padlen = output[ciphertext_size - 1];
+		if (padlen > PKCS7::BLOCKSIZE) {
+			throw std::runtime_error("Cannot unpad, invalid padding length of " + std::to_string(padlen) + " bytes");
+		}
+		DEBUGF("Token::decrypt: plaintext length: %lu", ciphertext_size - padlen);
+		return ciphertext_size - padlen;
 	}
 	catch (const std::exception& e) {
 		WARNING("Could not decrypt Token token");
 		throw std::runtime_error("Could not decrypt Token token");
 	}
-}
\ No newline at end of file
+}
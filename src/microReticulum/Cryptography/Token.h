@@ -15,6 +15,8 @@
 #pragma once
 
 #include "Random.h"
+#include "HMAC.h"
+#include "AES.h"
 #include "../Bytes.h"
 #include "../Type.h"
 
@@ -46,16 +48,33 @@ namespace RNS { namespace Cryptography {
 	public:
 		Token(const Bytes& key, RNS::Type::Cryptography::Token::token_mode mode = RNS::Type::Cryptography::Token::MODE_AES);
 		~Token();
+		// Key schedules are owned and not copied
+		Token(const Token&) = delete;
+		Token& operator=(const Token&) = delete;
+
+		// Size of the token for size bytes of plaintext, iv + padded ciphertext + hmac
+		static inline size_t token_size(size_t size) { return 16 + (size / 16 + 1) * 16 + 32; }
 
 	public:
-		bool verify_hmac(const Bytes& token);
+		inline bool verify_hmac(const Bytes& token) { return verify_hmac(token.data(), token.size()); }
+		bool verify_hmac(const uint8_t* token, size_t size);
 		const Bytes encrypt(const Bytes& data);
 		const Bytes decrypt(const Bytes& token);
 
+		// Writes the token for size bytes of data straight to output, which must hold token_size(size)
+		// bytes. Padding is done in place, so data may already sit at output + 16 where the ciphertext
+		// goes. Returns the token size.
+		size_t encrypt(uint8_t* output, const uint8_t* data, size_t size);
+		// Verifies and decrypts a token of size bytes to output, which must hold size - 48 bytes and may
+		// be the token buffer itself for decryption in place. Returns the plaintext size.
+		size_t decrypt(uint8_t* output, const uint8_t* token, size_t size);
+
 	private:
 		RNS::Type::Cryptography::Token::token_mode _mode = RNS::Type::Cryptography::Token::MODE_AES_256_CBC;
-		Bytes _signing_key;
-		Bytes _encryption_key;
+		// Signing and encryption keys are only kept as their precomputed HMAC states and AES key
+		// schedule, so a long lived token (one per link) does no per-packet key setup.
+		KeyedHMAC _signing_hmac;
+		AES_CBC _encryption_cipher;
 	};
 
 } }
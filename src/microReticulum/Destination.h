@@ -109,6 +109,9 @@ namespace RNS {
 		Destination(const Destination& destination) : _object(destination._object) {
 			MEMF("Destination object copy created, this: %p, data: %p", (void*)this, (void*)_object.get());
 		}
+		Destination(Destination&& destination) noexcept : _object(std::move(destination._object)) {
+			MEMF("Destination object move created, this: %p, data: %p", (void*)this, (void*)_object.get());
+		}
 		Destination(
 			const Identity& identity,
 			const Type::Destination::directions direction,
@@ -129,6 +132,11 @@ namespace RNS {
 			MEMF("Destination object copy created by assignment, this: %p, data: %p", (void*)this, (void*)_object.get());
 			return *this;
 		}
+		inline Destination& operator = (Destination&& destination) noexcept {
+			_object = std::move(destination._object);
+			MEMF("Destination object move created by assignment, this: %p, data: %p", (void*)this, (void*)_object.get());
+			return *this;
+		}
 		inline explicit operator bool() const {
 			return _object.get() != nullptr;
 		}
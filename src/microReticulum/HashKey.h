@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "Bytes.h"
+#include "Type.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <string>
+#include <functional>
+#include <type_traits>
+
+namespace RNS {
+
+	// Fixed-width, trivially copyable key for tables indexed by hashes (destination hashes, link ids,
+	// packet hashes, etc). The hash is held inline so table entries need no key allocation, and ordering
+	// and equality are a single memcmp over a known width.
+	//
+	// Converts implicitly from Bytes so tables can be searched directly with the Bytes hashes that arrive
+	// in packets, and back to Bytes for callers that still deal in Bytes. A Bytes of the wrong width is
+	// truncated or zero-padded to N bytes.
+	template <size_t N>
+	class HashKey {
+
+	public:
+		static constexpr size_t SIZE = N;
+
+	public:
+		HashKey() = default;
+		HashKey(const uint8_t* data, size_t size) {
+			assign(data, size);
+		}
+		HashKey(const Bytes& bytes) {
+			assign(bytes.data(), bytes.size());
+		}
+		HashKey(const BytesView& view) {
+			assign(view.data(), view.size());
+		}
+
+		inline bool operator == (const HashKey& key) const { return memcmp(_data, key._data, N) == 0; }
+		inline bool operator != (const HashKey& key) const { return memcmp(_data, key._data, N) != 0; }
+		inline bool operator < (const HashKey& key) const { return memcmp(_data, key._data, N) < 0; }
+		inline bool operator > (const HashKey& key) const { return memcmp(_data, key._data, N) > 0; }
+
+		inline operator Bytes() const { return Bytes(_data, N); }
+
+		inline const uint8_t* data() const { return _data; }
+		inline constexpr size_t size() const { return N; }
+		inline Bytes bytes() const { return Bytes(_data, N); }
+		inline std::string toHex(bool upper = false) const { return bytes().toHex(upper); }
+
+	private:
+		inline void assign(const uint8_t* data, size_t size) {
+			if (size > N) size = N;
+			if (size > 0 && data != nullptr) memcpy(_data, data, size);
+			if (size < N) memset(_data + size, 0, N - size);
+		}
+
+	private:
+		uint8_t _data[N] = {0};
+
+	};
+
+	// Truncated hashes (destination hashes, link ids, truncated packet hashes)
+	using Hash16 = HashKey<Type::Identity::TRUNCATED_HASHLENGTH/8>;
+	// Full hashes (packet hashes, tunnel ids)
+	using Hash32 = HashKey<Type::Identity::HASHLENGTH/8>;
+
+	static_assert(std::is_trivially_copyable<Hash16>::value, "Hash16 must be trivially copyable");
+	static_assert(std::is_trivially_copyable<Hash32>::value, "Hash32 must be trivially copyable");
+
+}
+
+template <size_t N>
+inline RNS::Bytes& operator << (RNS::Bytes& lhbytes, const RNS::HashKey<N>& rhkey) {
+	lhbytes.append(rhkey.data(), N);
+	return lhbytes;
+}
+
+namespace std {
+	// Key bytes are already uniformly distributed hash output, so the leading word is a sufficient hash
+	template <size_t N>
+	struct hash<RNS::HashKey<N>> {
+		inline size_t operator()(const RNS::HashKey<N>& key) const noexcept {
+			static_assert(N >= sizeof(size_t), "HashKey must be at least as wide as size_t");
+			size_t hash;
+			memcpy(&hash, key.data(), sizeof(hash));
+			return hash;
+		}
+	};
+}
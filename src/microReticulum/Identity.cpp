@@ -49,6 +49,11 @@ using namespace RNS::Utilities;
 #define RNS_IDENTITY_ANNOUNCE_RECALL 1
 #endif
 
+// Announces validated recently, 0 disables the cache
+#ifndef RNS_ANNOUNCE_CACHE_MAX
+#define RNS_ANNOUNCE_CACHE_MAX 64
+#endif
+
 
 /*static*/ uint16_t Identity::_known_destinations_maxsize = RNS_KNOWN_DESTINATIONS_MAX;
 /*static*/ uint32_t Identity::_known_store_segment_size = 0;
@@ -59,6 +64,10 @@ using namespace RNS::Utilities;
 /*static*/ Persistence::KnownStore Identity::_known_store;
 #endif
 /*static*/ Persistence::KnownDestinations Identity::_known_destinations(Identity::_known_store);
+/*static*/ Identity::AnnounceCache Identity::_announce_cache = Identity::AnnounceCache().max_size(RNS_ANNOUNCE_CACHE_MAX);
+/*static*/ uint16_t Identity::_announce_cache_maxsize = RNS_ANNOUNCE_CACHE_MAX;
+/*static*/ uint32_t Identity::_announce_cache_hits = 0;
+/*static*/ uint32_t Identity::_announce_cache_misses = 0;
 
 Identity::Identity(bool create_keys /*= true*/) : _object(new Object()) {
 	if (create_keys) {
@@ -150,17 +159,17 @@ Load a public key into the instance.
 :param pub_bytes: The public key as *bytes*.
 :returns: True if the key was loaded, otherwise False.
 */
-void Identity::load_public_key(const Bytes& pub_bytes) {
+void Identity::load_public_key(const BytesView& pub_bytes) {
 	assert(_object);
 
 	try {
 
 		//_pub_bytes     = pub_bytes[:Identity.KEYSIZE//8//2]
-		_object->_pub_bytes     = pub_bytes.left(Type::Identity::KEYSIZE/8/2);
+		_object->_pub_bytes     = pub_bytes.left(Type::Identity::KEYSIZE/8/2).bytes();
 		//TRACEF("Identity::load_public_key: pub bytes:     ", _object->_pub_bytes.toHex().c_str());
 
 		//_sig_pub_bytes = pub_bytes[Identity.KEYSIZE//8//2:]
-		_object->_sig_pub_bytes = pub_bytes.mid(Type::Identity::KEYSIZE/8/2);
+		_object->_sig_pub_bytes = pub_bytes.mid(Type::Identity::KEYSIZE/8/2).bytes();
 		//TRACEF("Identity::load_public_key: sig pub bytes: ", _object->_sig_pub_bytes.toHex().c_str());
 
 		_object->_pub           = X25519PublicKey::from_public_bytes(_object->_pub_bytes);
@@ -317,36 +326,39 @@ Recall last heard app_data for a destination hash.
 /*static*/ bool Identity::validate_announce(const Packet& packet, bool only_validate_signature /*= false*/) {
 	try {
 		if (packet.packet_type() == Type::Packet::ANNOUNCE) {
-			Bytes destination_hash = packet.destination_hash();
+			const Bytes& destination_hash = packet.destination_hash();
+
+			// Slice announce fields as views into the packet data (no copies)
+			const BytesView data = packet.data_view();
 
             // Get public key bytes from announce
-			Bytes public_key = packet.data().left(KEYSIZE/8);
+			BytesView public_key = data.left(KEYSIZE/8);
 
-			Bytes name_hash;
-			Bytes random_hash;
-			Bytes ratchet;
-			Bytes signature;
-			Bytes app_data;
+			BytesView name_hash;
+			BytesView random_hash;
+			BytesView ratchet;
+			BytesView signature;
+			BytesView app_data;
 
 			// If the packet context flag is set,
 			// this announce contains a new ratchet
 			if (packet.context_flag() == Type::Packet::FLAG_SET) {
-				name_hash = packet.data().mid(KEYSIZE/8, NAME_HASH_LENGTH/8);
-				random_hash = packet.data().mid(KEYSIZE/8 + NAME_HASH_LENGTH/8, RANDOM_HASH_LENGTH/8);
-				ratchet = packet.data().mid(KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8, RATCHETSIZE/8);
-				signature = packet.data().mid(KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + RATCHETSIZE/8, SIGLENGTH/8);
-				if (packet.data().size() > (KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + RATCHETSIZE/8 + SIGLENGTH/8)) {
-					app_data = packet.data().mid(KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + RATCHETSIZE/8 + SIGLENGTH/8);
+				name_hash = data.mid(KEYSIZE/8, NAME_HASH_LENGTH/8);
+				random_hash = data.mid(KEYSIZE/8 + NAME_HASH_LENGTH/8, RANDOM_HASH_LENGTH/8);
+				ratchet = data.mid(KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8, RATCHETSIZE/8);
+				signature = data.mid(KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + RATCHETSIZE/8, SIGLENGTH/8);
+				if (data.size() > (KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + RATCHETSIZE/8 + SIGLENGTH/8)) {
+					app_data = data.mid(KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + RATCHETSIZE/8 + SIGLENGTH/8);
 				}
 			}
 			// If the packet context flag is not set,
 			// this announce does not contain a ratchet
 			else {
-				name_hash = packet.data().mid(KEYSIZE/8, NAME_HASH_LENGTH/8);
-				random_hash = packet.data().mid(KEYSIZE/8 + NAME_HASH_LENGTH/8, RANDOM_HASH_LENGTH/8);
-				signature = packet.data().mid(KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8, SIGLENGTH/8);
-				if (packet.data().size() > (KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + SIGLENGTH/8)) {
-					app_data = packet.data().mid(KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + SIGLENGTH/8);
+				name_hash = data.mid(KEYSIZE/8, NAME_HASH_LENGTH/8);
+				random_hash = data.mid(KEYSIZE/8 + NAME_HASH_LENGTH/8, RANDOM_HASH_LENGTH/8);
+				signature = data.mid(KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8, SIGLENGTH/8);
+				if (data.size() > (KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + SIGLENGTH/8)) {
+					app_data = data.mid(KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + SIGLENGTH/8);
 				}
 			}
 
@@ -361,29 +373,57 @@ Recall last heard app_data for a destination hash.
 			TRACEF("Identity::validate_announce: app_data text:    %s", app_data.toString().c_str());
 */
 
-			Bytes signed_data;
+			// CBA Reserve exact size so signed data is assembled with a single allocation
+			Bytes signed_data(destination_hash.size() + public_key.size() + name_hash.size() + random_hash.size() + ratchet.size() + app_data.size());
 			signed_data << destination_hash << public_key << name_hash << random_hash << ratchet << app_data;
 			//TRACEF("Identity::validate_announce: signed_data:      %s", signed_data.toHex().c_str());
 
-			if (packet.data().size() <= KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + SIGLENGTH/8) {
-				app_data.clear();
+			if (data.size() <= KEYSIZE/8 + NAME_HASH_LENGTH/8 + RANDOM_HASH_LENGTH/8 + SIGLENGTH/8) {
+				app_data = {};
+			}
+
+			// The same announce arrives again over other interfaces and neighbours. Its digest covers
+			// everything signed plus the signature, so a cached one has already passed the signature
+			// and destination hash checks below and only needs checking against known destinations.
+			Hash32 announce_digest;
+			bool cached = false;
+			if (_announce_cache_maxsize > 0) {
+				announce_digest = full_hash(signed_data, signature);
+				cached = (_announce_cache.count(announce_digest) > 0);
+				if (cached) {
+					++_announce_cache_hits;
+				}
+				else {
+					++_announce_cache_misses;
+				}
 			}
 
-			Identity announced_identity(false);
-			announced_identity.load_public_key(public_key);
+			bool signature_valid = cached;
+			Bytes expected_hash;
+			if (!cached) {
+				Identity announced_identity(false);
+				announced_identity.load_public_key(public_key);
+				signature_valid = (announced_identity.pub() && announced_identity.validate(signature, signed_data));
+				if (signature_valid && !only_validate_signature) {
+					Bytes hash_material;
+					hash_material << name_hash << announced_identity.hash();
+					expected_hash = full_hash(hash_material).left(Type::Reticulum::TRUNCATED_HASHLENGTH/8);
+					//TRACEF("Identity::validate_announce: destination_hash: %s", destination_hash.toHex().c_str());
+					//TRACEF("Identity::validate_announce: expected_hash:    %s", expected_hash.toHex().c_str());
+				}
+			}
 
-			if (announced_identity.pub() && announced_identity.validate(signature, signed_data)) {
+			if (signature_valid) {
 				if (only_validate_signature) {
 					//p del announced_identity
 					return true;
 				}
 
-				Bytes hash_material = name_hash << announced_identity.hash();
-				Bytes expected_hash = full_hash(hash_material).left(Type::Reticulum::TRUNCATED_HASHLENGTH/8);
-				//TRACEF("Identity::validate_announce: destination_hash: %s", destination_hash.toHex().c_str());
-				//TRACEF("Identity::validate_announce: expected_hash:    %s", expected_hash.toHex().c_str());
+				if (cached || destination_hash == expected_hash) {
+					if (!cached && _announce_cache_maxsize > 0) {
+						_announce_cache.insert(announce_digest);
+					}
 
-				if (destination_hash == expected_hash) {
 					// Check if we already have a public key for this destination
 					// and make sure the public key is not different.
 					IdentityEntry identity_entry;
@@ -399,7 +439,7 @@ Recall last heard app_data for a destination hash.
 					else {
 						// DIVERGENCE: To lessen flash wear, only adding known destination if it's not already known
 						// NOTE: A side-effect of this is timestamp will not be updated and record may expire sooner
-						remember(packet.get_hash(), destination_hash, public_key, app_data);
+						remember(packet.get_hash(), destination_hash, public_key.bytes(), app_data.bytes());
 					}
 
 					std::string signal_str;
@@ -453,6 +493,13 @@ Encrypts information for the identity.
 :raises: *KeyError* if the instance does not hold a public key.
 */
 const Bytes Identity::encrypt(const Bytes& plaintext) const {
+	Bytes ciphertext;
+	encrypt(ciphertext.writable(encrypted_size(plaintext.size())), plaintext.data(), plaintext.size());
+	return ciphertext;
+}
+
+// Writes ephemeral public key + token straight to output, which must hold encrypted_size(size) bytes
+size_t Identity::encrypt(uint8_t* output, const uint8_t* plaintext, size_t size) const {
 	assert(_object);
 	TRACE("Identity::encrypt: encrypting data...");
 	if (!_object->_pub) {
@@ -476,12 +523,12 @@ const Bytes Identity::encrypt(const Bytes& plaintext) const {
 	TRACEF("Identity::encrypt: derived key:          %s", derived_key.toHex().c_str());
 
 	Cryptography::Token token(derived_key);
-	TRACEF("Identity::encrypt: Token encrypting data of length %lu", plaintext.size());
-	TRACEF("Identity::encrypt: plaintext:  %s", plaintext.toHex().c_str());
-	Bytes ciphertext = token.encrypt(plaintext);
-	TRACEF("Identity::encrypt: ciphertext: %s", ciphertext.toHex().c_str());
+	TRACEF("Identity::encrypt: Token encrypting data of length %lu", size);
+	// Token goes first since plaintext may already sit where the token's ciphertext goes
+	size_t token_size = token.encrypt(output + ephemeral_pub_bytes.size(), plaintext, size);
+	memcpy(output, ephemeral_pub_bytes.data(), ephemeral_pub_bytes.size());
 
-	return ephemeral_pub_bytes + ciphertext;
+	return ephemeral_pub_bytes.size() + token_size;
 }
 
 
@@ -526,10 +573,15 @@ const Bytes Identity::decrypt(const Bytes& ciphertext_token) const {
 
 		Cryptography::Token token(derived_key);
 		//ciphertext = ciphertext_token[Identity.KEYSIZE//8//2:]
-		Bytes ciphertext(ciphertext_token.mid(Type::Identity::KEYSIZE/8/2));
-		TRACEF("Identity::decrypt: Token decrypting data of length %lu", ciphertext.size());
-		TRACEF("Identity::decrypt: ciphertext: %s", ciphertext.toHex().c_str());
-		plaintext = token.decrypt(ciphertext);
+		const uint8_t* ciphertext = ciphertext_token.data() + Type::Identity::KEYSIZE/8/2;
+		size_t ciphertext_size = ciphertext_token.size() - Type::Identity::KEYSIZE/8/2;
+		TRACEF("Identity::decrypt: Token decrypting data of length %lu", ciphertext_size);
+		if (ciphertext_size < Type::Cryptography::Token::TOKEN_OVERHEAD) {
+			throw std::invalid_argument("Cannot decrypt token of only " + std::to_string(ciphertext_size) + " bytes");
+		}
+		Bytes decrypted;
+		decrypted.resize(token.decrypt(decrypted.writable(ciphertext_size - Type::Cryptography::Token::TOKEN_OVERHEAD), ciphertext, ciphertext_size));
+		plaintext = decrypted;
 		TRACEF("Identity::decrypt: plaintext:  %s", plaintext.toHex().c_str());
 		//TRACEF("Identity::decrypt: Token decrypted data of length %lu", plaintext.size());
 	}
@@ -569,7 +621,7 @@ Validates the signature of a signed message.
 :returns: True if the signature is valid, otherwise False.
 :raises: *KeyError* if the instance does not hold a public key.
 */
-bool Identity::validate(const Bytes& signature, const Bytes& message) const {
+bool Identity::validate(const BytesView& signature, const BytesView& message) const {
 	assert(_object);
 	if (_object->_pub) {
 		try {
@@ -23,6 +23,8 @@
 #include "Cryptography/Token.h"
 #include "Utilities/Memory.h"
 #include "Persistence/IdentityEntry.h"
+#include "Utilities/GenerationalSet.h"
+#include "HashKey.h"
 
 #include <map>
 #include <string>
@@ -46,6 +48,12 @@ namespace RNS {
 		static uint16_t _known_destinations_maxsize;
 		static uint32_t _known_store_segment_size;
 		static uint8_t _known_store_segment_count;
+		// Digests of announces that passed validate_announce(), so duplicates skip the signature check
+		using AnnounceCache = Utilities::GenerationalSet<Hash32>;
+		static AnnounceCache _announce_cache;
+		static uint16_t _announce_cache_maxsize;
+		static uint32_t _announce_cache_hits;
+		static uint32_t _announce_cache_misses;
 
 	public:
 		Identity(bool create_keys = true);
@@ -55,6 +63,9 @@ namespace RNS {
 		Identity(const Identity& identity) : _object(identity._object) {
 			MEMF("Identity object copy created, this: %p, data: %p", (void*)this, (void*)_object.get());
 		}
+		Identity(Identity&& identity) noexcept : _object(std::move(identity._object)) {
+			MEMF("Identity object move created, this: %p, data: %p", (void*)this, (void*)_object.get());
+		}
 		virtual ~Identity() {
 			MEMF("Identity object destroyed, this: %p, data: %p", (void*)this, (void*)_object.get());
 		}
@@ -64,6 +75,11 @@ namespace RNS {
 			MEMF("Identity object copy created by assignment, this: %p, data: %p", (void*)this, (void*)_object.get());
 			return *this;
 		}
+		inline Identity& operator = (Identity&& identity) noexcept {
+			_object = std::move(identity._object);
+			MEMF("Identity object move created by assignment, this: %p, data: %p", (void*)this, (void*)_object.get());
+			return *this;
+		}
 		inline explicit operator bool() const {
 			return _object.get() != nullptr;
 		}
@@ -89,7 +105,8 @@ namespace RNS {
 			return _object->_pub_bytes + _object->_sig_pub_bytes;
 		}
 		bool load_private_key(const Bytes& prv_bytes);
-		void load_public_key(const Bytes& pub_bytes);
+		inline void load_public_key(const Bytes& pub_bytes) { load_public_key(pub_bytes.view()); }
+		void load_public_key(const BytesView& pub_bytes);
 		inline void update_hashes() {
 			assert(_object);
 			_object->_hash = truncated_hash(get_public_key());
@@ -104,8 +121,12 @@ namespace RNS {
 
 		const Bytes encrypt(const Bytes& plaintext) const;
 		const Bytes decrypt(const Bytes& ciphertext_token) const;
+		// Buffer variant for encrypting straight into a packet, see Token
+		static inline size_t encrypted_size(size_t size) { return Type::Identity::KEYSIZE/8/2 + Cryptography::Token::token_size(size); }
+		size_t encrypt(uint8_t* output, const uint8_t* plaintext, size_t size) const;
 		const Bytes sign(const Bytes& message) const;
-		bool validate(const Bytes& signature, const Bytes& message) const;
+		inline bool validate(const Bytes& signature, const Bytes& message) const { return validate(signature.view(), message.view()); }
+		bool validate(const BytesView& signature, const BytesView& message) const;
 		// CBA following default for reference value requires inclusiion of header
 		//void prove(const Packet& packet, const Destination& destination = {Type::NONE}) const;
 		void prove(const Packet& packet, const Destination& destination) const;
@@ -125,6 +146,10 @@ namespace RNS {
 		static inline const Bytes full_hash(const Bytes& data) {
 			return Cryptography::sha256(data);
 		}
+		// Hash of head followed by tail, without concatenating them first
+		static inline const Bytes full_hash(const BytesView& head, const BytesView& tail) {
+			return Cryptography::sha256(head, tail);
+		}
 
 		/*
 		Get a truncated SHA-256 hash of passed data.
@@ -170,6 +195,11 @@ namespace RNS {
 		inline static void known_store_segment_count(uint8_t value) { _known_store_segment_count = value; }
 
 		inline static const Persistence::KnownDestinations& known_destinations() { return _known_destinations; }
+		inline static uint16_t announce_cache_maxsize() { return _announce_cache_maxsize; }
+		inline static void announce_cache_maxsize(uint16_t announce_cache_maxsize) { _announce_cache_maxsize = announce_cache_maxsize; _announce_cache.clear(); _announce_cache.max_size(announce_cache_maxsize); }
+		inline static size_t announce_cache_size() { return _announce_cache.size(); }
+		inline static uint32_t announce_cache_hits() { return _announce_cache_hits; }
+		inline static uint32_t announce_cache_misses() { return _announce_cache_misses; }
 
 		inline std::string toString() const { if (!_object) return ""; return "{Identity:" + _object->_hash.toHex() + "}"; }
 
@@ -16,10 +16,16 @@
 
 #include "Identity.h"
 #include "Transport.h"
+#include "Utilities/OS.h"
 
 using namespace RNS;
 using namespace RNS::Type::Interface;
 
+#ifdef RNS_DEBUG_METRICS
+/*static*/ std::atomic<uint32_t> Interface::_handle_copies{0};
+/*static*/ std::atomic<uint32_t> Interface::_handle_moves{0};
+#endif
+
 /*static*/ uint8_t Interface::DISCOVER_PATHS_FOR = MODE_ACCESS_POINT | MODE_GATEWAY | MODE_ROAMING;
 
 void InterfaceImpl::handle_outgoing(const Bytes& data) {
@@ -27,6 +33,10 @@ void InterfaceImpl::handle_outgoing(const Bytes& data) {
 	//TRACE("InterfaceImpl.handle_outgoing");
 	_tx += 1;
 	_txbytes += data.size();
+	// Spawned interfaces' traffic also counts towards their parent, whose totals count_traffic() reports
+	if (_parent_interface && _parent_interface->get()) {
+		_parent_interface->get()->_txbytes += data.size();
+	}
 }
 
 void InterfaceImpl::handle_incoming(const Bytes& data) {
@@ -34,6 +44,9 @@ void InterfaceImpl::handle_incoming(const Bytes& data) {
 	//TRACE("InterfaceImpl.handle_incoming");
 	_rx += 1;
 	_rxbytes += data.size();
+	if (_parent_interface && _parent_interface->get()) {
+		_parent_interface->get()->_rxbytes += data.size();
+	}
 	// Create temporary Interface encapsulating our own shared impl
 	std::shared_ptr<InterfaceImpl> self = shared_from_this();
 	Interface interface(self);
@@ -41,6 +54,14 @@ void InterfaceImpl::handle_incoming(const Bytes& data) {
 	Transport::inbound(data, interface);
 }
 
+bool InterfaceImpl::queue_incoming(const Bytes& data) {
+	// Create temporary Interface encapsulating our own shared impl
+	std::shared_ptr<InterfaceImpl> self = shared_from_this();
+	Interface interface(self);
+	// Pass data on to transport for handling on its own thread
+	return Transport::queue_inbound(data, interface);
+}
+
 bool Interface::send_outgoing(const Bytes& data) {
 	assert(_impl);
 	//TRACEF("Interface.send_outgoing: data: %s", data.toHex().c_str());
@@ -86,51 +107,166 @@ void Interface::handle_incoming(const Bytes& data) {
     }
 }
 
-void Interface::process_announce_queue() {
-/*
-	if not hasattr(self, "announce_cap"):
-		self.announce_cap = RNS.Reticulum.ANNOUNCE_CAP
-
-	if hasattr(self, "announce_queue"):
-		try:
-			now = time.time()
-			stale = []
-			for a in self.announce_queue:
-				if now > a["time"]+RNS.Reticulum.QUEUED_ANNOUNCE_LIFE:
-					stale.append(a)
-
-			for s in stale:
-				if s in self.announce_queue:
-					self.announce_queue.remove(s)
-
-			if len(self.announce_queue) > 0:
-				min_hops = min(entry["hops"] for entry in self.announce_queue)
-				entries = list(filter(lambda e: e["hops"] == min_hops, self.announce_queue))
-				entries.sort(key=lambda e: e["time"])
-				selected = entries[0]
-
-				double now = OS::time();
-				uint32_t wait_time = 0;
-				if (_impl->_bitrate > 0 && _impl->_announce_cap > 0) {
-					uint32_t tx_time = (len(selected["raw"])*8) / _impl->_bitrate;
-					wait_time = (tx_time / _impl->_announce_cap);
-				}
-				_impl->_announce_allowed_at = now + wait_time;
-
-				self.on_outgoing(selected["raw"])
-
-				if selected in self.announce_queue:
-					self.announce_queue.remove(selected)
-
-				if len(self.announce_queue) > 0:
-					timer = threading.Timer(wait_time, self.process_announce_queue)
-					timer.start()
-
-		except Exception as e:
-			self.announce_queue = []
-			RNS.log("Error while processing announce queue on "+str(self)+". The contained exception was: "+str(e), RNS.LOG_ERROR)
-			RNS.log("The announce queue for this interface has been cleared.", RNS.LOG_ERROR)
-*/
+void Interface::process_queued_incoming(const Bytes& data) {
+	assert(_impl);
+	// Catch exceptions from transport handling of queued data
+	try {
+		// Data was already received by the impl, so skip any override and go straight to housekeeping
+		_impl->InterfaceImpl::handle_incoming(data);
+	}
+	catch (const std::bad_alloc&) {
+		ERROR("Interface::process_queued_incoming: bad_alloc - OUT OF MEMORY");
+		// Critical OOM, restarting
+#if defined(ESP32)
+		ESP.restart();
+#elif defined(ARDUINO_ARCH_NRF52) || defined(ARDUINO_NRF52_ADAFRUIT)
+		NVIC_SystemReset();
+#endif
+	}
+	catch (const std::exception& e) {
+		ERRORF("Interface::process_queued_incoming: %s", e.what());
+	}
+}
+
+//p def process_announce_queue(self):
+bool Interface::process_announce_queue() {
+	assert(_impl);
+	AnnounceQueue& announce_queue = _impl->_announce_queue;
+	try {
+		//p now = time.time()
+		double now = Utilities::OS::time();
+		//p for a in self.announce_queue: if now > a["time"]+RNS.Reticulum.QUEUED_ANNOUNCE_LIFE: stale.append(a)
+		size_t stale = announce_queue.expire(now - Type::Reticulum::QUEUED_ANNOUNCE_LIFE);
+		if (stale > 0) {
+			DEBUGF("Dropped %zu stale queued announce%s on %s", stale, stale == 1 ? "" : "s", toString().c_str());
+		}
+
+		// DIVERGENCE: The reference sends on a timer set when the announce was queued, here the queue
+		// is polled by Transport so the announce cap is checked again before sending.
+		if (announce_queue.empty() || now < _impl->_announce_allowed_at) {
+			return false;
+		}
+
+		//p min_hops = min(entry["hops"] for entry in self.announce_queue)
+		//p entries = list(filter(lambda e: e["hops"] == min_hops, self.announce_queue))
+		//p entries.sort(key=lambda e: e["time"])
+		//p selected = entries[0]
+		const AnnounceEntry& selected = announce_queue.top();
+
+		//p tx_time   = (len(selected["raw"])*8) / self.bitrate
+		//p wait_time = (tx_time / self.announce_cap)
+		double wait_time = 0;
+		if (_impl->_bitrate > 0 && _impl->_announce_cap > 0) {
+			double tx_time = (selected._raw.size() * 8) / (double)_impl->_bitrate;
+			wait_time = (tx_time / _impl->_announce_cap);
+		}
+		//p self.announce_allowed_at = now + wait_time
+		_impl->_announce_allowed_at = now + wait_time;
+
+		// DIVERGENCE: Sent through Transport rather than straight to the interface, so queued announces
+		// get interface access codes too
+		//p self.process_outgoing(selected["raw"])
+		Bytes raw = selected._raw;
+		announce_queue.pop();
+		Transport::transmit(*this, raw);
+		return true;
+	}
+	catch (const std::exception& e) {
+		//p self.announce_queue = []
+		announce_queue.clear();
+		ERRORF("Error while processing announce queue on %s. The contained exception was: %s", toString().c_str(), e.what());
+		ERROR("The announce queue for this interface has been cleared.");
+	}
+	return false;
+}
+
+void Interface::egress_shaping(bool egress_shaping, uint32_t egress_burst /*= 0*/) {
+	assert(_impl);
+	_impl->_egress_shaping = egress_shaping;
+	if (egress_burst > 0) {
+		_impl->_egress_burst = egress_burst;
+	}
+	// Starts out with a full bucket
+	_impl->_egress_tokens = _impl->_egress_burst;
+	_impl->_egress_tokens_at = Utilities::OS::time();
+	// Anything still held goes out now
+	if (!egress_shaping) {
+		process_egress();
+	}
+}
+
+bool Interface::queue_outgoing(const Bytes& data, Type::Interface::egress_classes egress_class) {
+	assert(_impl);
+	if (!_impl->_egress_shaping || _impl->_bitrate == 0) {
+		return send_outgoing(data);
+	}
+	std::list<Bytes>& queue = _impl->_egress_queues[egress_class];
+	if (queue.size() >= Type::Interface::EGRESS_QUEUE_MAX) {
+		++_impl->_egress_dropped[egress_class];
+		TRACEF("Dropped outgoing packet of egress class %d on %s, queue is full", (int)egress_class, toString().c_str());
+		return false;
+	}
+	queue.push_back(data);
+	++_impl->_egress_queued;
+	process_egress();
+	return true;
+}
+
+void Interface::process_egress() {
+	assert(_impl);
+	if (_impl->_egress_queued == 0) {
+		return;
+	}
+	double now = Utilities::OS::time();
+	bool shaped = (_impl->_egress_shaping && _impl->_bitrate > 0);
+	if (shaped) {
+		// Refills at the bitrate, up to a burst
+		_impl->_egress_tokens = std::min((double)_impl->_egress_burst, _impl->_egress_tokens + (now - _impl->_egress_tokens_at) * _impl->_bitrate / 8.0);
+	}
+	_impl->_egress_tokens_at = now;
+	for (std::list<Bytes>& queue : _impl->_egress_queues) {
+		while (!queue.empty()) {
+			size_t size = queue.front().size();
+			// Packets larger than a burst go out on a full bucket, leaving it in debt. Strict priority,
+			// so lower classes wait while the head of a higher one doesn't fit.
+			if (shaped && _impl->_egress_tokens < std::min((double)size, (double)_impl->_egress_burst)) {
+				return;
+			}
+			Bytes data(std::move(queue.front()));
+			queue.pop_front();
+			--_impl->_egress_queued;
+			if (shaped) {
+				_impl->_egress_tokens -= size;
+			}
+			send_outgoing(data);
+		}
+	}
+}
+
+double Interface::egress_ready_at() const {
+	assert(_impl);
+	if (_impl->_egress_queued == 0) {
+		return 0;
+	}
+	if (!_impl->_egress_shaping || _impl->_bitrate == 0) {
+		return _impl->_egress_tokens_at;
+	}
+	for (const std::list<Bytes>& queue : _impl->_egress_queues) {
+		if (!queue.empty()) {
+			double needed = std::min((double)queue.front().size(), (double)_impl->_egress_burst) - _impl->_egress_tokens;
+			return _impl->_egress_tokens_at + std::max(needed, 0.0) * 8.0 / _impl->_bitrate;
+		}
+	}
+	return 0;
+}
+
+size_t Interface::egress_dropped() const {
+	assert(_impl);
+	size_t dropped = 0;
+	for (size_t count : _impl->_egress_dropped) {
+		dropped += count;
+	}
+	return dropped;
 }
 
 /*
@@ -151,3 +287,46 @@ TRACEF(">>> Interface post: %s", dst.debugString().c_str());
 	}
 }
 */
+
+//p IFAC_SALT = bytes.fromhex("adf54d882c9a9b80771eb4995d702d4a3e733391b2a0f53f416d9f907e55cff8")
+static const uint8_t IFAC_SALT[] = {
+	0xad, 0xf5, 0x4d, 0x88, 0x2c, 0x9a, 0x9b, 0x80, 0x77, 0x1e, 0xb4, 0x99, 0x5d, 0x70, 0x2d, 0x4a,
+	0x3e, 0x73, 0x33, 0x91, 0xb2, 0xa0, 0xf5, 0x3f, 0x41, 0x6d, 0x9f, 0x90, 0x7e, 0x55, 0xcf, 0xf8
+};
+
+// Python sets these up in Reticulum._add_interface() from the interface configuration
+void Interface::ifac(const char* netname, const char* netkey, uint8_t ifac_size /*= InterfaceImpl::DEFAULT_IFAC_SIZE*/) {
+	assert(_impl);
+	if (netname == nullptr && netkey == nullptr) {
+		throw std::invalid_argument("Interface access code needs a network name or passphrase");
+	}
+	if (ifac_size < Type::Reticulum::IFAC_MIN_SIZE || ifac_size > 64) {
+		throw std::invalid_argument("Interface access code size must be between 1 and 64 bytes");
+	}
+
+	//p ifac_origin = b""
+	Bytes ifac_origin;
+	//p if ifac_netname != None: ifac_origin += RNS.Identity.full_hash(ifac_netname.encode("utf-8"))
+	if (netname != nullptr) {
+		ifac_origin += Identity::full_hash(Bytes(netname));
+	}
+	//p if ifac_netkey != None: ifac_origin += RNS.Identity.full_hash(ifac_netkey.encode("utf-8"))
+	if (netkey != nullptr) {
+		ifac_origin += Identity::full_hash(Bytes(netkey));
+	}
+	//p ifac_origin_hash = RNS.Identity.full_hash(ifac_origin)
+	const Bytes ifac_origin_hash = Identity::full_hash(ifac_origin);
+	//p interface.ifac_key = RNS.Cryptography.hkdf(length=64, derive_from=ifac_origin_hash, salt=self.ifac_salt, context=None)
+	_impl->_ifac_key = Cryptography::hkdf(64, ifac_origin_hash, Bytes(IFAC_SALT, sizeof(IFAC_SALT)));
+	//p interface.ifac_identity = RNS.Identity.from_bytes(interface.ifac_key)
+	Identity ifac_identity(false);
+	if (!ifac_identity.load_private_key(_impl->_ifac_key)) {
+		throw std::runtime_error("Could not create interface access code identity");
+	}
+	_impl->_ifac_identity = ifac_identity;
+	//p interface.ifac_signature = interface.ifac_identity.sign(RNS.Identity.full_hash(interface.ifac_key))
+	_impl->_ifac_signature = ifac_identity.sign(Identity::full_hash(_impl->_ifac_key));
+	_impl->_ifac_size = ifac_size;
+	// Every packet's mask is derived with the key as salt
+	_impl->_ifac_hkdf.salt(_impl->_ifac_key);
+}
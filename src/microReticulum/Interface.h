@@ -16,15 +16,21 @@
 
 #include "Identity.h"
 #include "Log.h"
+#include "Cryptography/HKDF.h"
 #include "Bytes.h"
 #include "Type.h"
 
 #include <ArduinoJson.h>
 
 #include <list>
+#include <vector>
+#include <algorithm>
 #include <memory>
 #include <cassert>
 #include <limits>
+#ifdef RNS_DEBUG_METRICS
+#include <atomic>
+#endif
 #include <stdint.h>
 
 namespace RNS {
@@ -32,6 +38,9 @@ namespace RNS {
 	class Interface;
 	using HInterface = std::shared_ptr<Interface>;
 
+	// Small integer handle interned by Transport for each registered interface (0 = none)
+	using InterfaceId = uint16_t;
+
 	class AnnounceEntry {
 	public:
 		AnnounceEntry() {}
@@ -49,6 +58,71 @@ namespace RNS {
 		Bytes _raw;
 	};
 
+	// Announces waiting on an interface's announce cap, as a min-heap ordered by hops and then by
+	// the time they were queued so the next one to send is always at the front. Queues are bounded
+	// by MAX_QUEUED_ANNOUNCES, so looking up the entry for a destination is a scan of a few
+	// contiguous entries.
+	class AnnounceQueue {
+
+	private:
+		// Orders the heap so the fewest hops (then the earliest queued) is at the front
+		struct Later {
+			inline bool operator()(const AnnounceEntry& lhs, const AnnounceEntry& rhs) const {
+				if (lhs._hops != rhs._hops) return lhs._hops > rhs._hops;
+				return lhs._time > rhs._time;
+			}
+		};
+
+	public:
+		using const_iterator = std::vector<AnnounceEntry>::const_iterator;
+
+	public:
+		// Queues entry unless one for the same destination is already queued, in which case that
+		// one is replaced if entry is a newer emission. Returns true if entry was added.
+		bool push(const AnnounceEntry& entry) {
+			for (AnnounceEntry& queued : _heap) {
+				if (queued._destination == entry._destination) {
+					if (entry._emitted > queued._emitted) {
+						queued = entry;
+						std::make_heap(_heap.begin(), _heap.end(), Later());
+					}
+					return false;
+				}
+			}
+			_heap.push_back(entry);
+			std::push_heap(_heap.begin(), _heap.end(), Later());
+			return true;
+		}
+
+		// Next entry to send, queue must not be empty
+		inline const AnnounceEntry& top() const { return _heap.front(); }
+		inline void pop() {
+			std::pop_heap(_heap.begin(), _heap.end(), Later());
+			_heap.pop_back();
+		}
+
+		// Drops entries queued before oldest, returns the number dropped
+		size_t expire(double oldest) {
+			size_t before = _heap.size();
+			_heap.erase(std::remove_if(_heap.begin(), _heap.end(), [oldest](const AnnounceEntry& entry) { return entry._time < oldest; }), _heap.end());
+			if (_heap.size() != before) {
+				std::make_heap(_heap.begin(), _heap.end(), Later());
+			}
+			return before - _heap.size();
+		}
+
+		// Entries in no particular order
+		inline const_iterator begin() const { return _heap.begin(); }
+		inline const_iterator end() const { return _heap.end(); }
+		inline size_t size() const { return _heap.size(); }
+		inline bool empty() const { return _heap.empty(); }
+		inline void clear() { _heap.clear(); }
+
+	private:
+		std::vector<AnnounceEntry> _heap;
+
+	};
+
 	class InterfaceImpl : public std::enable_shared_from_this<InterfaceImpl> {
 
 	protected:
@@ -57,10 +131,24 @@ namespace RNS {
 	public:
 		virtual ~InterfaceImpl() { MEMF("InterfaceImpl object destroyed, this: 0x%X", this); }
 
+	public:
+		// poll_fd() of an interface with nothing to watch for now (e.g. waiting to reconnect), whose
+		// loop() only needs calling at the regular job interval
+		static const int POLL_IDLE = -2;
+		// Bytes of interface access code added to every packet, unless configured otherwise
+		static const uint8_t DEFAULT_IFAC_SIZE = 16;
+
 	protected:
 		virtual bool start() { return true; }
 		virtual void stop() {}
 		virtual void loop() {}
+		// File descriptor that becomes readable when loop() has input to handle, lets Reticulum::wait()
+		// sleep until then. -1 (the default) means loop() must be called continuously, POLL_IDLE that
+		// there is nothing to wait for.
+		virtual int poll_fd() const { return -1; }
+		// Called by Transport::loop() once it is done sending for now, so interfaces that hold
+		// outgoing data to send in batches transmit what they are holding
+		virtual void flush() {}
 		// Called by Transport::detach_interfaces() during clean shutdown so
 		// subclasses can release resources (sockets, threads, hardware) before
 		// destruction. Default is a no-op; idempotency is the subclass's call.
@@ -79,7 +167,12 @@ namespace RNS {
 		void handle_outgoing(const Bytes& data);
 		// CBA Internal method to handle data coming in on interface and pass on to transport
 		virtual void handle_incoming(const Bytes& data);
+		// Thread-safe alternative to handle_incoming() for interfaces receiving on their own threads,
+		// queues data for transport to process on its next loop(). Returns false if the queue is full
+		// and data was dropped. Signal stats (rssi/snr/q) are not carried with queued data.
+		bool queue_incoming(const Bytes& data);
 
+		// Computes the interface hash, callers should use the cached Interface::get_hash()
 		virtual const Bytes get_hash() const {
 			return Identity::full_hash({toString()});
 		}
@@ -94,14 +187,21 @@ namespace RNS {
 		bool _RPT = false;
 		std::string _name;
 		bool _online = false;
-		Bytes _ifac_identity;
+		// Interface access code (IFAC) authentication, enabled by Interface::ifac()
+		Identity _ifac_identity = {Type::NONE};
+		uint8_t _ifac_size = 0;
+		Bytes _ifac_key;
+		Bytes _ifac_signature;
+		// HKDF salted with _ifac_key, precomputed for masking every packet
+		Cryptography::SaltedHKDF _ifac_hkdf;
 		Type::Interface::modes _mode = Type::Interface::MODE_NONE;
 		uint32_t _bitrate = 0;
 		uint16_t _HW_MTU = 0;
 		bool _AUTOCONFIGURE_MTU = false;
 		bool _FIXED_MTU = false;
 		double _announce_allowed_at = 0;
-		float _announce_cap = 0.0;
+		// Fraction of the bitrate that announces being passed on may use
+		float _announce_cap = Type::Reticulum::ANNOUNCE_CAP / 100.0;
 		// Announce rate-limit configuration. 0 (target) means disabled; a positive
 		// target is the minimum interval (seconds) between announces from a given
 		// destination before that destination accumulates rate violations. After
@@ -110,10 +210,18 @@ namespace RNS {
 		float _announce_rate_target  = 0.0;
 		uint8_t _announce_rate_grace = 0;
 		float _announce_rate_penalty = 0.0;
-		std::list<AnnounceEntry> _announce_queue;
+		AnnounceQueue _announce_queue;
+		// Set while Transport has the announce queue scheduled for processing
+		bool _announce_queue_scheduled = false;
+		// Egress shaping holds outgoing packets in strict priority classes and sends them at _bitrate,
+		// allowing bursts of up to _egress_burst bytes
+		bool _egress_shaping = false;
+		uint32_t _egress_burst = 2 * Type::Reticulum::MTU;
 		bool _is_connected_to_shared_instance = false;
 		bool _is_local_shared_instance = false;
-		//Bytes _hash;
+		// Cached get_hash(), refreshed on registration and cleared on rename
+		mutable Bytes _hash;
+		InterfaceId _id = 0;
 		HInterface _parent_interface;
 		//Transport& _owner;
 
@@ -122,6 +230,12 @@ namespace RNS {
 		size_t _tx = 0;
 		size_t _rxbytes = 0;
 		size_t _txbytes = 0;
+		// Egress scheduler queues and token bucket (in bytes), only used with egress shaping
+		std::list<Bytes> _egress_queues[Type::Interface::EGRESS_CLASSES];
+		size_t _egress_queued = 0;
+		size_t _egress_dropped[Type::Interface::EGRESS_CLASSES] = {};
+		double _egress_tokens = 0;
+		double _egress_tokens_at = 0;
 
 		// Per-interface traffic counter state for Transport::count_traffic().
 		// _traffic_counter_ts = 0.0 means the counter has not been initialised yet.
@@ -154,8 +268,17 @@ namespace RNS {
 			MEMF("Interface NONE object created, this: 0x%X, impl: 0x%X", this, _impl.get());
 		}
 		Interface(const Interface& obj) : _impl(obj._impl) {
+#ifdef RNS_DEBUG_METRICS
+			if (_impl) ++_handle_copies;
+#endif
 			MEMF("Interface object copy created, this: 0x%X, impl: 0x%X", this, _impl.get());
 		}
+		Interface(Interface&& obj) noexcept : _impl(std::move(obj._impl)) {
+#ifdef RNS_DEBUG_METRICS
+			if (_impl) ++_handle_moves;
+#endif
+			MEMF("Interface object move created, this: 0x%X, impl: 0x%X", this, _impl.get());
+		}
 		Interface(std::shared_ptr<InterfaceImpl>& impl) : _impl(impl) {
 			MEMF("Interface object created with shared impl, this: 0x%X, impl: 0x%X", this, _impl.get());
 		}
@@ -168,9 +291,20 @@ namespace RNS {
 
 		inline Interface& operator = (const Interface& obj) {
 			_impl = obj._impl;
+#ifdef RNS_DEBUG_METRICS
+			if (_impl) ++_handle_copies;
+#endif
 			MEMF("Interface object copy created by assignment, this: 0x%X, impl: 0x%X", this, _impl.get());
 			return *this;
 		}
+		inline Interface& operator = (Interface&& obj) noexcept {
+			_impl = std::move(obj._impl);
+#ifdef RNS_DEBUG_METRICS
+			if (_impl) ++_handle_moves;
+#endif
+			MEMF("Interface object move created by assignment, this: 0x%X, impl: 0x%X", this, _impl.get());
+			return *this;
+		}
 		inline Interface& operator = (InterfaceImpl* impl) {
 			_impl.reset(impl);
 			MEMF("Interface object copy created by assignment, this: 0x%X, impl: 0x%X", this, _impl.get());
@@ -207,11 +341,27 @@ namespace RNS {
 		inline bool start() { assert(_impl); return _impl->start(); }
 		inline void stop() { assert(_impl); _impl->stop(); }
 		inline void loop() { assert(_impl); _impl->loop(); }
-		inline const Bytes get_hash() const { assert(_impl); return _impl->get_hash(); }
-		void process_announce_queue();
+		inline int poll_fd() const { assert(_impl); return _impl->poll_fd(); }
+		inline void flush() { assert(_impl); _impl->flush(); }
+		inline const Bytes& get_hash() const {
+			assert(_impl);
+			if (_impl->_hash.size() == 0) _impl->_hash = _impl->get_hash();
+			return _impl->_hash;
+		}
+		// Interned by Transport::register_interface(), 0 if not registered
+		inline InterfaceId id() const { return _impl ? _impl->_id : 0; }
+		// Sends the next queued announce if the announce cap allows it now, returns true if one was sent
+		bool process_announce_queue();
+		// Egress shaping, see InterfaceImpl::_egress_shaping. queue_outgoing() sends data in its
+		// priority class when the token bucket allows, straight away if it does now. Returns false
+		// if the class queue was full and data dropped. process_egress() sends whatever has become
+		// allowed, egress_ready_at() is when something next will be (0 if nothing is queued).
+		bool queue_outgoing(const Bytes& data, Type::Interface::egress_classes egress_class);
+		void process_egress();
+		double egress_ready_at() const;
 
 		// CBA ACCUMULATES
-		inline void add_announce(AnnounceEntry& entry) { assert(_impl); _impl->_announce_queue.push_back(entry); }
+		inline bool add_announce(const AnnounceEntry& entry) { assert(_impl); return _impl->_announce_queue.push(entry); }
 
 	protected:
 		// Internal method to handle data going out on interface and pass on to impl
@@ -219,6 +369,9 @@ namespace RNS {
 	public:
 		// Public method to handle data coming in on interface and pass on to impl
 		void handle_incoming(const Bytes& data);
+	protected:
+		// Internal method for transport to handle data queued by InterfaceImpl::queue_incoming()
+		void process_queued_incoming(const Bytes& data);
 
 	protected:
 		// setters
@@ -226,9 +379,12 @@ namespace RNS {
 		inline void OUT(bool OUT) { assert(_impl); _impl->_OUT = OUT; }
 		inline void FWD(bool FWD) { assert(_impl); _impl->_FWD = FWD; }
 		inline void RPT(bool RPT) { assert(_impl); _impl->_RPT = RPT; }
-		inline void name(const char* name) { assert(_impl); _impl->_name = name; }
+		inline void name(const char* name) { assert(_impl); _impl->_name = name; _impl->_hash.clear(); }
+		inline void update_hash() const { assert(_impl); _impl->_hash = _impl->get_hash(); }
+		inline void id(InterfaceId id) const { assert(_impl); _impl->_id = id; }
 		inline void online(bool online) { assert(_impl); _impl->_online = online; }
 		inline void announce_allowed_at(double announce_allowed_at) { assert(_impl); _impl->_announce_allowed_at = announce_allowed_at; }
+		inline void announce_queue_scheduled(bool scheduled) const { assert(_impl); _impl->_announce_queue_scheduled = scheduled; }
 	public:
 		// getters
 		inline bool IN() const { assert(_impl); return _impl->_IN; }
@@ -237,7 +393,14 @@ namespace RNS {
 		inline bool RPT() const { assert(_impl); return _impl->_RPT; }
 		inline bool online() const { assert(_impl); return _impl->_online; }
 		inline std::string name() const { assert(_impl); return _impl->_name; }
-		inline const Bytes& ifac_identity() const { assert(_impl); return _impl->_ifac_identity; }
+		inline const Identity& ifac_identity() const { assert(_impl); return _impl->_ifac_identity; }
+		inline uint8_t ifac_size() const { assert(_impl); return _impl->_ifac_size; }
+		inline const Bytes& ifac_key() const { assert(_impl); return _impl->_ifac_key; }
+		inline const Bytes& ifac_signature() const { assert(_impl); return _impl->_ifac_signature; }
+		inline const Cryptography::SaltedHKDF& ifac_hkdf() const { assert(_impl); return _impl->_ifac_hkdf; }
+		// Enables interface access codes, so only peers configured with the same network name and/or
+		// passphrase (either may be null) can communicate over the interface. ifac_size is in bytes.
+		void ifac(const char* netname, const char* netkey, uint8_t ifac_size = InterfaceImpl::DEFAULT_IFAC_SIZE);
 		inline Type::Interface::modes mode() const { assert(_impl); return _impl->_mode; }
 		inline void mode(Type::Interface::modes mode) { assert(_impl); _impl->_mode = mode; }
 		inline uint32_t bitrate() const { assert(_impl); return _impl->_bitrate; }
@@ -253,10 +416,20 @@ namespace RNS {
 		inline bool FIXED_MTU() const { assert(_impl); return _impl->_FIXED_MTU; }
 		inline double announce_allowed_at() const { assert(_impl); return _impl->_announce_allowed_at; }
 		inline float announce_cap() const { assert(_impl); return _impl->_announce_cap; }
+		inline void announce_cap(float announce_cap) { assert(_impl); _impl->_announce_cap = announce_cap; }
+		inline bool egress_shaping() const { assert(_impl); return _impl->_egress_shaping; }
+		inline uint32_t egress_burst() const { assert(_impl); return _impl->_egress_burst; }
+		// Only shapes with a bitrate set, a burst of 0 keeps the current one
+		void egress_shaping(bool egress_shaping, uint32_t egress_burst = 0);
+		inline bool announce_queue_scheduled() const { assert(_impl); return _impl->_announce_queue_scheduled; }
 		inline size_t rx() const { assert(_impl); return _impl->_rx; }
 		inline size_t tx() const { assert(_impl); return _impl->_tx; }
 		inline size_t rxbytes() const { assert(_impl); return _impl->_rxbytes; }
 		inline size_t txbytes() const { assert(_impl); return _impl->_txbytes; }
+		inline size_t egress_queued() const { assert(_impl); return _impl->_egress_queued; }
+		inline size_t egress_queued(Type::Interface::egress_classes egress_class) const { assert(_impl); return _impl->_egress_queues[egress_class].size(); }
+		inline size_t egress_dropped(Type::Interface::egress_classes egress_class) const { assert(_impl); return _impl->_egress_dropped[egress_class]; }
+		size_t egress_dropped() const;
 		inline double traffic_counter_ts() const { assert(_impl); return _impl->_traffic_counter_ts; }
 		inline size_t traffic_counter_rxb() const { assert(_impl); return _impl->_traffic_counter_rxb; }
 		inline size_t traffic_counter_txb() const { assert(_impl); return _impl->_traffic_counter_txb; }
@@ -276,7 +449,7 @@ namespace RNS {
 		}
 		inline void current_rx_speed(double speed) const { assert(_impl); _impl->_current_rx_speed = speed; }
 		inline void current_tx_speed(double speed) const { assert(_impl); _impl->_current_tx_speed = speed; }
-		inline std::list<AnnounceEntry>& announce_queue() const { assert(_impl); return _impl->_announce_queue; }
+		inline AnnounceQueue& announce_queue() const { assert(_impl); return _impl->_announce_queue; }
 		inline void detach() const { assert(_impl); _impl->detach(); }
 		inline void sent_announce() const { assert(_impl); _impl->sent_announce(); }
 		inline void sent_path_request() const { assert(_impl); _impl->sent_path_request(); }
@@ -286,6 +459,13 @@ namespace RNS {
 
 		virtual inline std::string toString() const { if (!_impl) return ""; return _impl->toString(); }
 
+#ifdef RNS_DEBUG_METRICS
+		// Copies (a refcount increment each, and a decrement when the copy goes) and moves (neither) of
+		// non-empty handles
+		inline static uint32_t handle_copies() { return _handle_copies; }
+		inline static uint32_t handle_moves() { return _handle_moves; }
+#endif
+
 #ifndef NDEBUG
 		inline std::string debugString() const {
 			std::string dump;
@@ -297,6 +477,12 @@ namespace RNS {
 	protected:
 		std::shared_ptr<InterfaceImpl> _impl;
 
+#ifdef RNS_DEBUG_METRICS
+		// Interface handles are also copied on interface threads queueing incoming data
+		static std::atomic<uint32_t> _handle_copies;
+		static std::atomic<uint32_t> _handle_moves;
+#endif
+
 	friend class Transport;
 	};
 
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "HDLC.h"
+
+using namespace RNS;
+using namespace RNS::Interfaces;
+
+/*
+@staticmethod
+def escape(data):
+	data = data.replace(bytes([HDLC.ESC]), bytes([HDLC.ESC, HDLC.ESC^HDLC.ESC_MASK]))
+	data = data.replace(bytes([HDLC.FLAG]), bytes([HDLC.ESC, HDLC.FLAG^HDLC.ESC_MASK]))
+	return data
+*/
+/*static*/ void HDLC::frame(const uint8_t* data, size_t size, Bytes& frame) {
+	uint8_t* out = frame.writable(max_framed_size(size));
+	uint8_t* start = out;
+	*out++ = FLAG;
+	const uint8_t* end = data + size;
+	while (data < end) {
+		uint8_t byte = *data++;
+		if (byte == FLAG || byte == ESC) {
+			*out++ = ESC;
+			*out++ = byte ^ ESC_MASK;
+		}
+		else {
+			*out++ = byte;
+		}
+	}
+	*out++ = FLAG;
+	frame.resize(out - start);
+}
+
+HDLC::Deframer::Deframer(size_t max_size, size_t min_size /*= Type::Reticulum::HEADER_MINSIZE*/) :
+	_max_size(max_size),
+	_min_size(min_size)
+{
+	// Start out with room for a full MTU packet, and always beyond inline storage so the buffer
+	// keeps its contents when grown
+	_capacity = Type::Reticulum::MTU;
+	if (_capacity > _max_size) {
+		_capacity = _max_size;
+	}
+	if (_capacity <= Bytes::INLINE_CAPACITY) {
+		_capacity = Bytes::INLINE_CAPACITY + 1;
+	}
+}
+
+void HDLC::Deframer::reset() {
+	_in_frame = false;
+	_escape = false;
+	_overflow = false;
+	_length = 0;
+}
+
+void HDLC::Deframer::begin() {
+	_in_frame = true;
+	_escape = false;
+	_overflow = false;
+	_length = 0;
+	// Reuses the previous frame's buffer, or allocates a fresh one if whoever received that frame
+	// still holds it
+	_buffer = _frame.writable(_capacity);
+}
+
+void HDLC::Deframer::grow(size_t size) {
+	size_t capacity = _capacity * 2;
+	if (capacity < size) {
+		capacity = size;
+	}
+	if (capacity > _max_size) {
+		capacity = _max_size;
+	}
+	// Exclusive while a frame is being assembled, so contents are kept
+	_buffer = _frame.writable(capacity);
+	_capacity = capacity;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "../Bytes.h"
+#include "../Type.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace RNS { namespace Interfaces {
+
+	//p class HDLC():
+	// Simplified HDLC framing used by the reference stream interfaces (TCP, local shared instance).
+	// A frame is FLAG + data + FLAG, with FLAG and ESC inside data sent as ESC followed by the byte
+	// xor ESC_MASK.
+	class HDLC {
+
+	public:
+		static const uint8_t FLAG     = 0x7E;
+		static const uint8_t ESC      = 0x7D;
+		static const uint8_t ESC_MASK = 0x20;
+
+		// Largest possible framed size of size bytes of data
+		static inline size_t max_framed_size(size_t size) { return 2 * size + 2; }
+
+		//p def escape(data):
+		// Replaces the contents of frame with data escaped and enclosed in flags, frame's buffer is
+		// reused when it isn't shared
+		static void frame(const uint8_t* data, size_t size, Bytes& frame);
+		static inline void frame(const Bytes& data, Bytes& frame) { HDLC::frame(data.data(), data.size(), frame); }
+		static inline Bytes frame(const Bytes& data) { Bytes frame; HDLC::frame(data.data(), data.size(), frame); return frame; }
+
+	public:
+		// Incremental deframer for a byte stream. Bytes are fed in as they are read, in chunks of any
+		// size, and unescaped straight into a Bytes buffer that is handed to the callback for every
+		// complete frame. The buffer is reused for the next frame unless the callback kept a
+		// reference to it, so steady-state deframing doesn't allocate.
+		//
+		// As in the reference a flag both ends a frame and starts the next one, frames no longer than
+		// min_size are ignored and frames longer than max_size are dropped.
+		class Deframer {
+
+		public:
+			Deframer(size_t max_size, size_t min_size = Type::Reticulum::HEADER_MINSIZE);
+
+			// Calls on_frame(const Bytes& frame) for each frame completed by data
+			template <typename Callback>
+			void feed(const uint8_t* data, size_t size, Callback&& on_frame) {
+				const uint8_t* end = data + size;
+				while (data < end) {
+					if (!_in_frame) {
+						// Anything before the first flag is line noise
+						const uint8_t* flag = (const uint8_t*)memchr(data, FLAG, end - data);
+						if (flag == nullptr) {
+							return;
+						}
+						data = flag + 1;
+						begin();
+						continue;
+					}
+					if (_escape) {
+						_escape = false;
+						if (*data == (FLAG ^ ESC_MASK)) {
+							put(FLAG);
+							++data;
+							continue;
+						}
+						if (*data == (ESC ^ ESC_MASK)) {
+							put(ESC);
+							++data;
+							continue;
+						}
+						// Not an escape sequence, the reference passes it through unchanged
+						put(ESC);
+					}
+					// Copy the run of plain bytes up to the next flag or escape in one go
+					const uint8_t* special = data;
+					while (special < end && *special != FLAG && *special != ESC) {
+						++special;
+					}
+					if (special > data) {
+						put(data, special - data);
+						data = special;
+					}
+					if (data == end) {
+						return;
+					}
+					++data;
+					if (*(data - 1) == ESC) {
+						_escape = true;
+						continue;
+					}
+					if (_overflow) {
+						++_dropped;
+					}
+					else if (_length > _min_size) {
+						_frame.resize(_length);
+						++_frames;
+						on_frame((const Bytes&)_frame);
+					}
+					begin();
+				}
+			}
+			template <typename Callback>
+			inline void feed(const Bytes& data, Callback&& on_frame) { feed(data.data(), data.size(), on_frame); }
+
+			// Discards any partial frame, e.g. after the stream was interrupted
+			void reset();
+
+			inline bool in_frame() const { return _in_frame; }
+			inline size_t frames() const { return _frames; }
+			inline size_t dropped() const { return _dropped; }
+
+		private:
+			void begin();
+			void grow(size_t size);
+			inline void put(uint8_t byte) { put(&byte, 1); }
+			inline void put(const uint8_t* data, size_t size) {
+				if (_overflow) {
+					return;
+				}
+				if (_length + size > _max_size) {
+					_overflow = true;
+					return;
+				}
+				if (_length + size > _capacity) {
+					grow(_length + size);
+				}
+				memcpy(_buffer + _length, data, size);
+				_length += size;
+			}
+
+		private:
+			Bytes _frame;
+			uint8_t* _buffer = nullptr;
+			size_t _capacity;
+			size_t _length = 0;
+			size_t _max_size;
+			size_t _min_size;
+			bool _in_frame = false;
+			bool _escape = false;
+			bool _overflow = false;
+			size_t _frames = 0;
+			size_t _dropped = 0;
+
+		};
+
+	};
+
+} }
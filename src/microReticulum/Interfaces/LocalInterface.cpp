@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "LocalInterface.h"
+
+#if RNS_TCP_INTERFACE
+
+#include "../Transport.h"
+#include "../Log.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <stddef.h>
+#include <string.h>
+
+using namespace RNS;
+using namespace RNS::Interfaces;
+
+// Abstract socket namespace is Linux only, like the reference's use_af_unix()
+#if defined(__linux__)
+#define RNS_LOCAL_INTERFACE_AF_UNIX 1
+#else
+#define RNS_LOCAL_INTERFACE_AF_UNIX 0
+#endif
+
+#if RNS_LOCAL_INTERFACE_AF_UNIX
+//p self.local_socket_path = f"\0rns/{self.instance_name}"
+static bool socket_address(const std::string& instance_name, sockaddr_storage& address, socklen_t& address_size) {
+	std::string path = "rns/" + instance_name;
+	sockaddr_un* address_un = (sockaddr_un*)&address;
+	if (path.size() + 1 > sizeof(address_un->sun_path)) {
+		return false;
+	}
+	memset(address_un, 0, sizeof(sockaddr_un));
+	address_un->sun_family = AF_UNIX;
+	// Leading nul places the name in the abstract namespace, so no file is left behind
+	memcpy(address_un->sun_path + 1, path.data(), path.size());
+	address_size = offsetof(sockaddr_un, sun_path) + 1 + path.size();
+	return true;
+}
+#endif
+
+
+//p def __init__(self, owner, name, port=None, connected_socket=None, socket_path=None):
+LocalClientInterface::LocalClientInterface(const char* name /*= "Local shared instance"*/, const char* instance_name /*= "default"*/, int port /*= DEFAULT_LOCAL_INTERFACE_PORT*/) : TCPClientInterface(name, "127.0.0.1", port),
+	_instance_name(instance_name)
+{
+	_bitrate = BITRATE_GUESS;
+	_is_connected_to_shared_instance = true;
+	reconnect_wait(RECONNECT_WAIT, RECONNECT_WAIT);
+}
+
+LocalClientInterface::LocalClientInterface(const char* name, int socket, const char* instance_name, int port, size_t connection) : TCPClientInterface(name, socket, "127.0.0.1", port),
+	_instance_name(instance_name),
+	_connection(connection)
+{
+	_bitrate = BITRATE_GUESS;
+}
+
+std::string LocalClientInterface::address() const {
+#if RNS_LOCAL_INTERFACE_AF_UNIX
+	return "rns/" + _instance_name;
+#else
+	return target_host() + ":" + std::to_string(target_port());
+#endif
+}
+
+/*virtual*/ bool LocalClientInterface::resolve(sockaddr_storage& address, socklen_t& address_size) {
+#if RNS_LOCAL_INTERFACE_AF_UNIX
+	return socket_address(_instance_name, address, address_size);
+#else
+	return TCPClientInterface::resolve(address, address_size);
+#endif
+}
+
+/*virtual*/ void LocalClientInterface::on_connect() {
+	// Only a connection coming back is a reappearance, the first one is set up by Reticulum
+	if (initiator() && _connects++ > 0) {
+		//p RNS.Transport.shared_connection_reappeared()
+		Transport::shared_connection_reappeared();
+	}
+}
+
+/*virtual*/ void LocalClientInterface::on_disconnect() {
+	if (initiator()) {
+		//p RNS.Transport.shared_connection_disappeared()
+		Transport::shared_connection_disappeared();
+	}
+}
+
+
+//p def __init__(self, owner, port=None, socket_path=None):
+LocalServerInterface::LocalServerInterface(const char* name /*= "Shared Instance"*/, const char* instance_name /*= "default"*/, int port /*= DEFAULT_LOCAL_INTERFACE_PORT*/) : TCPServerInterface(name, "127.0.0.1", port),
+	_instance_name(instance_name)
+{
+	_bitrate = BITRATE_GUESS;
+	_is_local_shared_instance = true;
+}
+
+std::string LocalServerInterface::address() const {
+#if RNS_LOCAL_INTERFACE_AF_UNIX
+	return "rns/" + _instance_name;
+#else
+	return bind_host() + ":" + std::to_string(port());
+#endif
+}
+
+/*virtual*/ bool LocalServerInterface::resolve(sockaddr_storage& address, socklen_t& address_size) {
+#if RNS_LOCAL_INTERFACE_AF_UNIX
+	return socket_address(_instance_name, address, address_size);
+#else
+	return TCPServerInterface::resolve(address, address_size);
+#endif
+}
+
+//p def incoming_connection(self, handler):
+/*virtual*/ TCPClientInterface* LocalServerInterface::spawn(int socket, const char* host, int port) {
+	// Peers on the Unix socket have no address, so spawned interfaces are told apart by connection
+	// number to keep their hashes unique
+	std::string name = "Client on " + _name;
+	return new LocalClientInterface(name.c_str(), socket, _instance_name.c_str(), this->port(), accepted());
+}
+
+#endif
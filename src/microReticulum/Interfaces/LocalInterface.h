@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "TCPInterface.h"
+
+#include <string>
+#include <stdint.h>
+
+#ifndef DEFAULT_LOCAL_INTERFACE_PORT
+#define DEFAULT_LOCAL_INTERFACE_PORT	37428
+#endif
+
+#if RNS_TCP_INTERFACE
+namespace RNS { namespace Interfaces {
+
+	//p class LocalClientInterface(Interface):
+	// Connection between programs sharing one Reticulum instance on the same host, framed like the
+	// reference. Connects to the abstract Unix socket "rns/<instance name>" where available (Linux),
+	// otherwise to 127.0.0.1 on the local interface port. An initiated client is the shared
+	// instance's end in a client program, spawned ones are the shared instance's end of each client.
+	class LocalClientInterface : public TCPClientInterface {
+
+	public:
+		static const uint32_t BITRATE_GUESS = 1000*1000*1000;
+		static const uint16_t RECONNECT_WAIT = 8;
+
+	public:
+		//p def __init__(self, owner, name, port=None, connected_socket=None, socket_path=None):
+		LocalClientInterface(const char* name = "Local shared instance", const char* instance_name = "default", int port = DEFAULT_LOCAL_INTERFACE_PORT);
+		// Takes ownership of a connected socket, as spawned by LocalServerInterface for its
+		// connection-th accepted connection
+		LocalClientInterface(const char* name, int socket, const char* instance_name, int port, size_t connection);
+
+		virtual inline std::string toString() const { return "LocalInterface[" + _name + "/" + address() + (initiator() ? "" : "#" + std::to_string(_connection)) + "]"; }
+
+		inline const std::string& instance_name() const { return _instance_name; }
+
+	protected:
+		virtual bool resolve(sockaddr_storage& address, socklen_t& address_size);
+		virtual void on_connect();
+		virtual void on_disconnect();
+
+	private:
+		std::string address() const;
+
+	private:
+		std::string _instance_name;
+		size_t _connection = 0;
+		size_t _connects = 0;
+
+	};
+
+	//p class LocalServerInterface(Interface):
+	// The shared instance's listening end, spawning a LocalClientInterface for every program that
+	// connects. Transport treats the spawned interfaces as local clients.
+	class LocalServerInterface : public TCPServerInterface {
+
+	public:
+		static const uint32_t BITRATE_GUESS = LocalClientInterface::BITRATE_GUESS;
+
+	public:
+		//p def __init__(self, owner, port=None, socket_path=None):
+		LocalServerInterface(const char* name = "Shared Instance", const char* instance_name = "default", int port = DEFAULT_LOCAL_INTERFACE_PORT);
+
+		virtual inline std::string toString() const { return "Shared Instance[" + _name + "/" + address() + "]"; }
+
+		inline const std::string& instance_name() const { return _instance_name; }
+
+	protected:
+		virtual bool resolve(sockaddr_storage& address, socklen_t& address_size);
+		virtual TCPClientInterface* spawn(int socket, const char* host, int port);
+
+	private:
+		std::string address() const;
+
+	private:
+		std::string _instance_name;
+
+	};
+
+} }
+#endif
@@ -0,0 +1,619 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "TCPInterface.h"
+
+#if RNS_TCP_INTERFACE
+
+#include "../Transport.h"
+#include "../Log.h"
+#include "../Utilities/OS.h"
+#include "../Utilities/EventLoop.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using namespace RNS;
+using namespace RNS::Interfaces;
+using namespace RNS::Utilities;
+
+static bool set_nonblocking(int socket) {
+	int flags = fcntl(socket, F_GETFL, 0);
+	if (flags == -1) {
+		return false;
+	}
+	if (fcntl(socket, F_SETFL, flags | O_NONBLOCK) == -1) {
+		return false;
+	}
+	fcntl(socket, F_SETFD, FD_CLOEXEC);
+	return true;
+}
+
+static void close_socket(int socket) {
+	// Dropped from the event loop first, a closed descriptor number is soon reused by another socket
+	EventLoop::unwatch(socket);
+	close(socket);
+}
+
+static std::string address_string(const sockaddr* address, int& port) {
+	char host[INET6_ADDRSTRLEN] = {0};
+	port = 0;
+	if (address->sa_family == AF_INET) {
+		const sockaddr_in* address4 = (const sockaddr_in*)address;
+		inet_ntop(AF_INET, &address4->sin_addr, host, sizeof(host));
+		port = ntohs(address4->sin_port);
+	}
+	else if (address->sa_family == AF_INET6) {
+		const sockaddr_in6* address6 = (const sockaddr_in6*)address;
+		inet_ntop(AF_INET6, &address6->sin6_addr, host, sizeof(host));
+		port = ntohs(address6->sin6_port);
+	}
+	return host;
+}
+
+static bool resolve_address(const char* host, int port, bool passive, sockaddr_storage& address, socklen_t& address_size) {
+	char service[8];
+	snprintf(service, sizeof(service), "%d", port);
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = passive ? AI_PASSIVE : 0;
+	addrinfo* addresses = nullptr;
+	if (getaddrinfo(host, service, &hints, &addresses) != 0 || addresses == nullptr) {
+		return false;
+	}
+	memcpy(&address, addresses->ai_addr, addresses->ai_addrlen);
+	address_size = addresses->ai_addrlen;
+	freeaddrinfo(addresses);
+	return true;
+}
+
+
+//p def __init__(self, owner, configuration, connected_socket=None):
+TCPClientInterface::TCPClientInterface(const char* name /*= "TCPClientInterface"*/, const char* target_host /*= "127.0.0.1"*/, int target_port /*= DEFAULT_TCP_PORT*/) : InterfaceImpl(name),
+	_target_host(target_host),
+	_target_port(target_port),
+	_deframer(HW_MTU)
+{
+	_IN = true;
+	_OUT = true;
+	_bitrate = BITRATE_GUESS;
+	// DIVERGENCE: The reference advertises its 262144 byte TCP HW_MTU for link MTU discovery, which
+	// doesn't fit _HW_MTU, so links over TCP keep the default MTU. Larger frames from peers are
+	// still accepted.
+	_HW_MTU = 1064;
+}
+
+TCPClientInterface::TCPClientInterface(const char* name, int socket, const char* target_host, int target_port) : InterfaceImpl(name),
+	_target_host(target_host),
+	_target_port(target_port),
+	_initiator(false),
+	_deframer(HW_MTU)
+{
+	_IN = true;
+	_OUT = true;
+	_bitrate = BITRATE_GUESS;
+	_HW_MTU = 1064;
+	if (!attach(socket)) {
+		close_socket(socket);
+	}
+}
+
+/*virtual*/ TCPClientInterface::~TCPClientInterface() {
+	stop();
+}
+
+/*virtual*/ bool TCPClientInterface::start() {
+	if (!_initiator) {
+		// Spawned interfaces come up connected and are done once their connection is gone
+		return _online;
+	}
+	_detached = false;
+	if (_socket >= 0) {
+		return true;
+	}
+	_reconnect_wait = _reconnect_wait_min;
+	// Failing the initial connection isn't fatal, the interface keeps trying in the background like
+	// the reference does
+	connect();
+	return true;
+}
+
+/*virtual*/ void TCPClientInterface::stop() {
+	if (_socket >= 0) {
+		write_pending();
+		close_socket(_socket);
+		_socket = -1;
+	}
+	_connecting = false;
+	_reconnect_at = 0;
+	_deframer.reset();
+	_tx_pending.resize(0);
+	_tx_pending_offset = 0;
+	_online = false;
+}
+
+//p def detach(self):
+/*virtual*/ void TCPClientInterface::detach() {
+	_detached = true;
+	stop();
+}
+
+/*virtual*/ int TCPClientInterface::poll_fd() const {
+	if (_socket < 0) {
+		// Nothing to read until the next reconnect attempt, which the job interval is fine for
+		return POLL_IDLE;
+	}
+	if (tx_pending() > 0) {
+		// Only readability is watched, so keep polling until the backlog is written
+		return -1;
+	}
+	// A connect in progress shows up as readable if it fails, success is picked up on the next loop()
+	return _socket;
+}
+
+/*virtual*/ void TCPClientInterface::loop() {
+	if (_socket < 0) {
+		if (_initiator && !_detached && _reconnect_at > 0 && OS::time() >= _reconnect_at) {
+			//p def reconnect(self):
+			++_reconnects;
+			connect();
+		}
+		return;
+	}
+	if (_connecting) {
+		connect_finished();
+		if (_connecting || _socket < 0) {
+			return;
+		}
+	}
+	write_pending();
+	read();
+}
+
+/*virtual*/ void TCPClientInterface::flush() {
+	write_pending();
+}
+
+/*virtual*/ bool TCPClientInterface::resolve(sockaddr_storage& address, socklen_t& address_size) {
+	return resolve_address(_target_host.c_str(), _target_port, false, address, address_size);
+}
+
+//p def connect(self, initial=False):
+bool TCPClientInterface::connect() {
+	_reconnect_at = 0;
+
+	sockaddr_storage address = {};
+	socklen_t address_size = 0;
+	if (!resolve(address, address_size)) {
+		disconnect("unable to resolve host");
+		return false;
+	}
+
+	int sock = socket(address.ss_family, SOCK_STREAM, 0);
+	if (sock < 0) {
+		ERRORF("%s: Unable to create socket with error %d", toString().c_str(), errno);
+		disconnect("unable to create socket");
+		return false;
+	}
+	set_nonblocking(sock);
+	DEBUGF("%s: Connecting", toString().c_str());
+	int result = ::connect(sock, (sockaddr*)&address, address_size);
+	if (result == 0) {
+		return attach(sock);
+	}
+	if (errno != EINPROGRESS) {
+		close(sock);
+		disconnect(strerror(errno));
+		return false;
+	}
+	_socket = sock;
+	_connecting = true;
+	_connect_started = OS::time();
+	return true;
+}
+
+void TCPClientInterface::connect_finished() {
+	pollfd pfd = {_socket, POLLOUT, 0};
+	int ready = poll(&pfd, 1, 0);
+	if (ready == 0) {
+		if (OS::time() > _connect_started + CONNECT_TIMEOUT) {
+			disconnect("connection timed out");
+		}
+		return;
+	}
+	int error = 0;
+	socklen_t error_size = sizeof(error);
+	if (ready < 0 || getsockopt(_socket, SOL_SOCKET, SO_ERROR, &error, &error_size) == -1 || error != 0) {
+		disconnect(strerror(error != 0 ? error : errno));
+		return;
+	}
+	int sock = _socket;
+	_socket = -1;
+	_connecting = false;
+	attach(sock);
+}
+
+//p def set_timeouts_linux(self):
+//p def set_timeouts_osx(self):
+bool TCPClientInterface::attach(int socket) {
+	if (!set_nonblocking(socket)) {
+		ERRORF("%s: Unable to configure socket with error %d", toString().c_str(), errno);
+		return false;
+	}
+	int enable = 1;
+	setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+	setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+#ifdef SO_NOSIGPIPE
+	setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+#ifdef TCP_USER_TIMEOUT
+	int user_timeout = TCP_USER_TIMEOUT_SECONDS * 1000;
+	setsockopt(socket, IPPROTO_TCP, TCP_USER_TIMEOUT, &user_timeout, sizeof(user_timeout));
+#endif
+	int probe_after = TCP_PROBE_AFTER;
+#ifdef TCP_KEEPIDLE
+	setsockopt(socket, IPPROTO_TCP, TCP_KEEPIDLE, &probe_after, sizeof(probe_after));
+#elif defined(TCP_KEEPALIVE)
+	setsockopt(socket, IPPROTO_TCP, TCP_KEEPALIVE, &probe_after, sizeof(probe_after));
+#endif
+#ifdef TCP_KEEPINTVL
+	int probe_interval = TCP_PROBE_INTERVAL;
+	setsockopt(socket, IPPROTO_TCP, TCP_KEEPINTVL, &probe_interval, sizeof(probe_interval));
+#endif
+#ifdef TCP_KEEPCNT
+	int probes = TCP_PROBES;
+	setsockopt(socket, IPPROTO_TCP, TCP_KEEPCNT, &probes, sizeof(probes));
+#endif
+
+	_socket = socket;
+	_connecting = false;
+	_deframer.reset();
+	_tx_pending.resize(0);
+	_tx_pending_offset = 0;
+	_reconnect_wait = _reconnect_wait_min;
+	_online = true;
+	if (_initiator) {
+		INFOF("%s: Connected", toString().c_str());
+	}
+	else {
+		DEBUGF("%s: Spawned for incoming connection", toString().c_str());
+	}
+	on_connect();
+	return true;
+}
+
+void TCPClientInterface::disconnect(const char* reason) {
+	if (_socket >= 0) {
+		close_socket(_socket);
+		_socket = -1;
+	}
+	bool was_online = _online;
+	_online = false;
+	_connecting = false;
+	_deframer.reset();
+	_tx_pending.resize(0);
+	_tx_pending_offset = 0;
+	if (was_online) {
+		on_disconnect();
+	}
+	if (!_initiator) {
+		// Spawned interfaces are torn down by their server
+		DEBUGF("%s: Client disconnected, %s", toString().c_str(), reason);
+		return;
+	}
+	if (_detached) {
+		return;
+	}
+	// DIVERGENCE: The reference retries every RECONNECT_WAIT seconds, retries here back off
+	// exponentially so unreachable peers cost less
+	_reconnect_at = OS::time() + _reconnect_wait;
+	if (was_online) {
+		WARNINGF("%s: Connection lost, %s, reconnecting in %.1f seconds", toString().c_str(), reason, _reconnect_wait);
+	}
+	else {
+		DEBUGF("%s: Connection attempt failed, %s, retrying in %.1f seconds", toString().c_str(), reason, _reconnect_wait);
+	}
+	_reconnect_wait *= 2;
+	if (_reconnect_wait > _reconnect_wait_max) {
+		_reconnect_wait = _reconnect_wait_max;
+	}
+}
+
+//p def read_loop(self):
+void TCPClientInterface::read() {
+	while (_socket >= 0) {
+		ssize_t received = recv(_socket, _read_buffer, sizeof(_read_buffer), MSG_DONTWAIT);
+		if (received > 0) {
+			// Frames are unescaped straight into the buffer handed to transport
+			_deframer.feed(_read_buffer, (size_t)received, [this](const Bytes& frame) {
+				handle_incoming(frame);
+			});
+			if ((size_t)received < sizeof(_read_buffer)) {
+				// socket is drained
+				break;
+			}
+			continue;
+		}
+		if (received == 0) {
+			disconnect("closed by peer");
+			break;
+		}
+		if (errno == EINTR) {
+			continue;
+		}
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			disconnect(strerror(errno));
+		}
+		break;
+	}
+}
+
+// Returns true once nothing is left pending
+bool TCPClientInterface::write_pending() {
+	if (_tx_pending_offset >= _tx_pending.size()) {
+		return true;
+	}
+	if (_socket < 0 || _connecting) {
+		return false;
+	}
+	while (_tx_pending_offset < _tx_pending.size()) {
+		ssize_t sent = send(_socket, _tx_pending.data() + _tx_pending_offset, _tx_pending.size() - _tx_pending_offset, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (sent > 0) {
+			_tx_pending_offset += sent;
+			continue;
+		}
+		if (sent < 0 && errno == EINTR) {
+			continue;
+		}
+		if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+			disconnect(strerror(errno));
+		}
+		return false;
+	}
+	// Emptied without releasing the buffer so it is reused
+	_tx_pending.resize(0);
+	_tx_pending_offset = 0;
+	return true;
+}
+
+//p def process_outgoing(self, data):
+/*virtual*/ bool TCPClientInterface::send_outgoing(const Bytes& data) {
+	if (!_online || _socket < 0 || _connecting) {
+		return false;
+	}
+	HDLC::frame(data, _tx_frame);
+	const uint8_t* frame = _tx_frame.data();
+	size_t size = _tx_frame.size();
+
+	// Written directly unless earlier frames are still waiting, which would be overtaken
+	if (write_pending()) {
+		while (size > 0) {
+			ssize_t sent = send(_socket, frame, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+			if (sent > 0) {
+				frame += sent;
+				size -= sent;
+				continue;
+			}
+			if (sent < 0 && errno == EINTR) {
+				continue;
+			}
+			if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+				ERRORF("Could not transmit on %s, %s", toString().c_str(), strerror(errno));
+				disconnect(strerror(errno));
+				return false;
+			}
+			break;
+		}
+	}
+	else if (_socket < 0) {
+		return false;
+	}
+
+	if (size > 0) {
+		if (tx_pending() + size > TX_BUFFER_MAX) {
+			WARNINGF("%s: Transmit buffer full, dropping %zu byte packet", toString().c_str(), data.size());
+			return false;
+		}
+		// Compact before appending so the backlog doesn't creep through the buffer
+		if (_tx_pending_offset > 0) {
+			size_t pending = tx_pending();
+			uint8_t* buffer = _tx_pending.writable(0);
+			memmove(buffer, buffer + _tx_pending_offset, pending);
+			_tx_pending.resize(pending);
+			_tx_pending_offset = 0;
+		}
+		_tx_pending.append(frame, size);
+	}
+
+	// Perform post-send housekeeping
+	InterfaceImpl::handle_outgoing(data);
+	return true;
+}
+
+
+//p def __init__(self, owner, configuration):
+TCPServerInterface::TCPServerInterface(const char* name /*= "TCPServerInterface"*/, const char* bind_host /*= "0.0.0.0"*/, int bind_port /*= DEFAULT_TCP_PORT*/) : InterfaceImpl(name),
+	_bind_host(bind_host),
+	_bind_port(bind_port)
+{
+	_IN = true;
+	_OUT = false;
+	_bitrate = BITRATE_GUESS;
+	_HW_MTU = 1064;
+}
+
+/*virtual*/ TCPServerInterface::~TCPServerInterface() {
+	stop();
+}
+
+/*virtual*/ bool TCPServerInterface::start() {
+	if (_socket >= 0) {
+		return true;
+	}
+	_online = false;
+
+	sockaddr_storage address = {};
+	socklen_t address_size = 0;
+	if (!resolve(address, address_size)) {
+		ERRORF("%s: Unable to resolve bind address", toString().c_str());
+		return false;
+	}
+
+	_socket = socket(address.ss_family, SOCK_STREAM, 0);
+	if (_socket < 0) {
+		ERRORF("%s: Unable to create socket with error %d", toString().c_str(), errno);
+		return false;
+	}
+	if (address.ss_family == AF_INET || address.ss_family == AF_INET6) {
+		int reuse = 1;
+		setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	}
+	set_nonblocking(_socket);
+
+	INFOF("Binding socket %d for %s", _socket, toString().c_str());
+	if (bind(_socket, (sockaddr*)&address, address_size) == -1 || listen(_socket, LISTEN_BACKLOG) == -1) {
+		ERRORF("%s: Unable to listen with error %d", toString().c_str(), errno);
+		close(_socket);
+		_socket = -1;
+		return false;
+	}
+
+	// Report the port actually bound when an ephemeral one was asked for
+	if (_bind_port == 0 && (address.ss_family == AF_INET || address.ss_family == AF_INET6)) {
+		address_size = sizeof(address);
+		if (getsockname(_socket, (sockaddr*)&address, &address_size) == 0) {
+			address_string((sockaddr*)&address, _bind_port);
+		}
+	}
+
+	_online = true;
+	return true;
+}
+
+/*virtual*/ bool TCPServerInterface::resolve(sockaddr_storage& address, socklen_t& address_size) {
+	return resolve_address(_bind_host.c_str(), _bind_port, true, address, address_size);
+}
+
+/*virtual*/ void TCPServerInterface::stop() {
+	if (_socket >= 0) {
+		close_socket(_socket);
+		_socket = -1;
+	}
+	for (auto& spawned_interface : _spawned_interfaces) {
+		spawned_interface.stop();
+		Transport::deregister_interface(spawned_interface);
+	}
+	// Also releases the spawned interfaces' references back to us
+	_spawned_interfaces.clear();
+	_online = false;
+}
+
+/*virtual*/ void TCPServerInterface::detach() {
+	stop();
+}
+
+/*virtual*/ int TCPServerInterface::poll_fd() const {
+	return (_socket >= 0) ? _socket : POLL_IDLE;
+}
+
+/*virtual*/ void TCPServerInterface::loop() {
+	if (_socket < 0) {
+		return;
+	}
+	accept_connections();
+	remove_disconnected();
+}
+
+//p def incoming_connection(self, handler):
+void TCPServerInterface::accept_connections() {
+	while (true) {
+		sockaddr_storage address = {};
+		socklen_t address_size = sizeof(address);
+		int sock = accept(_socket, (sockaddr*)&address, &address_size);
+		if (sock < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				WARNINGF("%s: Failed accepting connection with error %d", toString().c_str(), errno);
+			}
+			return;
+		}
+
+		++_accepted;
+		int port = 0;
+		std::string host = address_string((sockaddr*)&address, port);
+		TCPClientInterface* spawned_impl = spawn(sock, host.c_str(), port);
+		if (spawned_impl == nullptr) {
+			close(sock);
+			continue;
+		}
+		Interface spawned_interface(spawned_impl);
+		if (!spawned_interface.online()) {
+			continue;
+		}
+		spawned_impl->_IN = _IN;
+		spawned_impl->_OUT = true;
+		spawned_impl->_mode = _mode;
+		spawned_impl->_bitrate = _bitrate;
+		spawned_impl->_HW_MTU = _HW_MTU;
+		spawned_impl->_announce_cap = _announce_cap;
+		spawned_impl->_announce_rate_target = _announce_rate_target;
+		spawned_impl->_announce_rate_grace = _announce_rate_grace;
+		spawned_impl->_announce_rate_penalty = _announce_rate_penalty;
+		spawned_impl->_ifac_identity = _ifac_identity;
+		spawned_impl->_ifac_size = _ifac_size;
+		spawned_impl->_ifac_key = _ifac_key;
+		spawned_impl->_ifac_signature = _ifac_signature;
+		spawned_impl->_ifac_hkdf = _ifac_hkdf;
+		std::shared_ptr<InterfaceImpl> self = shared_from_this();
+		spawned_impl->_parent_interface = HInterface(new Interface(self));
+
+		VERBOSEF("%s: Accepted connection %s", toString().c_str(), spawned_interface.toString().c_str());
+		_spawned_interfaces.push_back(spawned_interface);
+		Transport::register_interface(spawned_interface);
+	}
+}
+
+/*virtual*/ TCPClientInterface* TCPServerInterface::spawn(int socket, const char* host, int port) {
+	std::string name = "Client on " + _name;
+	return new TCPClientInterface(name.c_str(), socket, host, port);
+}
+
+//p def teardown(self):
+void TCPServerInterface::remove_disconnected() {
+	for (auto iter = _spawned_interfaces.begin(); iter != _spawned_interfaces.end(); ) {
+		if (iter->online()) {
+			++iter;
+			continue;
+		}
+		Transport::deregister_interface(*iter);
+		iter = _spawned_interfaces.erase(iter);
+	}
+}
+
+#endif
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "HDLC.h"
+#include "../Interface.h"
+#include "../Bytes.h"
+#include "../Type.h"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// TCP interfaces need POSIX sockets, so are only built for native targets by default
+#ifndef RNS_TCP_INTERFACE
+	#if defined(ARDUINO)
+		#define RNS_TCP_INTERFACE 0
+	#else
+		#define RNS_TCP_INTERFACE 1
+	#endif
+#endif
+
+#ifndef DEFAULT_TCP_PORT
+#define DEFAULT_TCP_PORT	4242
+#endif
+
+#if RNS_TCP_INTERFACE
+#include <sys/socket.h>
+
+namespace RNS { namespace Interfaces {
+
+	class TCPServerInterface;
+
+	//p class TCPClientInterface(Interface):
+	// Stream connection to a peer speaking the reference HDLC framing, either initiated to a target
+	// host (reconnecting with backoff whenever the connection is lost) or spawned by a
+	// TCPServerInterface for an accepted connection.
+	class TCPClientInterface : public InterfaceImpl {
+
+	public:
+		static const uint32_t BITRATE_GUESS = 10*1000*1000;
+		// Largest frame accepted from a peer, the reference's TCP HW_MTU
+		static const uint32_t HW_MTU = 262144;
+		// Seconds before the first reconnect attempt, doubled after every failed attempt up to the max
+		static const uint16_t RECONNECT_WAIT = 5;
+		static const uint16_t RECONNECT_MAX_WAIT = 60;
+		static const uint16_t CONNECT_TIMEOUT = 5;
+
+		static const uint8_t TCP_USER_TIMEOUT_SECONDS = 24;
+		static const uint8_t TCP_PROBE_AFTER = 5;
+		static const uint8_t TCP_PROBE_INTERVAL = 2;
+		static const uint8_t TCP_PROBES = 12;
+
+		// Bytes read from the socket per recv()
+		static const size_t READ_BUFFER_SIZE = 16384;
+		// Outgoing bytes held while the socket is backed up, frames beyond this are dropped
+		static const size_t TX_BUFFER_MAX = HW_MTU;
+
+	public:
+		//p def __init__(self, owner, configuration, connected_socket=None):
+		TCPClientInterface(const char* name = "TCPClientInterface", const char* target_host = "127.0.0.1", int target_port = DEFAULT_TCP_PORT);
+		// Takes ownership of an already connected socket, as spawned by TCPServerInterface
+		TCPClientInterface(const char* name, int socket, const char* target_host, int target_port);
+		virtual ~TCPClientInterface();
+
+		virtual bool start();
+		virtual void stop();
+		virtual void loop();
+		virtual void flush();
+		virtual void detach();
+		virtual int poll_fd() const;
+
+		virtual inline std::string toString() const { return "TCPInterface[" + _name + "/" + _target_host + ":" + std::to_string(_target_port) + "]"; }
+
+		// Must be set before start()
+		inline void target_host(const char* target_host) { _target_host = target_host; }
+		inline void target_port(int target_port) { _target_port = target_port; }
+		inline void reconnect_wait(double reconnect_wait, double reconnect_max_wait) { _reconnect_wait_min = _reconnect_wait = reconnect_wait; _reconnect_wait_max = reconnect_max_wait; }
+
+		inline const std::string& target_host() const { return _target_host; }
+		inline int target_port() const { return _target_port; }
+		inline bool initiator() const { return _initiator; }
+		inline bool connected() const { return _socket >= 0 && !_connecting; }
+		inline bool connecting() const { return _connecting; }
+		// Seconds the next reconnect attempt will wait after a failure
+		inline double reconnect_wait() const { return _reconnect_wait; }
+		inline size_t reconnects() const { return _reconnects; }
+		inline size_t tx_pending() const { return _tx_pending.size() - _tx_pending_offset; }
+		inline const HDLC::Deframer& deframer() const { return _deframer; }
+
+	protected:
+		virtual bool send_outgoing(const Bytes& data);
+		// Address to connect to, target_host:target_port by default
+		virtual bool resolve(sockaddr_storage& address, socklen_t& address_size);
+		// Called when a connection is established and when an established connection is lost
+		virtual void on_connect() {}
+		virtual void on_disconnect() {}
+
+	private:
+		bool connect();
+		void connect_finished();
+		bool attach(int socket);
+		void disconnect(const char* reason);
+		void read();
+		bool write_pending();
+
+	private:
+		std::string _target_host;
+		int _target_port = DEFAULT_TCP_PORT;
+		bool _initiator = true;
+		bool _detached = false;
+
+		int _socket = -1;
+		bool _connecting = false;
+		double _connect_started = 0;
+		double _reconnect_at = 0;
+		double _reconnect_wait = RECONNECT_WAIT;
+		double _reconnect_wait_min = RECONNECT_WAIT;
+		double _reconnect_wait_max = RECONNECT_MAX_WAIT;
+		size_t _reconnects = 0;
+
+		HDLC::Deframer _deframer;
+		// Framing buffer reused for every outgoing packet
+		Bytes _tx_frame;
+		// Framed data the socket didn't take yet, sent from _tx_pending_offset on
+		Bytes _tx_pending;
+		size_t _tx_pending_offset = 0;
+		uint8_t _read_buffer[READ_BUFFER_SIZE];
+
+	friend class TCPServerInterface;
+	};
+
+	//p class TCPServerInterface(Interface):
+	// Listens for peers and spawns a TCPClientInterface for every accepted connection. Spawned
+	// interfaces are registered with Transport as children of the server, and deregistered again
+	// once their connection is gone.
+	class TCPServerInterface : public InterfaceImpl {
+
+	public:
+		static const uint32_t BITRATE_GUESS = TCPClientInterface::BITRATE_GUESS;
+		static const int LISTEN_BACKLOG = 16;
+
+	public:
+		//p def __init__(self, owner, configuration):
+		TCPServerInterface(const char* name = "TCPServerInterface", const char* bind_host = "0.0.0.0", int bind_port = DEFAULT_TCP_PORT);
+		virtual ~TCPServerInterface();
+
+		virtual bool start();
+		virtual void stop();
+		virtual void loop();
+		virtual void detach();
+		virtual int poll_fd() const;
+
+		virtual inline std::string toString() const { return "TCPServerInterface[" + _name + "/" + _bind_host + ":" + std::to_string(_bind_port) + "]"; }
+
+		// Must be set before start(), port 0 binds an ephemeral port that port() reports once started
+		inline void bind_host(const char* bind_host) { _bind_host = bind_host; }
+		inline void bind_port(int bind_port) { _bind_port = bind_port; }
+
+		inline const std::string& bind_host() const { return _bind_host; }
+		inline int port() const { return _bind_port; }
+		inline const std::vector<Interface>& spawned_interfaces() const { return _spawned_interfaces; }
+
+	protected:
+		// Outgoing traffic goes through the spawned interfaces
+		virtual bool send_outgoing(const Bytes& data) { return false; }
+		// Address to listen on, bind_host:bind_port by default
+		virtual bool resolve(sockaddr_storage& address, socklen_t& address_size);
+		// CBA Virtual override method to create the interface for an accepted connection, host and port
+		// are the peer's address (empty and 0 for peers without one, e.g. on Unix sockets)
+		virtual TCPClientInterface* spawn(int socket, const char* host, int port);
+		// Connections accepted so far, tells apart peers without an address
+		inline size_t accepted() const { return _accepted; }
+
+	private:
+		void accept_connections();
+		void remove_disconnected();
+
+	private:
+		std::string _bind_host;
+		int _bind_port = DEFAULT_TCP_PORT;
+		int _socket = -1;
+		size_t _accepted = 0;
+		std::vector<Interface> _spawned_interfaces;
+
+	};
+
+} }
+#endif
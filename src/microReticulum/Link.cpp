@@ -626,7 +626,7 @@ void Link::rtt_packet(const Packet& packet) {
 	assert(_object);
 	try {
 		double measured_rtt = OS::time() - _object->_request_time;
-		const Bytes plaintext(decrypt(packet.data()));
+		const Bytes plaintext(decrypt(packet.data_view()));
 		if (plaintext) {
 			//p rtt = umsgpack.unpackb(plaintext)
 			MsgPack::Unpacker unpacker;
@@ -805,7 +805,7 @@ void Link::teardown() {
 void Link::teardown_packet(const Packet& packet) {
 	assert(_object);
 	try {
-		Bytes plaintext = decrypt(packet.data());
+		Bytes plaintext = decrypt(packet.data_view());
 		if (plaintext == _object->_link_id) {
 			_object->_status = Type::Link::CLOSED;
 			if (_object->_initiator) {
@@ -1177,7 +1177,7 @@ void Link::receive(const Packet& packet) {
 				case Type::Packet::CONTEXT_NONE:
 				{
 					TRACEF("Link %s received DATA packet with context CONTEXT_NONE", hash().toHex().c_str());
-					const Bytes plaintext = decrypt(packet.data());
+					const Bytes plaintext = decrypt(packet.data_view());
 					if (plaintext) {
 						if (_object->_callbacks._packet) {
 							//z thread = threading.Thread(target=_object->_callbacks.packet, args=(plaintext, packet))
@@ -1214,7 +1214,7 @@ void Link::receive(const Packet& packet) {
 				case Type::Packet::LINKIDENTIFY:
 				{
 					TRACEF("Link %s received DATA packet with context LINKIDENTIFY", hash().toHex().c_str());
-					const Bytes plaintext = decrypt(packet.data());
+					const Bytes plaintext = decrypt(packet.data_view());
 					if (plaintext) {
 						if (!(_object->_initiator) && plaintext.size() == Type::Identity::KEYSIZE/8 + Type::Identity::SIGLENGTH/8) {
 							const Bytes public_key   = plaintext.left(Type::Identity::KEYSIZE/8);
@@ -1243,7 +1243,7 @@ void Link::receive(const Packet& packet) {
 					TRACEF("Link %s received DATA packet with context REQUEST", hash().toHex().c_str());
 					try {
 						const Bytes request_id = packet.getTruncatedHash();
-						const Bytes packed_request = decrypt(packet.data());
+						const Bytes packed_request = decrypt(packet.data_view());
 						if (packed_request) {
 							ResourceRequest resource_request;
 							if (!unpack_request_envelope(packed_request, resource_request)) {
@@ -1262,7 +1262,7 @@ void Link::receive(const Packet& packet) {
 				{
 					TRACEF("Link %s received DATA packet with context RESPONSE", hash().toHex().c_str());
 					try {
-						const Bytes packed_response = decrypt(packet.data());
+						const Bytes packed_response = decrypt(packet.data_view());
 						if (packed_response) {
 							//p unpacked_response = umsgpack.unpackb(packed_response)
 							//p request_id = unpacked_response[0]
@@ -1301,7 +1301,7 @@ void Link::receive(const Packet& packet) {
 				case Type::Packet::RESOURCE_ADV:
 				{
 					TRACEF("Link %s received DATA packet with context RESOURCE_ADV", hash().toHex().c_str());
-					const Bytes plaintext = decrypt(packet.data());
+					const Bytes plaintext = decrypt(packet.data_view());
 					if (plaintext) {
 						const_cast<Packet&>(packet).plaintext(plaintext);
 						if (ResourceAdvertisement::is_request(packet)) {
@@ -1355,7 +1355,7 @@ void Link::receive(const Packet& packet) {
 				case Type::Packet::RESOURCE_REQ:
 				{
 					TRACEF("Link %s received DATA packet with context RESOURCE_REQ", hash().toHex().c_str());
-					const Bytes plaintext = decrypt(packet.data());
+					const Bytes plaintext = decrypt(packet.data_view());
 					if (plaintext) {
 						// Layout: [hmu_flag (1 byte) || maybe last_map_hash (4 bytes)
 						//         || resource_hash (HASHLENGTH/8 bytes) || requested_hashes...]
@@ -1399,7 +1399,7 @@ void Link::receive(const Packet& packet) {
 				case Type::Packet::RESOURCE_HMU:
 				{
 					TRACEF("Link %s received DATA packet with context RESOURCE_HMU", hash().toHex().c_str());
-					const Bytes plaintext = decrypt(packet.data());
+					const Bytes plaintext = decrypt(packet.data_view());
 					if (plaintext) {
 						const size_t hash_bytes = Type::Identity::HASHLENGTH / 8;
 						if (plaintext.size() >= hash_bytes) {
@@ -1425,7 +1425,7 @@ void Link::receive(const Packet& packet) {
 				case Type::Packet::RESOURCE_ICL:
 				{
 					TRACEF("Link %s received DATA packet with context RESOURCE_ICL", hash().toHex().c_str());
-					const Bytes plaintext = decrypt(packet.data());
+					const Bytes plaintext = decrypt(packet.data_view());
 					if (plaintext) {
 						const size_t hash_bytes = Type::Identity::HASHLENGTH / 8;
 						if (plaintext.size() >= hash_bytes) {
@@ -1538,6 +1538,27 @@ void Link::receive(const Packet& packet) {
 }
 
 const Bytes Link::encrypt(const Bytes& plaintext) {
+	Bytes ciphertext;
+	encrypt(ciphertext.writable(encrypted_size(plaintext.size())), plaintext.data(), plaintext.size());
+	return ciphertext;
+}
+
+const Bytes Link::decrypt(const BytesView& ciphertext) {
+	if (ciphertext.size() < Type::Cryptography::Token::TOKEN_OVERHEAD) {
+		ERRORF("Decryption failed on link %s. Token of only %lu bytes", toString().c_str(), ciphertext.size());
+		return {Bytes::NONE};
+	}
+	Bytes plaintext;
+	size_t size = decrypt(plaintext.writable(ciphertext.size() - Type::Cryptography::Token::TOKEN_OVERHEAD), ciphertext.data(), ciphertext.size());
+	plaintext.resize(size);
+	return plaintext;
+}
+
+/*static*/ size_t Link::encrypted_size(size_t size) {
+	return Token::token_size(size);
+}
+
+size_t Link::encrypt(uint8_t* output, const uint8_t* plaintext, size_t size) {
 	assert(_object);
 	TRACE("Link::encrypt: encrypting data...");
 	try {
@@ -1550,7 +1571,7 @@ const Bytes Link::encrypt(const Bytes& plaintext) {
 				throw e;
 			}
 		}
-		return _object->_token->encrypt(plaintext);
+		return _object->_token->encrypt(output, plaintext, size);
 	}
 	catch (const std::exception& e) {
 		ERRORF("Encryption on link %s failed. The contained exception was: %s", toString().c_str(), e.what());
@@ -1558,18 +1579,19 @@ const Bytes Link::encrypt(const Bytes& plaintext) {
 	}
 }
 
-const Bytes Link::decrypt(const Bytes& ciphertext) {
+// Returns 0 if decryption fails
+size_t Link::decrypt(uint8_t* output, const uint8_t* ciphertext, size_t size) {
 	assert(_object);
 	TRACE("Link::decrypt: decrypting data...");
 	try {
 		if (!_object->_token) {
 			_object->_token.reset(new Token(_object->_derived_key));
 		}
-		return _object->_token->decrypt(ciphertext);
+		return _object->_token->decrypt(output, ciphertext, size);
 	}
 	catch (const std::exception& e) {
 		ERRORF("Decryption failed on link %s. The contained exception was: %s", toString().c_str(), e.what());
-		return {Bytes::NONE};
+		return 0;
 	}
 }
 
@@ -156,6 +156,9 @@ namespace RNS {
 		Link(const Link& link) : _object(link._object) {
 			MEM("Link object copy created");
 		}
+		Link(Link&& link) noexcept : _object(std::move(link._object)) {
+			MEM("Link object move created");
+		}
 		Link(const Destination& destination = {Type::NONE}, Callbacks::established established_callback = nullptr, Callbacks::closed closed_callback = nullptr, const Destination& owner = {Type::NONE}, const Bytes& peer_pub_bytes = {Bytes::NONE}, const Bytes& peer_sig_pub_bytes = {Bytes::NONE}, RNS::Type::Link::link_mode mode = MODE_DEFAULT);
 		//Link(const Destination& destination = {Type::NONE}, Callbacks::established established_callback = nullptr, Callbacks::closed closed_callback = nullptr, const Destination& owner = {Type::NONE}, const Bytes& peer_pub_bytes = {Bytes::NONE}, const Bytes& peer_sig_pub_bytes = {Bytes::NONE}, RNS::Type::Link::link_mode mode = MODE_DEFAULT);
 		virtual ~Link(){
@@ -166,6 +169,10 @@ namespace RNS {
 			_object = link._object;
 			return *this;
 		}
+		Link& operator = (Link&& link) noexcept {
+			_object = std::move(link._object);
+			return *this;
+		}
 		operator bool() const {
 			return _object.get() != nullptr;
 		}
@@ -227,7 +234,12 @@ namespace RNS {
 		//z const Channel& get_channel();
 		void receive(const Packet& packet);
 		const Bytes encrypt(const Bytes& plaintext);
-		const Bytes decrypt(const Bytes& ciphertext);
+		inline const Bytes decrypt(const Bytes& ciphertext) { return decrypt(ciphertext.view()); }
+		const Bytes decrypt(const BytesView& ciphertext);
+		// Buffer variants for encrypting straight into a packet, see Token
+		static size_t encrypted_size(size_t size);
+		size_t encrypt(uint8_t* output, const uint8_t* plaintext, size_t size);
+		size_t decrypt(uint8_t* output, const uint8_t* ciphertext, size_t size);
 		const Bytes sign(const Bytes& message);
 		bool validate(const Bytes& signature, const Bytes& message);
 		void set_link_established_callback(Callbacks::established callback);
@@ -28,6 +28,11 @@ using namespace RNS::Type::PacketReceipt;
 using namespace RNS::Type::Packet;
 using namespace RNS::Utilities;
 
+#ifdef RNS_DEBUG_METRICS
+/*static*/ std::atomic<uint32_t> Packet::_handle_copies{0};
+/*static*/ std::atomic<uint32_t> Packet::_handle_moves{0};
+#endif
+
 ProofDestination::ProofDestination(const Packet& packet) : Destination({Type::NONE}, Type::Destination::OUT, Type::Destination::SINGLE, packet.get_hash().left(Type::Reticulum::TRUNCATED_HASHLENGTH/8))
 {
 }
@@ -316,6 +321,7 @@ void Packet::pack() {
 	if (!_object->_destination) {
 		throw std::logic_error("Packet destination is required");
 	}
+	_object->unpack_data();
 	_object->_destination_hash = _object->_destination.hash();
 
 	_object->_header.clear();
@@ -371,15 +377,8 @@ void Packet::pack() {
 			else {
 				// In all other cases, we encrypt the packet
 				// with the destination's encryption method
-				// CBA LINK
-				if (_object->_destination_link) {
-					_object->_ciphertext = _object->_destination_link.encrypt(_object->_data);
-TRACEF("***** Link data: %s", _object->_ciphertext.toHex().c_str());
-				}
-				else {
-					_object->_ciphertext = _object->_destination.encrypt(_object->_data);
-TRACEF("***** Destination Data: %s", _object->_ciphertext.toHex().c_str());
-				}
+				// CBA Encrypted below once the header is complete, straight into raw
+				_object->_ciphertext.clear();
 				// CBA RATCHET
 				/*p TODO
 				if hasattr(self.destination, "latest_ratchet_id"):
@@ -408,7 +407,29 @@ TRACEF("***** Destination Data: %s", _object->_ciphertext.toHex().c_str());
 	}
 
 	_object->_header << (uint8_t)_object->_context;
-	_object->_raw = _object->_header + _object->_ciphertext;
+	if (_object->_encrypted) {
+		// Encrypt behind the header in raw, so packing takes one allocation (none when raw is reused)
+		const Bytes& data = _object->_data;
+		const size_t header_size = _object->_header.size();
+		// CBA LINK
+		if (_object->_destination_link) {
+			uint8_t* raw = _object->_raw.writable(header_size + Link::encrypted_size(data.size()));
+			memcpy(raw, _object->_header.data(), header_size);
+			_object->_destination_link.encrypt(raw + header_size, data.data(), data.size());
+		}
+		else if (_object->_destination.type() == Type::Destination::SINGLE && _object->_destination.identity()) {
+			uint8_t* raw = _object->_raw.writable(header_size + Identity::encrypted_size(data.size()));
+			memcpy(raw, _object->_header.data(), header_size);
+			_object->_destination.identity().encrypt(raw + header_size, data.data(), data.size());
+		}
+		else {
+			_object->_raw = _object->_header + _object->_destination.encrypt(data);
+		}
+		TRACEF("Packet::pack: encrypted data: %s", _object->_raw.mid(header_size).toHex().c_str());
+	}
+	else {
+		_object->_raw = _object->_header + _object->_ciphertext;
+	}
 
 	if (_object->_raw.size() > _object->_MTU) {
 		throw std::length_error("Packet size of " + std::to_string(_object->_raw.size()) + " exceeds MTU of " + std::to_string(_object->_MTU) +" bytes");
@@ -448,7 +469,9 @@ bool Packet::unpack() {
 			_object->_transport_id.assign(raw+2, Type::Reticulum::DESTINATION_LENGTH);
 			_object->_destination_hash.assign(raw+Type::Reticulum::DESTINATION_LENGTH+2, Type::Reticulum::DESTINATION_LENGTH);
 			_object->_context = static_cast<context_types>(raw[2*Type::Reticulum::DESTINATION_LENGTH+2]);
-			_object->_data.assign(raw+2*Type::Reticulum::DESTINATION_LENGTH+3, _object->_raw.size()-(2*Type::Reticulum::DESTINATION_LENGTH+3));
+			// data is left in raw and only copied out on first access to data()
+			_object->_data.clear();
+			_object->_data_offset = 2*Type::Reticulum::DESTINATION_LENGTH+3;
 			// uknown at this point whether data is encrypted or not
 			_object->_encrypted = false;
 		}
@@ -456,7 +479,9 @@ bool Packet::unpack() {
 			_object->_transport_id.clear();
 			_object->_destination_hash.assign(raw+2, Type::Reticulum::DESTINATION_LENGTH);
 			_object->_context = static_cast<context_types>(raw[Type::Reticulum::DESTINATION_LENGTH+2]);
-			_object->_data.assign(raw+Type::Reticulum::DESTINATION_LENGTH+3, _object->_raw.size()-(Type::Reticulum::DESTINATION_LENGTH+3));
+			// data is left in raw and only copied out on first access to data()
+			_object->_data.clear();
+			_object->_data_offset = Type::Reticulum::DESTINATION_LENGTH+3;
 			// uknown at this point whether data is encrypted or not
 			_object->_encrypted = false;
 		}
@@ -497,7 +522,7 @@ PacketReceipt Packet::receipt_send() {
 		else {
 			_object->_destination_link.last_outbound(OS::time());
 			_object->_destination_link.increment_tx();
-			_object->_destination_link.increment_txbytes(_object->_data.size());
+			_object->_destination_link.increment_txbytes(data().size());
 		}
 	}
 
@@ -598,30 +623,36 @@ void Packet::update_hash() {
 
 const Bytes Packet::get_hash() const {
 	assert(_object);
-	Bytes hashable_part = get_hashable_part();
+	// Hash the hashable part in place (masked flags byte followed by a view of raw)
+	// rather than assembling a copy of it with get_hashable_part()
+	Bytes hashable_flags;
+	hashable_flags << (uint8_t)(_object->_raw.data()[0] & 0b00001111);
 	// CBA MCU SHORTER HASH
-	return Identity::full_hash(hashable_part);
+	return Identity::full_hash(hashable_flags, _object->_raw.view(hashable_offset()));
 	//return Identity::truncated_hash(hashable_part);
 }
 
 const Bytes Packet::getTruncatedHash() const {
 	assert(_object);
-	Bytes hashable_part = get_hashable_part();
-	return Identity::truncated_hash(hashable_part);
+	//p return Identity.full_hash(self.get_hashable_part())[:(Identity.TRUNCATED_HASHLENGTH//8)]
+	return get_hash().left(Type::Identity::TRUNCATED_HASHLENGTH/8);
+}
+
+size_t Packet::hashable_offset() const {
+	assert(_object);
+	if (_object->_header_type == HEADER_2) {
+		//p self.raw[(RNS.Identity.TRUNCATED_HASHLENGTH//8)+2:]
+		return (Type::Identity::TRUNCATED_HASHLENGTH/8)+2;
+	}
+	//p self.raw[2:]
+	return 2;
 }
 
 const Bytes Packet::get_hashable_part() const {
 	assert(_object);
 	Bytes hashable_part;
 	hashable_part << (uint8_t)(_object->_raw.data()[0] & 0b00001111);
-	if (_object->_header_type == HEADER_2) {
-		//p hashable_part += self.raw[(RNS.Identity.TRUNCATED_HASHLENGTH//8)+2:]
-		hashable_part << _object->_raw.mid((Type::Identity::TRUNCATED_HASHLENGTH/8)+2);
-	}
-	else {
-		//p hashable_part += self.raw[2:];
-		hashable_part << _object->_raw.mid(2);
-	}
+	hashable_part << _object->_raw.view(hashable_offset());
 	return hashable_part;
 }
 
@@ -828,9 +859,9 @@ std::string Packet::dumpString() const {
 	}
 	dump += "raw:          " + _object->_raw.toHex() + "\n";
 	dump += "  length:           " + std::to_string(_object->_raw.size()) + "\n";
-	dump += "data:         " + _object->_data.toHex() + "\n";
+	dump += "data:         " + data().toHex() + "\n";
 	//dump += "text:         " + _object->_data.toString() + "\n";
-	dump += "  length:           " + std::to_string(_object->_data.size()) + "\n";
+	dump += "  length:           " + std::to_string(data().size()) + "\n";
 	//if ((encrypted || _object->_encrypted) && _object->_raw.size() > 0) {
 	if (false) {
 		size_t header_len = Type::Reticulum::HEADER_MINSIZE;
@@ -1056,6 +1087,16 @@ bool PacketReceipt::validate_proof(const Bytes& proof, const Packet& proof_packe
 	return false;
 }
 
+void PacketReceipt::set_timeout(int16_t timeout) {
+	assert(_object);
+	bool earlier = (timeout < _object->_timeout);
+	_object->_timeout = timeout;
+	// Transport expires receipts by deadline, a later one is picked up when the earlier comes due
+	if (earlier) {
+		Transport::receipt_timeout_changed(*this);
+	}
+}
+
 void PacketReceipt::check_timeout() {
 	assert(_object);
 	if (_object->_status == SENT && is_timed_out()) {
@@ -25,6 +25,9 @@
 #include <memory>
 #include <cassert>
 #include <functional>
+#ifdef RNS_DEBUG_METRICS
+#include <atomic>
+#endif
 #include <stdint.h>
 #include <time.h>
 
@@ -77,12 +80,17 @@ namespace RNS {
 		PacketReceipt() : _object(new Object()) {}
 		PacketReceipt(Type::NoneConstructor none) {}
 		PacketReceipt(const PacketReceipt& packet_receipt) : _object(packet_receipt._object) {}
+		PacketReceipt(PacketReceipt&& packet_receipt) noexcept : _object(std::move(packet_receipt._object)) {}
 		PacketReceipt(const Packet& packet);
 
 		inline PacketReceipt& operator = (const PacketReceipt& packet_receipt) {
 			_object = packet_receipt._object;
 			return *this;
 		}
+		inline PacketReceipt& operator = (PacketReceipt&& packet_receipt) noexcept {
+			_object = std::move(packet_receipt._object);
+			return *this;
+		}
 		inline explicit operator bool() const {
 			return _object.get() != nullptr;
 		}
@@ -106,7 +114,7 @@ namespace RNS {
 		void check_timeout();
 
 		// :param timeout: The timeout in seconds.
-		inline void set_timeout(int16_t timeout) { assert(_object); _object->_timeout = timeout; }
+		void set_timeout(int16_t timeout);
 
 		// Deprecated function-pointer setter retained for source compat
 		// with existing firmware; new code should use set_delivery_handler
@@ -151,6 +159,8 @@ namespace RNS {
 		inline bool proved() const { assert(_object); return _object->_proved; }
 		inline double concluded_at() const { assert(_object); return _object->_concluded_at; }
 		inline const Bytes& truncated_hash() const { assert(_object); return _object->_truncated_hash; }
+		inline double sent_at() const { assert(_object); return _object->_sent_at; }
+		inline int16_t timeout() const { assert(_object); return _object->_timeout; }
 		inline const Callbacks& callbacks() const { assert(_object); return _object->_callbacks; }
 
 		// setters
@@ -194,8 +204,17 @@ namespace RNS {
 			MEMF("Packet NONE object created, this: %p, data: %p", (void*)this, (void*)_object.get());
 		}
 		Packet(const Packet& packet) : _object(packet._object) {
+#ifdef RNS_DEBUG_METRICS
+			if (_object) ++_handle_copies;
+#endif
 			MEMF("Packet object copy created, this: %p, data: %p", (void*)this, (void*)_object.get());
 		}
+		Packet(Packet&& packet) noexcept : _object(std::move(packet._object)) {
+#ifdef RNS_DEBUG_METRICS
+			if (_object) ++_handle_moves;
+#endif
+			MEMF("Packet object move created, this: %p, data: %p", (void*)this, (void*)_object.get());
+		}
 		Packet(const Bytes& raw) : _object(new Object(raw)) {
 			MEMF("Packet object created from raw, this: %p, data: %p", (void*)this, (void*)_object.get());
 		}
@@ -250,9 +269,20 @@ namespace RNS {
 
 		inline Packet& operator = (const Packet& packet) {
 			_object = packet._object;
+#ifdef RNS_DEBUG_METRICS
+			if (_object) ++_handle_copies;
+#endif
 			MEMF("Packet object copy created by assignment, this: %p, data: %p", (void*)this, (void*)_object.get());
 			return *this;
 		}
+		inline Packet& operator = (Packet&& packet) noexcept {
+			_object = std::move(packet._object);
+#ifdef RNS_DEBUG_METRICS
+			if (_object) ++_handle_moves;
+#endif
+			MEMF("Packet object move created by assignment, this: %p, data: %p", (void*)this, (void*)_object.get());
+			return *this;
+		}
 		inline explicit operator bool() const {
 			return _object.get() != nullptr;
 		}
@@ -260,6 +290,13 @@ namespace RNS {
 			return _object.get() < packet._object.get();
 		}
 
+#ifdef RNS_DEBUG_METRICS
+		// Copies (a refcount increment each, and a decrement when the copy goes) and moves (neither) of
+		// non-empty handles
+		inline static uint32_t handle_copies() { return _handle_copies; }
+		inline static uint32_t handle_moves() { return _handle_moves; }
+#endif
+
 	private:
 	/*
 		void setTransportId(const uint8_t* transport_id);
@@ -288,6 +325,9 @@ namespace RNS {
 		const Bytes get_hash() const;
 		const Bytes getTruncatedHash() const;
 		const Bytes get_hashable_part() const;
+	private:
+		size_t hashable_offset() const;
+	public:
 
 		inline std::string toString() const { if (!_object) return ""; return "{Packet:" + _object->_packet_hash.toHex() + "}"; }
 
@@ -321,7 +361,10 @@ namespace RNS {
 		inline const Bytes& destination_hash() const { assert(_object); return _object->_destination_hash; }
 		inline const Bytes& transport_id() const { assert(_object); return _object->_transport_id; }
 		inline const Bytes& raw() const { assert(_object); return _object->_raw; }
-		inline const Bytes& data() const { assert(_object); return _object->_data; }
+		inline const Bytes& data() const { assert(_object); _object->unpack_data(); return _object->_data; }
+		// Zero-copy views into the raw packet buffer (preferred over raw().mid() and data() for parsing)
+		inline BytesView header_view() const { assert(_object); return _object->_raw.view(0, (_object->_header_type == Type::Packet::HEADER_2) ? (size_t)Type::Reticulum::HEADER_MAXSIZE : (size_t)Type::Reticulum::HEADER_MINSIZE); }
+		inline BytesView data_view() const { assert(_object); if (_object->_data_offset > 0) return _object->_raw.view(_object->_data_offset); return _object->_data.view(); }
 		// CBA LINK
 		inline const Link& destination_link() const { assert(_object); return _object->_destination_link; }
 		//CBA Following method is only used by Resource to access decrypted resource advertisement form Link. Consider a better way.
@@ -349,7 +392,7 @@ namespace RNS {
 		inline Packet& plaintext(const Bytes& plaintext) { assert(_object); _object->_plaintext = plaintext; return *this; }
 		// Used by Resource::receive_part to file an incoming packet's raw
 		// payload into the receiver-side assembly buffer.
-		inline Packet& data(const Bytes& data) { assert(_object); _object->_data = data; return *this; }
+		inline Packet& data(const Bytes& data) { assert(_object); _object->_data = data; _object->_data_offset = 0; return *this; }
 
 		// New fluent setters for fields that were previously only settable
 		// via constructor parameters.
@@ -375,6 +418,13 @@ namespace RNS {
 			//Object(const Destination& destination, const Link& destination_link) : _destination(destination), _destination_link(destination_link) { MEMF("Packet::Data object created, this: %p", (void*)this); }
 			//Object(const Link& link) : _destination(link.destination()), _destination_link(link) { MEMF("Packet::Data object created, this: %p", (void*)this); }
 			virtual ~Object() { MEMF("Packet::Data object destroyed, this: %p", (void*)this); }
+		private:
+			// Copies data out of raw on first access after unpack (until then data_view() serves it from raw)
+			inline void unpack_data() {
+				if (_data_offset == 0) return;
+				_data.assign(_raw.view(_data_offset));
+				_data_offset = 0;
+			}
 		private:
 			Destination _destination = {Type::NONE};
 
@@ -424,6 +474,7 @@ namespace RNS {
 
 			Bytes _raw;		// header + ( plaintext | ciphertext-token )
 			Bytes _data;	// plaintext | ciphertext
+			size_t _data_offset = 0;	// offset of not yet copied data within raw (0 if _data is current)
 
 			Bytes _plaintext;	// used exclusively to relay decrypted resource advertisement form Link to Resource
 
@@ -434,6 +485,11 @@ namespace RNS {
 		};
 		std::shared_ptr<Object> _object;
 
+#ifdef RNS_DEBUG_METRICS
+		static std::atomic<uint32_t> _handle_copies;
+		static std::atomic<uint32_t> _handle_moves;
+#endif
+
 	};
 
 }
@@ -59,9 +59,9 @@ using namespace RNS::Persistence;
 		p.packBinary(blob.data(), blob.size());
 	}
 
-	// receiving_interface (hash only; the live Interface is re-bound on decode)
-	Bytes interface_hash(entry._receiving_interface.get_hash());
-	p.packBinary(interface_hash.data(), interface_hash.size());
+	// receiving_interface (truncated hash only; the live Interface is re-bound on decode)
+	const Bytes& interface_hash = entry._receiving_interface.get_hash();
+	p.packBinary(interface_hash.data(), Type::Identity::TRUNCATED_HASHLENGTH/8);
 
 	// announce_packet (raw bytes, including header)
 	const Bytes& raw = entry._announce_packet.raw();
@@ -110,7 +110,7 @@ using namespace RNS::Persistence;
 		}
 	}
 
-	// receiving_interface (rebind to live Interface by hash)
+	// receiving_interface (rebind to live Interface by hash, full hashes written by earlier versions also match)
 	{
 		MsgPack::bin_t<uint8_t> b;
 		if (!u.deserialize(b)) return false;
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "PathCache.h"
+
+#include "../Utilities/OS.h"
+
+using namespace RNS;
+using namespace RNS::Persistence;
+using namespace RNS::Utilities;
+
+CachedPathTable::CachedPathTable(PathStore& store, PathStore& route_store, size_t capacity /*= RNS_PATH_CACHE_SIZE*/) :
+	_table(store),
+	_routes(route_store),
+	_slots(capacity)
+{
+}
+
+bool CachedPathTable::put(const Bytes& destination_hash, const DestinationEntry& entry, uint32_t ttl /*= 0*/) {
+	if (!_table.put(destination_hash, entry, ttl)) {
+		// store rejected the write so any cached copy may no longer match it
+		Slot* slot = lookup(destination_hash);
+		if (slot != nullptr) {
+			*slot = Slot();
+		}
+		return false;
+	}
+	if (!_routes.put(destination_hash, RouteSummary(entry), ttl)) {
+		// stale summary must not outlive the entry it was taken from
+		_routes.remove(destination_hash);
+	}
+	if (!_slots.empty()) {
+		double expires = entry._expires;
+		if (ttl > 0) {
+			double ttl_expires = OS::time() + ttl;
+			if (expires <= 0 || ttl_expires < expires) {
+				expires = ttl_expires;
+			}
+		}
+		store(destination_hash, entry, expires);
+	}
+	return true;
+}
+
+bool CachedPathTable::get(const Bytes& destination_hash, DestinationEntry& entry) const {
+	if (_slots.empty()) {
+		return _table.get(destination_hash, entry);
+	}
+	Hash16 key(destination_hash);
+	// removals and clears all go through here, so a live slot still matches the store
+	Slot* slot = lookup_live(key);
+	if (slot != nullptr && slot->_decoded) {
+		slot->_referenced = true;
+		++_hits;
+		entry = slot->_entry;
+		return true;
+	}
+	++_misses;
+	if (!_table.get(destination_hash, entry)) {
+		return false;
+	}
+	store(key, entry, entry._expires);
+	return true;
+}
+
+bool CachedPathTable::get_route(const Bytes& destination_hash, RouteSummary& route) const {
+	Hash16 key(destination_hash);
+	if (!_slots.empty()) {
+		Slot* slot = lookup_live(key);
+		if (slot != nullptr) {
+			slot->_referenced = true;
+			++_hits;
+			route = slot->_route;
+			return true;
+		}
+		++_misses;
+	}
+	if (_routes.get(destination_hash, route)) {
+		if (!_slots.empty()) {
+			store_route(key, route, route._expires);
+		}
+		return true;
+	}
+	// no summary (eg. path stored before summaries existed), derive it from the full entry once
+	DestinationEntry entry;
+	if (!_table.get(destination_hash, entry)) {
+		return false;
+	}
+	if (!_slots.empty()) {
+		store(key, entry, entry._expires);
+	}
+	route = RouteSummary(entry);
+	double now = OS::time();
+	if (entry._expires <= 0) {
+		_routes.put(destination_hash, route);
+	}
+	else if (entry._expires > now) {
+		_routes.put(destination_hash, route, (uint32_t)(entry._expires - now));
+	}
+	return true;
+}
+
+bool CachedPathTable::exists(const Bytes& destination_hash) const {
+	return _table.exists(destination_hash);
+}
+
+bool CachedPathTable::remove(const Bytes& destination_hash) {
+	Slot* slot = lookup(destination_hash);
+	if (slot != nullptr) {
+		*slot = Slot();
+	}
+	_routes.remove(destination_hash);
+	return _table.remove(destination_hash);
+}
+
+void CachedPathTable::invalidate() {
+	for (Slot& slot : _slots) {
+		slot = Slot();
+	}
+	_hand = 0;
+}
+
+CachedPathTable::Slot* CachedPathTable::lookup(const Hash16& destination_hash) const {
+	// cache is small so a linear scan over the inline keys beats any index
+	for (Slot& slot : _slots) {
+		if (slot._valid && slot._destination_hash == destination_hash) {
+			return &slot;
+		}
+	}
+	return nullptr;
+}
+
+CachedPathTable::Slot* CachedPathTable::lookup_live(const Hash16& destination_hash) const {
+	Slot* slot = lookup(destination_hash);
+	if (slot != nullptr && slot->_expires > 0 && OS::time() >= slot->_expires) {
+		// path has expired, defer to the store
+		*slot = Slot();
+		++_expirations;
+		return nullptr;
+	}
+	return slot;
+}
+
+CachedPathTable::Slot& CachedPathTable::claim(const Hash16& destination_hash) const {
+	Slot* slot = lookup(destination_hash);
+	if (slot != nullptr) {
+		return *slot;
+	}
+	// CLOCK sweep, referenced entries get a second chance before eviction
+	while (true) {
+		Slot& candidate = _slots[_hand];
+		_hand = (_hand + 1) % _slots.size();
+		if (!candidate._valid) {
+			slot = &candidate;
+			break;
+		}
+		if (!candidate._referenced) {
+			++_evictions;
+			slot = &candidate;
+			break;
+		}
+		candidate._referenced = false;
+	}
+	*slot = Slot();
+	slot->_destination_hash = destination_hash;
+	slot->_valid = true;
+	return *slot;
+}
+
+void CachedPathTable::store(const Hash16& destination_hash, const DestinationEntry& entry, double expires) const {
+	Slot& slot = claim(destination_hash);
+	slot._route = RouteSummary(entry);
+	slot._entry = entry;
+	slot._decoded = true;
+	slot._expires = expires;
+}
+
+void CachedPathTable::store_route(const Hash16& destination_hash, const RouteSummary& route, double expires) const {
+	Slot& slot = claim(destination_hash);
+	slot._route = route;
+	slot._entry = DestinationEntry();
+	slot._decoded = false;
+	slot._expires = expires;
+}
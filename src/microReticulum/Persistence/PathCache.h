@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "DestinationEntry.h"
+#include "RouteSummary.h"
+#include "../HashKey.h"
+#include "../Bytes.h"
+
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+// Number of decoded path entries held in front of the path store (0 disables caching)
+#ifndef RNS_PATH_CACHE_SIZE
+	#define RNS_PATH_CACHE_SIZE 8
+#endif
+
+namespace RNS { namespace Persistence {
+
+// Bounded cache of decoded DestinationEntry records in front of NewPathTable.
+//
+// Every NewPathTable::get() decodes the full entry (including the announce packet and random blobs)
+// from the path store, and a single link establishment or path request looks up the same destination
+// several times. This keeps the most recently used entries decoded, with CLOCK (second chance)
+// eviction so a hit costs only a reference bit update.
+//
+// Writes go through to the store on put() and remove(). Cached entries are dropped once they pass
+// their path expiry (or the store ttl given on put()), matching when the store itself expires them.
+// A hit is served from the slot without consulting the store, so any code that modifies the path
+// store directly (including clearing it) must call invalidate(). Entries the store drops on its own
+// to stay under its record limit remain cached until they expire or are evicted here.
+//
+// Each put() also writes a fixed-size RouteSummary to a separate route store. Slots hold the summary
+// next to the entry, and get_route() serves forwarding decisions from them, reading only the summary
+// on a miss. The full entry is only decoded for callers that need the announce packet or random blobs.
+//
+// Provides the subset of the NewPathTable interface used by Transport so it can stand in for it.
+class CachedPathTable {
+
+public:
+	CachedPathTable(PathStore& store, PathStore& route_store, size_t capacity = RNS_PATH_CACHE_SIZE);
+
+	bool put(const Bytes& destination_hash, const DestinationEntry& entry, uint32_t ttl = 0);
+	bool get(const Bytes& destination_hash, DestinationEntry& entry) const;
+	// Routing fields only, falls back to (and backfills from) the full entry if no summary is stored
+	bool get_route(const Bytes& destination_hash, RouteSummary& route) const;
+	bool exists(const Bytes& destination_hash) const;
+	bool remove(const Bytes& destination_hash);
+	inline size_t size() const { return _table.size(); }
+
+	// Iteration decodes directly from the store and bypasses the cache
+	inline auto begin() const -> decltype(std::declval<const NewPathTable&>().begin()) { return _table.begin(); }
+	inline auto end() const -> decltype(std::declval<const NewPathTable&>().end()) { return _table.end(); }
+
+	// Drop all cached entries (store is left untouched)
+	void invalidate();
+
+	inline size_t capacity() const { return _slots.size(); }
+	inline uint32_t hits() const { return _hits; }
+	inline uint32_t misses() const { return _misses; }
+	inline uint32_t evictions() const { return _evictions; }
+	inline uint32_t expirations() const { return _expirations; }
+
+private:
+	struct Slot {
+		Hash16 _destination_hash;
+		RouteSummary _route;
+		// only set when _decoded, slots filled by get_route() hold just the summary
+		DestinationEntry _entry;
+		double _expires = 0;
+		bool _valid = false;
+		bool _decoded = false;
+		bool _referenced = false;
+	};
+
+	Slot* lookup(const Hash16& destination_hash) const;
+	// Live slot for destination_hash, dropping it if it has expired
+	Slot* lookup_live(const Hash16& destination_hash) const;
+	Slot& claim(const Hash16& destination_hash) const;
+	void store(const Hash16& destination_hash, const DestinationEntry& entry, double expires) const;
+	void store_route(const Hash16& destination_hash, const RouteSummary& route, double expires) const;
+
+private:
+	NewPathTable _table;
+	// summaries are (re)written from const lookups when backfilling
+	mutable RouteTable _routes;
+	// cache is logically const, lookups fill and update it
+	mutable std::vector<Slot> _slots;
+	mutable size_t _hand = 0;
+	mutable uint32_t _hits = 0;
+	mutable uint32_t _misses = 0;
+	mutable uint32_t _evictions = 0;
+	mutable uint32_t _expirations = 0;
+
+};
+
+} }
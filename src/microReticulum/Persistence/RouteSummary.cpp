@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "RouteSummary.h"
+
+#include "../Transport.h"
+
+#include <string.h>
+
+using namespace RNS;
+using namespace RNS::Persistence;
+
+// Encodes a RouteSummary as a fixed-size record (host byte order, the store is local to the device):
+//   [timestamp:8][expires:8][hops:1][received_from:16][receiving_interface_hash:16]
+//
+// Unlike DestinationEntry there is no MsgPack framing, so decoding is a handful of copies.
+// Any record not exactly ENCODED_SIZE bytes is rejected.
+/*static*/ std::vector<uint8_t> microStore::Codec<RouteSummary>::encode(const RouteSummary& summary) {
+
+	// If invalid/empty summary then return empty
+	if (!summary) return {};
+
+	std::vector<uint8_t> data(RouteSummary::ENCODED_SIZE);
+	uint8_t* p = data.data();
+
+	memcpy(p, &summary._timestamp, sizeof(double));
+	p += sizeof(double);
+	memcpy(p, &summary._expires, sizeof(double));
+	p += sizeof(double);
+	*p++ = summary._hops;
+	memcpy(p, summary._received_from.data(), Hash16::SIZE);
+	p += Hash16::SIZE;
+	// receiving_interface (truncated hash only; the live Interface is re-bound on decode)
+	Hash16 interface_hash(summary._receiving_interface.get_hash());
+	memcpy(p, interface_hash.data(), Hash16::SIZE);
+
+	return data;
+}
+
+/*static*/ bool microStore::Codec<RouteSummary>::decode(const std::vector<uint8_t>& data, RouteSummary& summary)
+{
+	if (data.size() != RouteSummary::ENCODED_SIZE) return false;
+
+	const uint8_t* p = data.data();
+
+	memcpy(&summary._timestamp, p, sizeof(double));
+	p += sizeof(double);
+	memcpy(&summary._expires, p, sizeof(double));
+	p += sizeof(double);
+	summary._hops = *p++;
+	summary._received_from = Hash16(p, Hash16::SIZE);
+	p += Hash16::SIZE;
+
+	// receiving_interface (rebind to live Interface by hash)
+	Bytes interface_hash(p, Hash16::SIZE);
+	summary._receiving_interface = Transport::find_interface_from_hash(interface_hash);
+	if (!summary._receiving_interface) {
+		WARNINGF("Route Interface %s not found", interface_hash.toHex().c_str());
+	}
+
+	return true;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include "DestinationEntry.h"
+#include "../Interface.h"
+#include "../HashKey.h"
+#include "../Bytes.h"
+#include "../Type.h"
+
+#include <microStore/TypedStore.h>
+#include <microStore/Codec.h>
+
+#include <vector>
+#include <stdint.h>
+
+namespace RNS { namespace Persistence {
+
+// Fixed-size routing fields of a path, stored alongside the full DestinationEntry so forwarding
+// decisions don't need to decode the announce packet and random blobs.
+class RouteSummary {
+public:
+	// Encoded size: timestamp, expires, hops, received_from, truncated receiving_interface hash
+	static constexpr size_t ENCODED_SIZE = sizeof(double) + sizeof(double) + sizeof(uint8_t) + Hash16::SIZE + Hash16::SIZE;
+
+public:
+	RouteSummary() {}
+	RouteSummary(const DestinationEntry& entry) :
+		_timestamp(entry._timestamp),
+		_expires(entry._expires),
+		_hops(entry._hops),
+		_received_from(entry._received_from),
+		_receiving_interface(entry._receiving_interface)
+	{
+	}
+	inline explicit operator bool() const {
+		return (bool)_receiving_interface;
+	}
+public:
+	inline Interface& receiving_interface() { return _receiving_interface; }
+	inline const Interface& receiving_interface() const { return _receiving_interface; }
+public:
+	double _timestamp = 0;
+	double _expires = 0;
+	uint8_t _hops = 0;
+	Hash16 _received_from;
+	Interface _receiving_interface = {Type::NONE};
+};
+
+using RouteTable = microStore::TypedStore<Bytes, RouteSummary, PathStore>;
+
+} }
+
+namespace microStore {
+template<>
+struct Codec<RNS::Persistence::RouteSummary>
+{
+	static std::vector<uint8_t> encode(const RNS::Persistence::RouteSummary& summary);
+	static bool decode(const std::vector<uint8_t>& data, RNS::Persistence::RouteSummary& summary);
+};
+}
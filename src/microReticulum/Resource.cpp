@@ -19,6 +19,7 @@
 #include "Transport.h"
 #include "Packet.h"
 #include "Identity.h"
+#include "Cryptography/Hashes.h"
 #include "Link.h"
 #include "Log.h"
 
@@ -317,19 +318,29 @@ const Resource& Resource::start() {
 	_object->_parts.reserve(hashmap_entries);
 	_object->_hashmap = {Bytes::NONE};
 
+	// Map hashes of all parts in one batch, so they can be hashed several at a time
+	// (same as get_map_hash for each chunk)
+	std::vector<const uint8_t*> chunk_data(hashmap_entries);
+	std::vector<size_t> chunk_sizes(hashmap_entries);
 	for (uint32_t i = 0; i < hashmap_entries; ++i) {
 		const size_t offset = static_cast<size_t>(i) * _object->_sdu;
-		size_t chunk_size = _object->_sdu;
-		if (offset + chunk_size > encrypted.size()) {
-			chunk_size = encrypted.size() - offset;
-		}
-		Bytes chunk = encrypted.mid(offset, chunk_size);
+		chunk_data[i]  = encrypted.data() + offset;
+		chunk_sizes[i] = std::min(static_cast<size_t>(_object->_sdu), encrypted.size() - offset);
+	}
+	std::vector<uint8_t> map_hashes(static_cast<size_t>(hashmap_entries) * Cryptography::SHA256Context::DIGEST_SIZE);
+	Cryptography::sha256_many(map_hashes.data(), chunk_data.data(), chunk_sizes.data(), hashmap_entries,
+	                          _object->_random_hash.data(), _object->_random_hash.size());
+	uint8_t* hashmap = _object->_hashmap.writable(static_cast<size_t>(hashmap_entries) * Type::Resource::MAPHASH_LEN);
+
+	for (uint32_t i = 0; i < hashmap_entries; ++i) {
+		Bytes chunk(chunk_data[i], chunk_sizes[i]);
 
 		Packet part = Packet(_object->_link, chunk).context(Type::Packet::RESOURCE);
 		part.pack();
 
-		Bytes map_hash = get_map_hash(chunk);
-		_object->_hashmap.append(map_hash);
+		memcpy(hashmap + static_cast<size_t>(i) * Type::Resource::MAPHASH_LEN,
+		       map_hashes.data() + static_cast<size_t>(i) * Cryptography::SHA256Context::DIGEST_SIZE,
+		       Type::Resource::MAPHASH_LEN);
 		_object->_parts.push_back(part);
 	}
 
@@ -413,10 +424,11 @@ void Resource::hashmap_update(uint16_t segment, const Bytes& hashmap) {
 	request_next();
 }
 
-Bytes Resource::get_map_hash(const Bytes& data) {
+Bytes Resource::get_map_hash(const BytesView& data) {
 	// Python Resource.py:505 — full_hash(data + random_hash)[:MAPHASH_LEN]
 	assert(_object);
-	return Identity::full_hash(data + _object->_random_hash).left(Type::Resource::MAPHASH_LEN);
+	// hash data and random_hash in sequence rather than concatenating them
+	return Identity::full_hash(data, _object->_random_hash).left(Type::Resource::MAPHASH_LEN);
 }
 
 
@@ -878,7 +890,8 @@ void Resource::receive_part(const Packet& packet) {
 	}
 
 	_object->_status = Type::Resource::TRANSFERRING;
-	const Bytes part_data = packet.data();
+	// part data is only copied out of the packet if it fills a slot
+	const BytesView part_data = packet.data_view();
 	const Bytes part_hash = get_map_hash(part_data);
 
 	const int32_t cci    = (_object->_consecutive_completed_height >= 0) ? _object->_consecutive_completed_height : 0;
@@ -888,7 +901,7 @@ void Resource::receive_part(const Packet& packet) {
 	                                   static_cast<size_t>(_object->_total_parts));
 
 	for (size_t j = static_cast<size_t>(cci); j < window_end; ++j) {
-		Bytes map_hash_j = _object->_hashmap.mid(j * maphash_len, maphash_len);
+		BytesView map_hash_j = _object->_hashmap.view(j * maphash_len, maphash_len);
 		if (map_hash_j == part_hash) {
 			if (!_object->_parts[i]) {
 				// File this part into the slot. Python stores the raw part
@@ -900,8 +913,9 @@ void Resource::receive_part(const Packet& packet) {
 				// carrier), and the throw propagates up to Reticulum::loop()
 				// as "Packet destination is required", leaving the slot
 				// unfilled and stalling the transfer.
-				_object->_parts[i] = Packet(part_data);
-				_object->_parts[i].data(part_data);
+				const Bytes part_bytes = part_data.bytes();
+				_object->_parts[i] = Packet(part_bytes);
+				_object->_parts[i].data(part_bytes);
 
 				_object->_rtt_rxd_bytes  += part_data.size();
 				_object->_received_count += 1;
@@ -1091,10 +1105,10 @@ void Resource::request(const Bytes& request_data) {
 	const size_t hash_bytes = Type::Identity::HASHLENGTH / 8;
 
 	if (request_data.size() < pad + hash_bytes) return;
-	const Bytes requested_hashes = request_data.mid(pad + hash_bytes);
+	const BytesView requested_hashes = request_data.view(pad + hash_bytes);
 
-	// Build the set of requested map_hashes for membership testing.
-	std::vector<Bytes> map_hashes;
+	// Build the set of requested map_hashes for membership testing (views, no copies).
+	std::vector<BytesView> map_hashes;
 	const size_t map_hashes_count = requested_hashes.size() / Type::Resource::MAPHASH_LEN;
 	map_hashes.reserve(map_hashes_count);
 	for (size_t i = 0; i < map_hashes_count; ++i) {
@@ -1105,7 +1119,7 @@ void Resource::request(const Bytes& request_data) {
 	const size_t collision_guard = Type::Resource::ResourceAdvertisement::COLLISION_GUARD_SIZE;
 	const size_t search_end = std::min(search_start + collision_guard, static_cast<size_t>(_object->_parts.size()));
 
-	auto map_hash_in_requested = [&](const Bytes& mh) -> bool {
+	auto map_hash_in_requested = [&](const BytesView& mh) -> bool {
 		for (const auto& candidate : map_hashes) {
 			if (candidate == mh) return true;
 		}
@@ -1113,7 +1127,7 @@ void Resource::request(const Bytes& request_data) {
 	};
 
 	for (size_t i = search_start; i < search_end; ++i) {
-		Bytes part_map_hash = _object->_hashmap.mid(i * Type::Resource::MAPHASH_LEN, Type::Resource::MAPHASH_LEN);
+		BytesView part_map_hash = _object->_hashmap.view(i * Type::Resource::MAPHASH_LEN, Type::Resource::MAPHASH_LEN);
 		if (!map_hash_in_requested(part_map_hash)) continue;
 
 		try {
@@ -1141,11 +1155,11 @@ void Resource::request(const Bytes& request_data) {
 		// Receiver is requesting the next slice of the hashmap.
 		// Mirror Python Resource.py:1027-1064. Locate the last map_hash the
 		// receiver saw and emit the next HASHMAP_MAX_LEN entries.
-		const Bytes last_map_hash = request_data.mid(1, Type::Resource::MAPHASH_LEN);
+		const BytesView last_map_hash = request_data.view(1, Type::Resource::MAPHASH_LEN);
 		size_t part_index = static_cast<size_t>(_object->_receiver_min_consecutive_height);
 		for (size_t i = search_start; i < search_end; ++i) {
 			++part_index;
-			Bytes mh = _object->_hashmap.mid(i * Type::Resource::MAPHASH_LEN, Type::Resource::MAPHASH_LEN);
+			BytesView mh = _object->_hashmap.view(i * Type::Resource::MAPHASH_LEN, Type::Resource::MAPHASH_LEN);
 			if (mh == last_map_hash) break;
 		}
 
@@ -1164,7 +1178,7 @@ void Resource::request(const Bytes& request_data) {
 		size_t hashmap_end = (segment + 1) * hm_max_len;
 		if (hashmap_end > _object->_parts.size()) hashmap_end = _object->_parts.size();
 
-		Bytes segment_hashmap = _object->_hashmap.mid(hashmap_start * Type::Resource::MAPHASH_LEN, (hashmap_end - hashmap_start) * Type::Resource::MAPHASH_LEN);
+		BytesView segment_hashmap = _object->_hashmap.view(hashmap_start * Type::Resource::MAPHASH_LEN, (hashmap_end - hashmap_start) * Type::Resource::MAPHASH_LEN);
 
 		// hmu = hash || msgpack([segment, hashmap]) — mirror Python Resource.py:1055.
 		MsgPack::Packer hmu_packer;
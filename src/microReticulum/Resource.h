@@ -101,7 +101,7 @@ namespace RNS {
 		// Methods in roughly the same order as Python RNS.Resource
 		void hashmap_update_packet(const Bytes& plaintext);
 		void hashmap_update(uint16_t segment, const Bytes& hashmap);
-		Bytes get_map_hash(const Bytes& data);
+		Bytes get_map_hash(const BytesView& data);
 		void advertise();
 		void advertise_job();
 		void update_eifr();
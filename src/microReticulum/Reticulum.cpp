@@ -18,6 +18,8 @@
 #include "Log.h"
 #include "Type.h"
 #include "Utilities/Memory.h"
+#include "Utilities/EventLoop.h"
+#include "Interfaces/LocalInterface.h"
 
 #ifdef RNS_USE_PROVISIONING
 #include "Provisioning/Provisioning.h"
@@ -26,6 +28,8 @@
 //#include <TransistorNoiseSource.h>
 #include <RNG.h>
 
+#include <algorithm>
+
 #ifdef ARDUINO
 #include <Arduino.h>
 //#include <TransistorNoiseSource.h>
@@ -212,6 +216,12 @@ void Reticulum::start() {
 	Provisioning::Provisioner::instance().begin();
 #endif
 
+	// Ready for wakes from interface threads before any can start queueing
+	EventLoop::open();
+
+	// Before Transport, which skips loading tables when connected to a shared instance
+	start_local_interface();
+
 	INFO("Starting Transport...");
 	Transport::start(*this);
 
@@ -226,28 +236,29 @@ void Reticulum::loop() {
 	assert(_object);
 	// Catch exceptions from loop work
 	try {
-		if (!_object->_is_connected_to_shared_instance) {
-
-			// Perform Reticulum housekeeping
-			if (OS::time() > (_object->_jobs_last_run + JOB_INTERVAL)) {
-				jobs();
-			}
-
-			// Perform Interface processing
-			for (auto& interface : Transport::get_interfaces()) {
-				const_cast<Interface&>(interface).loop();
-			}
+		// Perform Reticulum housekeeping, which is left to the shared instance when connected to one
+		if (!_object->_is_connected_to_shared_instance && OS::time() > (_object->_jobs_last_run + JOB_INTERVAL)) {
+			jobs();
+		}
 
-			// Perform Filesystem processing
-			microStore::FileSystem& filesystem = OS::get_filesystem();
-			if (filesystem) {
-				filesystem.loop();
-			}
+		// Perform Interface processing
+		// Indexed over handle copies since interfaces may register or deregister spawned interfaces
+		// from their loop()
+		const Transport::InterfaceTable& interfaces = Transport::get_interfaces();
+		for (size_t i = 0; i < interfaces.size(); ++i) {
+			Interface interface(interfaces[i]);
+			interface.loop();
+		}
 
-			// Perform Transport processing
-			RNS::Transport::loop();
+		// Perform Filesystem processing
+		microStore::FileSystem& filesystem = OS::get_filesystem();
+		if (filesystem) {
+			filesystem.loop();
 		}
 
+		// Perform Transport processing
+		RNS::Transport::loop();
+
 		// Perform random number gnerator housekeeping
 		RNG.loop();
     }
@@ -265,6 +276,53 @@ void Reticulum::loop() {
     }
 }
 
+bool Reticulum::wait(double max_wait /*= 1.0*/) {
+	assert(_object);
+#if RNS_EVENT_LOOP
+	double now = OS::time();
+	double deadline = now + max_wait;
+	if (!_object->_is_connected_to_shared_instance) {
+		deadline = std::min(deadline, _object->_jobs_last_run + JOB_INTERVAL);
+	}
+	deadline = std::min(deadline, Transport::next_loop_time());
+
+	// Keep the watched set in step with the interfaces, a single interface without a descriptor
+	// has to be polled by loop() so waiting at all would only add latency
+	bool pollable = true;
+	std::vector<int>& next_poll_fds = _object->_next_poll_fds;
+	next_poll_fds.clear();
+	for (auto& interface : Transport::get_interfaces()) {
+		int fd = interface.poll_fd();
+		if (fd == InterfaceImpl::POLL_IDLE) {
+			continue;
+		}
+		if (fd < 0) {
+			pollable = false;
+			continue;
+		}
+		next_poll_fds.push_back(fd);
+		if (!EventLoop::watching(fd)) {
+			EventLoop::watch(fd);
+		}
+	}
+	for (int fd : _object->_poll_fds) {
+		if (std::find(next_poll_fds.begin(), next_poll_fds.end(), fd) == next_poll_fds.end()) {
+			EventLoop::unwatch(fd);
+		}
+	}
+	_object->_poll_fds.swap(next_poll_fds);
+
+	if (!pollable || deadline <= now) {
+		return false;
+	}
+	// Anything sent since the last loop() goes out before sleeping
+	Transport::flush_interfaces();
+	return EventLoop::wait(deadline - now);
+#else
+	return false;
+#endif
+}
+
 void Reticulum::jobs() {
 
 	double now = OS::time();
@@ -304,11 +362,60 @@ void Reticulum::jobs() {
 	_object->_jobs_last_run = OS::time();
 }
 
-// CBA TODO
-/*
-void Reticulum::start_local_interface() {
+//p def __start_local_interface(self):
+bool Reticulum::start_local_interface() {
+	assert(_object);
+	if (_object->_local_interface) {
+		return _object->_is_shared_instance || _object->_is_connected_to_shared_instance;
+	}
+	_object->_is_shared_instance = false;
+	_object->_is_connected_to_shared_instance = false;
+	_object->_is_standalone_instance = true;
+#if RNS_TCP_INTERFACE
+	if (!_object->_share_instance) {
+		return false;
+	}
+	const char* instance_name = _object->_instance_name.c_str();
+
+	// The reference binds first and connects if that fails, connecting first instead finds a running
+	// shared instance without logging a failed bind in every client program
+	Interfaces::LocalClientInterface* client_impl = new Interfaces::LocalClientInterface("Local shared instance", instance_name, _object->_local_interface_port);
+	Interface client_interface(client_impl);
+	client_interface.start();
+	double timeout = OS::time() + Interfaces::LocalClientInterface::CONNECT_TIMEOUT;
+	while (client_impl->connecting() && OS::time() < timeout) {
+		OS::sleep(0.01);
+		client_interface.loop();
+	}
+	if (client_impl->connected()) {
+		Transport::register_interface(client_interface);
+		_object->_local_interface = client_interface;
+		_object->_is_standalone_instance = false;
+		_object->_is_connected_to_shared_instance = true;
+		__transport_enabled = false;
+		__remote_management_enabled = false;
+		__allow_probes = false;
+		DEBUGF("Connected to locally available Reticulum instance via: %s", client_interface.toString().c_str());
+		return true;
+	}
+	client_interface.detach();
+
+	Interface server_interface(new Interfaces::LocalServerInterface("Shared Instance", instance_name, _object->_local_interface_port));
+	if (server_interface.start()) {
+		Transport::register_interface(server_interface);
+		_object->_local_interface = server_interface;
+		_object->_is_standalone_instance = false;
+		_object->_is_shared_instance = true;
+		DEBUGF("Started shared instance interface: %s", server_interface.toString().c_str());
+		return true;
+	}
+	ERROR("Local shared instance could neither be started nor connected to, running standalone");
+#endif
+	return false;
 }
 
+// CBA TODO
+/*
 void Reticulum::apply_config() {
 }
 
@@ -435,7 +542,7 @@ const PathTable& Reticulum::get_path_table() const {
 	return Transport::path_table();
 }
 
-const std::map<Bytes, Transport::RateEntry>& Reticulum::get_rate_table() const {
+const Transport::RateTable& Reticulum::get_rate_table() const {
 /*
 	rate_table = []
 	for dst_hash in Transport::announce_rate_table:
@@ -27,6 +27,11 @@
 #include <cassert>
 #include <stdint.h>
 
+// Whether instances share themselves with other programs on the host by default, see share_instance()
+#ifndef RNS_SHARE_INSTANCE
+#define RNS_SHARE_INSTANCE 0
+#endif
+
 using namespace RNS::Persistence;
 
 namespace RNS {
@@ -101,17 +106,29 @@ namespace RNS {
 
 	public:
 		void start();
+		// Shares this instance over a LocalServerInterface, or if another program already shares
+		// one, connects to it over a LocalClientInterface so this program's traffic goes through the
+		// shared instance's Transport. Called by start(), returns whether the instance is shared or
+		// connected to a shared instance.
+		bool start_local_interface();
 		void loop();
+		// DIVERGENCE: Python runs interfaces and jobs on their own threads. Here loop() must be called
+		// continuously, and wait() lets native callers sleep between calls until an interface has
+		// input, a frame is queued by another thread, or jobs are due (at most max_wait seconds).
+		// Returns immediately if any interface can't be waited on (see InterfaceImpl::poll_fd()).
+		bool wait(double max_wait = 1.0);
 		void jobs();
 		void should_persist_data();
 		void persist_data();
 		void clean_caches();
 		void clear_caches();
 		//void __create_default_config();
+		// DIVERGENCE: No RPC listener is started, clients of a shared instance can't query its
+		// interface stats, paths or link counts.
 		//void rpc_loop();
 		//void get_interface_stats() const;
 		const PathTable& get_path_table() const;
-		const std::map<Bytes, Transport::RateEntry>& get_rate_table() const;
+		const Transport::RateTable& get_rate_table() const;
 		bool drop_path(const Bytes& destination);
 		uint16_t drop_all_via(const Bytes& transport_hash);
 		void drop_announce_queues();
@@ -188,6 +205,16 @@ namespace RNS {
 
 		// getters/setters
 		inline bool is_connected_to_shared_instance() const { assert(_object); return _object->_is_connected_to_shared_instance; }
+		inline bool is_shared_instance() const { assert(_object); return _object->_is_shared_instance; }
+		inline bool is_standalone_instance() const { assert(_object); return _object->_is_standalone_instance; }
+		// DIVERGENCE: The reference shares instances unless configured not to, here it's opt-in
+		// (RNS_SHARE_INSTANCE) so existing programs keep running standalone. Must be set before start().
+		inline bool share_instance() const { assert(_object); return _object->_share_instance; }
+		inline void share_instance(bool share_instance) { assert(_object); _object->_share_instance = share_instance; }
+		inline const std::string& instance_name() const { assert(_object); return _object->_instance_name; }
+		inline void instance_name(const char* instance_name) { assert(_object); _object->_instance_name = instance_name; }
+		inline uint16_t local_interface_port() const { assert(_object); return _object->_local_interface_port; }
+		inline void local_interface_port(uint16_t local_interface_port) { assert(_object); _object->_local_interface_port = local_interface_port; }
 		inline static uint16_t persist_interval() { return _persist_interval; }
 		inline static void persist_interval(uint16_t persist_interval) { _persist_interval = persist_interval; }
 		inline static uint16_t clean_interval() { return _clean_interval; }
@@ -212,7 +239,9 @@ namespace RNS {
 
 			uint16_t _local_interface_port = 37428;
 			uint16_t _local_control_port   = 37429;
-			bool _share_instance       = true;
+			bool _share_instance       = RNS_SHARE_INSTANCE;
+			std::string _instance_name = "default";
+			Interface _local_interface = {Type::NONE};
 			//p _rpc_listener         = None
 
 			//p _ifac_salt = Reticulum.IFAC_SALT
@@ -227,6 +256,9 @@ namespace RNS {
 
 			// CBA
 			double _jobs_last_run = Utilities::OS::time();
+			// Interface descriptors currently watched by wait()
+			std::vector<int> _poll_fds;
+			std::vector<int> _next_poll_fds;
 
 		friend class Reticulum;
 		};
@@ -23,6 +23,7 @@
 #include "Log.h"
 #include "Cryptography/Random.h"
 #include "Utilities/OS.h"
+#include "Utilities/EventLoop.h"
 #include "Utilities/Persistence.h"
 
 #if defined(RNS_ENABLE_REMOTE_PROVISIONING) && defined(RNS_USE_PROVISIONING)
@@ -33,6 +34,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <string.h>
 #include <unistd.h>
 #include <time.h>
 
@@ -53,6 +55,11 @@ using namespace RNS::Persistence;
 #define RNS_PATH_TABLE_SEGMENT_COUNT 8
 #endif
 
+// Route summaries are fixed-size and a fraction of a full path entry
+#ifndef RNS_ROUTE_TABLE_SEGMENT_SIZE
+#define RNS_ROUTE_TABLE_SEGMENT_SIZE 16384
+#endif
+
 #ifndef RNS_ANNOUNCE_TABLE_MAX
 #define RNS_ANNOUNCE_TABLE_MAX 100
 #endif
@@ -95,56 +102,66 @@ using namespace RNS::Persistence;
 
 
 /*static*/ Transport::InterfaceTable Transport::_interfaces;
+/*static*/ Transport::InterfaceSlots Transport::_interface_slots;
+/*static*/ Transport::IngressQueue Transport::_ingress_queue(RNS_INGRESS_QUEUE_SIZE);
+/*static*/ Bytes Transport::_ifac_buffer;
+/*static*/ Bytes Transport::_ifac_mask;
 /*static*/ Transport::DestinationTable Transport::_destinations;
-/*static*/ std::set<Link> Transport::_pending_links;
-/*static*/ std::set<Link> Transport::_active_links;
+/*static*/ Transport::LinkIndex Transport::_pending_links;
+/*static*/ Transport::LinkIndex Transport::_active_links;
 #if defined(RNS_USE_FS) && RNS_PERSIST_HASHLIST
 /*static*/ Transport::BytesStore Transport::_packet_hash_store(RNS_HASHLIST_SEGMENT_SIZE, RNS_HASHLIST_SEGMENT_COUNT);
 #else
 /*static*/ Transport::BytesStore Transport::_packet_hash_store;
 #endif
 /*static*/ Transport::PersistedBytesList Transport::_packet_hashlist(Transport::_packet_hash_store);
-/*static*/ std::list<PacketReceipt> Transport::_receipts;
+/*static*/ Transport::ReceiptTable Transport::_receipts;
 
 /*static*/ Transport::AnnounceTable Transport::_announce_table;
 /*static*/ PathTable Transport::_path_table;
-/*static*/ std::map<Bytes, Transport::ReverseEntry> Transport::_reverse_table;
+/*static*/ Transport::ReverseTable Transport::_reverse_table;
 #if RNS_NEIGHBOR_PROBING
 // DIVERGENCE: in-memory neighbor stats for passive liveness inference.
 /*static*/ Transport::NeighborStatsTable Transport::_neighbor_stats;
 #endif
-/*static*/ std::map<Bytes, Transport::LinkEntry> Transport::_link_table;
+/*static*/ Transport::LinkTable Transport::_link_table;
 /*static*/ Transport::AnnounceTable Transport::_held_announces;
 /*static*/ std::set<HAnnounceHandler> Transport::_announce_handlers;
-/*static*/ std::map<Bytes, Transport::TunnelEntry> Transport::_tunnels;
-/*static*/ std::map<Bytes, Transport::RateEntry> Transport::_announce_rate_table;
-/*static*/ std::map<Bytes, double> Transport::_path_requests;
+/*static*/ Transport::TunnelTable Transport::_tunnels;
+/*static*/ Transport::RateTable Transport::_announce_rate_table;
+/*static*/ Transport::PathRequestTimes Transport::_path_requests;
 
-/*static*/ std::map<Bytes, Transport::PathRequestEntry> Transport::_discovery_path_requests;
+/*static*/ Transport::PathRequestTable Transport::_discovery_path_requests;
 /*static*/ Transport::BytesList Transport::_discovery_pr_tags;
 /*static*/ Transport::PathStateTable Transport::_path_states;
 /*static*/ Transport::PendingDiscoveryPRs Transport::_pending_discovery_prs;
 /*static*/ double Transport::_pending_discovery_prs_last_tx = 0.0;
 /*static*/ Transport::BlackholeTable Transport::_blackholed_identities;
 
+/*static*/ Transport::DeadlineQueue Transport::_receipt_deadlines;
+/*static*/ Transport::DeadlineQueue Transport::_announce_deadlines;
+/*static*/ Transport::DeadlineQueue Transport::_reverse_deadlines;
+/*static*/ Transport::DeadlineQueue Transport::_link_deadlines;
+/*static*/ Transport::DeadlineQueue Transport::_path_request_deadlines;
+/*static*/ Transport::DeadlineQueue Transport::_discovery_pr_deadlines;
+/*static*/ Transport::InterfaceDeadlineQueue Transport::_announce_queue_deadlines;
+
 /*static*/ std::set<Destination> Transport::_control_destinations;
 /*static*/ std::set<Bytes> Transport::_control_hashes;
 /*static*/ std::set<Destination> Transport::_mgmt_destinations;
 /*static*/ std::set<Bytes> Transport::_mgmt_hashes;
 
-///*static*/ std::set<Interface> Transport::_local_client_interfaces;
-/*static*/ std::set<std::reference_wrapper<const Interface>, std::less<const Interface>> Transport::_local_client_interfaces;
+/*static*/ std::set<Interface> Transport::_local_client_interfaces;
 
-/*static*/ std::map<Bytes, const Interface> Transport::_pending_local_path_requests;
+/*static*/ Transport::PendingLocalPathRequests Transport::_pending_local_path_requests;
 
 // CBA
-/*static*/ std::map<Bytes, Transport::PacketEntry> Transport::_packet_table;
+/*static*/ Transport::PacketTable Transport::_packet_table;
 
 /*static*/ uint16_t Transport::_LOCAL_CLIENT_CACHE_MAXSIZE = 512;
 
 /*static*/ double Transport::_start_time				= 0.0;
 /*static*/ bool Transport::_jobs_locked					= false;
-/*static*/ bool Transport::_jobs_running				= false;
 /*static*/ float Transport::_job_interval				= 0.250;
 /*static*/ double Transport::_jobs_last_run				= 0.0;
 /*static*/ double Transport::_links_last_checked		= 0.0;
@@ -233,10 +250,12 @@ using namespace RNS::Persistence;
 /*static*/ uint8_t Transport::_hashlist_segment_count = 0;
 #if defined(RNS_USE_FS) && RNS_PERSIST_PATHS
 /*static*/ PathStore Transport::_path_store(RNS_PATH_TABLE_SEGMENT_SIZE, RNS_PATH_TABLE_SEGMENT_COUNT);
+/*static*/ PathStore Transport::_route_store(RNS_ROUTE_TABLE_SEGMENT_SIZE, RNS_PATH_TABLE_SEGMENT_COUNT);
 #else
 /*static*/ PathStore Transport::_path_store;
+/*static*/ PathStore Transport::_route_store;
 #endif
-/*static*/ NewPathTable Transport::_new_path_table(Transport::_path_store);
+/*static*/ CachedPathTable Transport::_new_path_table(Transport::_path_store, Transport::_route_store);
 
 DestinationEntry empty_destination_entry;
 
@@ -244,8 +263,6 @@ DestinationEntry empty_destination_entry;
 	INFO("Transport starting...");
 	_owner = reticulum_instance;
 
-	_jobs_running = true;
-
 	// Wire size caps (no-op if already set via hashlist_maxsize()/max_pr_tags()
 	// setters before start()).
 	_packet_hash_store.set_max_recs(_hashlist_maxsize);
@@ -369,8 +386,6 @@ DestinationEntry empty_destination_entry;
 		ERRORF("The contained exception was: %s", e.what());
 	}
 
-	_jobs_running = false;
-
 	// Start job loops
 	// CBA Threading
 	//p thread = threading.Thread(target=Transport.jobloop, daemon=True)
@@ -392,10 +407,14 @@ DestinationEntry empty_destination_entry;
 #endif
 			TRACE("Initializing path table store...");
 			_path_store.init(Utilities::OS::get_filesystem(), "./path_store/", false, _path_store_segment_size, _path_store_segment_count);
+			TRACE("Initializing route summary store...");
+			_route_store.init(Utilities::OS::get_filesystem(), "./route_store/", false, 0, _path_store_segment_count);
 			// If the filesystem is full then clear the path store since it's of no use full anyway
 			if (Utilities::OS::get_filesystem().storageAvailable() > 0 && Utilities::OS::get_filesystem().storageAvailable() < 1024) {
 				WARNING("FileSystem is full, clearing existing path store");
 				_path_store.clear();
+				_route_store.clear();
+				_new_path_table.invalidate();
 			}
 		}
 #endif // RNS_USE_FS && RNS_PERSIST_PATHS
@@ -481,10 +500,92 @@ DestinationEntry empty_destination_entry;
 }
 
 /*static*/ void Transport::loop() {
+	process_ingress();
+	process_announce_queues();
 	if (OS::time() > (_jobs_last_run + _job_interval)) {
 		jobs();
 		_jobs_last_run = OS::time();
 	}
+	flush_interfaces();
+}
+
+/*static*/ void Transport::flush_interfaces() {
+	for (auto& interface : _interfaces) {
+		interface.process_egress();
+		interface.flush();
+	}
+}
+
+/*static*/ bool Transport::queue_inbound(const Bytes& raw, const Interface& interface) {
+	IngressFrame frame;
+	frame._raw = raw;
+	frame._interface = interface;
+	// Full queue drops the new frame, the sender will retransmit or the packet was expendable
+	if (!_ingress_queue.try_push(std::move(frame))) {
+		return false;
+	}
+	// Cut short any Reticulum::wait() so the frame is handled now
+	EventLoop::wake();
+	return true;
+}
+
+/*static*/ double Transport::next_loop_time() {
+	if (!_ingress_queue.empty()) {
+		return OS::time();
+	}
+	double next_time = _jobs_last_run + _job_interval;
+	if (!_announce_queue_deadlines.empty()) {
+		next_time = std::min(next_time, _announce_queue_deadlines.next_deadline());
+	}
+	for (const auto& interface : _interfaces) {
+		double egress_ready_at = interface.egress_ready_at();
+		if (egress_ready_at > 0) {
+			next_time = std::min(next_time, egress_ready_at);
+		}
+	}
+	return next_time;
+}
+
+/*static*/ void Transport::process_ingress() {
+	// At most one queue's worth per loop so producers outpacing us can't starve jobs
+	size_t count = _ingress_queue.capacity();
+	IngressFrame frame;
+	while (count-- > 0 && _ingress_queue.try_pop(frame)) {
+		if (!frame._interface) {
+			inbound(frame._raw, frame._interface);
+			continue;
+		}
+		frame._interface.process_queued_incoming(frame._raw);
+	}
+	// Release the last frame now rather than holding it until the next one arrives
+	frame = IngressFrame();
+}
+
+/*static*/ void Transport::process_announce_queues() {
+	InterfaceId interface_id;
+	while (_announce_queue_deadlines.pop_due(OS::time(), interface_id)) {
+		// Interface may have been deregistered since
+		Interface interface = find_interface_from_id(interface_id);
+		if (!interface) {
+			continue;
+		}
+		interface.announce_queue_scheduled(false);
+		interface.process_announce_queue();
+		if (!interface.announce_queue().empty()) {
+			schedule_announce_queue(interface);
+		}
+	}
+}
+
+// Entries removed from a table before their deadline stay queued until they come due, so once they
+// outnumber the live entries drop them all in one pass
+template <typename Table>
+static void prune_deadlines(Transport::DeadlineQueue& deadlines, const Table& table) {
+	if (deadlines.size() > (table.size() * 2) + 32) {
+		size_t pruned = deadlines.prune([&table](const Hash16& key) { return table.count(key) == 0; });
+		TRACEF("Pruned %zu stale deadlines", pruned);
+		(void)pruned;
+	}
 }
 
 /*static*/ void Transport::jobs() {
@@ -493,15 +594,15 @@ DestinationEntry empty_destination_entry;
 	std::vector<Packet> outgoing;
 	std::map<Bytes, Interface> path_requests;	// destination_hash -> blocked_interface ({NONE} = no interface to avoid)
 	int count;
-	_jobs_running = true;
 
 	try {
 		if (!_jobs_locked) {
 
 			// Process active and pending link lists
 			if (OS::time() > (_links_last_checked + _links_check_interval)) {
-				std::set<Link> pending_links(_pending_links);
-				for (auto& link : pending_links) {
+				for (auto pending_iter = _pending_links.begin(); pending_iter != _pending_links.end(); ) {
+					// Copy handle so the link outlives its index entry
+					Link link = (*pending_iter).second;
 					if (link.status() == Type::Link::CLOSED) {
 						// If we are not a Transport Instance, finding a pending link
 						// that was never activated will trigger an expiry of the path
@@ -528,13 +629,23 @@ DestinationEntry empty_destination_entry;
 							}
 						}
 
-						_pending_links.erase(link);
+						pending_iter = _pending_links.erase(pending_iter);
+					}
+					else {
+						++pending_iter;
 					}
 				}
-				std::set<Link> active_links(_active_links);
-				for (auto& link : active_links) {
-					if (link.status() == Type::Link::CLOSED) {
-						_active_links.erase(link);
+				// Snapshot surviving active links while culling closed ones, since
+				// resource callbacks below may register/activate links re-entrantly
+				std::vector<Link> active_links;
+				active_links.reserve(_active_links.size());
+				for (auto active_iter = _active_links.begin(); active_iter != _active_links.end(); ) {
+					if ((*active_iter).second.status() == Type::Link::CLOSED) {
+						active_iter = _active_links.erase(active_iter);
+					}
+					else {
+						active_links.push_back((*active_iter).second);
+						++active_iter;
 					}
 				}
 
@@ -542,11 +653,7 @@ DestinationEntry empty_destination_entry;
 				// retransmit/timeout retries depend on this — without it,
 				// a dropped resource part stalls the transfer forever
 				// (we never re-request the missing part, server gives up).
-				// const_cast mirrors the pattern used elsewhere when
-				// iterating std::set<Link> — the wrapper is const but
-				// shared_ptr-backed mutation is the codebase convention.
-				for (auto& link_const : active_links) {
-					Link& link = const_cast<Link&>(link_const);
+				for (auto& link : active_links) {
 					if (link.status() != Type::Link::CLOSED) {
 						link.tick_resources();
 					}
@@ -557,68 +664,100 @@ DestinationEntry empty_destination_entry;
 
 			// Process receipts list for timed-out packets
 			if (OS::time() > (_receipts_last_checked + _receipts_check_interval)) {
-				while (_receipts.size() > Type::Transport::MAX_RECEIPTS) {
+				// DIVERGENCE: Receipts closest to timing out are culled first rather than the oldest sent
+				Hash16 receipt_hash;
+				while (_receipts.size() > Type::Transport::MAX_RECEIPTS && _receipt_deadlines.pop_due(std::numeric_limits<double>::infinity(), receipt_hash)) {
 					//p culled_receipt = Transport.receipts.pop(0)
-					PacketReceipt culled_receipt = _receipts.front();
-					_receipts.pop_front();
+					auto iter = _receipts.find(receipt_hash);
+					if (iter == _receipts.end()) {
+						continue;
+					}
+					PacketReceipt culled_receipt = (*iter).second;
+					_receipts.erase(iter);
 					culled_receipt.set_timeout(-1);
 					culled_receipt.check_timeout();
 				}
 
-				std::list<PacketReceipt> cull_receipts;
-				for (auto& receipt : _receipts) {
+				// Only receipts whose timeout has passed are visited. Timeouts can be changed after
+				// sending, so one that has moved later is rescheduled.
+				while (_receipt_deadlines.pop_due(OS::time(), receipt_hash)) {
+					auto iter = _receipts.find(receipt_hash);
+					if (iter == _receipts.end()) {
+						continue;
+					}
+					// Copy handle since timeout callbacks may send packets and add receipts
+					PacketReceipt receipt = (*iter).second;
 					receipt.check_timeout();
 					if (receipt.status() != Type::PacketReceipt::SENT) {
 						//p if receipt in Transport.receipts:
 						//p 	Transport.receipts.remove(receipt)
-						cull_receipts.push_back(receipt);
+						remove_receipt(receipt);
+					}
+					else {
+						_receipt_deadlines.schedule(receipt_hash, receipt.sent_at() + receipt.timeout());
 					}
 				}
-				// CBA since modifying of collection while iterating is forbidden
-				for (auto& receipt : cull_receipts) {
-					_receipts.remove(receipt);
-				}
+				prune_deadlines(_receipt_deadlines, _receipts);
 
 				_receipts_last_checked = OS::time();
 			}
 
 			// Process announces needing retransmission
+			// Only announces whose retransmit timeout has passed are visited. Retries are only advanced
+			// here, so an announce that has completed is rescheduled to be removed on the next check.
 			if (OS::time() > (_announces_last_checked + _announces_check_interval)) {
-				std::vector<Bytes> completed_announces;
-				for (auto& [destination_hash, announce_entry] : _announce_table) {
+				auto announce_completed = [](const Hash16& destination_hash, const AnnounceEntry& announce_entry) {
 					if (announce_entry._retries > 0 && announce_entry._retries >= Type::Transport::LOCAL_REBROADCASTS_MAX) {
 						TRACEF("Completed announce processing for %s, local rebroadcast limit reached", destination_hash.toHex().c_str());
-						completed_announces.push_back(destination_hash);
+						return true;
 					}
 					else if (announce_entry._retries > Type::Transport::PATHFINDER_R) {
 						TRACEF("Completed announce processing for %s, retry limit reached", destination_hash.toHex().c_str());
-						completed_announces.push_back(destination_hash);
+						return true;
 					}
-					else {
-						if (OS::time() > announce_entry._retransmit_timeout) {
-							TRACEF("Performing announce processing for %s...", destination_hash.toHex().c_str());
-							announce_entry._retransmit_timeout = OS::time() + Type::Transport::PATHFINDER_G + Type::Transport::PATHFINDER_RW;
-							announce_entry._retries += 1;
-							Type::Packet::context_types announce_context = Type::Packet::CONTEXT_NONE;
-							if (announce_entry._block_rebroadcasts) {
-								announce_context = Type::Packet::PATH_RESPONSE;
-							}
-							//p announce_data = packet.data
-							Identity announce_identity(Identity::recall(announce_entry._packet.destination_hash()));
+					return false;
+				};
+				Hash16 destination_hash;
+				double retransmit_timeout;
+				while (_announce_deadlines.pop_due(OS::time(), destination_hash, retransmit_timeout)) {
+					auto announce_iter = _announce_table.find(destination_hash);
+					if (announce_iter == _announce_table.end()) {
+						continue;
+					}
+					AnnounceEntry& announce_entry = (*announce_iter).second;
+					if (announce_completed(destination_hash, announce_entry)) {
+						_announce_table.erase(announce_iter);
+						continue;
+					}
+					// Every retransmit timeout written is scheduled, so one that no longer matches is stale
+					if (announce_entry._retransmit_timeout != retransmit_timeout) {
+						continue;
+					}
+
+					TRACEF("Performing announce processing for %s...", destination_hash.toHex().c_str());
+					announce_entry._retransmit_timeout = OS::time() + Type::Transport::PATHFINDER_G + Type::Transport::PATHFINDER_RW;
+					announce_entry._retries += 1;
+					Type::Packet::context_types announce_context = Type::Packet::CONTEXT_NONE;
+					if (announce_entry._block_rebroadcasts) {
+						announce_context = Type::Packet::PATH_RESPONSE;
+					}
+					//p announce_data = packet.data
+					Identity announce_identity(Identity::recall(announce_entry._packet.destination_hash()));
 //TRACEF("announce_identity public_key: %s", announce_identity.get_public_key().toHex().c_str());
 //Destination test_destination(announce_identity, Type::Destination::OUT, Type::Destination::SINGLE, "rnstransport", "remote.management");
 //TRACEF("test_destination hash: %s", test_destination.hash().toHex().c_str());
 
-							if (!announce_identity) {
-								DEBUGF("Completed announce processing for %s, the path was cleaned while waiting for announce rebroadcast", destination_hash.toHex().c_str());
-								completed_announces.push_back(destination_hash);
-							}
-							else {
-								// CBA TODO Check the following destination creation against the ref impl
-								//Destination announce_destination(announce_identity, Type::Destination::OUT, Type::Destination::SINGLE, "unknown", "unknown");
-								//announce_destination.hash(announce_entry._packet.destination_hash());
-								Destination announce_destination(announce_identity, Type::Destination::OUT, Type::Destination::SINGLE, announce_entry._packet.destination_hash());
-								//P announce_destination.hexhash = announce_destination.hash.hex()
+					if (!announce_identity) {
+						DEBUGF("Completed announce processing for %s, the path was cleaned while waiting for announce rebroadcast", destination_hash.toHex().c_str());
+						_announce_table.erase(announce_iter);
+						continue;
+					}
+
+					// CBA TODO Check the following destination creation against the ref impl
+					//Destination announce_destination(announce_identity, Type::Destination::OUT, Type::Destination::SINGLE, "unknown", "unknown");
+					//announce_destination.hash(announce_entry._packet.destination_hash());
+					Destination announce_destination(announce_identity, Type::Destination::OUT, Type::Destination::SINGLE, announce_entry._packet.destination_hash());
+					//P announce_destination.hexhash = announce_destination.hash.hex()
 TRACEF("announce_destination: %s", announce_destination.hash().toHex().c_str());
 
 //if (announce_entry._attached_interface) {
@@ -626,55 +765,55 @@ TRACEF("announce_destination: %s", announce_destination.hash().toHex().c_str());
 //TRACEF("[1] interface: %s", announce_entry._attached_interface.debugString().c_str());
 //TRACEF("[1] interface: %s", announce_entry._attached_interface.toString().c_str());
 //}
-								Packet new_packet = Packet(announce_destination, announce_entry._packet.data())
-									.attached_interface(announce_entry._attached_interface)
-									.packet_type(Type::Packet::ANNOUNCE)
-									.context(announce_context)
-									.transport_type(Type::Transport::TRANSPORT)
-									.header_type(Type::Packet::HEADER_2)
-									.transport_id(Transport::_identity.hash())
-									.context_flag(announce_entry._packet.context_flag());
-
-								new_packet.hops(announce_entry._hops);
-								if (announce_entry._block_rebroadcasts) {
-									DEBUGF("Rebroadcasting announce as path response for %s with hop count %d", announce_destination.hash().toHex().c_str(), new_packet.hops());
-								}
-								else {
-									DEBUGF("Rebroadcasting announce for %s with hop count %d", announce_destination.hash().toHex().c_str(), new_packet.hops());
-								}
+					Packet new_packet = Packet(announce_destination, announce_entry._packet.data())
+						.attached_interface(announce_entry._attached_interface)
+						.packet_type(Type::Packet::ANNOUNCE)
+						.context(announce_context)
+						.transport_type(Type::Transport::TRANSPORT)
+						.header_type(Type::Packet::HEADER_2)
+						.transport_id(Transport::_identity.hash())
+						.context_flag(announce_entry._packet.context_flag());
+
+					new_packet.hops(announce_entry._hops);
+					if (announce_entry._block_rebroadcasts) {
+						DEBUGF("Rebroadcasting announce as path response for %s with hop count %d", announce_destination.hash().toHex().c_str(), new_packet.hops());
+					}
+					else {
+						DEBUGF("Rebroadcasting announce for %s with hop count %d", announce_destination.hash().toHex().c_str(), new_packet.hops());
+					}
 
-								outgoing.push_back(new_packet);
-
-								// This handles an edge case where a peer sends a past
-								// request for a destination just after an announce for
-								// said destination has arrived, but before it has been
-								// rebroadcast locally. In such a case the actual announce
-								// is temporarily held, and then reinserted when the path
-								// request has been served to the peer.
-								//p if destination_hash in Transport.held_announces:
-								auto iter =_held_announces.find(destination_hash);
-								if (iter != _held_announces.end()) {
-									//p held_entry = Transport.held_announces.pop(destination_hash)
-									auto held_entry = (*iter).second;
-									_held_announces.erase(iter);
-									//p Transport.announce_table[destination_hash] = held_entry
-									//_announce_table[destination_hash] = held_entry;
-									//_announce_table.insert_or_assign({destination_hash, held_entry});
-									_announce_table.erase(destination_hash);
-									// CBA ACCUMULATES
-									_announce_table.insert({destination_hash, held_entry});
-									DEBUG("Reinserting held announce into table");
-									// CBA IMMEDIATE CULL
-									cull_announce_table();
-								}
-							}
-						}
+					outgoing.push_back(std::move(new_packet));
+
+					_announce_deadlines.schedule(destination_hash, announce_entry._retransmit_timeout);
+					if (announce_completed(destination_hash, announce_entry)) {
+						_announce_deadlines.schedule(destination_hash, OS::time());
 					}
-				}
 
-				for (const auto& destination_hash : completed_announces) {
-					_announce_table.erase(destination_hash);
+					// This handles an edge case where a peer sends a past
+					// request for a destination just after an announce for
+					// said destination has arrived, but before it has been
+					// rebroadcast locally. In such a case the actual announce
+					// is temporarily held, and then reinserted when the path
+					// request has been served to the peer.
+					//p if destination_hash in Transport.held_announces:
+					auto iter =_held_announces.find(destination_hash);
+					if (iter != _held_announces.end()) {
+						//p held_entry = Transport.held_announces.pop(destination_hash)
+						auto held_entry = (*iter).second;
+						_held_announces.erase(iter);
+						//p Transport.announce_table[destination_hash] = held_entry
+						//_announce_table[destination_hash] = held_entry;
+						//_announce_table.insert_or_assign({destination_hash, held_entry});
+						_announce_table.erase(destination_hash);
+						// CBA ACCUMULATES
+						_announce_table.insert({destination_hash, held_entry});
+						_announce_deadlines.schedule(destination_hash, held_entry._retransmit_timeout);
+						DEBUG("Reinserting held announce into table");
+						// CBA IMMEDIATE CULL
+						cull_announce_table();
+					}
 				}
+				prune_deadlines(_announce_deadlines, _announce_table);
 
 				_announces_last_checked = OS::time();
 			}
@@ -687,7 +826,7 @@ TRACEF("announce_destination: %s", announce_destination.hash().toHex().c_str());
 			if (OS::time() > (_pending_prs_last_checked + _pending_prs_check_interval)) {
 				std::vector<Bytes> stale_local_prs;
 				for (auto& [destination_hash, interface] : _pending_local_path_requests) {
-					if (!find_interface_from_hash(destination_hash)) {
+					if (!find_interface_from_hash(interface.get_hash())) {
 						stale_local_prs.push_back(destination_hash);
 					}
 				}
@@ -701,206 +840,230 @@ TRACEF("announce_destination: %s", announce_destination.hash().toHex().c_str());
 			// Cull the path request tags list if it has reached its max size
 			// CBA Culling no longer necessary since switch to GenerationalSet<>
 
-			if (OS::time() > (_tables_last_culled + _tables_cull_interval)) {
+			// Expire timed table entries
+			// Entries register their deadline when inserted, so only entries that are actually due are
+			// visited here instead of sweeping the tables every _tables_cull_interval.
 
-                // Remove unneeded path state entries
-				try {
-					std::vector<Bytes> stale_path_states;
-					stale_path_states.reserve(_path_states.size());
-					for (const auto& [destination_hash, state] : _path_states) {
-						if (!_new_path_table.exists(destination_hash)) {
-							stale_path_states.push_back(destination_hash);
-						}
-					}
-					for (const Bytes& destination_hash : stale_path_states) {
-						_path_states.erase(destination_hash);
+			// Cull the reverse table according to timeout
+			try {
+				std::vector<Bytes> stale_reverse_entries;
+				Hash16 packet_hash;
+				double deadline;
+				while (_reverse_deadlines.pop_due(OS::time(), packet_hash, deadline)) {
+					auto reverse_iter = _reverse_table.find(packet_hash);
+					if (reverse_iter != _reverse_table.end() && ((*reverse_iter).second._timestamp + REVERSE_TIMEOUT) == deadline) {
+						stale_reverse_entries.push_back(packet_hash);
 					}
 				}
-				catch (const std::bad_alloc&) {
-					ERROR("jobs: bad_alloc - out of memory culling path states");
-				}
-				catch (const std::exception& e) {
-					ERRORF("jobs: failed to cull path states: %s", e.what());
-				}
+				remove_reverse_entries(stale_reverse_entries);
+				prune_deadlines(_reverse_deadlines, _reverse_table);
+			}
+			catch (const std::bad_alloc&) {
+				ERROR("jobs: bad_alloc - out of memory culling reverse table");
+			}
+			catch (const std::exception& e) {
+				ERRORF("jobs: failed to cull reverse table: %s", e.what());
+			}
 
-				// Cull the reverse table according to timeout
-				try {
-					std::vector<Bytes> stale_reverse_entries;
-					stale_reverse_entries.reserve(_reverse_table.size());
-					for (const auto& [packet_hash, reverse_entry] : _reverse_table) {
-						if (OS::time() > (reverse_entry._timestamp + REVERSE_TIMEOUT)) {
-							stale_reverse_entries.push_back(packet_hash);
-						}
+			// Cull the link table according to timeout
+			try {
+				std::vector<Bytes> stale_links;
+				Hash16 link_id;
+				while (_link_deadlines.pop_due(OS::time(), link_id)) {
+					auto link_iter = _link_table.find(link_id);
+					if (link_iter == _link_table.end()) {
+						continue;
 					}
-					remove_reverse_entries(stale_reverse_entries);
-				}
-				catch (const std::bad_alloc&) {
-					ERROR("jobs: bad_alloc - out of memory culling reverse table");
-				}
-				catch (const std::exception& e) {
-					ERRORF("jobs: failed to cull reverse table: %s", e.what());
-				}
+					const LinkEntry& link_entry = (*link_iter).second;
+					// Link timestamps are refreshed by traffic and validation replaces the proof timeout
+					// with the link timeout, so the deadline is recomputed and rescheduled if it moved
+					double deadline = link_entry._validated ? (link_entry._timestamp + LINK_TIMEOUT) : link_entry._proof_timeout;
+					if (!(OS::time() > deadline)) {
+						_link_deadlines.schedule(link_id, deadline);
+						continue;
+					}
+					// A link reinserted under the same id may be queued more than once
+					if (std::find(stale_links.begin(), stale_links.end(), link_id.bytes()) != stale_links.end()) {
+						continue;
+					}
+					if (link_entry._validated) {
+						TRACEF("Culling link %s due to link timeout", link_entry._destination_hash.toHex().c_str());
+						stale_links.push_back(link_id);
+					}
+					else {
+						TRACEF("Culling link %s due to proof timeout", link_entry._destination_hash.toHex().c_str());
+						stale_links.push_back(link_id);
 
-				// Cull the link table according to timeout
-				try {
-					std::vector<Bytes> stale_links;
-					stale_links.reserve(_link_table.size());
-					for (const auto& [link_id, link_entry] : _link_table) {
-						if (link_entry._validated) {
-							if (OS::time() > (link_entry._timestamp + LINK_TIMEOUT)) {
-								TRACEF("Culling link %s due to link timeout", link_entry._destination_hash.toHex().c_str());
-								stale_links.push_back(link_id);
-							}
+						double last_path_request = 0.0;
+						const auto& iter = _path_requests.find(link_entry._destination_hash);
+						if (iter != _path_requests.end()) {
+							last_path_request = (*iter).second;
 						}
-						else {
-							if (OS::time() > link_entry._proof_timeout) {
-								TRACEF("Culling link %s due to proof timeout", link_entry._destination_hash.toHex().c_str());
-								stale_links.push_back(link_id);
-
-								double last_path_request = 0.0;
-								const auto& iter = _path_requests.find(link_entry._destination_hash);
-								if (iter != _path_requests.end()) {
-									last_path_request = (*iter).second;
-								}
 TRACEF("last_path_request=%f", last_path_request);
 
-								uint8_t lr_taken_hops = link_entry._hops;
+						uint8_t lr_taken_hops = link_entry._hops;
 TRACEF("lr_taken_hops=%u", lr_taken_hops);
 
-								bool path_request_throttle = (OS::time() - last_path_request) < PATH_REQUEST_MI;
-								bool path_request_conditions = false;
-								Interface blocked_if{Type::NONE};
+						bool path_request_throttle = (OS::time() - last_path_request) < PATH_REQUEST_MI;
+						bool path_request_conditions = false;
+						Interface blocked_if{Type::NONE};
 TRACEF("path_request_throttle=%u", path_request_throttle);
 
-								// If the path has been invalidated between the time of
-								// making the link request and now, try to rediscover it
-								if (!has_path(link_entry._destination_hash)) {
-									DEBUGF("Trying to rediscover path for %s since an attempted link was never established, and path is now missing", link_entry._destination_hash.toHex().c_str());
-									path_request_conditions = true;
-								}
+						// If the path has been invalidated between the time of
+						// making the link request and now, try to rediscover it
+						if (!has_path(link_entry._destination_hash)) {
+							DEBUGF("Trying to rediscover path for %s since an attempted link was never established, and path is now missing", link_entry._destination_hash.toHex().c_str());
+							path_request_conditions = true;
+						}
 
-								// If this link request was originated from a local client
-								// attempt to rediscover a path to the destination, if this
-								// has not already happened recently.
-								else if (!path_request_throttle && lr_taken_hops == 0) {
-									DEBUGF("Trying to rediscover path for %s since an attempted local client link was never established", link_entry._destination_hash.toHex().c_str());
-									path_request_conditions = true;
-								}
+						// If this link request was originated from a local client
+						// attempt to rediscover a path to the destination, if this
+						// has not already happened recently.
+						else if (!path_request_throttle && lr_taken_hops == 0) {
+							DEBUGF("Trying to rediscover path for %s since an attempted local client link was never established", link_entry._destination_hash.toHex().c_str());
+							path_request_conditions = true;
+						}
 
-								// If the link destination was previously only 1 hop
-								// away, this likely means that it was local to one
-								// of our interfaces, and that it roamed somewhere else.
-								// In that case, try to discover a new path, and mark
-								// the old one as unresponsive.
-								else if (!path_request_throttle && hops_to(link_entry._destination_hash) == 1) {
-									DEBUGF("Trying to rediscover path for %s since an attempted link was never established, and destination was previously local to an interface on this instance", link_entry._destination_hash.toHex().c_str());
-									path_request_conditions = true;
-									blocked_if = link_entry._receiving_interface;
-
-									if (Reticulum::transport_enabled()) {
-										if (link_entry._receiving_interface && link_entry._receiving_interface.mode() != Type::Interface::MODE_BOUNDARY) {
-											TRACEF("Marking link destination %s unresponsive", link_entry._destination_hash.toHex().c_str());
-											mark_path_unresponsive(link_entry._destination_hash);
-										}
-									}
+						// If the link destination was previously only 1 hop
+						// away, this likely means that it was local to one
+						// of our interfaces, and that it roamed somewhere else.
+						// In that case, try to discover a new path, and mark
+						// the old one as unresponsive.
+						else if (!path_request_throttle && hops_to(link_entry._destination_hash) == 1) {
+							DEBUGF("Trying to rediscover path for %s since an attempted link was never established, and destination was previously local to an interface on this instance", link_entry._destination_hash.toHex().c_str());
+							path_request_conditions = true;
+							blocked_if = link_entry.receiving_interface();
+
+							if (Reticulum::transport_enabled()) {
+								if (blocked_if && blocked_if.mode() != Type::Interface::MODE_BOUNDARY) {
+									TRACEF("Marking link destination %s unresponsive", link_entry._destination_hash.toHex().c_str());
+									mark_path_unresponsive(link_entry._destination_hash);
 								}
+							}
+						}
 
-								// If the link initiator is only 1 hop away,
-								// this likely means that network topology has
-								// changed. In that case, we try to discover a new path,
-								// and mark the old one as potentially unresponsive.
-								else if ( !path_request_throttle and lr_taken_hops == 1) {
-									DEBUGF("Trying to rediscover path for %s since an attempted link was never established, and link initiator is local to an interface on this instance", link_entry._destination_hash.toHex().c_str());
-									path_request_conditions = true;
-									blocked_if = link_entry._receiving_interface;
-
-									if (Reticulum::transport_enabled()) {
-										if (link_entry._receiving_interface && link_entry._receiving_interface.mode() != Type::Interface::MODE_BOUNDARY) {
-											TRACEF("Marking link destination %s unresponsive", link_entry._destination_hash.toHex().c_str());
-											mark_path_unresponsive(link_entry._destination_hash);
-										}
-									}
+						// If the link initiator is only 1 hop away,
+						// this likely means that network topology has
+						// changed. In that case, we try to discover a new path,
+						// and mark the old one as potentially unresponsive.
+						else if ( !path_request_throttle and lr_taken_hops == 1) {
+							DEBUGF("Trying to rediscover path for %s since an attempted link was never established, and link initiator is local to an interface on this instance", link_entry._destination_hash.toHex().c_str());
+							path_request_conditions = true;
+							blocked_if = link_entry.receiving_interface();
+
+							if (Reticulum::transport_enabled()) {
+								if (blocked_if && blocked_if.mode() != Type::Interface::MODE_BOUNDARY) {
+									TRACEF("Marking link destination %s unresponsive", link_entry._destination_hash.toHex().c_str());
+									mark_path_unresponsive(link_entry._destination_hash);
 								}
+							}
+						}
 
 #if RNS_EXPIRE_UNRESPONSIVE_PATHS
-								// DIVERGENCE: If proof timeout occurs when a path is already marked UNRESPONSIVE
-								// then force replacement of the path
-								if (!path_request_conditions && path_is_unresponsive(link_entry._destination_hash)) {
-									DEBUGF("Trying to rediscover path for %s since an attempted local client link was never established and the path is already marked unresponsive", link_entry._destination_hash.toHex().c_str());
-									path_request_conditions = true;
-								}
+						// DIVERGENCE: If proof timeout occurs when a path is already marked UNRESPONSIVE
+						// then force replacement of the path
+						if (!path_request_conditions && path_is_unresponsive(link_entry._destination_hash)) {
+							DEBUGF("Trying to rediscover path for %s since an attempted local client link was never established and the path is already marked unresponsive", link_entry._destination_hash.toHex().c_str());
+							path_request_conditions = true;
+						}
 #endif
 
 #if RNS_NEIGHBOR_PROBING
-								// DIVERGENCE: The next-hop is suspicious if proofs fail, so schedule a probe
-								// CBA TODO: Make a failed proof just another data point that heuristics use to decide if/when to probe
-								INFOF("Neighbor probe: classifying %s as suspicious due to link failure", link_entry._next_hop.toHex().c_str());
-								_dispatch_neighbor_probe(link_entry._next_hop);
+						// DIVERGENCE: The next-hop is suspicious if proofs fail, so schedule a probe
+						// CBA TODO: Make a failed proof just another data point that heuristics use to decide if/when to probe
+						INFOF("Neighbor probe: classifying %s as suspicious due to link failure", link_entry._next_hop.toHex().c_str());
+						_dispatch_neighbor_probe(link_entry._next_hop);
 #endif
 
 TRACEF("path_request_conditions=%u", path_request_conditions);
-								if (path_request_conditions) {
-									if (path_requests.count(link_entry._destination_hash) == 0) {
-										path_requests.emplace(link_entry._destination_hash, blocked_if);
-									}
+						if (path_request_conditions) {
+							if (path_requests.count(link_entry._destination_hash) == 0) {
+								path_requests.emplace(link_entry._destination_hash, blocked_if);
+							}
 
-									if (!Reticulum::transport_enabled()) {
-										// Drop current path if we are not a transport instance, to
-										// allow using higher-hop count paths or reused announces
-										// from newly adjacent transport instances.
-										TRACEF("Expiring link %s", link_entry._destination_hash.toHex().c_str());
-										expire_path(link_entry._destination_hash);
-									}
-								}
+							if (!Reticulum::transport_enabled()) {
+								// Drop current path if we are not a transport instance, to
+								// allow using higher-hop count paths or reused announces
+								// from newly adjacent transport instances.
+								TRACEF("Expiring link %s", link_entry._destination_hash.toHex().c_str());
+								expire_path(link_entry._destination_hash);
 							}
 						}
 					}
-					remove_links(stale_links);
 				}
-				catch (const std::bad_alloc&) {
-					ERROR("jobs: bad_alloc - out of memory culling link table");
-				}
-				catch (const std::exception& e) {
-					ERRORF("jobs: failed to cull link table: %s", e.what());
-				}
-
-				// Cull the path table
-				// CBA microStore
-				// CBA Culling of path table no longer necessary since switch to microStore
+				remove_links(stale_links);
+				prune_deadlines(_link_deadlines, _link_table);
+			}
+			catch (const std::bad_alloc&) {
+				ERROR("jobs: bad_alloc - out of memory culling link table");
+			}
+			catch (const std::exception& e) {
+				ERRORF("jobs: failed to cull link table: %s", e.what());
+			}
 
-                // Cull the pending path requests table
-				try {
-					std::vector<Bytes> stale_path_requests;
-					for (const auto& [destination_hash, timestamp] : _path_requests) {
-						if (OS::time() > (timestamp + PATH_REQUEST_GATE_TIMEOUT)) {
-							stale_path_requests.push_back(destination_hash);
-						}
-					}
-					for (const Bytes& destination_hash : stale_path_requests) {
-						_path_requests.erase(destination_hash);
+			// Cull the pending path requests table
+			try {
+				Hash16 destination_hash;
+				double deadline;
+				while (_path_request_deadlines.pop_due(OS::time(), destination_hash, deadline)) {
+					// Every request time written is scheduled, so only the latest one for a destination matches
+					auto request_iter = _path_requests.find(destination_hash);
+					if (request_iter != _path_requests.end() && ((*request_iter).second + PATH_REQUEST_GATE_TIMEOUT) == deadline) {
+						_path_requests.erase(request_iter);
 					}
 				}
-				catch (const std::exception& e) {
-					ERRORF("jobs: failed to cull path requests: %s", e.what());
+				prune_deadlines(_path_request_deadlines, _path_requests);
+			}
+			catch (const std::exception& e) {
+				ERRORF("jobs: failed to cull path requests: %s", e.what());
+			}
+
+			// Cull the pending discovery path requests table
+			try {
+				std::vector<Bytes> stale_discovery_path_requests;
+				Hash16 destination_hash;
+				double deadline;
+				while (_discovery_pr_deadlines.pop_due(OS::time(), destination_hash, deadline)) {
+					auto pr_iter = _discovery_path_requests.find(destination_hash);
+					if (pr_iter != _discovery_path_requests.end() && (*pr_iter).second._timeout == deadline) {
+						stale_discovery_path_requests.push_back(destination_hash);
+						DEBUGF("Waiting path request for %s timed out and was removed", destination_hash.toHex().c_str());
+					}
 				}
+				remove_discovery_path_requests(stale_discovery_path_requests);
+				prune_deadlines(_discovery_pr_deadlines, _discovery_path_requests);
+			}
+			catch (const std::bad_alloc&) {
+				ERROR("jobs: bad_alloc - out of memory culling discovery path requests");
+			}
+			catch (const std::exception& e) {
+				ERRORF("jobs: failed to cull discovery path requests: %s", e.what());
+			}
+
+			// Cull the path table
+			// CBA microStore
+			// CBA Culling of path table no longer necessary since switch to microStore
+
+			if (OS::time() > (_tables_last_culled + _tables_cull_interval)) {
 
-				// Cull the pending discovery path requests table
+                // Remove unneeded path state entries
 				try {
-					std::vector<Bytes> stale_discovery_path_requests;
-					stale_discovery_path_requests.reserve(_discovery_path_requests.size());
-					for (const auto& [destination_hash, path_entry] : _discovery_path_requests) {
-						if (OS::time() > path_entry._timeout) {
-							stale_discovery_path_requests.push_back(destination_hash);
-							DEBUGF("Waiting path request for %s timed out and was removed", destination_hash.toHex().c_str());
+					std::vector<Bytes> stale_path_states;
+					stale_path_states.reserve(_path_states.size());
+					for (const auto& [destination_hash, state] : _path_states) {
+						if (!_new_path_table.exists(destination_hash)) {
+							stale_path_states.push_back(destination_hash);
 						}
 					}
-					remove_discovery_path_requests(stale_discovery_path_requests);
+					for (const Bytes& destination_hash : stale_path_states) {
+						_path_states.erase(destination_hash);
+					}
 				}
 				catch (const std::bad_alloc&) {
-					ERROR("jobs: bad_alloc - out of memory culling discovery path requests");
+					ERROR("jobs: bad_alloc - out of memory culling path states");
 				}
 				catch (const std::exception& e) {
-					ERRORF("jobs: failed to cull discovery path requests: %s", e.what());
+					ERRORF("jobs: failed to cull path states: %s", e.what());
 				}
 
 				// Cull the tunnel table
@@ -1040,8 +1203,6 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 		ERRORF("The contained exception was: %s", e.what());
 	}
 
-	_jobs_running = false;
-
 	// CBA send announce retransmission packets
 	for (auto& packet : outgoing) {
 		packet.send();
@@ -1102,45 +1263,24 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 		}
 	}
 	try {
+		// Shaped interfaces hold packets by priority class, sending them as their bitrate allows
+		if (interface.egress_shaping()) {
+			Type::Interface::egress_classes egress_class = egress_class_of(raw);
+			if (interface.ifac_identity()) {
+				if (ifac_mask(interface, raw, _ifac_buffer)) {
+					sent = interface.queue_outgoing(_ifac_buffer, egress_class);
+				}
+			}
+			else {
+				sent = interface.queue_outgoing(raw, egress_class);
+			}
+		}
 		//if hasattr(interface, "ifac_identity") and interface.ifac_identity != None:
-		if (interface.ifac_identity()) {
-// TODO
-/*p
-			// Calculate packet access code
-			ifac = interface.ifac_identity.sign(raw)[-interface.ifac_size:]
-
-			// Generate mask
-			mask = RNS.Cryptography.hkdf(
-				length=len(raw)+interface.ifac_size,
-				derive_from=ifac,
-				salt=interface.ifac_key,
-				context=None,
-			)
-
-			// Set IFAC flag
-			new_header = bytes([raw[0] | 0x80, raw[1]])
-
-			// Assemble new payload with IFAC
-			new_raw    = new_header+ifac+raw[2:]
-			
-			// Mask payload
-			i = 0; masked_raw = b""
-			for byte in new_raw:
-				if i == 0:
-					// Mask first header byte, but make sure the
-					// IFAC flag is still set
-					masked_raw += bytes([byte ^ mask[i] | 0x80])
-				elif i == 1 or i > interface.ifac_size+1:
-					// Mask second header byte and payload
-					masked_raw += bytes([byte ^ mask[i]])
-				else:
-					// Don't mask the IFAC itself
-					masked_raw += bytes([byte])
-				i += 1
-
-			// Send it
-			sent = interface.on_outgoing(masked_raw)
-*/
+		else if (interface.ifac_identity()) {
+			// Reuses the buffer unless the interface still holds the previous packet
+			if (ifac_mask(interface, raw, _ifac_buffer)) {
+				sent = interface.send_outgoing(_ifac_buffer);
+			}
 		}
 		else {
 			sent = interface.send_outgoing(raw);
@@ -1152,6 +1292,117 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 	return sent;
 }
 
+/*static*/ Type::Interface::egress_classes Transport::egress_class_of(const Bytes& raw) {
+	using namespace Type::Interface;
+	const uint8_t* data = raw.data();
+	// Flags and hops, transport id for HEADER_2, then destination hash and context
+	size_t context_offset = 2 + Type::Reticulum::DESTINATION_LENGTH;
+	if (raw.size() > 0 && ((data[0] >> 6) & 0x01) == Type::Packet::HEADER_2) {
+		context_offset += Type::Reticulum::DESTINATION_LENGTH;
+	}
+	if (raw.size() <= context_offset) {
+		return EGRESS_LINK_DATA;
+	}
+	uint8_t packet_type = data[0] & 0x03;
+	uint8_t destination_type = (data[0] >> 2) & 0x03;
+	switch (packet_type) {
+	case Type::Packet::ANNOUNCE:
+		return EGRESS_ANNOUNCE;
+	case Type::Packet::LINKREQUEST:
+	case Type::Packet::PROOF:
+		return EGRESS_LINK_CONTROL;
+	default:
+		break;
+	}
+	if (destination_type == Type::Destination::LINK) {
+		switch (data[context_offset]) {
+		case Type::Packet::KEEPALIVE:
+		case Type::Packet::LINKIDENTIFY:
+		case Type::Packet::LINKCLOSE:
+		case Type::Packet::LRRTT:
+			return EGRESS_LINK_CONTROL;
+		default:
+			return EGRESS_LINK_DATA;
+		}
+	}
+	if (destination_type == Type::Destination::PLAIN) {
+		const Bytes destination_hash(data + context_offset - Type::Reticulum::DESTINATION_LENGTH, Type::Reticulum::DESTINATION_LENGTH);
+		if (_control_hashes.find(destination_hash) != _control_hashes.end()) {
+			return EGRESS_PATH_REQUEST;
+		}
+	}
+	return EGRESS_LINK_DATA;
+}
+
+/*static*/ bool Transport::ifac_mask(const Interface& interface, const Bytes& raw, Bytes& masked) {
+	size_t ifac_size = interface.ifac_size();
+	if (raw.size() < 2 || ifac_size == 0) {
+		return false;
+	}
+
+	//p ifac = interface.ifac_identity.sign(raw)[-interface.ifac_size:]
+	const Bytes signature = interface.ifac_identity().sign(raw);
+	const uint8_t* ifac = signature.data() + signature.size() - ifac_size;
+
+	//p mask = RNS.Cryptography.hkdf(length=len(raw)+interface.ifac_size, derive_from=ifac, salt=interface.ifac_key, context=None)
+	size_t length = raw.size() + ifac_size;
+	uint8_t* mask = _ifac_mask.writable(length);
+	interface.ifac_hkdf().derive(mask, length, ifac, ifac_size);
+
+	//p new_header = bytes([raw[0] | 0x80, raw[1]])
+	//p new_raw    = new_header+ifac+raw[2:]
+	// Assembled and masked in a single pass. The first header byte is masked but keeps the IFAC
+	// flag set, the IFAC itself isn't masked.
+	const uint8_t* data = raw.data();
+	uint8_t* out = masked.writable(length);
+	out[0] = ((data[0] | 0x80) ^ mask[0]) | 0x80;
+	out[1] = data[1] ^ mask[1];
+	memcpy(out + 2, ifac, ifac_size);
+	out += ifac_size;
+	mask += ifac_size;
+	for (size_t i = 2; i < raw.size(); ++i) {
+		out[i] = data[i] ^ mask[i];
+	}
+	return true;
+}
+
+/*static*/ bool Transport::ifac_unmask(const Interface& interface, const Bytes& raw, Bytes& unmasked) {
+	size_t ifac_size = interface.ifac_size();
+	const uint8_t* data = raw.data();
+	//p if raw[0] & 0x80 == 0x80:
+	if (raw.size() < 2 || (data[0] & 0x80) != 0x80) {
+		// If the IFAC flag is not set, but should be, drop the packet
+		return false;
+	}
+	//p if len(raw) > 2+interface.ifac_size:
+	if (ifac_size == 0 || raw.size() <= 2 + (size_t)ifac_size) {
+		return false;
+	}
+
+	//p ifac = raw[2:2+interface.ifac_size]
+	const uint8_t* ifac = data + 2;
+
+	//p mask = RNS.Cryptography.hkdf(length=len(raw), derive_from=ifac, salt=interface.ifac_key, context=None)
+	uint8_t* mask = _ifac_mask.writable(raw.size());
+	interface.ifac_hkdf().derive(mask, raw.size(), ifac, ifac_size);
+
+	//p new_header = bytes([raw[0] & 0x7f, raw[1]])
+	//p new_raw = new_header+raw[2+interface.ifac_size:]
+	// Unmasked in a single pass straight into the packet without the IFAC, with the flag cleared
+	size_t length = raw.size() - ifac_size;
+	uint8_t* out = unmasked.writable(length);
+	out[0] = (data[0] ^ mask[0]) & 0x7f;
+	out[1] = data[1] ^ mask[1];
+	for (size_t i = 2 + ifac_size; i < raw.size(); ++i) {
+		out[i - ifac_size] = data[i] ^ mask[i];
+	}
+
+	//p expected_ifac = interface.ifac_identity.sign(new_raw)[-interface.ifac_size:]
+	const Bytes signature = interface.ifac_identity().sign(unmasked);
+	//p if ifac == expected_ifac:
+	return memcmp(signature.data() + signature.size() - ifac_size, ifac, ifac_size) == 0;
+}
+
 /*static*/ bool Transport::outbound(Packet& packet) {
 	TRACE("Transport::outbound()");
 	++_packets_sent;
@@ -1167,11 +1418,9 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 	else TRACE("Transport::outbound: packet transport=n/a");
 	TRACEF("Transport::outbound: packet hash=%s", packet.packet_hash().toHex().c_str());
 
-	if (_jobs_running) DEBUG("Transport::outbound: jobs still running!");
-	while (_jobs_running) {
-		//TRACE("Transport::outbound: sleeping...");
-		OS::sleep(0.0005);
-	}
+	// DIVERGENCE: Python sleeps here while jobs() runs on its own thread. jobs(), inbound() and
+	// outbound() all run on the Reticulum thread, interface threads hand frames over through
+	// queue_inbound(), so there is nothing to wait for.
 	_jobs_locked = true;
 
 	bool sent = false;
@@ -1181,12 +1430,13 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
     //if packet.packet_type != RNS.Packet.ANNOUNCE and packet.destination.type != RNS.Destination.PLAIN and packet.destination.type != RNS.Destination.GROUP and packet.destination_hash in Transport.destination_table:
 	// CBA microStore
 	//auto& destination_entry = get_path(packet.destination_hash());
-	DestinationEntry destination_entry;
-	_new_path_table.get(packet.destination_hash(), destination_entry);
-	if (packet.packet_type() != Type::Packet::ANNOUNCE && packet.destination().type() != Type::Destination::PLAIN && packet.destination().type() != Type::Destination::GROUP && destination_entry) {
+	// Only routing fields are needed here, avoid decoding the full path entry
+	RouteSummary route;
+	_new_path_table.get_route(packet.destination_hash(), route);
+	if (packet.packet_type() != Type::Packet::ANNOUNCE && packet.destination().type() != Type::Destination::PLAIN && packet.destination().type() != Type::Destination::GROUP && route) {
 		TRACE("Transport::outbound: Path to destination is known");
         //outbound_interface = Transport.destination_table[packet.destination_hash][5]
-		Interface outbound_interface = destination_entry.receiving_interface();
+		Interface outbound_interface = route.receiving_interface();
 
 		// If there's more than one hop to the destination, and we know
 		// a path, we insert the packet into transport by adding the next
@@ -1194,7 +1444,7 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 		// This rule applies both for "normal" transport, and when connected
 		// to a local shared Reticulum instance.
         //if Transport.destination_table[packet.destination_hash][2] > 1:
-		if (destination_entry._hops > 1) {
+		if (route._hops > 1) {
 			TRACE("Forwarding packet to next closest interface...");
 			if (packet.header_type() == Type::Packet::HEADER_1) {
 				// Insert packet into transport
@@ -1208,16 +1458,16 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 				//new_raw += packet.raw[1:2]
 				new_raw << packet.raw().mid(1,1);
 				//new_raw += Transport.destination_table[packet.destination_hash][1]
-				new_raw << destination_entry._received_from;
+				new_raw << route._received_from;
 				//new_raw += packet.raw[2:]
 				new_raw << packet.raw().mid(2);
 				sent = transmit(outbound_interface, new_raw);
 				//_path_table[packet.destination_hash][0] = time.time()
-				destination_entry._timestamp = OS::time();
+				route._timestamp = OS::time();
 #if RNS_NEIGHBOR_PROBING
 				// DIVERGENCE: count packets forwarded through this
 				// neighbor for passive liveness inference.
-				if (sent) _record_neighbor_packet(destination_entry._received_from);
+				if (sent) _record_neighbor_packet(route._received_from);
 #endif
 			}
 		}
@@ -1230,7 +1480,7 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 		// are "behind" a shared instance, we need to get that instance
 		// to transport it onto the network.
         //elif Transport.destination_table[packet.destination_hash][2] == 1 and Transport.owner.is_connected_to_shared_instance:
-		else if (destination_entry._hops == 1 && _owner.is_connected_to_shared_instance()) {
+		else if (route._hops == 1 && _owner.is_connected_to_shared_instance()) {
 			TRACE("Transport::outbound: Sending packet for directly connected interface to shared instance...");
 			if (packet.header_type() == Type::Packet::HEADER_1) {
 				// Insert packet into transport
@@ -1244,16 +1494,16 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 				//new_raw += packet.raw[1:2]
 				new_raw << packet.raw().mid(1, 1);
 				//new_raw += Transport.destination_table[packet.destination_hash][1]
-				new_raw << destination_entry._received_from;
+				new_raw << route._received_from;
 				//new_raw += packet.raw[2:]
 				new_raw << packet.raw().mid(2);
 				sent = transmit(outbound_interface, new_raw);
 				//Transport.destination_table[packet.destination_hash][0] = time.time()
-				destination_entry._timestamp = OS::time();
+				route._timestamp = OS::time();
 #if RNS_NEIGHBOR_PROBING
 				// DIVERGENCE: count packets forwarded through this
 				// neighbor for passive liveness inference.
-				if (sent) _record_neighbor_packet(destination_entry._received_from);
+				if (sent) _record_neighbor_packet(route._received_from);
 #endif
 			}
 		}
@@ -1268,7 +1518,7 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 			// DIVERGENCE: count directly-delivered packets toward this
 			// neighbor; for hops==0 paths _received_from is the neighbor
 			// itself.
-			if (sent) _record_neighbor_packet(destination_entry._received_from);
+			if (sent) _record_neighbor_packet(route._received_from);
 #endif
 		}
 	}
@@ -1391,11 +1641,13 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 										interface.announce_queue = []
 */
 
-								bool queued_announces = (interface.announce_queue().size() > 0);
+								bool queued_announces = !interface.announce_queue().empty();
 								if (!queued_announces && outbound_time > interface.announce_allowed_at()) {
-									uint16_t wait_time = 0;
+									//p tx_time   = (len(packet.raw)*8) / interface.bitrate
+									//p wait_time = (tx_time / interface.announce_cap)
+									double wait_time = 0;
 									if (interface.bitrate() > 0 && interface.announce_cap() > 0) {
-										uint16_t tx_time = (packet.raw().size() * 8) / interface.bitrate();
+										double tx_time = (packet.raw().size() * 8) / (double)interface.bitrate();
 										wait_time = (tx_time / interface.announce_cap());
 									}
 									interface.announce_allowed_at(outbound_time + wait_time);
@@ -1403,55 +1655,25 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 								else {
 									should_transmit = false;
 									if (interface.announce_queue().size() < Type::Reticulum::MAX_QUEUED_ANNOUNCES) {
-										bool should_queue = true;
-										for (auto& entry : interface.announce_queue()) {
-											if (entry._destination == packet.destination_hash()) {
-												uint64_t emission_timestamp = announce_emitted(packet);
-												should_queue = false;
-												if (emission_timestamp > entry._emitted) {
-													entry._time = outbound_time;
-													entry._hops = packet.hops();
-													entry._emitted = emission_timestamp;
-													entry._raw = packet.raw();
-												}
-												break;
-											}
-										}
-										if (should_queue) {
-											RNS::AnnounceEntry entry(
-												packet.destination_hash(),
-												outbound_time,
-												packet.hops(),
-												announce_emitted(packet),
-												packet.raw()
-											);
-
-											queued_announces = (interface.announce_queue().size() > 0);
-											// CBA ACCUMULATES
-											interface.add_announce(entry);
-
-											if (!queued_announces) {
-												double wait_time = std::max(interface.announce_allowed_at() - OS::time(), (double)0);
-
-												// CBA TODO THREAD?
-												//z timer = threading.Timer(wait_time, interface.process_announce_queue)
-												//z timer.start()
-
-												if (wait_time < 1000) {
-													TRACEF("Added announce to queue (height %lu) on %s for processing in %d ms", interface.announce_queue().size(), interface.toString().c_str(), (int)wait_time);
-												}
-												else {
-													TRACEF("Added announce to queue (height %lu) on %s for processing in %.1f s", interface.announce_queue().size(), interface.toString().c_str(), OS::round(wait_time/1000,1));
-												}
+										RNS::AnnounceEntry entry(
+											packet.destination_hash(),
+											outbound_time,
+											packet.hops(),
+											announce_emitted(packet),
+											packet.raw()
+										);
+										// A newer emission of an announce already queued just replaces it
+										// CBA ACCUMULATES
+										if (interface.add_announce(entry)) {
+											//z timer = threading.Timer(wait_time, interface.process_announce_queue)
+											schedule_announce_queue(interface);
+
+											double wait_time = std::max(interface.announce_allowed_at() - OS::time(), (double)0);
+											if (wait_time < 1) {
+												TRACEF("Added announce to queue (height %zu) on %s for processing in %d ms", interface.announce_queue().size(), interface.toString().c_str(), (int)(wait_time*1000));
 											}
 											else {
-												double wait_time = std::max(interface.announce_allowed_at() - OS::time(), (double)0);
-												if (wait_time < 1000) {
-													TRACEF("Added announce to queue (height %lu) on %s for processing in %d ms", interface.announce_queue().size(), interface.toString().c_str(), (int)wait_time);
-												}
-												else {
-													TRACEF("Added announce to queue (height %lu) on %s for processing in %.1f s", interface.announce_queue().size(), interface.toString().c_str(), OS::round(wait_time/1000,1));
-												}
+												TRACEF("Added announce to queue (height %zu) on %s for processing in %.1f s", interface.announce_queue().size(), interface.toString().c_str(), OS::round(wait_time,1));
 											}
 										}
 									}
@@ -1518,8 +1740,18 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 
 			PacketReceipt receipt(packet);
 			packet.receipt(receipt);
+			Hash16 receipt_hash(receipt.truncated_hash());
+			auto receipt_iter = _receipts.find(receipt_hash);
+			if (receipt_iter != _receipts.end()) {
+				// A resent packet supersedes the receipt of its previous transmission
+				PacketReceipt superseded_receipt = (*receipt_iter).second;
+				_receipts.erase(receipt_iter);
+				superseded_receipt.set_timeout(-1);
+				superseded_receipt.check_timeout();
+			}
+			_receipt_deadlines.schedule(receipt_hash, receipt.sent_at() + receipt.timeout());
 			// CBA ACCUMULATES
-			_receipts.push_back(receipt);
+			_receipts.insert({receipt_hash, std::move(receipt)});
 		}
 
 		cache_packet(packet);
@@ -1694,91 +1926,43 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 	return false;
 }
 
-/*static*/ void Transport::inbound(const Bytes& raw, const Interface& interface /*= {Type::NONE}*/) {
-	TRACEF("Transport::inbound: received %d bytes", raw.size());
+/*static*/ void Transport::inbound(const Bytes& received, const Interface& interface /*= {Type::NONE}*/) {
+	TRACEF("Transport::inbound: received %d bytes", received.size());
 	++_packets_received;
 	// CBA
 	if (_callbacks._receive_packet) {
 		try {
-			_callbacks._receive_packet(raw, interface);
+			_callbacks._receive_packet(received, interface);
 		}
 		catch (const std::exception& e) {
 			DEBUGF("Error while executing receive packet callback. The contained exception was: %s", e.what());
 		}
 	}
-// TODO
-/*p
 	// If interface access codes are enabled,
 	// we must authenticate each packet.
-	//if len(raw) > 2:
-	if (raw.size() > 2) {
-		if interface != None and hasattr(interface, "ifac_identity") and interface.ifac_identity != None:
-			// Check that IFAC flag is set
-			if raw[0] & 0x80 == 0x80:
-				if len(raw) > 2+interface.ifac_size:
-					// Extract IFAC
-					ifac = raw[2:2+interface.ifac_size]
-
-					// Generate mask
-					mask = RNS.Cryptography.hkdf(
-						length=len(raw),
-						derive_from=ifac,
-						salt=interface.ifac_key,
-						context=None,
-					)
-
-					// Unmask payload
-					i = 0; unmasked_raw = b""
-					for byte in raw:
-						if i <= 1 or i > interface.ifac_size+1:
-							// Unmask header bytes and payload
-							unmasked_raw += bytes([byte ^ mask[i]])
-						else:
-							// Don't unmask IFAC itself
-							unmasked_raw += bytes([byte])
-						i += 1
-					raw = unmasked_raw
-
-					// Unset IFAC flag
-					new_header = bytes([raw[0] & 0x7f, raw[1]])
-
-					// Re-assemble packet
-					new_raw = new_header+raw[2+interface.ifac_size:]
-
-					// Calculate expected IFAC
-					expected_ifac = interface.ifac_identity.sign(new_raw)[-interface.ifac_size:]
-
-					// Check it
-					if ifac == expected_ifac:
-						raw = new_raw
-					else:
-						return
-
-				else:
-					return
-
-			else:
-				// If the IFAC flag is not set, but should be,
-				// drop the packet.
-				return
-
-		else:
-			// If the interface does not have IFAC enabled,
-			// check the received packet IFAC flag.
-			if raw[0] & 0x80 == 0x80:
-				// If the flag is set, drop the packet
-				return
+	//p if len(raw) > 2:
+	if (received.size() <= 2) {
+		return;
 	}
-	else {
+	bool authenticated = false;
+	//p if interface != None and hasattr(interface, "ifac_identity") and interface.ifac_identity != None:
+	if (interface && interface.ifac_identity()) {
+		if (!ifac_unmask(interface, received, _ifac_buffer)) {
+			TRACE("Transport::inbound: Dropped packet failing interface access code");
+			return;
+		}
+		authenticated = true;
+	}
+	//p elif raw[0] & 0x80 == 0x80:
+	else if ((received.data()[0] & 0x80) == 0x80) {
+		// If the interface does not have IFAC enabled but the packet IFAC flag is set, drop the packet
+		TRACE("Transport::inbound: Dropped packet with interface access code on interface without");
 		return;
 	}
-*/
+	// Packets are parsed from the unmasked copy, which the next one won't overwrite while still held
+	const Bytes raw = authenticated ? _ifac_buffer : received;
 
-	if (_jobs_running) DEBUG("Transport::inbound: jobs still running!");
-	while (_jobs_running) {
-		TRACE("Transport::inbound: sleeping...");
-		OS::sleep(0.0005);
-	}
+	// DIVERGENCE: No waiting for jobs() as Python does, see outbound()
 
 	if (!_identity) {
 		WARNING("Transport::inbound: No identity!");
@@ -1809,9 +1993,8 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 	// synchronously with handle_incoming() so the values describe THIS packet.
 	// A NaN value means the interface didn't report that metric. Python keeps
 	// a class-level cache keyed by packet_hash so shared-instance clients can
-	// look up signal stats via RPC; microReticulum doesn't support being a
-	// shared-instance client, so we stamp the packet directly and skip the
-	// cache.
+	// look up signal stats via RPC; microReticulum has no shared-instance RPC,
+	// so we stamp the packet directly and skip the cache.
 	if (interface) {
 		if (!Type::isNan(interface.r_stat_rssi())) packet.rssi(interface.r_stat_rssi());
 		if (!Type::isNan(interface.r_stat_snr()))  packet.snr(interface.r_stat_snr());
@@ -1877,25 +2060,28 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 		// If packet is anything besides ANNOUNCE then determine if it's destinated for a local destination or link
 		bool for_local_client = false;
 		bool for_local_client_link = false;
+		// Looked up once, transport handling below forwards along the same route
+		RouteSummary route;
 		if (packet.packet_type() != Type::Packet::ANNOUNCE) {
 			// CBA microStore
 			//auto& destination_entry = get_path(packet.destination_hash());
-			DestinationEntry destination_entry;
-			_new_path_table.get(packet.destination_hash(), destination_entry);
-			if (destination_entry) {
-			 	if (destination_entry._hops == 0) {
+			_new_path_table.get_route(packet.destination_hash(), route);
+			if (route) {
+			 	if (route._hops == 0) {
 					// Destined for a local destination
 					for_local_client = true;
 				}
 			}
 			auto link_iter = _link_table.find(packet.destination_hash());
 			if (link_iter != _link_table.end()) {
-				LinkEntry link_entry = (*link_iter).second;
-			 	if (_local_client_interfaces.find(link_entry._receiving_interface) != _local_client_interfaces.end()) {
+				const LinkEntry& link_entry = (*link_iter).second;
+				Interface link_receiving_interface(link_entry.receiving_interface());
+				Interface link_outbound_interface(link_entry.outbound_interface());
+			 	if (link_receiving_interface && _local_client_interfaces.find(link_receiving_interface) != _local_client_interfaces.end()) {
 					// Destined for a local link
 					for_local_client_link = true;
 				}
-			 	if (_local_client_interfaces.find(link_entry._outbound_interface) != _local_client_interfaces.end()) {
+			 	if (link_outbound_interface && _local_client_interfaces.find(link_outbound_interface) != _local_client_interfaces.end()) {
 					// Destined for a local link
 					for_local_client_link = true;
 				}
@@ -1907,8 +2093,8 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 		bool proof_for_local_client = false;
 		auto reverse_iter = _reverse_table.find(packet.destination_hash());
 		if (reverse_iter != _reverse_table.end()) {
-			ReverseEntry reverse_entry = (*reverse_iter).second;
-			if (_local_client_interfaces.find(reverse_entry._receiving_interface) != _local_client_interfaces.end()) {
+			Interface reverse_receiving_interface((*reverse_iter).second.receiving_interface());
+			if (reverse_receiving_interface && _local_client_interfaces.find(reverse_receiving_interface) != _local_client_interfaces.end()) {
 				// Proof for local destination???
 				proof_for_local_client = true;
 			}
@@ -1983,12 +2169,10 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 					TRACE("Transport::inbound: We are designated next-hop");
 					// CBA microStore
 					//auto& destination_entry = get_path(packet.destination_hash());
-					DestinationEntry destination_entry;
-					_new_path_table.get(packet.destination_hash(), destination_entry);
-					if (destination_entry) {
-						TRACEF("Transport::inbound: Found path to destination, next_hop=%2", destination_entry._received_from.toHex().c_str());
-						Bytes next_hop = destination_entry._received_from;
-						uint8_t remaining_hops = destination_entry._hops;
+					if (route) {
+						TRACEF("Transport::inbound: Found path to destination, next_hop=%2", route._received_from.toHex().c_str());
+						Bytes next_hop = route._received_from;
+						uint8_t remaining_hops = route._hops;
 						
 						// CBA RESERVE
 						//Bytes new_raw;
@@ -2025,7 +2209,7 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 							new_raw << packet.raw().mid(2);
 						}
 
-						Interface outbound_interface = destination_entry.receiving_interface();
+						Interface& outbound_interface = route.receiving_interface();
 
 						if (packet.packet_type() == Type::Packet::LINKREQUEST) {
 							TRACE("Transport::inbound: Packet is next-hop LINKREQUEST");
@@ -2077,7 +2261,10 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 								proof_timeout
 							);
 							// CBA ACCUMULATES
-							_link_table.insert({Link::link_id_from_lr_packet(packet), link_entry});
+							Bytes link_id = Link::link_id_from_lr_packet(packet);
+							if (_link_table.insert({link_id, std::move(link_entry)}).second) {
+								_link_deadlines.schedule(link_id, proof_timeout);
+							}
 						}
 						else {
 							TRACE("Transport::inbound: Packet is next-hop other type");
@@ -2093,11 +2280,14 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 #endif
 							);
 							// CBA ACCUMULATES
-							_reverse_table.insert({packet.getTruncatedHash(), reverse_entry});
+							double reverse_deadline = reverse_entry._timestamp + REVERSE_TIMEOUT;
+							if (_reverse_table.insert({packet.getTruncatedHash(), std::move(reverse_entry)}).second) {
+								_reverse_deadlines.schedule(packet.getTruncatedHash(), reverse_deadline);
+							}
 						}
 						TRACE("Transport::outbound: Sending packet to next hop...");
 						transmit(outbound_interface, new_raw);
-						destination_entry._timestamp = OS::time();
+						route._timestamp = OS::time();
 					}
 					else {
 						// TODO: There should probably be some kind of REJECT
@@ -2126,30 +2316,30 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 					// the same for this link, direction doesn't
 					// matter, and we simply send the packet on.
 					Interface outbound_interface({Type::NONE});
-					if (link_entry._outbound_interface == link_entry._receiving_interface) {
+					if (link_entry._outbound_interface_id == link_entry._receiving_interface_id) {
 						// But check that taken hops matches one
 						// of the expectede values.
 						if (packet.hops() == link_entry._remaining_hops || packet.hops() == link_entry._hops) {
 							TRACE("Transport::inbound: Link inbound/outbound interfaes are same, transporting on same interface");
-							outbound_interface = link_entry._outbound_interface;
+							outbound_interface = link_entry.outbound_interface();
 						}
 					}
 					else {
 						// If interfaces differ, we transmit on
 						// the opposite interface of what the
 						// packet was received on.
-						if (packet.receiving_interface() == link_entry._outbound_interface) {
+						if (packet.receiving_interface().id() == link_entry._outbound_interface_id) {
 							// Also check that expected hop count matches
 							if (packet.hops() == link_entry._remaining_hops) {
 								TRACE("Transport::inbound: Link transporting on inbound interface");
-								outbound_interface = link_entry._receiving_interface;
+								outbound_interface = link_entry.receiving_interface();
 							}
 						}
-						else if (packet.receiving_interface() == link_entry._receiving_interface) {
+						else if (packet.receiving_interface().id() == link_entry._receiving_interface_id) {
 							// Also check that expected hop count matches
 							if (packet.hops() == link_entry._hops) {
 								TRACE("Transport::inbound: Link transporting on outbound interface");
-								outbound_interface = link_entry._outbound_interface;
+								outbound_interface = link_entry.outbound_interface();
 							}
 						}
 					}
@@ -2165,8 +2355,9 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 						new_raw << packet.hops();
 						//new_raw += packet.raw[2:]
 						new_raw << packet.raw().mid(2);
-						transmit(outbound_interface, new_raw);
+						// update entry before transmit, table entries may be relocated by re-entrant table changes
 						link_entry._timestamp = OS::time();
+						transmit(outbound_interface, new_raw);
 						// Deferred hashlist insertion for link transport packets
 						// CBA ACCUMULATES
 						add_packet_hash(packet.packet_hash());
@@ -2243,7 +2434,7 @@ TRACEF("path_request_conditions=%u", path_request_conditions);
 TRACEF("announce_emitted=%lu", announce_emitted);
 
 					//p random_blob = packet.data[RNS.Identity.KEYSIZE//8+RNS.Identity.NAME_HASH_LENGTH//8:RNS.Identity.KEYSIZE//8+RNS.Identity.NAME_HASH_LENGTH//8+10]
-					Bytes random_blob = packet.data().mid(Type::Identity::KEYSIZE/8 + Type::Identity::NAME_HASH_LENGTH/8, Type::Identity::RANDOM_HASH_LENGTH/8);
+					Bytes random_blob = packet.data_view().mid(Type::Identity::KEYSIZE/8 + Type::Identity::NAME_HASH_LENGTH/8, Type::Identity::RANDOM_HASH_LENGTH/8).bytes();
 					//p random_blobs = []
 					std::vector<Bytes> empty_random_blobs;
 					std::vector<Bytes>& random_blobs = empty_random_blobs;
@@ -2459,7 +2650,7 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 						// dropping oldest entries from the front. Matches Python's
 						// `random_blobs = random_blobs[-MAX_RANDOM_BLOBS:]` semantics.
 						if (std::find(random_blobs.begin(), random_blobs.end(), random_blob) == random_blobs.end()) {
-							random_blobs.push_back(random_blob);
+							random_blobs.push_back(std::move(random_blob));
 							if (random_blobs.size() > MAX_RANDOM_BLOBS) {
 								random_blobs.erase(random_blobs.begin(),
 									random_blobs.begin() + (random_blobs.size() - MAX_RANDOM_BLOBS));
@@ -2491,7 +2682,9 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 									attached_interface
 								);
 								// CBA ACCUMULATES
-								_announce_table.insert({packet.destination_hash(), announce_entry});
+								if (_announce_table.insert({packet.destination_hash(), std::move(announce_entry)}).second) {
+									_announce_deadlines.schedule(packet.destination_hash(), retransmit_timeout);
+								}
 								// CBA IMMEDIATE CULL
 								cull_announce_table();
 							}
@@ -2522,7 +2715,9 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 									attached_interface
 								);
 								// CBA ACCUMULATES
-								_announce_table.insert({packet.destination_hash(), announce_entry});
+								if (_announce_table.insert({packet.destination_hash(), std::move(announce_entry)}).second) {
+									_announce_deadlines.schedule(packet.destination_hash(), retransmit_timeout);
+								}
 								// CBA IMMEDIATE CULL
 								cull_announce_table();
 							}
@@ -2663,7 +2858,7 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 							else {
 								ttl = DESTINATION_TIMEOUT;
 							}
-							if (_new_path_table.put(packet.destination_hash().collection(), destination_table_entry, ttl)) {
+							if (_new_path_table.put(packet.destination_hash(), destination_table_entry, ttl)) {
 								TRACEF("Added destination %s to path table!", packet.destination_hash().toHex().c_str());
 								mark_path_unknown_state(packet.destination_hash());
 								if (path_found) ++_paths_updated;
@@ -2818,27 +3013,26 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 			if (packet.destination_type() == Type::Destination::LINK) {
 				// Data is destined for a link
 				TRACE("Transport::inbound: Packet is DATA for a LINK");
-				std::set<Link> active_links(_active_links);
-				for (auto& link : active_links) {
-					if (link.link_id() == packet.destination_hash()) {
-						if (link.attached_interface() == packet.receiving_interface()) {
-							TRACE("Transport::inbound: Packet is DATA for an active LINK");
-							packet.link(link);
-							const_cast<Link&>(link).receive(packet);
-						}
-						else {
-							// In the strange and rare case that an interface is
-							// partly malfunctioning and a link-associated packet
-							// arrives on an interface that has failed sending --
-							// and transport has failed over to another path --
-							// drop the packet hash from the dedup filter so the
-							// link can still receive the packet when it finally
-							// arrives over the correct interface.
-							_packet_hashlist.remove(packet.packet_hash());
-							TRACEF("Transport::inbound: removed packet hash=%s from hashlist", packet.packet_hash().toHex().c_str());
-							WARNING("Transport::inbound: DATA for an active LINK received on wrong interface!");
-						}
-						break;
+				auto iter = _active_links.find(packet.destination_hash());
+				if (iter != _active_links.end()) {
+					// Copy handle since receive may re-enter Transport and modify _active_links
+					Link link = (*iter).second;
+					if (link.attached_interface() == packet.receiving_interface()) {
+						TRACE("Transport::inbound: Packet is DATA for an active LINK");
+						packet.link(link);
+						link.receive(packet);
+					}
+					else {
+						// In the strange and rare case that an interface is
+						// partly malfunctioning and a link-associated packet
+						// arrives on an interface that has failed sending --
+						// and transport has failed over to another path --
+						// drop the packet hash from the dedup filter so the
+						// link can still receive the packet when it finally
+						// arrives over the correct interface.
+						_packet_hashlist.remove(packet.packet_hash());
+						TRACEF("Transport::inbound: removed packet hash=%s from hashlist", packet.packet_hash().toHex().c_str());
+						WARNING("Transport::inbound: DATA for an active LINK received on wrong interface!");
 					}
 				}
 			}
@@ -2890,23 +3084,27 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 				if ((Reticulum::transport_enabled() || for_local_client_link || from_local_client) && _link_table.count(packet.destination_hash()) > 0) {
 					TRACE("Handling link request proof...");
 					LinkEntry& link_entry = (*_link_table.find(packet.destination_hash())).second;
-					if (packet.receiving_interface() == link_entry._outbound_interface) {
+					if (packet.receiving_interface().id() == link_entry._outbound_interface_id) {
 						try {
-							if (packet.data().size() == (Type::Identity::SIGLENGTH/8 + Type::Link::ECPUBSIZE/2) || packet.data().size() == (Type::Identity::SIGLENGTH/8 + Type::Link::ECPUBSIZE/2 + Type::Link::LINK_MTU_SIZE)) {
+							const BytesView data = packet.data_view();
+							if (data.size() == (Type::Identity::SIGLENGTH/8 + Type::Link::ECPUBSIZE/2) || data.size() == (Type::Identity::SIGLENGTH/8 + Type::Link::ECPUBSIZE/2 + Type::Link::LINK_MTU_SIZE)) {
 								Bytes signalling_bytes;
-								if (packet.data().size() == (Type::Identity::SIGLENGTH/8 + Type::Link::ECPUBSIZE/2 + Type::Link::LINK_MTU_SIZE)) {
+								if (data.size() == (Type::Identity::SIGLENGTH/8 + Type::Link::ECPUBSIZE/2 + Type::Link::LINK_MTU_SIZE)) {
 									signalling_bytes = Link::signalling_bytes(Link::mtu_from_lp_packet(packet), Link::mode_from_lp_packet(packet));
 								}
-								Bytes peer_pub_bytes = packet.data().mid(Type::Identity::SIGLENGTH/8, Type::Link::ECPUBSIZE/2);
+								BytesView peer_pub_bytes = data.mid(Type::Identity::SIGLENGTH/8, Type::Link::ECPUBSIZE/2);
 								Identity peer_identity = Identity::recall(link_entry._destination_hash);
 								if (peer_identity) {
 									Bytes peer_sig_pub_bytes = peer_identity.get_public_key().mid(Type::Link::ECPUBSIZE/2, Type::Link::ECPUBSIZE/2);
 
-									Bytes signed_data = packet.destination_hash() + peer_pub_bytes + peer_sig_pub_bytes + signalling_bytes;
-									Bytes signature = packet.data().left(Type::Identity::SIGLENGTH/8);
+									Bytes signed_data(packet.destination_hash().size() + peer_pub_bytes.size() + peer_sig_pub_bytes.size() + signalling_bytes.size());
+									signed_data << packet.destination_hash() << peer_pub_bytes << peer_sig_pub_bytes << signalling_bytes;
+									BytesView signature = data.left(Type::Identity::SIGLENGTH/8);
 
 									if (peer_identity.validate(signature, signed_data)) {
-										TRACEF("Link request proof validated for transport via %s", link_entry._receiving_interface.toString().c_str());
+										// transmit on a copy, table entries may be relocated by re-entrant table changes
+										Interface receiving_interface(link_entry.receiving_interface());
+										TRACEF("Link request proof validated for transport via %s", receiving_interface.toString().c_str());
 										//p new_raw = packet.raw[0:1]
 										// CBA RESERVE
 										//Bytes new_raw = packet.raw().left(1);
@@ -2917,7 +3115,9 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 										//p new_raw += packet.raw[2:]
 										new_raw << packet.raw().mid(2);
 										link_entry._validated = true;
-										transmit(link_entry._receiving_interface, new_raw);
+										if (receiving_interface) {
+											transmit(receiving_interface, new_raw);
+										}
 									}
 									else {
 										DEBUGF("Invalid link request proof in transport for link %s, dropping proof.", packet.destination_hash().toHex().c_str());
@@ -2940,35 +3140,29 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 					// Check if we can deliver it to a local
 					// pending link
 					TRACEF("Handling proof for link request %s", packet.destination_hash().toHex().c_str());
-					// CBA Must make a copy of _pending_links before traversing since it gets modified
-					//for (auto link : _pending_links) {
-					std::set<Link> pending_links(_pending_links);
-					for (auto& link : pending_links) {
-						TRACEF("Checking for link request handling by pending link %s", link.link_id().toHex().c_str());
-						if (link.link_id() == packet.destination_hash()) {
-							TRACE("Requesting pending link to validate proof");
-							const_cast<Link&>(link).validate_proof(packet);
-						}
+					auto iter = _pending_links.find(packet.destination_hash());
+					if (iter != _pending_links.end()) {
+						// CBA Must copy handle before validating since activation moves it from _pending_links to _active_links
+						Link link = (*iter).second;
+						TRACE("Requesting pending link to validate proof");
+						link.validate_proof(packet);
 					}
 				}
 			}
 			else if (packet.context() == Type::Packet::RESOURCE_PRF) {
 				TRACE("Transport::inbound: Packet is RESOURCE PROOF");
-				std::set<Link> active_links(_active_links);
-				for (auto& link : active_links) {
-					if (link.link_id() == packet.destination_hash()) {
-						const_cast<Link&>(link).receive(packet);
-					}
+				auto iter = _active_links.find(packet.destination_hash());
+				if (iter != _active_links.end()) {
+					Link link = (*iter).second;
+					link.receive(packet);
 				}
 			}
 			else {
 				TRACE("Transport::inbound: Packet is regular PROOF");
 				if (packet.destination_type() == Type::Destination::LINK) {
-					std::set<Link> active_links(_active_links);
-					for (auto& link : active_links) {
-						if (link.link_id() == packet.destination_hash()) {
-							packet.link(link);
-						}
+					auto iter = _active_links.find(packet.destination_hash());
+					if (iter != _active_links.end()) {
+						packet.link((*iter).second);
 					}
 				}
 
@@ -2980,8 +3174,9 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 				// Check if this proof needs to be transported
 				if ((Reticulum::transport_enabled() || from_local_client || proof_for_local_client) && _reverse_table.find(packet.destination_hash()) != _reverse_table.end()) {
 					ReverseEntry reverse_entry = (*_reverse_table.find(packet.destination_hash())).second;
-					if (packet.receiving_interface() == reverse_entry._outbound_interface) {
-						TRACEF("Proof received on correct interface, transporting it via %s", reverse_entry._receiving_interface.toString().c_str());
+					Interface receiving_interface(reverse_entry.receiving_interface());
+					if (receiving_interface && packet.receiving_interface().id() == reverse_entry._outbound_interface_id) {
+						TRACEF("Proof received on correct interface, transporting it via %s", receiving_interface.toString().c_str());
 						//p new_raw = packet.raw[0:1]
 						// CBA RESERVE
 						//Bytes new_raw = packet.raw().left(1);
@@ -2991,7 +3186,7 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 						new_raw << packet.hops();
 						//p new_raw += packet.raw[2:]
 						new_raw << packet.raw().mid(2);
-						transmit(reverse_entry._receiving_interface, new_raw);
+						transmit(receiving_interface, new_raw);
 #if RNS_NEIGHBOR_PROBING
 						// DIVERGENCE: credit the forwarding neighbor with a
 						// returning proof for passive liveness inference.
@@ -3006,35 +3201,37 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 					TRACE("Proof is not candidate for transporting");
 				}
 
-				std::list<PacketReceipt> cull_receipts;
-				for (auto& receipt : _receipts) {
-					bool receipt_validated = false;
-					if (proof_hash) {
+				// DIVERGENCE: Receipts are indexed by truncated packet hash, which explicit proofs carry
+				// and implicit proofs are addressed to, so only the matching receipt is tested
+				std::vector<PacketReceipt> candidate_receipts;
+				if (proof_hash || packet.destination_type() != Type::Destination::LINK) {
+					auto iter = _receipts.find(proof_hash ? Hash16(proof_hash) : Hash16(packet.destination_hash()));
+					if (iter != _receipts.end()) {
 						// Only test validation if hash matches
-						if (receipt.hash() == proof_hash) {
-							receipt_validated = receipt.validate_proof_packet(packet);
+						if (!proof_hash || (*iter).second.hash() == proof_hash) {
+							candidate_receipts.push_back((*iter).second);
 						}
 					}
-					else {
-						// TODO: This looks like it should actually
-						// be rewritten when implicit proofs are added.
-
-						// In case of an implicit proof, we have
-						// to check every single outstanding receipt
-						receipt_validated = receipt.validate_proof_packet(packet);
+				}
+				else {
+					// TODO: This looks like it should actually
+					// be rewritten when implicit proofs are added.
+
+					// In case of an implicit proof over a link, we have
+					// to check every single outstanding receipt
+					candidate_receipts.reserve(_receipts.size());
+					for (const auto& [receipt_hash, receipt] : _receipts) {
+						candidate_receipts.push_back(receipt);
 					}
-
-					// CBA TODO requires modifying of collection while iterating which is forbidden
-					if (receipt_validated) {
+				}
+				// CBA Receipt handles are copied since delivery callbacks may send packets and add receipts
+				for (auto& receipt : candidate_receipts) {
+					if (receipt.validate_proof_packet(packet)) {
 						//p if receipt in Transport.receipts:
 						//p 	Transport.receipts.remove(receipt)
-						cull_receipts.push_back(receipt);
+						remove_receipt(receipt);
 					}
 				}
-				// CBA since modifying of collection while iterating is forbidden
-				for (auto& receipt : cull_receipts) {
-					_receipts.remove(receipt);
-				}
 			}
 		}
 	}
@@ -3149,9 +3346,32 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 }
 
 /*static*/ void Transport::register_interface(Interface& interface) {
+	// Hash is computed once here and cached, since every path lookup and persist asks for it
+	interface.update_hash();
 	TRACEF("Transport: Registering interface %s %s", interface.get_hash().toHex().c_str(), interface.toString().c_str());
 	if (!find_interface_from_hash(interface.get_hash())) {
+		// Intern an id for table entries to hold instead of the interface handle
+		size_t slot = 0;
+		while (slot < _interface_slots.size() && _interface_slots[slot]._interface) {
+			++slot;
+		}
+		if (slot >= MAX_INTERFACE_SLOTS) {
+			// Without an id its table entries would all compare equal to those of any other such interface
+			ERRORF("Transport: No interface id available for %s, not registering it", interface.toString().c_str());
+			return;
+		}
 		_interfaces.push_back(interface);
+		if (slot == _interface_slots.size()) {
+			_interface_slots.emplace_back();
+		}
+		InterfaceSlot& interface_slot = _interface_slots[slot];
+		interface_slot._interface = interface;
+		interface.id((InterfaceId)((interface_slot._generation << 8) | (slot + 1)));
+
+		// Clients of a shared instance are spawned by its local server interface
+		if (is_local_client_interface(interface)) {
+			_local_client_interfaces.insert(interface);
+		}
 	}
 	// CBA TODO set or add transport as listener on interface to receive incoming packets?
 }
@@ -3164,6 +3384,34 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 			[&](const Interface& i) { return i.get_hash() == hash; }),
 		_interfaces.end()
 	);
+
+	// Release the interned id, bumping the slot generation so ids still held by table entries go stale
+	for (auto& interface_slot : _interface_slots) {
+		if (interface_slot._interface && interface_slot._interface.get_hash() == hash) {
+			// Its announce queue deadline goes stale with the id
+			interface_slot._interface.announce_queue_scheduled(false);
+			interface_slot._interface.id(0);
+			interface_slot._interface.clear();
+			++interface_slot._generation;
+		}
+	}
+
+	for (auto iter = _local_client_interfaces.begin(); iter != _local_client_interfaces.end(); ) {
+		if (iter->get_hash() == hash) {
+			iter = _local_client_interfaces.erase(iter);
+		}
+		else {
+			++iter;
+		}
+	}
+	for (auto iter = _pending_local_path_requests.begin(); iter != _pending_local_path_requests.end(); ) {
+		if (iter->second.get_hash() == hash) {
+			iter = _pending_local_path_requests.erase(iter);
+		}
+		else {
+			++iter;
+		}
+	}
 }
 
 /*static*/ void Transport::register_destination(Destination& destination) {
@@ -3212,23 +3460,24 @@ TRACEF("path_announce_emitted=%lu", path_announce_emitted);
 	TRACEF("Transport: Registering link %s", link.toString().c_str());
 	if (link.initiator()) {
 		// CBA ACCUMULATES
-		_pending_links.insert(link);
+		_pending_links.emplace(link.link_id(), link);
 	}
 	else {
 		// CBA ACCUMULATES
-		_active_links.insert(link);
+		_active_links.emplace(link.link_id(), link);
 	}
 }
 
 /*static*/ void Transport::activate_link(Link& link) {
 	TRACEF("Transport: Activating link %s", link.toString().c_str());
-	if (_pending_links.find(link) != _pending_links.end()) {
+	auto iter = _pending_links.find(link.link_id());
+	if (iter != _pending_links.end()) {
 		if (link.status() != Type::Link::ACTIVE) {
 			throw std::runtime_error("Invalid link state for link activation: " + std::to_string(link.status()));
 		}
-		_pending_links.erase(link);
+		_pending_links.erase(iter);
 		// CBA ACCUMULATES
-		_active_links.insert(link);
+		_active_links.emplace(link.link_id(), link);
 		link.status(Type::Link::ACTIVE);
 	}
 	else {
@@ -3263,15 +3512,34 @@ Deregisters an announce handler.
 	return (bool)find_interface_from_hash(interface_hash);
 }
 
+// Matches full interface hashes as well as the truncated hashes stored in persisted path records
 /*static*/ Interface Transport::find_interface_from_hash(const Bytes& interface_hash) {
+	if (interface_hash.size() == 0) {
+		return {Type::NONE};
+	}
 	auto iter = std::find_if(_interfaces.begin(), _interfaces.end(),
-		[&](const Interface& i) { return i.get_hash() == interface_hash; });
+		[&](const Interface& i) {
+			const Bytes& hash = i.get_hash();
+			return hash.size() >= interface_hash.size() && memcmp(hash.data(), interface_hash.data(), interface_hash.size()) == 0;
+		});
 	if (iter != _interfaces.end()) {
 		return *iter;
 	}
 	return {Type::NONE};
 }
 
+/*static*/ Interface Transport::find_interface_from_id(InterfaceId interface_id) {
+	size_t slot = (interface_id & 0xFF);
+	if (slot == 0 || slot > _interface_slots.size()) {
+		return {Type::NONE};
+	}
+	const InterfaceSlot& interface_slot = _interface_slots[slot - 1];
+	if (!interface_slot._interface || interface_slot._interface.id() != interface_id) {
+		return {Type::NONE};
+	}
+	return interface_slot._interface;
+}
+
 /*static*/ bool Transport::should_cache_packet(const Packet& packet) {
 	// TODO: Rework the caching system. It's currently
 	// not very useful to even cache Resource proofs,
@@ -3440,7 +3708,7 @@ Deregisters an announce handler.
 	}
 #endif
 	// CBA microStore
-	return _new_path_table.remove(destination_hash.collection());
+	return _new_path_table.remove(destination_hash);
 }
 
 /*
@@ -3453,7 +3721,7 @@ Deregisters an announce handler.
 	return (_path_table.find(destination_hash) != _path_table.end());
 */
 	// CBA microStore
-	return _new_path_table.exists(destination_hash.collection());
+	return _new_path_table.exists(destination_hash);
 }
 
 /*
@@ -3463,10 +3731,10 @@ Deregisters an announce handler.
 /*static*/ uint8_t Transport::hops_to(const Bytes& destination_hash) {
 	// CBA microStore
 	//auto& destination_entry = get_path(destination_hash);
-	DestinationEntry destination_entry;
-	_new_path_table.get(destination_hash, destination_entry);
-	if (destination_entry) {
-		return destination_entry._hops;
+	RouteSummary route;
+	_new_path_table.get_route(destination_hash, route);
+	if (route) {
+		return route._hops;
 	}
 	else {
 		return PATHFINDER_M;
@@ -3480,10 +3748,10 @@ Deregisters an announce handler.
 /*static*/ Bytes Transport::next_hop(const Bytes& destination_hash) {
 	// CBA microStore
 	//auto& destination_entry = get_path(destination_hash);
-	DestinationEntry destination_entry;
-	_new_path_table.get(destination_hash, destination_entry);
-	if (destination_entry) {
-		return destination_entry._received_from;
+	RouteSummary route;
+	_new_path_table.get_route(destination_hash, route);
+	if (route) {
+		return route._received_from.bytes();
 	}
 	else {
 		return {};
@@ -3497,10 +3765,10 @@ Deregisters an announce handler.
 /*static*/ Interface Transport::next_hop_interface(const Bytes& destination_hash) {
 	// CBA microStore
 	//auto& destination_entry = get_path(destination_hash);
-	DestinationEntry destination_entry;
-	_new_path_table.get(destination_hash, destination_entry);
-	if (destination_entry) {
-		return destination_entry.receiving_interface();
+	RouteSummary route;
+	_new_path_table.get_route(destination_hash, route);
+	if (route) {
+		return route.receiving_interface();
 	}
 	else {
 		return {Type::NONE};
@@ -3588,8 +3856,8 @@ Deregisters an announce handler.
 }
 
 /*static*/ bool Transport::mark_path_unresponsive(const Bytes& destination_hash) {
-	DestinationEntry destination_entry;
-	if (_new_path_table.get(destination_hash, destination_entry) && destination_entry) {
+	RouteSummary route;
+	if (_new_path_table.get_route(destination_hash, route) && route) {
 		_path_states[destination_hash] = STATE_UNRESPONSIVE;
 		++_paths_unresponsive;
 		return true;
@@ -3598,8 +3866,8 @@ Deregisters an announce handler.
 }
 
 /*static*/ bool Transport::mark_path_responsive(const Bytes& destination_hash) {
-	DestinationEntry destination_entry;
-	if (_new_path_table.get(destination_hash, destination_entry) && destination_entry) {
+	RouteSummary route;
+	if (_new_path_table.get_route(destination_hash, route) && route) {
 		_path_states[destination_hash] = STATE_RESPONSIVE;
 		++_paths_responsive;
 		return true;
@@ -3608,8 +3876,8 @@ Deregisters an announce handler.
 }
 
 /*static*/ bool Transport::mark_path_unknown_state(const Bytes& destination_hash) {
-	DestinationEntry destination_entry;
-	if (_new_path_table.get(destination_hash, destination_entry) && destination_entry) {
+	RouteSummary route;
+	if (_new_path_table.get_route(destination_hash, route) && route) {
 		_path_states[destination_hash] = STATE_UNKNOWN;
 		++_paths_unknown;
 		return true;
@@ -3772,7 +4040,7 @@ will announce it.
 			on_interface.announce_queue = []
 */
 
-		bool queued_announces = (on_interface.announce_queue().size() > 0);
+		bool queued_announces = !on_interface.announce_queue().empty();
 		if (queued_announces) {
 			TRACEF("Blocking recursive path request on %s due to queued announces", on_interface.toString().c_str());
 			return;
@@ -3785,9 +4053,9 @@ will announce it.
 			}
 			else {
 				//p tx_time   = ((len(path_request_data)+RNS.Reticulum.HEADER_MINSIZE)*8) / on_interface.bitrate
-				uint32_t wait_time = 0;
-				if ( on_interface.bitrate() > 0 && on_interface.announce_cap() > 0) {
-					uint32_t tx_time = ((path_request_data.size() + Type::Reticulum::HEADER_MINSIZE)*8) / on_interface.bitrate();
+				double wait_time = 0;
+				if (on_interface.bitrate() > 0 && on_interface.announce_cap() > 0) {
+					double tx_time = ((path_request_data.size() + Type::Reticulum::HEADER_MINSIZE)*8) / (double)on_interface.bitrate();
 					wait_time = (tx_time / on_interface.announce_cap());
 				}
 				const_cast<Interface&>(on_interface).announce_allowed_at(now + wait_time);
@@ -3797,7 +4065,9 @@ will announce it.
 
 	packet.is_outbound_pr(true);
 	packet.send();
-	_path_requests[destination_hash] = OS::time();
+	double request_time = OS::time();
+	_path_requests[destination_hash] = request_time;
+	_path_request_deadlines.schedule(destination_hash, request_time + Type::Transport::PATH_REQUEST_GATE_TIMEOUT);
 }
 
 /*static*/ void Transport::request_path(const Bytes& destination_hash) {
@@ -4471,7 +4741,9 @@ TRACEF("announce_packet hops: %u", announce_packet.hops());
 					attached_interface
 				);
 				// CBA ACCUMULATES
-				_announce_table.insert({announce_packet.destination_hash(), announce_entry});
+				if (_announce_table.insert({announce_packet.destination_hash(), std::move(announce_entry)}).second) {
+					_announce_deadlines.schedule(announce_packet.destination_hash(), retransmit_timeout);
+				}
 				// CBA IMMEDIATE CULL
 				cull_announce_table();
 
@@ -4527,11 +4799,13 @@ TRACEF("announce_packet hops: %u", announce_packet.hops());
 			//p pr_entry = { "destination_hash": destination_hash, "timeout": time.time()+Transport.PATH_REQUEST_TIMEOUT, "requesting_interface": attached_interface }
 			//p _discovery_path_requests[destination_hash] = pr_entry;
 			// CBA ACCUMULATES
+			double pr_timeout = OS::time() + Type::Transport::PATH_REQUEST_TIMEOUT;
 			_discovery_path_requests.insert({destination_hash, {
 				destination_hash,
-				OS::time() + Type::Transport::PATH_REQUEST_TIMEOUT,
+				pr_timeout,
 				attached_interface
 			}});
+			_discovery_pr_deadlines.schedule(destination_hash, pr_timeout);
 
 			for (auto& interface : _interfaces) {
 #if RNS_SAME_INTERFACE_PATH_REQUESTS
@@ -4603,25 +4877,27 @@ TRACEF("announce_packet hops: %u", announce_packet.hops());
 // call detach() on every interface so they can release resources before
 // destruction. Python additionally orders LocalServerInterface and
 // LocalClientInterface teardown separately for its shared-instance protocol;
-// microReticulum does not support shared-instance clients/servers, so those
-// branches collapse to the unified loop here.
+// here a local server detaches its spawned clients itself, so those branches
+// collapse to the unified loop.
 /*static*/ void Transport::detach_interfaces() {
 	TRACE("Transport::detach_interfaces()");
 
 	size_t closed_links = 0;
-	// Iterate by value -- Link is a value-type wrapping a shared impl, so a
-	// copy still routes teardown() to the same underlying object. std::set
-	// yields const references which can't call the non-const teardown().
-	for (Link link : _active_links) {
-		try { link.teardown(); closed_links++; }
-		catch (const std::exception& e) {
-			WARNINGF("Could not tear down active link before interface detach: %s", e.what());
-		}
-	}
-	for (Link link : _pending_links) {
+	// Snapshot handles first -- Link is a value-type wrapping a shared impl, so a
+	// copy still routes teardown() to the same underlying object, and teardown
+	// must not invalidate the index iterators underneath us.
+	std::vector<Link> links;
+	links.reserve(_active_links.size() + _pending_links.size());
+	for (auto& [link_id, link] : _active_links) {
+		links.push_back(link);
+	}
+	for (auto& [link_id, link] : _pending_links) {
+		links.push_back(link);
+	}
+	for (Link& link : links) {
 		try { link.teardown(); closed_links++; }
 		catch (const std::exception& e) {
-			WARNINGF("Could not tear down pending link before interface detach: %s", e.what());
+			WARNINGF("Could not tear down link before interface detach: %s", e.what());
 		}
 	}
 
@@ -4631,7 +4907,9 @@ TRACEF("announce_packet hops: %u", announce_packet.hops());
 	}
 
 	DEBUG("Detaching interfaces");
-	for (Interface& iface : _interfaces) {
+	// Iterates a copy, servers deregister their spawned interfaces when detached
+	InterfaceTable interfaces(_interfaces);
+	for (Interface& iface : interfaces) {
 		try {
 			iface.detach();
 		}
@@ -4642,33 +4920,74 @@ TRACEF("announce_packet hops: %u", announce_packet.hops());
 	DEBUG("All interfaces detached");
 }
 
+// Everything learned through the shared instance is stale once the connection
+// to it is gone, so is dropped until it comes back.
 /*static*/ void Transport::shared_connection_disappeared() {
-// TODO
-/*p
-	for link in Transport.active_links:
-		link.teardown()
-
-	for link in Transport.pending_links:
-		link.teardown()
-
-	Transport.announce_table    = {}
-	Transport.destination_table = {}
-	Transport.reverse_table     = {}
-	Transport.link_table        = {}
-	Transport.held_announces    = {}
-	Transport.announce_handlers = []
-	Transport.tunnels           = {}
-*/
+	TRACE("Transport::shared_connection_disappeared()");
+	//p for link in Transport.active_links:
+	//p     link.teardown()
+	//p for link in Transport.pending_links:
+	//p     link.teardown()
+	std::vector<Link> links;
+	links.reserve(_active_links.size() + _pending_links.size());
+	for (auto& [link_id, link] : _active_links) {
+		links.push_back(link);
+	}
+	for (auto& [link_id, link] : _pending_links) {
+		links.push_back(link);
+	}
+	for (Link& link : links) {
+		try {
+			link.teardown();
+		}
+		catch (const std::exception& e) {
+			WARNINGF("Could not tear down link after losing shared instance: %s", e.what());
+		}
+	}
+
+	//p Transport.announce_table    = {}
+	_announce_table.clear();
+	_announce_deadlines.clear();
+	//p Transport.destination_table = {}
+#if defined(RNS_USE_FS) && RNS_PERSIST_PATHS
+	// Path stores are only initialised with transport enabled, which a shared instance client never has
+	if (_path_store) {
+		_path_store.clear();
+	}
+	if (_route_store) {
+		_route_store.clear();
+	}
+#endif
+	_new_path_table.invalidate();
+	//p Transport.reverse_table     = {}
+	_reverse_table.clear();
+	_reverse_deadlines.clear();
+	//p Transport.link_table        = {}
+	_link_table.clear();
+	_link_deadlines.clear();
+	//p Transport.held_announces    = {}
+	_held_announces.clear();
+	//p Transport.tunnels           = {}
+	_tunnels.clear();
+	// DIVERGENCE: The reference also drops all announce handlers, which the application registered
+	// and wouldn't know to register again once the shared instance is back, so they're kept.
+	//p Transport.announce_handlers = []
 }
 
 /*static*/ void Transport::shared_connection_reappeared() {
-// TODO
-/*p
-	if Transport.owner.is_connected_to_shared_instance:
-		for registered_destination in Transport.destinations:
-			if registered_destination.type == RNS.Destination.SINGLE:
-				registered_destination.announce(path_response=True)
-*/
+	TRACE("Transport::shared_connection_reappeared()");
+	//p if Transport.owner.is_connected_to_shared_instance:
+	if (_owner && _owner.is_connected_to_shared_instance()) {
+		//p for registered_destination in Transport.destinations:
+		for (auto& [destination_hash, registered_destination] : _destinations) {
+			//p if registered_destination.type == RNS.Destination.SINGLE:
+			if (registered_destination.type() == Type::Destination::SINGLE) {
+				//p registered_destination.announce(path_response=True)
+				// Announcing doesn't modify the destination table, it is safe to iterate
+				registered_destination.announce({}, true);
+			}
+		}
+	}
 }
 
 // Empties every interface's pending announce queue. Useful when shutting down
@@ -4685,10 +5004,20 @@ TRACEF("announce_packet hops: %u", announce_packet.hops());
 	}
 }
 
+// Queue is processed once the interface's announce cap next allows sending, at most one deadline is
+// kept per interface
+/*static*/ void Transport::schedule_announce_queue(const Interface& interface) {
+	if (interface.announce_queue_scheduled() || interface.id() == 0) {
+		return;
+	}
+	interface.announce_queue_scheduled(true);
+	_announce_queue_deadlines.schedule(interface.id(), interface.announce_allowed_at());
+}
+
 /*static*/ uint64_t Transport::announce_emitted(const Packet& packet) {
 	//p random_blob = packet.data[RNS.Identity.KEYSIZE//8+RNS.Identity.NAME_HASH_LENGTH//8:RNS.Identity.KEYSIZE//8+RNS.Identity.NAME_HASH_LENGTH//8+10]
 	//p announce_emitted = int.from_bytes(random_blob[5:10], "big")
-	Bytes random_blob = packet.data().mid(Type::Identity::KEYSIZE/8+Type::Identity::NAME_HASH_LENGTH/8, 10);
+	BytesView random_blob = packet.data_view().mid(Type::Identity::KEYSIZE/8+Type::Identity::NAME_HASH_LENGTH/8, 10);
 	if (random_blob) {
 		return OS::from_bytes_big_endian(random_blob.data() + 5, 5);
 	}
@@ -5375,6 +5704,8 @@ TRACEF("Transport::write_path_table: buffer size %lu bytes", Persistence::_buffe
 
 		// Clear the microStore-backed stores (removes their segment files on disk)
 		_path_store.clear();
+		_route_store.clear();
+		_new_path_table.invalidate();
 		_packet_hash_store.clear();
 
 		// Remove cached announce packets
@@ -5445,6 +5776,13 @@ TRACEF("Transport::write_path_table: buffer size %lu bytes", Persistence::_buffe
 	// _held_announces
 	HEADF(LOG_VERBOSE, "paths: %u dsts: %u revr: %u annc: %u held: %u", _new_path_table.size(), _destinations.size(), _reverse_table.size(), _announce_table.size(), _held_announces.size());
 
+	// _new_path_table cache
+	VERBOSEF("pch: %u pcm: %u pce: %u pcx: %u", _new_path_table.hits(), _new_path_table.misses(), _new_path_table.evictions(), _new_path_table.expirations());
+
+	// Identity announce validation cache
+	uint32_t announce_cache_lookups = Identity::announce_cache_hits() + Identity::announce_cache_misses();
+	VERBOSEF("ach: %u acm: %u acr: %u%% acs: %u", Identity::announce_cache_hits(), Identity::announce_cache_misses(), announce_cache_lookups > 0 ? (unsigned)(Identity::announce_cache_hits() * 100ull / announce_cache_lookups) : 0, Identity::announce_cache_size());
+
 	// _path_requests
 	// _discovery_path_requests
 	// _pending_local_path_requests
@@ -5468,6 +5806,10 @@ TRACEF("Transport::write_path_table: buffer size %lu bytes", Persistence::_buffe
 		interface_announces += interface.announce_queue().size();
 	}
 	VERBOSEF("phl: %u rcp: %u lt: %u pl: %u al: %u tun: %u", _packet_hashlist.size(), _receipts.size(), _link_table.size(), _pending_links.size(), _active_links.size(), _tunnels.size());
+	// _ingress_queue
+	VERBOSEF("iqp: %u iqd: %u iqh: %u", _ingress_queue.pushed(), _ingress_queue.dropped(), _ingress_queue.high_watermark());
+	// Packet and Interface handle copies and moves
+	VERBOSEF("pkc: %u pkm: %u ifc: %u ifm: %u", Packet::handle_copies(), Packet::handle_moves(), Interface::handle_copies(), Interface::handle_moves());
 	VERBOSEF("pin: %u pout: %u padd: %u pupd: %u pfail: %u dpr: %u ikd: %u ia: %u\r\n", _packets_received, _packets_sent, _paths_added, _paths_updated, _paths_failed, destination_path_responses, Identity::known_destinations().size(), interface_announces);
 #endif // RNS_DEBUG_METRICS
 
@@ -5500,6 +5842,8 @@ TRACEF("Transport::write_path_table: buffer size %lu bytes", Persistence::_buffe
 		persist_data();
 	}
 	detach_interfaces();
+	// Interfaces are gone so nothing is left to wait on
+	EventLoop::close();
 }
 
 /*p
@@ -6058,6 +6402,23 @@ TRACEF("Transport::write_path_table: buffer size %lu bytes", Persistence::_buffe
 }
 #endif
 
+/*static*/ bool Transport::remove_receipt(const PacketReceipt& receipt) {
+	// Only remove the receipt itself, not one that has since superseded it
+	auto iter = _receipts.find(receipt.truncated_hash());
+	if (iter == _receipts.end() || !((*iter).second == receipt)) {
+		return false;
+	}
+	_receipts.erase(iter);
+	return true;
+}
+
+/*static*/ void Transport::receipt_timeout_changed(const PacketReceipt& receipt) {
+	auto iter = _receipts.find(receipt.truncated_hash());
+	if (iter != _receipts.end() && (*iter).second == receipt) {
+		_receipt_deadlines.schedule(receipt.truncated_hash(), receipt.sent_at() + receipt.timeout());
+	}
+}
+
 /*static*/ uint16_t Transport::remove_links(const std::vector<Bytes>& hashes) {
 	uint16_t count = 0;
 	for (const auto& link_id : hashes) {
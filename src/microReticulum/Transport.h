@@ -16,10 +16,15 @@
 
 #include "Packet.h"
 #include "Bytes.h"
+#include "HashKey.h"
 #include "Type.h"
 #include "Utilities/Memory.h"
 #include "Utilities/GenerationalSet.h"
+#include "Utilities/FlatMap.h"
+#include "Utilities/DeadlineQueue.h"
+#include "Utilities/MpscRing.h"
 #include "Persistence/DestinationEntry.h"
+#include "Persistence/PathCache.h"
 
 #if defined(RNS_USE_FS) && RNS_PERSIST_HASHLIST
 #include <microStore/FileStore.h>
@@ -28,6 +33,7 @@
 #endif
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <list>
 #include <set>
@@ -41,6 +47,22 @@
 	#define RNS_LEAN_PATH_TABLE 1
 #endif
 
+// Use open-addressing Utilities::FlatMap (in the TLSF pool) instead of std::map for the
+// per-packet forwarding tables (link, reverse, path state and path request times)
+#ifndef RNS_FLAT_TABLES
+	#define RNS_FLAT_TABLES 0
+#endif
+
+// Received frames that interface threads can queue for Transport::loop() before further frames
+// are dropped (rounded up to a power of two)
+#ifndef RNS_INGRESS_QUEUE_SIZE
+	#if defined(NATIVE)
+		#define RNS_INGRESS_QUEUE_SIZE 1024
+	#else
+		#define RNS_INGRESS_QUEUE_SIZE 32
+	#endif
+#endif
+
 using namespace RNS::Persistence;
 
 namespace RNS {
@@ -80,8 +102,25 @@ namespace RNS {
 
 	public:
 
+#if RNS_FLAT_TABLES
+		template <typename V>
+		using FlatTable = Utilities::FlatMap<Hash16, V, std::hash<Hash16>, std::equal_to<Hash16>, Utilities::Memory::ContainerAllocator<std::pair<Hash16, V>>>;
+#endif
+
 		using InterfaceTable = std::vector<Interface>;
-		using DestinationTable = std::map<Bytes, Destination>;
+		// Registered interfaces indexed by the slot of their interned InterfaceId. An id holds the slot
+		// index (plus one) in its low byte and the slot generation in its high byte, so entries still
+		// holding the id of a deregistered interface never resolve to one registered in its place.
+		class InterfaceSlot {
+		public:
+			Interface _interface = {Type::NONE};
+			uint8_t _generation = 0;
+		};
+		using InterfaceSlots = std::vector<InterfaceSlot>;
+		static const size_t MAX_INTERFACE_SLOTS = 255;
+		using DestinationTable = std::map<Hash16, Destination>;
+		// Links keyed by link_id so inbound dispatch is a single hash lookup
+		using LinkIndex = std::unordered_map<Hash16, Link, std::hash<Hash16>, std::equal_to<Hash16>, Utilities::Memory::ContainerAllocator<std::pair<const Hash16, Link>>>;
 		using BytesList = RNS::Utilities::GenerationalSet<Bytes>;
 #if defined(RNS_USE_FS) && RNS_PERSIST_HASHLIST
 		using BytesStore = microStore::BasicFileStore<Utilities::Memory::ContainerAllocator<uint8_t>>;
@@ -131,7 +170,7 @@ namespace RNS {
 			}
 #endif
 		};
-		using PacketTable = std::map<Bytes, PacketEntry>;
+		using PacketTable = std::map<Hash32, PacketEntry>;
 
 		// CBA TODO Analyze safety of using Inrerface references here
 		// CBA TODO Analyze safety of using Packet references here
@@ -164,7 +203,7 @@ namespace RNS {
 			const Interface _attached_interface = {Type::NONE};
 		};
 		//using AnnounceTable = std::map<Bytes, AnnounceEntry>;
-		using AnnounceTable = std::map<Bytes, AnnounceEntry, std::less<Bytes>, Utilities::Memory::ContainerAllocator<std::pair<const Bytes, AnnounceEntry>>>;
+		using AnnounceTable = std::map<Hash16, AnnounceEntry, std::less<Hash16>, Utilities::Memory::ContainerAllocator<std::pair<const Hash16, AnnounceEntry>>>;
 
 		// CBA TODO Analyze safety of using Inrerface references here
 		class LinkEntry {
@@ -172,27 +211,34 @@ namespace RNS {
 			LinkEntry(double timestamp, const Bytes& next_hop, const Interface& outbound_interface, uint8_t remaining_hops, const Interface& receiving_interface, uint8_t hops, const Bytes& destination_hash, bool validated, double proof_timeout) :
 				_timestamp(timestamp),
 				_next_hop(next_hop),
-				_outbound_interface(outbound_interface),
+				_outbound_interface_id(outbound_interface.id()),
 				_remaining_hops(remaining_hops),
-				_receiving_interface(receiving_interface),
+				_receiving_interface_id(receiving_interface.id()),
 				_hops(hops),
 				_destination_hash(destination_hash),
 				_validated(validated),
 				_proof_timeout(proof_timeout)
 			{
 			}
+			// Resolve to {Type::NONE} once the interface has been deregistered
+			inline Interface outbound_interface() const { return find_interface_from_id(_outbound_interface_id); }
+			inline Interface receiving_interface() const { return find_interface_from_id(_receiving_interface_id); }
 		public:
 			double _timestamp = 0;
 			const Bytes _next_hop;
-			const Interface _outbound_interface = {Type::NONE};
+			const InterfaceId _outbound_interface_id = 0;
 			uint8_t _remaining_hops = 0;
-			Interface _receiving_interface = {Type::NONE};
+			InterfaceId _receiving_interface_id = 0;
 			uint8_t _hops = 0;
 			const Bytes _destination_hash;
 			bool _validated = false;
 			double _proof_timeout = 0;
 		};
-		using LinkTable = std::map<Bytes, LinkEntry>;
+#if RNS_FLAT_TABLES
+		using LinkTable = FlatTable<LinkEntry>;
+#else
+		using LinkTable = std::map<Hash16, LinkEntry>;
+#endif
 
 		// CBA TODO Analyze safety of using Inrerface references here
 		class ReverseEntry {
@@ -205,29 +251,36 @@ namespace RNS {
 			// named members instead. Parameter defaults to {} so call
 			// sites that have not yet been updated keep working.
 			ReverseEntry(const Interface& receiving_interface, const Interface& outbound_interface, double timestamp, const Bytes& next_hop = {}) :
-				_receiving_interface(receiving_interface),
-				_outbound_interface(outbound_interface),
+				_receiving_interface_id(receiving_interface.id()),
+				_outbound_interface_id(outbound_interface.id()),
 				_timestamp(timestamp),
 				_next_hop(next_hop)
 			{
 			}
 #else
 			ReverseEntry(const Interface& receiving_interface, const Interface& outbound_interface, double timestamp) :
-				_receiving_interface(receiving_interface),
-				_outbound_interface(outbound_interface),
+				_receiving_interface_id(receiving_interface.id()),
+				_outbound_interface_id(outbound_interface.id()),
 				_timestamp(timestamp)
 			{
 			}
 #endif
+			// Resolve to {Type::NONE} once the interface has been deregistered
+			inline Interface receiving_interface() const { return find_interface_from_id(_receiving_interface_id); }
+			inline Interface outbound_interface() const { return find_interface_from_id(_outbound_interface_id); }
 		public:
-			Interface _receiving_interface = {Type::NONE};
-			const Interface _outbound_interface = {Type::NONE};
+			InterfaceId _receiving_interface_id = 0;
+			const InterfaceId _outbound_interface_id = 0;
 			double _timestamp = 0;
 #if RNS_NEIGHBOR_PROBING
 			Bytes _next_hop;
 #endif
 		};
-		using ReverseTable = std::map<Bytes, ReverseEntry>;
+#if RNS_FLAT_TABLES
+		using ReverseTable = FlatTable<ReverseEntry>;
+#else
+		using ReverseTable = std::map<Hash16, ReverseEntry>;
+#endif
 
 #if RNS_NEIGHBOR_PROBING
 		// DIVERGENCE: per-direct-neighbor stats for passive liveness
@@ -245,9 +298,9 @@ namespace RNS {
 			Bytes    pending_probe_hash;   // truncated hash of in-flight probe packet
 		};
 		using NeighborStatsTable = std::map<
-			Bytes, NeighborStat,
-			std::less<Bytes>,
-			Utilities::Memory::ContainerAllocator<std::pair<const Bytes, NeighborStat>>
+			Hash16, NeighborStat,
+			std::less<Hash16>,
+			Utilities::Memory::ContainerAllocator<std::pair<const Hash16, NeighborStat>>
 		>;
 #endif
 
@@ -265,8 +318,12 @@ namespace RNS {
 			double _timeout = 0;
 			const Interface _requesting_interface = {Type::NONE};
 		};
-		using PathRequestTable = std::map<Bytes, PathRequestEntry>;
-		using PathStateTable = std::map<Bytes, uint8_t>;
+		using PathRequestTable = std::map<Hash16, PathRequestEntry>;
+#if RNS_FLAT_TABLES
+		using PathStateTable = FlatTable<uint8_t>;
+#else
+		using PathStateTable = std::map<Hash16, uint8_t>;
+#endif
 
 		class PendingDiscoveryPREntry {
 		public:
@@ -288,7 +345,7 @@ namespace RNS {
 			double _until = 0.0;       // 0.0 = permanent; otherwise unix timestamp expiry
 			std::string _reason;       // optional human-readable reason
 		};
-		using BlackholeTable = std::map<Bytes, BlackholeEntry>;
+		using BlackholeTable = std::map<Hash16, BlackholeEntry>;
 
 /*
 		// CBA TODO Analyze safety of using Inrerface references here
@@ -331,7 +388,7 @@ namespace RNS {
 			PathTable _serialised_paths;
 			double _expires = 0;
 		};
-		using TunnelTable = std::map<Bytes, TunnelEntry>;
+		using TunnelTable = std::map<Hash32, TunnelEntry>;
 
 		class RateEntry {
 		public:
@@ -346,19 +403,59 @@ namespace RNS {
 			double _blocked_until = 0.0;
 			std::vector<double> _timestamps;
 		};
-		using RateTable = std::map<Bytes, RateEntry>;
+		using RateTable = std::map<Hash16, RateEntry>;
+#if RNS_FLAT_TABLES
+		using PathRequestTimes = FlatTable<double>;
+#else
+		using PathRequestTimes = std::map<Hash16, double>;
+#endif
+		using PendingLocalPathRequests = std::map<Hash16, const Interface>;
+		// Outstanding receipts, indexed by the truncated hash of the packet they are for
+#if RNS_FLAT_TABLES
+		using ReceiptTable = FlatTable<PacketReceipt>;
+#else
+		using ReceiptTable = std::map<Hash16, PacketReceipt>;
+#endif
+		// Expiry and retransmit deadlines of table entries, keyed by the table key
+		using DeadlineQueue = Utilities::DeadlineQueue<Hash16, Utilities::Memory::ContainerAllocator<Hash16>>;
+		// Announce cap deadlines of interfaces with queued announces, by interface id
+		using InterfaceDeadlineQueue = Utilities::DeadlineQueue<InterfaceId>;
+		// Frame received on an interface thread, waiting for Transport::loop() to process it
+		class IngressFrame {
+		public:
+			Bytes _raw;
+			Interface _interface = {Type::NONE};
+		};
+		using IngressQueue = Utilities::MpscRing<IngressFrame>;
 
 	public:
 		static void start(const Reticulum& reticulum_instance);
 		static void loop();
+		// Time by which loop() next has work to do, for callers that sleep between loop() calls
+		static double next_loop_time();
+		// Has interfaces transmit any outgoing data they are holding for a batch
+		static void flush_interfaces();
+		static void process_ingress();
+		// Sends queued announces on interfaces whose announce cap allows it again
+		static void process_announce_queues();
 		static void jobs();
 		static bool transmit(Interface& interface, const Bytes& raw);
+		// Egress scheduler priority class of a packed packet
+		static Type::Interface::egress_classes egress_class_of(const Bytes& raw);
+		// Interface access codes, for interfaces with ifac() set. Signs raw and masks it with the IFAC
+		// into masked, or authenticates and unmasks a received raw into unmasked. Return false if the
+		// packet is to be dropped.
+		static bool ifac_mask(const Interface& interface, const Bytes& raw, Bytes& masked);
+		static bool ifac_unmask(const Interface& interface, const Bytes& raw, Bytes& unmasked);
 		static bool outbound(Packet& packet);
 		static void add_packet_hash(const Bytes& packet_hash);
 		static bool packet_filter(const Packet& packet);
 		//static void inbound(const Bytes& raw, const Interface& interface = {Type::NONE});
 		static void inbound(const Bytes& raw, const Interface& interface);
 		static void inbound(const Bytes& raw);
+		// DIVERGENCE: Python interfaces call inbound() from their own threads. Here that is only safe
+		// from the thread running Reticulum::loop(), any other thread must queue_inbound() instead.
+		static bool queue_inbound(const Bytes& raw, const Interface& interface);
 		static void synthesize_tunnel(const Interface& interface);
 		static void tunnel_synthesize_handler(const Bytes& data, const Packet& packet);
 		static void handle_tunnel(const Bytes& tunnel_id, const Interface& interface);
@@ -373,6 +470,7 @@ namespace RNS {
 		static void deregister_announce_handler(HAnnounceHandler handler);
 		static bool is_interface_from_hash(const Bytes& interface_hash);
 		static Interface find_interface_from_hash(const Bytes& interface_hash);
+		static Interface find_interface_from_id(InterfaceId interface_id);
 		static bool should_cache_packet(const Packet& packet);
 		static bool cache_packet(const Packet& packet, bool force_cache = false);
 		static bool is_cached_packet(const Bytes& packet_hash);
@@ -428,6 +526,7 @@ namespace RNS {
 		static void shared_connection_disappeared();
 		static void shared_connection_reappeared();
 		static void drop_announce_queues();
+		static void schedule_announce_queue(const Interface& interface);
 		static uint64_t announce_emitted(const Packet& packet);
 		static bool read_path_table();
 		static bool write_path_table();
@@ -439,6 +538,8 @@ namespace RNS {
 		static void dump_stats();
 		static void exit_handler();
 
+		static bool remove_receipt(const PacketReceipt& receipt);
+		static void receipt_timeout_changed(const PacketReceipt& receipt);
 		static uint16_t remove_reverse_entries(const std::vector<Bytes>& hashes);
 		static uint16_t remove_links(const std::vector<Bytes>& hashes);
 		static uint16_t remove_paths(const std::vector<Bytes>& hashes);
@@ -486,7 +587,7 @@ namespace RNS {
 		}
 		static inline bool has_network_identity() { return (bool)_network_identity; }
 		inline static uint16_t path_table_maxsize() { return _path_table_maxsize; }
-		inline static void path_table_maxsize(uint16_t path_table_maxsize) { _path_table_maxsize = path_table_maxsize; _path_store.set_max_recs(_path_table_maxsize); }
+		inline static void path_table_maxsize(uint16_t path_table_maxsize) { _path_table_maxsize = path_table_maxsize; _path_store.set_max_recs(_path_table_maxsize); _route_store.set_max_recs(_path_table_maxsize); }
 		inline static uint16_t announce_table_maxsize() { return _announce_table_maxsize; }
 		inline static void announce_table_maxsize(uint16_t announce_table_maxsize) { _announce_table_maxsize = announce_table_maxsize; }
 		inline static uint16_t hashlist_maxsize() { return _hashlist_maxsize; }
@@ -516,11 +617,11 @@ namespace RNS {
 		inline static const Destination& network_destination() { return _network_destination; }
 
 		inline static const PathTable& path_table() { return _path_table; }
-		inline static const NewPathTable& new_path_table() { return _new_path_table; }
+		inline static const CachedPathTable& new_path_table() { return _new_path_table; }
 		inline static const RateTable& announce_rate_table() { return _announce_rate_table; }
 		inline static const LinkTable& link_table() { return _link_table; }
-		inline static const std::set<Link>& pending_links() { return _pending_links; }
-		inline static const std::set<Link>& active_links() { return _active_links; }
+		inline static const LinkIndex& pending_links() { return _pending_links; }
+		inline static const LinkIndex& active_links() { return _active_links; }
 		inline static const DestinationTable& destinations() { return _destinations; }
 		inline static const AnnounceTable& announce_table() { return _announce_table; }
 		inline static const AnnounceTable& held_announces() { return _held_announces; }
@@ -530,18 +631,20 @@ namespace RNS {
 		// stats — useful for diagnostics and tests.
 		inline static const NeighborStatsTable& neighbor_stats() { return _neighbor_stats; }
 #endif
-		inline static const std::map<Bytes, double>& path_requests() { return _path_requests; }
+		inline static const PathRequestTimes& path_requests() { return _path_requests; }
 		inline static const PathRequestTable& discovery_path_requests() { return _discovery_path_requests; }
 		inline static const PathStateTable& path_states() { return _path_states; }
 		inline static const PendingDiscoveryPRs& pending_discovery_prs() { return _pending_discovery_prs; }
 		inline static const BlackholeTable& blackholed_identities() { return _blackholed_identities; }
-		inline static const std::map<Bytes, const Interface>& pending_local_path_requests() { return _pending_local_path_requests; }
+		inline static const PendingLocalPathRequests& pending_local_path_requests() { return _pending_local_path_requests; }
+		inline static const std::set<Interface>& local_client_interfaces() { return _local_client_interfaces; }
 		inline static const BytesList& discovery_pr_tags() { return _discovery_pr_tags; }
 		inline static const std::set<Destination>& control_destinations() { return _control_destinations; }
 		inline static const std::set<Bytes>& control_hashes() { return _control_hashes; }
 		inline static const PersistedBytesList& packet_hashlist() { return _packet_hashlist; }
-		inline static const std::list<PacketReceipt>& receipts() { return _receipts; }
+		inline static const ReceiptTable& receipts() { return _receipts; }
 		inline static const TunnelTable& tunnels() { return _tunnels; }
+		inline static const IngressQueue& ingress_queue() { return _ingress_queue; }
 
 		inline static uint32_t packets_sent() { return _packets_sent; }
 		inline static uint32_t packets_received() { return _packets_received; }
@@ -568,13 +671,16 @@ namespace RNS {
 		// CBA MUST use references to interfaces here in order for virtul overrides for send/receive to work
 		// map is sorted, can use find
 		static InterfaceTable _interfaces;			// All active interfaces
+		static InterfaceSlots _interface_slots;		// Active interfaces by interned id
+		static IngressQueue _ingress_queue;			// Frames received on interface threads
+		static Bytes _ifac_buffer;					// Reused for packets masked for IFAC interfaces
+		static Bytes _ifac_mask;					// Reused for IFAC masks
 		static DestinationTable _destinations;		// All active destinations
-		// CBA TODO: Reconsider using std::set for enforcing uniqueness. Maybe consider std::map keyed on hash instead
-		static std::set<Link> _pending_links;		// Links that are being established
-		static std::set<Link> _active_links;		// Links that are active
+		static LinkIndex _pending_links;			// Links that are being established
+		static LinkIndex _active_links;				// Links that are active
 		static BytesStore _packet_hash_store;
 		static PersistedBytesList _packet_hashlist;  // Set of packet hashes for duplicate detection
-		static std::list<PacketReceipt> _receipts;	// Receipts of all outgoing packets for proof processing
+		static ReceiptTable _receipts;				// Receipts of all outgoing packets for proof processing
 
 		static AnnounceTable _announce_table;	// A table for storing announces currently waiting to be retransmitted
 		static PathTable _path_table;			// A lookup table containing the next hop to a given destination
@@ -589,7 +695,7 @@ namespace RNS {
 		static TunnelTable _tunnels;			// A table storing tunnels to other transport instances
 		static RateTable _announce_rate_table;	// A table for keeping track of announce rates
 		static std::set<HAnnounceHandler> _announce_handlers;	// A table storing externally registered announce handlers
-		static std::map<Bytes, double> _path_requests;	// A table for storing path request timestamps
+		static PathRequestTimes _path_requests;	// A table for storing path request timestamps
 
 		static PathRequestTable _discovery_path_requests;	// A table for keeping track of path requests on behalf of other nodes
 		static BytesList _discovery_pr_tags;	// A table for keeping track of tagged path requests
@@ -598,6 +704,15 @@ namespace RNS {
 		static double _pending_discovery_prs_last_tx;		// Timestamp of last discovery path request transmission
 		static BlackholeTable _blackholed_identities;		// Identity hashes blocked from path-table population
 
+		// Deadlines of the timed table entries above, so jobs() only visits entries that are due
+		static DeadlineQueue _receipt_deadlines;			// Receipt timeouts
+		static DeadlineQueue _announce_deadlines;			// Announce table retransmit timeouts
+		static DeadlineQueue _reverse_deadlines;			// Reverse table entry expiry
+		static DeadlineQueue _link_deadlines;				// Link table proof and link timeouts
+		static DeadlineQueue _path_request_deadlines;		// Path request gate timeouts
+		static DeadlineQueue _discovery_pr_deadlines;		// Discovery path request timeouts
+		static InterfaceDeadlineQueue _announce_queue_deadlines;	// Interface announce queue processing
+
 		// Transport control destinations are used
 		// for control purposes like path requests
 		static std::set<Destination> _control_destinations;
@@ -608,10 +723,9 @@ namespace RNS {
 		// Interfaces for communicating with
 		// local clients connected to a shared
 		// Reticulum instance
-		//static std::set<Interface> _local_client_interfaces;
-		static std::set<std::reference_wrapper<const Interface>, std::less<const Interface>> _local_client_interfaces;
+		static std::set<Interface> _local_client_interfaces;
 
-		static std::map<Bytes, const Interface> _pending_local_path_requests;
+		static PendingLocalPathRequests _pending_local_path_requests;
 
 		// CBA
 		static PacketTable _packet_table;           // A lookup table containing announce packets for known paths
@@ -622,7 +736,6 @@ namespace RNS {
 
 		static double _start_time;
 		static bool _jobs_locked;
-		static bool _jobs_running;
 		static float _job_interval;
 		static double _jobs_last_run;
 		static double _links_last_checked;
@@ -701,7 +814,8 @@ namespace RNS {
 		static uint32_t _path_store_segment_size;
 		static uint8_t _path_store_segment_count;
 		static PathStore _path_store;
-		static NewPathTable _new_path_table;
+		static PathStore _route_store;
+		static CachedPathTable _new_path_table;
 
 		static uint32_t _hashlist_segment_size;
 		static uint8_t _hashlist_segment_count;
@@ -55,6 +55,11 @@
 #define RNS_QUEUED_ANNOUNCES_MAX 20
 #endif
 
+// Packets held per priority class by an interface's egress scheduler
+#ifndef RNS_EGRESS_QUEUE_MAX
+#define RNS_EGRESS_QUEUE_MAX 16
+#endif
+
 #ifndef RNS_RECEIPTS_MAX
 #define RNS_RECEIPTS_MAX 20
 #endif
@@ -394,6 +399,16 @@ namespace RNS { namespace Type {
 			MODE_GATEWAY        = 0x40,
 		};
 
+		// Egress scheduler priority classes, lower classes are always sent first
+		enum egress_classes {
+			EGRESS_LINK_CONTROL = 0x00,   // Link requests, proofs, keepalives, RTT and close messages
+			EGRESS_LINK_DATA    = 0x01,   // Link data including resource parts, and other data
+			EGRESS_PATH_REQUEST = 0x02,   // Path requests and other transport control traffic
+			EGRESS_ANNOUNCE     = 0x03,   // Announces
+		};
+		static const uint8_t EGRESS_CLASSES     = 4;
+		static const uint16_t EGRESS_QUEUE_MAX  = RNS_EGRESS_QUEUE_MAX;
+
 	}
 
 	namespace Packet {
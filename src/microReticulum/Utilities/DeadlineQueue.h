@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+
+namespace RNS { namespace Utilities {
+
+	// Min-heap of (deadline, key) pairs for driving timeouts from the entries that own them, so periodic
+	// jobs only visit entries that are actually due instead of sweeping whole tables.
+	//
+	// The queue does not own the entries it schedules and is never told when one is removed or its
+	// deadline changes. Instead the caller re-validates each popped key against its own table:
+	//  - entry gone: ignore it
+	//  - deadline moved later: schedule() it again at the new deadline
+	//  - otherwise: the entry is expired, handle it
+	// When every write of a deadline schedules it, a popped deadline that no longer matches the entry
+	// can simply be dropped since a matching one is still queued.
+	//
+	// Entries with equal deadlines pop in the order they were scheduled. Stale entries are only
+	// discarded when they come due, so prune() is provided for callers whose tables churn much faster
+	// than their timeouts.
+	template <typename Key,
+	          typename Allocator = std::allocator<Key>>
+	class DeadlineQueue {
+
+	public:
+		using key_type  = Key;
+		using size_type = std::size_t;
+
+	private:
+		struct Item {
+			double _deadline;
+			uint32_t _sequence;
+			Key _key;
+		};
+		// Orders the heap so the earliest deadline (then earliest scheduled) is at the front
+		struct Later {
+			inline bool operator()(const Item& lhs, const Item& rhs) const {
+				if (lhs._deadline != rhs._deadline) return lhs._deadline > rhs._deadline;
+				// wrap-safe comparison of sequence numbers
+				return (int32_t)(lhs._sequence - rhs._sequence) > 0;
+			}
+		};
+		using ItemAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Item>;
+
+	public:
+		DeadlineQueue() = default;
+		explicit DeadlineQueue(const Allocator& allocator) : _heap(ItemAllocator(allocator)) {}
+
+		// Schedule key to come due once time passes deadline
+		inline void schedule(const Key& key, double deadline) {
+			_heap.push_back(Item{deadline, _sequence++, key});
+			std::push_heap(_heap.begin(), _heap.end(), Later());
+		}
+
+		// Removes the earliest entry if its deadline is before now, returns false if nothing is due
+		inline bool pop_due(double now, Key& key, double& deadline) {
+			if (_heap.empty() || !(_heap.front()._deadline < now)) {
+				return false;
+			}
+			std::pop_heap(_heap.begin(), _heap.end(), Later());
+			key = std::move(_heap.back()._key);
+			deadline = _heap.back()._deadline;
+			_heap.pop_back();
+			return true;
+		}
+		inline bool pop_due(double now, Key& key) {
+			double deadline;
+			return pop_due(now, key, deadline);
+		}
+
+		// Earliest scheduled deadline, or 0 if nothing is scheduled
+		inline double next_deadline() const { return _heap.empty() ? 0.0 : _heap.front()._deadline; }
+
+		// Drops every entry for which stale(key) returns true, returns the number removed
+		template <typename Predicate>
+		size_type prune(Predicate stale) {
+			size_type before = _heap.size();
+			_heap.erase(std::remove_if(_heap.begin(), _heap.end(), [&stale](const Item& item) { return stale(item._key); }), _heap.end());
+			std::make_heap(_heap.begin(), _heap.end(), Later());
+			return before - _heap.size();
+		}
+
+		inline size_type size() const { return _heap.size(); }
+		inline bool empty() const { return _heap.empty(); }
+		inline void reserve(size_type capacity) { _heap.reserve(capacity); }
+		inline void clear() { _heap.clear(); }
+
+	private:
+		std::vector<Item, ItemAllocator> _heap;
+		uint32_t _sequence = 0;
+
+	};
+
+} }
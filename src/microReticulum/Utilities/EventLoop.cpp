@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#include "EventLoop.h"
+
+#include "../Log.h"
+
+#include <algorithm>
+
+#if RNS_EVENT_LOOP
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#else
+#include <poll.h>
+#include <fcntl.h>
+#endif
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#endif
+
+using namespace RNS;
+using namespace RNS::Utilities;
+
+/*static*/ std::vector<int> EventLoop::_fds;
+/*static*/ int EventLoop::_wait_fd = -1;
+/*static*/ int EventLoop::_wake_fd = -1;
+/*static*/ std::atomic<int> EventLoop::_wake_write_fd{-1};
+/*static*/ std::atomic<bool> EventLoop::_wake_pending{false};
+
+namespace {
+
+// Defined after the members above so it runs before they're destroyed, releases the wait descriptors
+// at exit for instances that never reach Transport::exit_handler()
+struct EventLoopRelease {
+	~EventLoopRelease() { EventLoop::close(); }
+} event_loop_release;
+
+}
+
+/*static*/ bool EventLoop::open() {
+#if RNS_EVENT_LOOP
+	if (_wake_fd >= 0) {
+		return true;
+	}
+	_wake_pending.store(false);
+#if defined(__linux__)
+	_wait_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (_wait_fd < 0) {
+		ERRORF("EventLoop: Unable to create epoll instance with error %d", errno);
+		return false;
+	}
+	_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_wake_fd < 0) {
+		ERRORF("EventLoop: Unable to create eventfd with error %d", errno);
+		::close(_wait_fd);
+		_wait_fd = -1;
+		return false;
+	}
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.fd = _wake_fd;
+	if (epoll_ctl(_wait_fd, EPOLL_CTL_ADD, _wake_fd, &event) == -1) {
+		ERRORF("EventLoop: Unable to watch eventfd with error %d", errno);
+		::close(_wake_fd);
+		::close(_wait_fd);
+		_wake_fd = -1;
+		_wait_fd = -1;
+		return false;
+	}
+	_wake_write_fd.store(_wake_fd);
+#else
+	int fds[2];
+	if (pipe(fds) == -1) {
+		ERRORF("EventLoop: Unable to create wake pipe with error %d", errno);
+		return false;
+	}
+	fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+	fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+	fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+	_wake_fd = fds[0];
+	_wake_write_fd.store(fds[1]);
+#endif
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*static*/ void EventLoop::close() {
+#if RNS_EVENT_LOOP
+	_fds.clear();
+	int wake_write_fd = _wake_write_fd.exchange(-1);
+	if (wake_write_fd >= 0 && wake_write_fd != _wake_fd) {
+		::close(wake_write_fd);
+	}
+	if (_wake_fd >= 0) {
+		::close(_wake_fd);
+		_wake_fd = -1;
+	}
+	if (_wait_fd >= 0) {
+		::close(_wait_fd);
+		_wait_fd = -1;
+	}
+#endif
+}
+
+/*static*/ bool EventLoop::watch(int fd) {
+#if RNS_EVENT_LOOP
+	if (fd < 0) {
+		return false;
+	}
+	if (watching(fd)) {
+		return true;
+	}
+	if (!open()) {
+		return false;
+	}
+#if defined(__linux__)
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.fd = fd;
+	if (epoll_ctl(_wait_fd, EPOLL_CTL_ADD, fd, &event) == -1 && errno != EEXIST) {
+		ERRORF("EventLoop: Unable to watch fd %d with error %d", fd, errno);
+		return false;
+	}
+#endif
+	_fds.push_back(fd);
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*static*/ void EventLoop::unwatch(int fd) {
+	auto iter = std::find(_fds.begin(), _fds.end(), fd);
+	if (iter == _fds.end()) {
+		return;
+	}
+	_fds.erase(iter);
+#if RNS_EVENT_LOOP && defined(__linux__)
+	// Fails harmlessly if fd was already closed, which removes it from the epoll set anyway
+	if (_wait_fd >= 0) {
+		epoll_ctl(_wait_fd, EPOLL_CTL_DEL, fd, nullptr);
+	}
+#endif
+}
+
+/*static*/ bool EventLoop::watching(int fd) {
+	return std::find(_fds.begin(), _fds.end(), fd) != _fds.end();
+}
+
+/*static*/ bool EventLoop::wait(double timeout) {
+#if RNS_EVENT_LOOP
+	if (!open()) {
+		return false;
+	}
+	// Round up so a wait never ends just short of a deadline and leaves the caller spinning to it
+	int timeout_ms = 0;
+	if (timeout > 0) {
+		double ms = timeout * 1000.0;
+		timeout_ms = (ms >= (double)INT_MAX) ? INT_MAX : (int)ms;
+		if ((double)timeout_ms < ms) {
+			++timeout_ms;
+		}
+	}
+#if defined(__linux__)
+	epoll_event events[16];
+	int count = epoll_wait(_wait_fd, events, sizeof(events)/sizeof(events[0]), timeout_ms);
+	if (count <= 0) {
+		// timeout, or interrupted by a signal
+		return false;
+	}
+	for (int i = 0; i < count; ++i) {
+		if (events[i].data.fd == _wake_fd) {
+			drain_wake();
+		}
+	}
+	return true;
+#else
+	std::vector<pollfd> pollfds;
+	pollfds.reserve(_fds.size() + 1);
+	pollfds.push_back({_wake_fd, POLLIN, 0});
+	for (int fd : _fds) {
+		pollfds.push_back({fd, POLLIN, 0});
+	}
+	int count = poll(pollfds.data(), pollfds.size(), timeout_ms);
+	if (count <= 0) {
+		return false;
+	}
+	if (pollfds[0].revents != 0) {
+		drain_wake();
+	}
+	return true;
+#endif
+#else
+	return false;
+#endif
+}
+
+/*static*/ void EventLoop::wake() {
+#if RNS_EVENT_LOOP
+	int wake_write_fd = _wake_write_fd.load();
+	if (wake_write_fd < 0) {
+		return;
+	}
+	// Only one wake needs to be outstanding, saves a syscall per call while the waiter catches up
+	if (_wake_pending.exchange(true)) {
+		return;
+	}
+#if defined(__linux__)
+	uint64_t one = 1;
+	ssize_t written = write(wake_write_fd, &one, sizeof(one));
+#else
+	uint8_t one = 1;
+	ssize_t written = write(wake_write_fd, &one, sizeof(one));
+#endif
+	(void)written;
+#endif
+}
+
+/*static*/ void EventLoop::drain_wake() {
+#if RNS_EVENT_LOOP
+#if defined(__linux__)
+	uint64_t value;
+	ssize_t read_size = read(_wake_fd, &value, sizeof(value));
+	(void)read_size;
+#else
+	uint8_t buffer[64];
+	while (read(_wake_fd, buffer, sizeof(buffer)) > 0) {}
+#endif
+	// Cleared after draining so a wake() racing with this either finds the flag set and its work is
+	// picked up by the loop() that follows, or finds it clear and writes a fresh wake
+	_wake_pending.store(false);
+#endif
+}
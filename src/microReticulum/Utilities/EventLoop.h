@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+
+// Blocking wait on file descriptors for Reticulum::wait() (epoll on Linux, poll elsewhere). Without
+// it wait() returns immediately and callers keep polling as before.
+#ifndef RNS_EVENT_LOOP
+	#if defined(ARDUINO)
+		#define RNS_EVENT_LOOP 0
+	#else
+		#define RNS_EVENT_LOOP 1
+	#endif
+#endif
+
+namespace RNS { namespace Utilities {
+
+	// Process-wide set of watched file descriptors that the Reticulum thread blocks on between loop()
+	// calls, so an idle instance sleeps until input arrives instead of spinning.
+	//
+	// Descriptors are level-triggered: wait() returns while any watched descriptor is readable, so
+	// whoever owns the descriptor must drain it (interfaces do so from loop()). Any thread may call
+	// wake() to cut a wait() short, e.g. after queueing work for the Reticulum thread.
+	//
+	// Everything except wake() must only be called from the Reticulum thread.
+	class EventLoop {
+
+	public:
+		// Watch fd for readability, returns false if it can't be watched
+		static bool watch(int fd);
+		static void unwatch(int fd);
+		static bool watching(int fd);
+		inline static const std::vector<int>& watched() { return _fds; }
+
+		// Blocks up to timeout seconds until a watched fd is readable or wake() is called, returns true
+		// if woken before the timeout
+		static bool wait(double timeout);
+		// Thread-safe, makes the current or next wait() return immediately
+		static void wake();
+
+		// Creates the wait descriptors, done lazily by watch() and wait() but should be done before any
+		// thread can call wake() so its first wake can't be missed
+		static bool open();
+		// Stop watching everything and release the wait descriptors, done by Transport::exit_handler() and
+		// at process exit
+		static void close();
+
+	private:
+		static void drain_wake();
+
+	private:
+		static std::vector<int> _fds;
+		static int _wait_fd;
+		static int _wake_fd;
+		static std::atomic<int> _wake_write_fd;
+		static std::atomic<bool> _wake_pending;
+
+	};
+
+} }
@@ -0,0 +1,436 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include <new>
+#include <type_traits>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+
+namespace RNS { namespace Utilities {
+
+	// Open-addressing hash map using Robin Hood probing, intended as a drop-in replacement for the subset of
+	// std::map used by the Transport tables (find/insert/emplace/erase/operator[]/iteration).
+	//
+	// Entries are held in a single flat slot array, so lookups touch one or two cache lines instead of walking
+	// a tree of individually allocated nodes. The slot array is a power-of-two bucket count followed by a
+	// tail of max_probe overflow slots, so probe sequences never wrap and erase uses backward-shift deletion
+	// (no tombstones). The table grows when the load factor or the probe limit is exceeded.
+	//
+	// Allocator is rebound to the internal slot type, so Memory::ContainerAllocator places the slot array in
+	// the TLSF pool like the node-based containers.
+	//
+	// Unlike std::map:
+	//  - iteration order is unspecified
+	//  - insert() may invalidate all iterators and references (on growth), and erase() may move other entries,
+	//    so callers must not hold references into the table across calls that can modify it
+	//  - value_type is std::pair<Key, T> (non-const key) so entries can be relocated
+	template <typename Key,
+	          typename T,
+	          typename Hash = std::hash<Key>,
+	          typename KeyEqual = std::equal_to<Key>,
+	          typename Allocator = std::allocator<std::pair<Key, T>>>
+	class FlatMap {
+
+	public:
+		using key_type        = Key;
+		using mapped_type     = T;
+		using value_type      = std::pair<Key, T>;
+		using size_type       = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using hasher          = Hash;
+		using key_equal       = KeyEqual;
+		using allocator_type  = Allocator;
+		using reference       = value_type&;
+		using const_reference = const value_type&;
+
+	private:
+		static constexpr size_type MIN_CAPACITY = 8;
+		static constexpr int16_t EMPTY = -1;
+		static constexpr size_type MAX_PROBE_LIMIT = INT16_MAX;
+
+		struct Slot {
+			// distance from ideal bucket, EMPTY if unused
+			int16_t distance;
+			alignas(value_type) unsigned char storage[sizeof(value_type)];
+
+			inline value_type* value() { return reinterpret_cast<value_type*>(storage); }
+			inline const value_type* value() const { return reinterpret_cast<const value_type*>(storage); }
+		};
+
+		using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+		using SlotTraits = std::allocator_traits<SlotAllocator>;
+
+	public:
+		template <bool IsConst>
+		class basic_iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type        = typename FlatMap::value_type;
+			using difference_type   = std::ptrdiff_t;
+			using pointer           = typename std::conditional<IsConst, const value_type*, value_type*>::type;
+			using reference         = typename std::conditional<IsConst, const value_type&, value_type&>::type;
+			using slot_pointer      = typename std::conditional<IsConst, const Slot*, Slot*>::type;
+
+			basic_iterator() = default;
+			// allow iterator -> const_iterator
+			template <bool C = IsConst, typename std::enable_if<C, int>::type = 0>
+			basic_iterator(const basic_iterator<false>& it) : _slot(it._slot) {}
+
+			inline reference operator*() const { return *_slot->value(); }
+			inline pointer operator->() const { return _slot->value(); }
+			inline basic_iterator& operator++() { ++_slot; skip(); return *this; }
+			inline basic_iterator operator++(int) { basic_iterator tmp(*this); ++(*this); return tmp; }
+			inline bool operator==(const basic_iterator& it) const { return _slot == it._slot; }
+			inline bool operator!=(const basic_iterator& it) const { return _slot != it._slot; }
+
+		private:
+			friend class FlatMap;
+			template <bool> friend class basic_iterator;
+			explicit basic_iterator(slot_pointer slot) : _slot(slot) {}
+			// advance to next occupied slot, the sentinel slot past the end is always marked occupied
+			inline void skip() { while (_slot->distance == EMPTY) ++_slot; }
+
+			slot_pointer _slot = nullptr;
+		};
+
+		using iterator       = basic_iterator<false>;
+		using const_iterator = basic_iterator<true>;
+
+	public:
+		FlatMap() = default;
+		explicit FlatMap(const Allocator& alloc) : _alloc(alloc) {}
+		FlatMap(const FlatMap& map) : _hash(map._hash), _equal(map._equal), _alloc(SlotTraits::select_on_container_copy_construction(map._alloc)) {
+			reserve(map._size);
+			for (const auto& value : map) {
+				place(value_type(value));
+			}
+		}
+		FlatMap(FlatMap&& map) noexcept : _hash(std::move(map._hash)), _equal(std::move(map._equal)), _alloc(std::move(map._alloc)) {
+			take(map);
+		}
+		~FlatMap() {
+			release();
+		}
+
+		FlatMap& operator=(const FlatMap& map) {
+			if (this != &map) {
+				FlatMap copy(map);
+				swap(copy);
+			}
+			return *this;
+		}
+		FlatMap& operator=(FlatMap&& map) noexcept {
+			if (this != &map) {
+				release();
+				_hash = std::move(map._hash);
+				_equal = std::move(map._equal);
+				_alloc = std::move(map._alloc);
+				take(map);
+			}
+			return *this;
+		}
+
+		void swap(FlatMap& map) noexcept {
+			using std::swap;
+			swap(_hash, map._hash);
+			swap(_equal, map._equal);
+			swap(_alloc, map._alloc);
+			swap(_slots, map._slots);
+			swap(_capacity, map._capacity);
+			swap(_max_probe, map._max_probe);
+			swap(_shift, map._shift);
+			swap(_size, map._size);
+		}
+
+	public:
+		inline iterator begin() { if (_size == 0) return end(); iterator it(_slots); it.skip(); return it; }
+		inline iterator end() { return iterator(_slots + slot_count()); }
+		inline const_iterator begin() const { if (_size == 0) return end(); const_iterator it(_slots); it.skip(); return it; }
+		inline const_iterator end() const { return const_iterator(_slots + slot_count()); }
+		inline const_iterator cbegin() const { return begin(); }
+		inline const_iterator cend() const { return end(); }
+
+		inline size_type size() const { return _size; }
+		inline bool empty() const { return _size == 0; }
+		inline size_type bucket_count() const { return _capacity; }
+		inline float load_factor() const { return (_capacity > 0) ? (float)_size / (float)_capacity : 0.0f; }
+		inline allocator_type get_allocator() const { return allocator_type(_alloc); }
+
+		iterator find(const Key& key) {
+			Slot* slot = lookup(key);
+			return (slot != nullptr) ? iterator(slot) : end();
+		}
+		const_iterator find(const Key& key) const {
+			const Slot* slot = const_cast<FlatMap*>(this)->lookup(key);
+			return (slot != nullptr) ? const_iterator(slot) : end();
+		}
+		inline size_type count(const Key& key) const {
+			return (const_cast<FlatMap*>(this)->lookup(key) != nullptr) ? 1 : 0;
+		}
+
+		inline std::pair<iterator, bool> insert(const value_type& value) {
+			return emplace_value(value_type(value));
+		}
+		inline std::pair<iterator, bool> insert(value_type&& value) {
+			return emplace_value(std::move(value));
+		}
+		template <typename... Args>
+		inline std::pair<iterator, bool> emplace(Args&&... args) {
+			return emplace_value(value_type(std::forward<Args>(args)...));
+		}
+
+		T& operator[](const Key& key) {
+			Slot* slot = lookup(key);
+			if (slot != nullptr) {
+				return slot->value()->second;
+			}
+			return emplace_value(value_type(key, T())).first->second;
+		}
+
+		size_type erase(const Key& key) {
+			Slot* slot = lookup(key);
+			if (slot == nullptr) {
+				return 0;
+			}
+			remove(slot);
+			return 1;
+		}
+		// Returns iterator to the entry following the erased one. Entries shifted back into the erased slot
+		// have not yet been visited, so erase-while-iterating visits every remaining entry exactly once.
+		iterator erase(const_iterator pos) {
+			Slot* slot = const_cast<Slot*>(pos._slot);
+			remove(slot);
+			iterator it(slot);
+			it.skip();
+			return it;
+		}
+		inline iterator erase(iterator pos) {
+			return erase(const_iterator(pos));
+		}
+
+		void clear() {
+			if (_slots == nullptr) {
+				return;
+			}
+			for (size_type i = 0; i < slot_count(); ++i) {
+				if (_slots[i].distance != EMPTY) {
+					_slots[i].value()->~value_type();
+					_slots[i].distance = EMPTY;
+				}
+			}
+			_size = 0;
+		}
+
+		// Ensure capacity for count entries without growth
+		void reserve(size_type count) {
+			if (count == 0) {
+				return;
+			}
+			size_type capacity = MIN_CAPACITY;
+			while (count > max_load(capacity)) {
+				capacity <<= 1;
+			}
+			if (capacity > _capacity) {
+				rehash(capacity, _max_probe);
+			}
+		}
+
+	private:
+		static inline size_type max_load(size_type capacity) { return capacity - (capacity >> 3); }
+		inline size_type slot_count() const { return (_capacity > 0) ? _capacity + _max_probe : 0; }
+
+		// Fibonacci hashing spreads weak hashes across the bucket range and selects the bucket from the top bits
+		inline size_type bucket(const Key& key) const {
+			return (size_type)(((uint64_t)_hash(key) * UINT64_C(0x9E3779B97F4A7C15)) >> _shift);
+		}
+
+		Slot* lookup(const Key& key) {
+			if (_size == 0) {
+				return nullptr;
+			}
+			Slot* slot = _slots + bucket(key);
+			// robin hood invariant, key cannot be further from its bucket than the resident entry
+			for (int16_t distance = 0; distance <= slot->distance; ++distance, ++slot) {
+				if (_equal(slot->value()->first, key)) {
+					return slot;
+				}
+			}
+			return nullptr;
+		}
+
+		std::pair<iterator, bool> emplace_value(value_type&& value) {
+			Slot* slot = lookup(value.first);
+			if (slot != nullptr) {
+				return {iterator(slot), false};
+			}
+			if (_size + 1 > max_load(_capacity)) {
+				rehash((_capacity > 0) ? _capacity << 1 : MIN_CAPACITY, _max_probe);
+			}
+			Key key(value.first);
+			if (!place(std::move(value))) {
+				// placement triggered growth so the entry moved, locate it again
+				return {find(key), true};
+			}
+			return {iterator(_last), true};
+		}
+
+		// Insert a value known to be absent. Returns false if the table had to grow along the way, in which case
+		// _last is not valid. Values are relocated by move-construction only so entries need not be assignable.
+		bool place(value_type&& value) {
+			bool grown = false;
+			if (_capacity == 0) {
+				rehash(MIN_CAPACITY, 0);
+				grown = true;
+			}
+			Slot carry;
+			new (carry.storage) value_type(std::move(value));
+			bool carrying_new = true;
+			size_type index = bucket(carry.value()->first);
+			int16_t distance = 0;
+			while (true) {
+				if (distance > (int16_t)_max_probe) {
+					// probe limit reached, grow and start over with whatever entry is in hand. A sparse table
+					// overflowing means keys are clustered (weak hash), so lengthen probes instead of doubling.
+					if (_size >= (_capacity >> 2)) {
+						rehash(_capacity << 1, _max_probe);
+					}
+					else if (_max_probe < MAX_PROBE_LIMIT) {
+						rehash(_capacity, ((_max_probe << 1) < MAX_PROBE_LIMIT) ? (_max_probe << 1) : (size_type)MAX_PROBE_LIMIT);
+					}
+					else {
+						carry.value()->~value_type();
+						throw std::length_error("FlatMap probe limit exceeded");
+					}
+					grown = true;
+					index = bucket(carry.value()->first);
+					distance = 0;
+					continue;
+				}
+				Slot& slot = _slots[index];
+				if (slot.distance == EMPTY) {
+					new (slot.storage) value_type(std::move(*carry.value()));
+					carry.value()->~value_type();
+					slot.distance = distance;
+					if (carrying_new) _last = &slot;
+					++_size;
+					return !grown;
+				}
+				if (slot.distance < distance) {
+					// displace the richer resident entry and carry it forward
+					Slot tmp;
+					new (tmp.storage) value_type(std::move(*slot.value()));
+					slot.value()->~value_type();
+					new (slot.storage) value_type(std::move(*carry.value()));
+					carry.value()->~value_type();
+					new (carry.storage) value_type(std::move(*tmp.value()));
+					tmp.value()->~value_type();
+					std::swap(slot.distance, distance);
+					if (carrying_new) {
+						_last = &slot;
+						carrying_new = false;
+					}
+				}
+				++index;
+				++distance;
+			}
+		}
+
+		// Backward-shift deletion keeps probe sequences contiguous without tombstones
+		void remove(Slot* slot) {
+			slot->value()->~value_type();
+			slot->distance = EMPTY;
+			--_size;
+			Slot* next = slot + 1;
+			// sentinel slot has distance 0 so the shift stops there
+			while (next->distance > 0) {
+				new (slot->storage) value_type(std::move(*next->value()));
+				next->value()->~value_type();
+				slot->distance = next->distance - 1;
+				next->distance = EMPTY;
+				++slot;
+				++next;
+			}
+		}
+
+		void rehash(size_type capacity, size_type max_probe) {
+			Slot* old_slots = _slots;
+			size_type old_count = slot_count();
+
+			uint8_t bits = 0;
+			while (((size_type)1 << bits) < capacity) ++bits;
+			_capacity = (size_type)1 << bits;
+			_shift = 64 - bits;
+			_max_probe = std::max<size_type>((bits > 4) ? bits : 4, max_probe);
+			_size = 0;
+			// one extra sentinel slot terminates iteration and backward-shift
+			size_type count = slot_count() + 1;
+			_slots = SlotTraits::allocate(_alloc, count);
+			for (size_type i = 0; i < count - 1; ++i) {
+				_slots[i].distance = EMPTY;
+			}
+			_slots[count - 1].distance = 0;
+
+			if (old_slots != nullptr) {
+				for (size_type i = 0; i < old_count; ++i) {
+					if (old_slots[i].distance != EMPTY) {
+						place(std::move(*old_slots[i].value()));
+						old_slots[i].value()->~value_type();
+					}
+				}
+				SlotTraits::deallocate(_alloc, old_slots, old_count + 1);
+			}
+		}
+
+		void release() {
+			if (_slots != nullptr) {
+				clear();
+				SlotTraits::deallocate(_alloc, _slots, slot_count() + 1);
+				_slots = nullptr;
+				_capacity = 0;
+			}
+		}
+
+		void take(FlatMap& map) {
+			_slots = map._slots;
+			_capacity = map._capacity;
+			_max_probe = map._max_probe;
+			_shift = map._shift;
+			_size = map._size;
+			map._slots = nullptr;
+			map._capacity = 0;
+			map._size = 0;
+		}
+
+	private:
+		Hash _hash;
+		KeyEqual _equal;
+		SlotAllocator _alloc;
+		Slot* _slots = nullptr;
+		Slot* _last = nullptr;
+		size_type _capacity = 0;
+		size_type _max_probe = 0;
+		uint8_t _shift = 64;
+		size_type _size = 0;
+
+	};
+
+} }
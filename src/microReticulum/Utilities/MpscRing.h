@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2023 Chad Attermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <stdint.h>
+
+namespace RNS { namespace Utilities {
+
+	// Bounded lock-free ring for handing items from any number of producer threads to a single
+	// consumer thread (interface reader threads -> the Transport loop).
+	//
+	// Each cell carries a sequence number telling producers and the consumer whose turn it is, so a
+	// push claims a cell with a single compare-and-swap on the enqueue position and a pop needs no
+	// atomic read-modify-write at all. Neither side ever blocks or allocates; storage is allocated
+	// once at construction.
+	//
+	// When the ring is full try_push() fails and counts the item as dropped (tail drop). The producer
+	// keeps ownership of the item and is free to discard it. Dropping the newest item keeps producers
+	// wait-free, where dropping the oldest would need producers to take the consumer's role.
+	//
+	// try_pop() must only ever be called from one thread at a time.
+	template <typename T>
+	class MpscRing {
+
+	public:
+		using value_type = T;
+		using size_type  = std::size_t;
+
+	private:
+		struct Cell {
+			std::atomic<size_type> _sequence;
+			T _value;
+		};
+
+	public:
+		// Capacity is rounded up to a power of two (minimum 2)
+		explicit MpscRing(size_type capacity) {
+			size_type size = 2;
+			while (size < capacity) {
+				size <<= 1;
+			}
+			_mask = size - 1;
+			_cells.reset(new Cell[size]);
+			for (size_type i = 0; i < size; ++i) {
+				_cells[i]._sequence.store(i, std::memory_order_relaxed);
+			}
+			_enqueue_pos.store(0, std::memory_order_relaxed);
+			_dequeue_pos = 0;
+		}
+		MpscRing(const MpscRing&) = delete;
+		MpscRing& operator = (const MpscRing&) = delete;
+
+		// Safe from any thread, moves value into the ring and returns true, or returns false (leaving
+		// value untouched) if the ring is full
+		bool try_push(T&& value) {
+			Cell* cell;
+			size_type pos = _enqueue_pos.load(std::memory_order_relaxed);
+			for (;;) {
+				cell = &_cells[pos & _mask];
+				size_type sequence = cell->_sequence.load(std::memory_order_acquire);
+				intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+				if (diff == 0) {
+					// cell is free for this position, claim it
+					if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						break;
+					}
+					// lost the race, pos now holds the current enqueue position
+				}
+				else if (diff < 0) {
+					// cell still holds the item from one lap ago, ring is full
+					_dropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				else {
+					// another producer claimed this position, catch up
+					pos = _enqueue_pos.load(std::memory_order_relaxed);
+				}
+			}
+			cell->_value = std::move(value);
+			// publish to the consumer
+			cell->_sequence.store(pos + 1, std::memory_order_release);
+			_pushed.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+		inline bool try_push(const T& value) {
+			T copy(value);
+			return try_push(std::move(copy));
+		}
+
+		// Consumer thread only, moves the oldest item into value and returns true, or returns false if
+		// nothing is ready. An item whose producer has claimed but not yet filled its cell holds back
+		// the items behind it until the next call.
+		bool try_pop(T& value) {
+			Cell* cell = &_cells[_dequeue_pos & _mask];
+			size_type sequence = cell->_sequence.load(std::memory_order_acquire);
+			if (sequence != _dequeue_pos + 1) {
+				return false;
+			}
+			size_type depth = _enqueue_pos.load(std::memory_order_relaxed) - _dequeue_pos;
+			if (depth > _high_watermark) {
+				_high_watermark = depth;
+			}
+			value = std::move(cell->_value);
+			// release whatever the moved-from item still holds before handing the cell back
+			cell->_value = T();
+			// hand the cell to the producer one lap ahead
+			cell->_sequence.store(_dequeue_pos + _mask + 1, std::memory_order_release);
+			++_dequeue_pos;
+			++_popped;
+			return true;
+		}
+
+		inline size_type capacity() const { return _mask + 1; }
+		// Consumer thread only, includes items producers have claimed but not yet published
+		inline size_type size() const { return _enqueue_pos.load(std::memory_order_relaxed) - _dequeue_pos; }
+		inline bool empty() const { return size() == 0; }
+
+		// Backpressure counters
+		inline uint32_t pushed() const { return _pushed.load(std::memory_order_relaxed); }
+		inline uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+		// Consumer side only
+		inline uint32_t popped() const { return _popped; }
+		inline size_type high_watermark() const { return _high_watermark; }
+
+	private:
+		std::unique_ptr<Cell[]> _cells;
+		size_type _mask = 0;
+		// producers and consumer positions on separate cache lines
+		alignas(64) std::atomic<size_type> _enqueue_pos;
+		std::atomic<uint32_t> _pushed{0};
+		std::atomic<uint32_t> _dropped{0};
+		alignas(64) size_type _dequeue_pos = 0;
+		uint32_t _popped = 0;
+		size_type _high_watermark = 0;
+
+	};
+
+} }
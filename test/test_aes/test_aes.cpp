@@ -0,0 +1,242 @@
+#include <unity.h>
+
+#include "microReticulum/Cryptography/AES.h"
+#include "microReticulum/Cryptography/AESBackend.h"
+#include "microReticulum/Cryptography/Token.h"
+#include "microReticulum/Log.h"
+#include "microReticulum/Bytes.h"
+
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+using RNS::Bytes;
+namespace Cryptography = RNS::Cryptography;
+
+#ifdef ARDUINO
+uint64_t test_micros() {
+	return micros();
+}
+#else
+uint64_t test_micros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+static const Cryptography::aes_backend BACKENDS[] = {
+	Cryptography::AES_BACKEND_PORTABLE,
+	Cryptography::AES_BACKEND_AESNI,
+};
+
+static Bytes make_bytes(size_t size, uint32_t seed) {
+	Bytes bytes;
+	uint8_t* data = bytes.writable(size);
+	for (size_t i = 0; i < size; ++i) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (uint8_t)(seed >> 16);
+	}
+	return bytes;
+}
+
+static Bytes hex(const char* hex) {
+	Bytes bytes;
+	bytes.assignHex(hex);
+	return bytes;
+}
+
+// NIST SP 800-38A F.2.1 and F.2.5
+void test_known_vectors() {
+	const Bytes iv = hex("000102030405060708090a0b0c0d0e0f");
+	const Bytes plaintext = hex("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e5130c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+	const Bytes key128 = hex("2b7e151628aed2a6abf7158809cf4f3c");
+	const Bytes ciphertext128 = hex("7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b273bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7");
+	const Bytes key256 = hex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+	const Bytes ciphertext256 = hex("f58c4c04d6e5f1ba779eabfb5f7bfbd69cfc4e967edb808d679f777bc6702c7d39f23369a9d9bacfa530e26304231461b2eb05e2c39be9fcda6c19078c6a9d1b");
+
+	Cryptography::aes_backend active = Cryptography::aes_active_backend();
+	for (Cryptography::aes_backend backend : BACKENDS) {
+		if (!Cryptography::aes_use_backend(backend)) {
+			continue;
+		}
+		TEST_ASSERT_TRUE(Cryptography::AES_128_CBC::encrypt(plaintext, key128, iv) == ciphertext128);
+		TEST_ASSERT_TRUE(Cryptography::AES_128_CBC::decrypt(ciphertext128, key128, iv) == plaintext);
+		TEST_ASSERT_TRUE(Cryptography::AES_256_CBC::encrypt(plaintext, key256, iv) == ciphertext256);
+		TEST_ASSERT_TRUE(Cryptography::AES_256_CBC::decrypt(ciphertext256, key256, iv) == plaintext);
+
+		Bytes buffer(plaintext);
+		Cryptography::AES_256_CBC::inplace_encrypt(buffer, key256, iv);
+		TEST_ASSERT_TRUE(buffer == ciphertext256);
+		Cryptography::AES_256_CBC::inplace_decrypt(buffer, key256, iv);
+		TEST_ASSERT_TRUE(buffer == plaintext);
+	}
+	Cryptography::aes_use_backend(active);
+}
+
+void test_key_sizes() {
+	Cryptography::AES_CBC cbc;
+	TEST_ASSERT_FALSE((bool)cbc);
+	bool thrown = false;
+	try {
+		cbc.key(make_bytes(24, 1));
+	}
+	catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	TEST_ASSERT_TRUE(thrown);
+	TEST_ASSERT_FALSE((bool)cbc);
+
+	thrown = false;
+	try {
+		Cryptography::AES_128_CBC::encrypt(make_bytes(16, 1), make_bytes(32, 1), make_bytes(16, 2));
+	}
+	catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	TEST_ASSERT_TRUE(thrown);
+
+	cbc.key(make_bytes(16, 1));
+	TEST_ASSERT_TRUE((bool)cbc);
+}
+
+// Every backend against the portable one, around the decrypt batch size and in place
+void test_backends_match() {
+	Cryptography::aes_backend active = Cryptography::aes_active_backend();
+	TEST_ASSERT_TRUE(Cryptography::aes_backend_supported(Cryptography::AES_BACKEND_PORTABLE));
+	size_t tested = 0;
+	for (size_t key_size : {16, 32}) {
+		Bytes key = make_bytes(key_size, (uint32_t)key_size);
+		Bytes iv = make_bytes(16, 7);
+		for (Cryptography::aes_backend backend : BACKENDS) {
+			if (!Cryptography::aes_use_backend(backend)) {
+				TEST_ASSERT_FALSE(Cryptography::aes_backend_supported(backend));
+				continue;
+			}
+			TEST_ASSERT_EQUAL_INT(backend, Cryptography::aes_active_backend());
+			printf("aes backend: %s (%zu bit)\n", Cryptography::aes_backend_name(backend), key_size * 8);
+			Cryptography::AES_CBC cbc(key);
+			Cryptography::aes_use_backend(Cryptography::AES_BACKEND_PORTABLE);
+			Cryptography::AES_CBC reference(key);
+			for (size_t blocks = 0; blocks <= 40; ++blocks) {
+				size_t size = blocks * 16;
+				Bytes plaintext = make_bytes(size, (uint32_t)blocks);
+				std::vector<uint8_t> expected(size + 16);
+				std::vector<uint8_t> output(size + 16);
+				reference.encrypt(expected.data(), plaintext.data(), size, iv.data());
+				cbc.encrypt(output.data(), plaintext.data(), size, iv.data());
+				TEST_ASSERT_EQUAL_MEMORY(expected.data(), output.data(), size);
+
+				cbc.decrypt(output.data(), expected.data(), size, iv.data());
+				TEST_ASSERT_EQUAL_MEMORY(plaintext.data(), output.data(), size);
+
+				// In place
+				memcpy(output.data(), expected.data(), size);
+				cbc.decrypt(output.data(), output.data(), size, iv.data());
+				TEST_ASSERT_EQUAL_MEMORY(plaintext.data(), output.data(), size);
+				cbc.encrypt(output.data(), output.data(), size, iv.data());
+				TEST_ASSERT_EQUAL_MEMORY(expected.data(), output.data(), size);
+
+				// Output one block ahead of input, as Token does when decrypting over the iv
+				memcpy(output.data() + 16, expected.data(), size);
+				cbc.decrypt(output.data(), output.data() + 16, size, iv.data());
+				TEST_ASSERT_EQUAL_MEMORY(plaintext.data(), output.data(), size);
+			}
+			Cryptography::aes_use_backend(backend);
+			++tested;
+		}
+	}
+	TEST_ASSERT_TRUE(tested >= 2);
+	Cryptography::aes_use_backend(active);
+}
+
+void test_benchmark() {
+	Cryptography::aes_backend active = Cryptography::aes_active_backend();
+	const size_t sizes[] = {500, 16384};
+#ifdef ARDUINO
+	const size_t total = 256 * 1024;
+#else
+	const size_t total = 32 * 1024 * 1024;
+#endif
+	Bytes key = make_bytes(32, 1);
+	Bytes iv = make_bytes(16, 2);
+	for (size_t size : sizes) {
+		Bytes plaintext = make_bytes(size, 3);
+		std::vector<uint8_t> ciphertext(size);
+		std::vector<uint8_t> token(Cryptography::Token::token_size(size));
+		size_t rounds = total / size;
+		for (Cryptography::aes_backend backend : BACKENDS) {
+			if (!Cryptography::aes_use_backend(backend)) {
+				continue;
+			}
+			Cryptography::AES_CBC cbc(key);
+			uint64_t start = test_micros();
+			for (size_t i = 0; i < rounds; ++i) {
+				cbc.encrypt(ciphertext.data(), plaintext.data(), size, iv.data());
+			}
+			uint64_t elapsed = test_micros() - start;
+			printf("%5zu bytes: %-8s cbc encrypt %8.1f MB/s\n", size, Cryptography::aes_backend_name(backend), (double)(rounds * size) / (elapsed > 0 ? elapsed : 1));
+
+			std::vector<uint8_t> decrypted(token.size() - 48);
+			start = test_micros();
+			for (size_t i = 0; i < rounds; ++i) {
+				cbc.decrypt(decrypted.data(), ciphertext.data(), size, iv.data());
+			}
+			elapsed = test_micros() - start;
+			printf("%5zu bytes: %-8s cbc decrypt %8.1f MB/s\n", size, Cryptography::aes_backend_name(backend), (double)(rounds * size) / (elapsed > 0 ? elapsed : 1));
+
+			// Whole token per packet, HMAC included
+			Cryptography::Token fernet(make_bytes(64, 4));
+			start = test_micros();
+			for (size_t i = 0; i < rounds; ++i) {
+				fernet.encrypt(token.data(), plaintext.data(), size);
+				fernet.decrypt(decrypted.data(), token.data(), token.size());
+			}
+			elapsed = test_micros() - start;
+			printf("%5zu bytes: %-8s token round trip %8.3f us\n", size, Cryptography::aes_backend_name(backend), (double)elapsed / rounds);
+		}
+	}
+	Cryptography::aes_use_backend(active);
+}
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_known_vectors);
+	RUN_TEST(test_key_sizes);
+	RUN_TEST(test_backends_match);
+	RUN_TEST(test_benchmark);
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	RNS::loglevel(RNS::LOG_WARNING);
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
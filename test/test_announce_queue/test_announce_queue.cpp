@@ -0,0 +1,210 @@
+#include <unity.h>
+
+#include "microReticulum/Interface.h"
+#include "microReticulum/Transport.h"
+#include "microReticulum/Utilities/OS.h"
+#include "microReticulum/Log.h"
+#include "microReticulum/Bytes.h"
+
+#include <vector>
+
+using RNS::Bytes;
+using RNS::Interface;
+using RNS::AnnounceEntry;
+using RNS::AnnounceQueue;
+using RNS::Transport;
+using RNS::Utilities::OS;
+
+class TestInterface : public RNS::InterfaceImpl {
+public:
+	TestInterface(const char* name) : RNS::InterfaceImpl(name) {}
+	std::vector<Bytes> _sent;
+protected:
+	virtual bool send_outgoing(const Bytes& data) {
+		_sent.push_back(data);
+		return true;
+	}
+};
+
+static Bytes destination(uint8_t n) {
+	Bytes hash;
+	uint8_t* data = hash.writable(16);
+	for (size_t i = 0; i < 16; ++i) {
+		data[i] = n;
+	}
+	return hash;
+}
+
+static AnnounceEntry make_entry(uint8_t n, double time, uint8_t hops, uint64_t emitted = 1, size_t size = 100) {
+	Bytes raw;
+	uint8_t* data = raw.writable(size);
+	for (size_t i = 0; i < size; ++i) {
+		data[i] = n;
+	}
+	return AnnounceEntry(destination(n), time, hops, emitted, raw);
+}
+
+void test_queue_order() {
+	AnnounceQueue queue;
+	TEST_ASSERT_TRUE(queue.push(make_entry(1, 10.0, 3)));
+	TEST_ASSERT_TRUE(queue.push(make_entry(2, 11.0, 1)));
+	TEST_ASSERT_TRUE(queue.push(make_entry(3, 9.0, 2)));
+	TEST_ASSERT_TRUE(queue.push(make_entry(4, 8.0, 1)));
+	TEST_ASSERT_TRUE(queue.push(make_entry(5, 12.0, 3)));
+	TEST_ASSERT_EQUAL_size_t(5, queue.size());
+
+	// Fewest hops first, oldest first among equal hops
+	const uint8_t expected[] = {4, 2, 3, 1, 5};
+	for (uint8_t n : expected) {
+		TEST_ASSERT_FALSE(queue.empty());
+		TEST_ASSERT_TRUE(queue.top()._destination == destination(n));
+		queue.pop();
+	}
+	TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_queue_replaces_destination() {
+	AnnounceQueue queue;
+	TEST_ASSERT_TRUE(queue.push(make_entry(1, 10.0, 4, 100)));
+	TEST_ASSERT_TRUE(queue.push(make_entry(2, 10.0, 2, 100)));
+
+	// Older or same emission is ignored
+	TEST_ASSERT_FALSE(queue.push(make_entry(1, 20.0, 1, 99)));
+	TEST_ASSERT_FALSE(queue.push(make_entry(1, 20.0, 1, 100)));
+	TEST_ASSERT_EQUAL_size_t(2, queue.size());
+	TEST_ASSERT_TRUE(queue.top()._destination == destination(2));
+
+	// Newer emission replaces the queued one, and is reordered by its hops
+	TEST_ASSERT_FALSE(queue.push(make_entry(1, 20.0, 1, 101)));
+	TEST_ASSERT_EQUAL_size_t(2, queue.size());
+	TEST_ASSERT_TRUE(queue.top()._destination == destination(1));
+	TEST_ASSERT_EQUAL_UINT64(101, queue.top()._emitted);
+	TEST_ASSERT_TRUE(queue.top()._time == 20.0);
+}
+
+void test_queue_expire() {
+	AnnounceQueue queue;
+	queue.push(make_entry(1, 10.0, 1));
+	queue.push(make_entry(2, 50.0, 2));
+	queue.push(make_entry(3, 20.0, 3));
+	queue.push(make_entry(4, 60.0, 1));
+	TEST_ASSERT_EQUAL_size_t(0, queue.expire(5.0));
+	TEST_ASSERT_EQUAL_size_t(2, queue.expire(30.0));
+	TEST_ASSERT_EQUAL_size_t(2, queue.size());
+	TEST_ASSERT_TRUE(queue.top()._destination == destination(4));
+	queue.pop();
+	TEST_ASSERT_TRUE(queue.top()._destination == destination(2));
+}
+
+void test_process_respects_announce_cap() {
+	TestInterface* impl = new TestInterface("capped");
+	Interface interface(impl);
+	// 100 byte announces take 0.1 s at 8000 bps, at a 50% cap one may be sent every 0.2 s
+	interface.bitrate(8000);
+	interface.announce_cap(0.5);
+
+	double now = OS::time();
+	interface.add_announce(make_entry(1, now, 2));
+	interface.add_announce(make_entry(2, now, 1));
+	interface.add_announce(make_entry(3, now - RNS::Type::Reticulum::QUEUED_ANNOUNCE_LIFE - 1, 1));
+
+	// Stale announce is dropped, fewest hops goes out first
+	TEST_ASSERT_TRUE(interface.process_announce_queue());
+	TEST_ASSERT_EQUAL_size_t(1, impl->_sent.size());
+	TEST_ASSERT_EQUAL_UINT8(2, impl->_sent[0].data()[0]);
+	TEST_ASSERT_EQUAL_size_t(1, interface.announce_queue().size());
+	double wait_time = interface.announce_allowed_at() - now;
+	TEST_ASSERT_TRUE(wait_time >= 0.2 && wait_time < 0.25);
+
+	// Nothing more until the cap allows it
+	TEST_ASSERT_FALSE(interface.process_announce_queue());
+	TEST_ASSERT_EQUAL_size_t(1, impl->_sent.size());
+	while (OS::time() <= interface.announce_allowed_at()) {
+		OS::sleep(0.01);
+	}
+	TEST_ASSERT_TRUE(interface.process_announce_queue());
+	TEST_ASSERT_EQUAL_size_t(2, impl->_sent.size());
+	TEST_ASSERT_EQUAL_UINT8(1, impl->_sent[1].data()[0]);
+	TEST_ASSERT_TRUE(interface.announce_queue().empty());
+	TEST_ASSERT_FALSE(interface.process_announce_queue());
+}
+
+void test_transport_drains_queue() {
+	TestInterface* impl = new TestInterface("scheduled");
+	Interface interface(impl);
+	interface.bitrate(8000);
+	interface.announce_cap(0.5);
+	Transport::register_interface(interface);
+
+	double now = OS::time();
+	interface.add_announce(make_entry(1, now, 1));
+	interface.add_announce(make_entry(2, now, 2));
+	interface.add_announce(make_entry(3, now, 3));
+	Transport::schedule_announce_queue(interface);
+	TEST_ASSERT_TRUE(interface.announce_queue_scheduled());
+	TEST_ASSERT_TRUE(Transport::next_loop_time() <= now + 0.001);
+
+	// Drained one announce per cap interval, in order
+	double deadline = now + 5.0;
+	while (!interface.announce_queue().empty() && OS::time() < deadline) {
+		Transport::process_announce_queues();
+		OS::sleep(0.01);
+	}
+	TEST_ASSERT_EQUAL_size_t(3, impl->_sent.size());
+	for (size_t i = 0; i < impl->_sent.size(); ++i) {
+		TEST_ASSERT_EQUAL_UINT8(i + 1, impl->_sent[i].data()[0]);
+	}
+	TEST_ASSERT_TRUE(OS::time() >= now + 0.4);
+
+	// Last deadline comes due with the queue empty and isn't renewed
+	while (interface.announce_queue_scheduled() && OS::time() < deadline) {
+		Transport::process_announce_queues();
+		OS::sleep(0.01);
+	}
+	TEST_ASSERT_FALSE(interface.announce_queue_scheduled());
+	TEST_ASSERT_EQUAL_size_t(3, impl->_sent.size());
+
+	Transport::deregister_interface(interface);
+}
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_queue_order);
+	RUN_TEST(test_queue_replaces_destination);
+	RUN_TEST(test_queue_expire);
+	RUN_TEST(test_process_respects_announce_cap);
+	RUN_TEST(test_transport_drains_queue);
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	RNS::loglevel(RNS::LOG_WARNING);
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
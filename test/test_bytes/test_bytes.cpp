@@ -4,6 +4,8 @@
 #include "microReticulum/Bytes.h"
 #include "microReticulum/Log.h"
 
+#include <unordered_map>
+
 void testBytesDefault(const RNS::Bytes& bytes = {}) {
 	TEST_ASSERT_FALSE(bytes);
 	TEST_ASSERT_EQUAL_size_t(0, bytes.size());
@@ -212,18 +214,21 @@ void testBytesMain() {
 
 void testCowBytes() {
 
-	RNS::Bytes bytes1("1");
-	TEST_ASSERT_EQUAL_size_t(1, bytes1.size());
-	TEST_ASSERT_EQUAL_MEMORY("1", bytes1.data(), bytes1.size());
+	// Shared (COW) data is only used above the inline capacity
+	const std::string one(RNS::Bytes::INLINE_CAPACITY + 1, '1');
+
+	RNS::Bytes bytes1(one);
+	TEST_ASSERT_EQUAL_size_t(one.size(), bytes1.size());
+	TEST_ASSERT_EQUAL_MEMORY(one.data(), bytes1.data(), bytes1.size());
 
 	RNS::Bytes bytes2(bytes1);
-	TEST_ASSERT_EQUAL_size_t(1, bytes2.size());
-	TEST_ASSERT_EQUAL_MEMORY("1", bytes2.data(), bytes2.size());
+	TEST_ASSERT_EQUAL_size_t(one.size(), bytes2.size());
+	TEST_ASSERT_EQUAL_MEMORY(one.data(), bytes2.data(), bytes2.size());
 	TEST_ASSERT_EQUAL_PTR(bytes1.data(), bytes2.data());
 
 	RNS::Bytes bytes3(bytes2);
-	TEST_ASSERT_EQUAL_size_t(1, bytes3.size());
-	TEST_ASSERT_EQUAL_MEMORY("1", bytes3.data(), bytes3.size());
+	TEST_ASSERT_EQUAL_size_t(one.size(), bytes3.size());
+	TEST_ASSERT_EQUAL_MEMORY(one.data(), bytes3.data(), bytes3.size());
 	TEST_ASSERT_EQUAL_PTR(bytes2.data(), bytes3.data());
 
 	TRACEF("pre bytes1 ptr: %p data: %s", (void*)bytes1.data(), bytes1.toString().c_str());
@@ -236,9 +241,10 @@ void testCowBytes() {
 	//assert(bytes1.data() != bytes2.data());
 
 	bytes2.append("mississippi");
-	TEST_ASSERT_EQUAL_size_t(12, bytes2.size());
-	TEST_ASSERT_EQUAL_MEMORY("1mississippi", bytes2.data(), bytes2.size());
+	TEST_ASSERT_EQUAL_size_t(one.size() + 11, bytes2.size());
+	TEST_ASSERT_EQUAL_MEMORY((one + "mississippi").data(), bytes2.data(), bytes2.size());
 	TEST_ASSERT_NOT_EQUAL(bytes1.data(), bytes2.data());
+	TEST_ASSERT_EQUAL_size_t(one.size(), bytes1.size());
 
 	bytes3.assign("mississippi");
 	TEST_ASSERT_EQUAL_size_t(11, bytes3.size());
@@ -250,6 +256,104 @@ void testCowBytes() {
 	TRACEF("post bytes3 ptr: %p data: %s", (void*)bytes3.data(), bytes3.toString().c_str());
 }
 
+void testInlineBytes() {
+
+	// Small payloads are held inline, so copies are independent (not shared)
+	RNS::Bytes bytes1("1");
+	RNS::Bytes bytes2(bytes1);
+	TEST_ASSERT_EQUAL_size_t(1, bytes2.size());
+	TEST_ASSERT_EQUAL_MEMORY("1", bytes2.data(), bytes2.size());
+	TEST_ASSERT_TRUE(bytes1 == bytes2);
+	TEST_ASSERT_EQUAL_size_t(RNS::Bytes::INLINE_CAPACITY, bytes1.capacity());
+
+	bytes2.append("mississippi");
+	TEST_ASSERT_EQUAL_size_t(12, bytes2.size());
+	TEST_ASSERT_EQUAL_MEMORY("1mississippi", bytes2.data(), bytes2.size());
+	TEST_ASSERT_EQUAL_size_t(1, bytes1.size());
+	TEST_ASSERT_EQUAL_MEMORY("1", bytes1.data(), bytes1.size());
+
+	// grow one byte at a time across the inline boundary into shared data
+	RNS::Bytes grown;
+	for (size_t i = 0; i < RNS::Bytes::INLINE_CAPACITY * 4; ++i) {
+		grown.append((uint8_t)i);
+	}
+	TEST_ASSERT_EQUAL_size_t(RNS::Bytes::INLINE_CAPACITY * 4, grown.size());
+	for (size_t i = 0; i < grown.size(); ++i) {
+		TEST_ASSERT_EQUAL_UINT8((uint8_t)i, grown[i]);
+	}
+
+	// shrinking a shared copy back below the inline capacity leaves the original intact
+	RNS::Bytes shrunk(grown);
+	shrunk.resize(8);
+	TEST_ASSERT_EQUAL_size_t(8, shrunk.size());
+	TEST_ASSERT_EQUAL_size_t(RNS::Bytes::INLINE_CAPACITY * 4, grown.size());
+	TEST_ASSERT_EQUAL_MEMORY(grown.data(), shrunk.data(), shrunk.size());
+
+	// growth via resize is zero-filled
+	shrunk.resize(12);
+	TEST_ASSERT_EQUAL_UINT8(0, shrunk[11]);
+
+	// collection() still exposes the data as a vector
+	RNS::Bytes small("short");
+	TEST_ASSERT_EQUAL_size_t(5, small.collection().size());
+	TEST_ASSERT_EQUAL_MEMORY("short", small.data(), small.size());
+
+	// self-append
+	RNS::Bytes twice("abc");
+	twice.append(twice);
+	TEST_ASSERT_EQUAL_size_t(6, twice.size());
+	TEST_ASSERT_EQUAL_MEMORY("abcabc", twice.data(), twice.size());
+}
+
+void testBytesView() {
+
+	std::string payload(RNS::Bytes::INLINE_CAPACITY * 2, 'x');
+	payload.replace(0, 4, "head");
+	payload.replace(payload.size() - 4, 4, "tail");
+	RNS::Bytes bytes(payload.c_str());
+
+	// view shares the owner's buffer without copying
+	RNS::BytesView whole = bytes.view();
+	TEST_ASSERT_EQUAL_size_t(bytes.size(), whole.size());
+	TEST_ASSERT_EQUAL_PTR(bytes.data(), whole.data());
+	TEST_ASSERT_TRUE(whole == bytes);
+
+	RNS::BytesView head = bytes.view(0, 4);
+	TEST_ASSERT_EQUAL_size_t(4, head.size());
+	TEST_ASSERT_EQUAL_PTR(bytes.data(), head.data());
+	TEST_ASSERT_EQUAL_MEMORY("head", head.data(), head.size());
+
+	RNS::BytesView tail = whole.right(4);
+	TEST_ASSERT_EQUAL_MEMORY("tail", tail.data(), tail.size());
+	TEST_ASSERT_EQUAL_PTR(bytes.data() + bytes.size() - 4, tail.data());
+
+	// out-of-range slices clamp to empty
+	TEST_ASSERT_TRUE(bytes.view(bytes.size() + 10).empty());
+	TEST_ASSERT_EQUAL_size_t(4, whole.mid(bytes.size() - 4, 100).size());
+
+	// view keeps its data alive and unchanged across owner mutation
+	RNS::Bytes original(bytes);
+	bytes.append("more");
+	TEST_ASSERT_TRUE(whole == original);
+	bytes = {};
+	TEST_ASSERT_EQUAL_MEMORY("head", head.data(), head.size());
+
+	// materializing and appending views
+	RNS::Bytes built;
+	built << head << tail;
+	TEST_ASSERT_EQUAL_size_t(8, built.size());
+	TEST_ASSERT_EQUAL_MEMORY("headtail", built.data(), built.size());
+	TEST_ASSERT_TRUE(head.bytes() == RNS::Bytes("head"));
+	TEST_ASSERT_EQUAL_STRING("68656164", head.toHex().c_str());
+
+	// views over inline data
+	RNS::Bytes small("abcdef");
+	RNS::BytesView mid = small.view(2, 2);
+	TEST_ASSERT_EQUAL_MEMORY("cd", mid.data(), mid.size());
+	TEST_ASSERT_EQUAL_UINT8('d', mid[1]);
+	TEST_ASSERT_TRUE(mid < small.view(3));
+}
+
 void testBytesConversion() {
 
 	{
@@ -655,6 +759,25 @@ void test_empty_collection() {
 	TEST_ASSERT_EQUAL_size_t(0, vec.size());
 }
 
+void test_hash_unordered_map() {
+	std::hash<RNS::Bytes> hasher;
+	RNS::Bytes a("link-id-0001");
+	RNS::Bytes b("link-id-0001");
+	RNS::Bytes c("link-id-0002");
+	TEST_ASSERT_EQUAL_size_t(hasher(a), hasher(b));
+	TEST_ASSERT_NOT_EQUAL(hasher(a), hasher(c));
+	TEST_ASSERT_EQUAL_size_t(hasher(RNS::Bytes()), hasher(RNS::Bytes(RNS::Bytes::NONE)));
+
+	std::unordered_map<RNS::Bytes, int> map;
+	map[a] = 1;
+	map[c] = 2;
+	TEST_ASSERT_EQUAL_size_t(2, map.size());
+	TEST_ASSERT_TRUE(map.find(b) != map.end());
+	TEST_ASSERT_EQUAL_INT(1, map[b]);
+	TEST_ASSERT_EQUAL_size_t(1, map.erase(c));
+	TEST_ASSERT_TRUE(map.find(c) == map.end());
+}
+
 
 void setUp(void) {
 	// set stuff up here before each test
@@ -675,6 +798,8 @@ int runUnityTests(void) {
 	// Run tests
 	RUN_TEST(testBytesMain);
 	RUN_TEST(testCowBytes);
+	RUN_TEST(testInlineBytes);
+	RUN_TEST(testBytesView);
 	RUN_TEST(testBytesConversion);
 	RUN_TEST(testBytesResize);
 	RUN_TEST(testBytesStream);
@@ -694,6 +819,7 @@ int runUnityTests(void) {
 	RUN_TEST(test_mid_large_len);
 	RUN_TEST(test_mid_zero_size_bytes);
 	RUN_TEST(test_empty_collection);
+	RUN_TEST(test_hash_unordered_map);
 
 	// Suite-level teardown
 	size_t post_memory = RNS::Utilities::Memory::heap_available();
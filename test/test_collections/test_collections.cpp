@@ -1,12 +1,14 @@
 #include <unity.h>
 
 #include "microReticulum/Bytes.h"
+#include "microReticulum/HashKey.h"
 #include "microReticulum/Log.h"
 #include "microReticulum/Identity.h"
 #include "microReticulum/Destination.h"
 #include "microReticulum/Link.h"
 
 #include <map>
+#include <unordered_map>
 #include <string>
 
 void testBytesMap()
@@ -57,6 +59,53 @@ void testBytesMap()
 	TEST_ASSERT_EQUAL_STRING("world", str.c_str());
 }
 
+void testHashKeyMap()
+{
+	RNS::Bytes hash1;
+	hash1.assignHex("00112233445566778899aabbccddeeff");
+	RNS::Bytes hash2;
+	hash2.assignHex("00112233445566778899aabbccddeef0");
+
+	RNS::Hash16 key1(hash1);
+	TEST_ASSERT_EQUAL_size_t(16, key1.size());
+	TEST_ASSERT_EQUAL_MEMORY(hash1.data(), key1.data(), key1.size());
+	TEST_ASSERT_TRUE(key1.bytes() == hash1);
+	TEST_ASSERT_EQUAL_STRING("00112233445566778899aabbccddeeff", key1.toHex().c_str());
+
+	// ordering matches Bytes ordering for same-width hashes
+	RNS::Hash16 key2(hash2);
+	TEST_ASSERT_TRUE(key2 < key1);
+	TEST_ASSERT_TRUE(hash2 < hash1);
+	TEST_ASSERT_TRUE(key1 != key2);
+
+	// wrong width is truncated or zero-padded
+	RNS::Hash16 short_key(RNS::Bytes("abc"));
+	TEST_ASSERT_EQUAL_MEMORY("abc", short_key.data(), 3);
+	TEST_ASSERT_EQUAL_UINT8(0, short_key.data()[15]);
+	RNS::Hash16 empty_key;
+	TEST_ASSERT_TRUE(empty_key == RNS::Hash16(RNS::Bytes()));
+
+	// tables keyed by hash are searched directly with Bytes
+	std::map<RNS::Hash16, std::string> map;
+	map.insert({hash1, "one"});
+	map.insert({hash2, "two"});
+	TEST_ASSERT_EQUAL_size_t(2, map.size());
+	auto it = map.find(hash1);
+	TEST_ASSERT_TRUE(it != map.end());
+	TEST_ASSERT_EQUAL_STRING("one", (*it).second.c_str());
+	TEST_ASSERT_TRUE((*map.begin()).first == key2);
+	RNS::Bytes first = (*map.begin()).first;
+	TEST_ASSERT_TRUE(first == hash2);
+	TEST_ASSERT_EQUAL_size_t(1, map.erase(hash2));
+
+	std::unordered_map<RNS::Hash32, int> umap;
+	RNS::Bytes full;
+	full.assignHex("00112233445566778899aabbccddeeff00112233445566778899aabbccddeeff");
+	umap[full] = 1;
+	TEST_ASSERT_EQUAL_size_t(1, umap.count(RNS::Hash32(full)));
+	TEST_ASSERT_EQUAL_size_t(0, umap.count(RNS::Hash32(hash1)));
+}
+
 class Entry {
 	public:
 	// CBA for some reason default constructor is required for map index reference/asign to work
@@ -174,6 +223,7 @@ void tearDown(void) {
 int runUnityTests(void) {
 	UNITY_BEGIN();
 	RUN_TEST(testBytesMap);
+	RUN_TEST(testHashKeyMap);
 	RUN_TEST(testOldMap);
 	RUN_TEST(testNewMap);
 	RUN_TEST(test_request_handlers);
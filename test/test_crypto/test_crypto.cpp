@@ -6,6 +6,8 @@
 #include "microReticulum/Utilities/Crc.h"
 #include "microReticulum/Cryptography/HMAC.h"
 #include "microReticulum/Cryptography/PKCS7.h"
+#include "microReticulum/Cryptography/AES.h"
+#include "microReticulum/Cryptography/Token.h"
 
 #include <string.h>
 #include <vector>
@@ -14,12 +16,25 @@
 #include <stdint.h>
 #include <sys/time.h>
 #include <stdio.h>
+#ifndef ARDUINO
+#include <chrono>
+#endif
 
 // Imported from Crypto.cpp
 // Computes CRC-8/HITAG checksum
 // CBA Doesn't appear to support incremental checksum building
 extern uint8_t crypto_crc8(uint8_t tag, const void *data, unsigned size);
 
+#ifdef ARDUINO
+uint64_t test_micros() {
+	return micros();
+}
+#else
+uint64_t test_micros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
 void testHMAC() {
 
 	{
@@ -244,6 +259,215 @@ void testRebroadcastRatchetAnnounceValidate() {
 	TEST_ASSERT_TRUE(RNS::Identity::validate_announce(packet));
 }
 
+void testAnnounceValidateCache() {
+	// Starts from an empty cache
+	RNS::Identity::announce_cache_maxsize(RNS::Identity::announce_cache_maxsize());
+	uint32_t hits = RNS::Identity::announce_cache_hits();
+	uint32_t misses = RNS::Identity::announce_cache_misses();
+
+	RNS::Bytes direct_raw;
+	direct_raw.assignHex("0100f083a7f4b00d799808c44a4634bba7d7006afd960bf3b01801a2e88b2ce1f7040817dc1b6bffa366b103468f3988e0db7f00dc1fdc15fa7fd31a34a02207cfb4d26e11e57504e43686ec7fad84774bec88fd68805f2ea383c8d6f6c39824652e00698fd5fd1088b38832f247a9daebf017d8bfe641882d9fe9b37cf49a97402b7e3d8bec61b4950d39c0996588dd0288bf6a7a0a4390bb331bd82704b618f107cf8bf2230f");
+	RNS::Packet direct(direct_raw);
+	direct.unpack();
+	TEST_ASSERT_TRUE(RNS::Identity::validate_announce(direct));
+	TEST_ASSERT_EQUAL_UINT32(misses + 1, RNS::Identity::announce_cache_misses());
+	TEST_ASSERT_EQUAL_size_t(1, RNS::Identity::announce_cache_size());
+
+	// The same announce rebroadcast by a transport node is found in the cache
+	RNS::Bytes rebroadcast_raw;
+	rebroadcast_raw.assignHex("510139745d39d5108615635d433d6cb14803f083a7f4b00d799808c44a4634bba7d7006afd960bf3b01801a2e88b2ce1f7040817dc1b6bffa366b103468f3988e0db7f00dc1fdc15fa7fd31a34a02207cfb4d26e11e57504e43686ec7fad84774bec88fd68805f2ea383c8d6f6c39824652e00698fd5fd1088b38832f247a9daebf017d8bfe641882d9fe9b37cf49a97402b7e3d8bec61b4950d39c0996588dd0288bf6a7a0a4390bb331bd82704b618f107cf8bf2230f");
+	RNS::Packet rebroadcast(rebroadcast_raw);
+	rebroadcast.unpack();
+	TEST_ASSERT_TRUE(RNS::Identity::validate_announce(rebroadcast));
+	TEST_ASSERT_TRUE(RNS::Identity::validate_announce(rebroadcast, true));
+	TEST_ASSERT_EQUAL_UINT32(hits + 2, RNS::Identity::announce_cache_hits());
+
+	// A tampered signature misses the cache, fails and is not cached
+	std::vector<uint8_t> tampered(direct_raw.data(), direct_raw.data() + direct_raw.size());
+	tampered[2 + 16 + 1 + 64 + 10 + 10] ^= 0x01;
+	for (int i = 0; i < 2; ++i) {
+		RNS::Packet bad(RNS::Bytes(tampered.data(), tampered.size()));
+		bad.unpack();
+		TEST_ASSERT_FALSE(RNS::Identity::validate_announce(bad));
+	}
+	TEST_ASSERT_EQUAL_UINT32(misses + 3, RNS::Identity::announce_cache_misses());
+	TEST_ASSERT_EQUAL_size_t(1, RNS::Identity::announce_cache_size());
+
+	// Disabled cache validates every time
+	uint16_t maxsize = RNS::Identity::announce_cache_maxsize();
+	RNS::Identity::announce_cache_maxsize(0);
+	hits = RNS::Identity::announce_cache_hits();
+	TEST_ASSERT_TRUE(RNS::Identity::validate_announce(direct));
+	TEST_ASSERT_TRUE(RNS::Identity::validate_announce(direct));
+	TEST_ASSERT_EQUAL_UINT32(hits, RNS::Identity::announce_cache_hits());
+	TEST_ASSERT_EQUAL_size_t(0, RNS::Identity::announce_cache_size());
+	RNS::Identity::announce_cache_maxsize(maxsize);
+}
+
+static RNS::Bytes sequence_bytes(uint8_t first, size_t size) {
+	RNS::Bytes bytes;
+	uint8_t* data = bytes.writable(size);
+	for (size_t i = 0; i < size; ++i) {
+		data[i] = (uint8_t)(first + i);
+	}
+	return bytes;
+}
+
+void testToken() {
+	const char plaintext[] = "The quick brown fox jumps over the lazy dog";
+
+	// Reference tokens with iv 0x40..0x4f, signing key 0x00.. and encryption key following it
+	{
+		RNS::Cryptography::Token token(sequence_bytes(0, 64));
+		RNS::Bytes reference;
+		reference.assignHex("404142434445464748494a4b4c4d4e4f8063a6fcc6f4fe77240f2840f832645375f634efcc506d24548d35570b6b100829ce92684ca04f7d1713a1a1e6c6c6b7f3555fe3fd53ee5249522796e17ce421cc89178772208608581ae41f3d161b82");
+		TEST_ASSERT_TRUE(token.verify_hmac(reference));
+		TEST_ASSERT_TRUE(token.decrypt(reference) == RNS::Bytes(plaintext));
+	}
+	{
+		RNS::Cryptography::Token token(sequence_bytes(0, 32));
+		RNS::Bytes reference;
+		reference.assignHex("404142434445464748494a4b4c4d4e4fec8360ffe7a0c644d41184ddcd469877a6ebff8a47078278cfccb9f7ec430b0ec45fc075f028da821bb185b8fa6504698fcdfad498a7c1eb1a68e389bbb461b9ed86666f1ca2a3c8939240a6c1758835");
+		TEST_ASSERT_TRUE(token.decrypt(reference) == RNS::Bytes(plaintext));
+	}
+
+	// Round trips across block boundaries, and agreement with separately keyed AES and HMAC
+	RNS::Bytes key = sequence_bytes(7, 64);
+	RNS::Cryptography::Token token(key);
+	const size_t sizes[] = {0, 1, 15, 16, 17, 100, 383, 464};
+	for (size_t size : sizes) {
+		RNS::Bytes data = sequence_bytes((uint8_t)size, size);
+		RNS::Bytes encrypted = token.encrypt(data);
+		TEST_ASSERT_EQUAL_size_t(16 + (size / 16 + 1) * 16 + 32, encrypted.size());
+		TEST_ASSERT_TRUE(encrypted.right(32) == RNS::Cryptography::HMAC::generate(key.left(32), encrypted.left(encrypted.size() - 32))->digest());
+		RNS::Bytes ciphertext = encrypted.mid(16, encrypted.size() - 48);
+		TEST_ASSERT_TRUE(RNS::Cryptography::PKCS7::unpad(RNS::Cryptography::AES_256_CBC::decrypt(ciphertext, key.mid(32), encrypted.left(16))) == data);
+		TEST_ASSERT_TRUE(token.decrypt(encrypted) == data);
+	}
+
+	// Tampering anywhere fails the HMAC
+	RNS::Bytes encrypted = token.encrypt(RNS::Bytes(plaintext));
+	const size_t positions[] = {0, 15, 16, 40, 63, 64, 95};
+	for (size_t position : positions) {
+		RNS::Bytes tampered(encrypted.data(), encrypted.size());
+		tampered.writable(tampered.size())[position] ^= 0x01;
+		TEST_ASSERT_FALSE(token.verify_hmac(tampered));
+		bool thrown = false;
+		try {
+			token.decrypt(tampered);
+		}
+		catch (const std::exception&) {
+			thrown = true;
+		}
+		TEST_ASSERT_TRUE(thrown);
+	}
+}
+
+void testTokenBuffers() {
+	RNS::Bytes key = sequence_bytes(9, 64);
+	RNS::Cryptography::Token token(key);
+	const size_t sizes[] = {0, 1, 16, 100, 431};
+	for (size_t size : sizes) {
+		RNS::Bytes data = sequence_bytes((uint8_t)(size + 1), size);
+		size_t token_size = RNS::Cryptography::Token::token_size(size);
+
+		// Plaintext placed where the ciphertext goes is padded and encrypted in place
+		std::vector<uint8_t> buffer(token_size + 8, 0xee);
+		memcpy(buffer.data() + 16, data.data(), size);
+		TEST_ASSERT_EQUAL_size_t(token_size, token.encrypt(buffer.data(), buffer.data() + 16, size));
+		TEST_ASSERT_EQUAL_UINT8(0xee, buffer[token_size]);
+		RNS::Bytes encrypted(buffer.data(), token_size);
+		TEST_ASSERT_TRUE(token.decrypt(encrypted) == data);
+
+		// And decrypted in place over the token
+		TEST_ASSERT_EQUAL_size_t(size, token.decrypt(buffer.data(), buffer.data(), token_size));
+		TEST_ASSERT_EQUAL_MEMORY(data.data(), buffer.data(), size);
+
+		// Separate buffers
+		std::vector<uint8_t> output(token_size);
+		TEST_ASSERT_EQUAL_size_t(token_size, token.encrypt(output.data(), data.data(), size));
+		std::vector<uint8_t> plaintext(token_size - 48);
+		TEST_ASSERT_EQUAL_size_t(size, token.decrypt(plaintext.data(), output.data(), token_size));
+		TEST_ASSERT_EQUAL_MEMORY(data.data(), plaintext.data(), size);
+	}
+
+	// Identity encryption into a buffer
+	RNS::Identity identity;
+	RNS::Bytes data = sequence_bytes(5, 200);
+	size_t encrypted_size = RNS::Identity::encrypted_size(data.size());
+	std::vector<uint8_t> buffer(encrypted_size);
+	TEST_ASSERT_EQUAL_size_t(encrypted_size, identity.encrypt(buffer.data(), data.data(), data.size()));
+	TEST_ASSERT_TRUE(identity.decrypt(RNS::Bytes(buffer.data(), buffer.size())) == data);
+	TEST_ASSERT_TRUE(identity.decrypt(identity.encrypt(data)) == data);
+}
+
+// Per-packet link encryption cost: keys set up on every call (as Token used to) vs kept in the token
+void testTokenBenchmark() {
+	RNS::Bytes key = sequence_bytes(1, 64);
+	RNS::Bytes signing_key = key.left(32);
+	RNS::Bytes encryption_key = key.mid(32);
+	RNS::Cryptography::Token token(key);
+#ifdef ARDUINO
+	const int rounds = 100;
+#else
+	const int rounds = 5000;
+#endif
+	const size_t sizes[] = {64, 431};
+	for (size_t size : sizes) {
+		RNS::Bytes data = sequence_bytes(3, size);
+
+		RNS::Bytes encrypted;
+		RNS::Bytes decrypted;
+		uint64_t start = test_micros();
+		for (int i = 0; i < rounds; ++i) {
+			RNS::Bytes iv = RNS::Cryptography::random(16);
+			RNS::Bytes signed_parts = iv + RNS::Cryptography::AES_256_CBC::encrypt(RNS::Cryptography::PKCS7::pad(data), encryption_key, iv);
+			encrypted = signed_parts + RNS::Cryptography::HMAC::generate(signing_key, signed_parts)->digest();
+		}
+		uint64_t setup_encrypt_us = test_micros() - start;
+		start = test_micros();
+		for (int i = 0; i < rounds; ++i) {
+			if (encrypted.right(32) == RNS::Cryptography::HMAC::generate(signing_key, encrypted.left(encrypted.size() - 32))->digest()) {
+				decrypted = RNS::Cryptography::PKCS7::unpad(RNS::Cryptography::AES_256_CBC::decrypt(encrypted.mid(16, encrypted.size() - 48), encryption_key, encrypted.left(16)));
+			}
+		}
+		uint64_t setup_decrypt_us = test_micros() - start;
+		TEST_ASSERT_TRUE(decrypted == data);
+
+		start = test_micros();
+		for (int i = 0; i < rounds; ++i) {
+			encrypted = token.encrypt(data);
+		}
+		uint64_t token_encrypt_us = test_micros() - start;
+		start = test_micros();
+		for (int i = 0; i < rounds; ++i) {
+			decrypted = token.decrypt(encrypted);
+		}
+		uint64_t token_decrypt_us = test_micros() - start;
+		TEST_ASSERT_TRUE(decrypted == data);
+
+		// Into a reused packet sized buffer, as Packet::pack() does
+		std::vector<uint8_t> buffer(RNS::Cryptography::Token::token_size(size));
+		start = test_micros();
+		for (int i = 0; i < rounds; ++i) {
+			token.encrypt(buffer.data(), data.data(), size);
+		}
+		uint64_t buffer_encrypt_us = test_micros() - start;
+		std::vector<uint8_t> plaintext(buffer.size() - 48);
+		start = test_micros();
+		for (int i = 0; i < rounds; ++i) {
+			token.decrypt(plaintext.data(), buffer.data(), buffer.size());
+		}
+		uint64_t buffer_decrypt_us = test_micros() - start;
+		TEST_ASSERT_EQUAL_MEMORY(data.data(), plaintext.data(), size);
+
+		printf("%4zu byte packet: per-call keys encrypt %6.2f us, decrypt %6.2f us; token encrypt %6.2f us, decrypt %6.2f us; into buffer encrypt %6.2f us, decrypt %6.2f us\n", size,
+			(double)setup_encrypt_us / rounds, (double)setup_decrypt_us / rounds,
+			(double)token_encrypt_us / rounds, (double)token_decrypt_us / rounds,
+			(double)buffer_encrypt_us / rounds, (double)buffer_decrypt_us / rounds);
+	}
+}
+
 void setUp(void) {
     // set stuff up here before each test
 }
@@ -265,6 +489,10 @@ int runUnityTests(void) {
 	RUN_TEST(testRebroadcastAnnounceValidate);
 	RUN_TEST(testDirectRatchetAnnounceValidate);
 	RUN_TEST(testRebroadcastRatchetAnnounceValidate);
+	RUN_TEST(testAnnounceValidateCache);
+	RUN_TEST(testToken);
+	RUN_TEST(testTokenBuffers);
+	RUN_TEST(testTokenBenchmark);
     return UNITY_END();
 }
 
@@ -0,0 +1,290 @@
+#include <unity.h>
+
+#include "microReticulum/Bytes.h"
+#include "microReticulum/HashKey.h"
+#include "microReticulum/Utilities/DeadlineQueue.h"
+#include "microReticulum/Utilities/Memory.h"
+
+#include <map>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+using RNS::Hash16;
+using RNS::Utilities::DeadlineQueue;
+using RNS::Utilities::Memory;
+
+#ifdef ARDUINO
+uint64_t test_micros() {
+	return micros();
+}
+#else
+uint64_t test_micros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+static Hash16 make_key(uint32_t n) {
+	uint8_t data[Hash16::SIZE] = {0};
+	memcpy(data, &n, sizeof(n));
+	return Hash16(data, sizeof(data));
+}
+
+static uint32_t key_value(const Hash16& key) {
+	uint32_t n;
+	memcpy(&n, key.data(), sizeof(n));
+	return n;
+}
+
+void test_empty_state() {
+	DeadlineQueue<Hash16> queue;
+	TEST_ASSERT_TRUE(queue.empty());
+	TEST_ASSERT_EQUAL_size_t(0, queue.size());
+	TEST_ASSERT_TRUE(queue.next_deadline() == 0.0);
+	Hash16 key;
+	TEST_ASSERT_FALSE(queue.pop_due(1e9, key));
+}
+
+void test_pops_in_deadline_order() {
+	DeadlineQueue<Hash16> queue;
+	const double deadlines[] = {50.0, 10.0, 40.0, 20.0, 30.0, 60.0, 5.0};
+	for (uint32_t i = 0; i < sizeof(deadlines)/sizeof(deadlines[0]); ++i) {
+		queue.schedule(make_key(i), deadlines[i]);
+	}
+	TEST_ASSERT_EQUAL_size_t(7, queue.size());
+	TEST_ASSERT_TRUE(queue.next_deadline() == 5.0);
+
+	Hash16 key;
+	double deadline;
+	double last = 0.0;
+	size_t popped = 0;
+	while (queue.pop_due(100.0, key, deadline)) {
+		TEST_ASSERT_TRUE(deadline >= last);
+		TEST_ASSERT_TRUE(deadlines[key_value(key)] == deadline);
+		last = deadline;
+		++popped;
+	}
+	TEST_ASSERT_EQUAL_size_t(7, popped);
+	TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_pops_only_due() {
+	DeadlineQueue<Hash16> queue;
+	queue.schedule(make_key(1), 10.0);
+	queue.schedule(make_key(2), 20.0);
+
+	Hash16 key;
+	// Due only once time has passed the deadline
+	TEST_ASSERT_FALSE(queue.pop_due(5.0, key));
+	TEST_ASSERT_FALSE(queue.pop_due(10.0, key));
+	TEST_ASSERT_TRUE(queue.pop_due(10.5, key));
+	TEST_ASSERT_EQUAL_UINT32(1, key_value(key));
+	TEST_ASSERT_FALSE(queue.pop_due(10.5, key));
+	TEST_ASSERT_EQUAL_size_t(1, queue.size());
+	TEST_ASSERT_TRUE(queue.next_deadline() == 20.0);
+}
+
+void test_equal_deadlines_are_fifo() {
+	DeadlineQueue<Hash16> queue;
+	for (uint32_t i = 0; i < 100; ++i) {
+		queue.schedule(make_key(i), 10.0);
+	}
+	Hash16 key;
+	for (uint32_t i = 0; i < 100; ++i) {
+		TEST_ASSERT_TRUE(queue.pop_due(11.0, key));
+		TEST_ASSERT_EQUAL_UINT32(i, key_value(key));
+	}
+	TEST_ASSERT_TRUE(queue.empty());
+}
+
+// Drives a table the way Transport does: deadlines move later without the queue being told, and
+// entries are removed early, so popped keys are re-validated against the table
+void test_lazy_revalidation() {
+	DeadlineQueue<Hash16> queue;
+	std::map<Hash16, double> table;
+	for (uint32_t i = 0; i < 10; ++i) {
+		table[make_key(i)] = 10.0 + i;
+		queue.schedule(make_key(i), 10.0 + i);
+	}
+	// removed before its deadline
+	table.erase(make_key(3));
+	// refreshed, deadline moved later
+	table[make_key(5)] = 100.0;
+
+	std::vector<uint32_t> expired;
+	auto expire = [&](double now) {
+		Hash16 key;
+		while (queue.pop_due(now, key)) {
+			auto iter = table.find(key);
+			if (iter == table.end()) {
+				continue;
+			}
+			if (!(now > iter->second)) {
+				queue.schedule(key, iter->second);
+				continue;
+			}
+			expired.push_back(key_value(key));
+			table.erase(iter);
+		}
+	};
+
+	expire(50.0);
+	TEST_ASSERT_EQUAL_size_t(8, expired.size());
+	for (uint32_t n : expired) {
+		TEST_ASSERT_TRUE(n != 3 && n != 5);
+	}
+	TEST_ASSERT_EQUAL_size_t(1, table.size());
+	TEST_ASSERT_EQUAL_size_t(1, queue.size());
+	TEST_ASSERT_TRUE(queue.next_deadline() == 100.0);
+
+	expire(100.5);
+	TEST_ASSERT_EQUAL_size_t(9, expired.size());
+	TEST_ASSERT_EQUAL_UINT32(5, expired.back());
+	TEST_ASSERT_TRUE(table.empty());
+	TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_prune() {
+	DeadlineQueue<Hash16> queue;
+	std::map<Hash16, double> table;
+	for (uint32_t i = 0; i < 100; ++i) {
+		queue.schedule(make_key(i), 1000.0 - i);
+		if ((i % 10) == 0) {
+			table[make_key(i)] = 1000.0 - i;
+		}
+	}
+	size_t pruned = queue.prune([&table](const Hash16& key) { return table.count(key) == 0; });
+	TEST_ASSERT_EQUAL_size_t(90, pruned);
+	TEST_ASSERT_EQUAL_size_t(10, queue.size());
+
+	// Heap order survives pruning
+	Hash16 key;
+	double deadline;
+	double last = 0.0;
+	while (queue.pop_due(2000.0, key, deadline)) {
+		TEST_ASSERT_EQUAL_UINT32(0, key_value(key) % 10);
+		TEST_ASSERT_TRUE(deadline >= last);
+		last = deadline;
+	}
+	TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_container_allocator() {
+	size_t alloc_before = Memory::container_allocator_alloc();
+	size_t free_before = Memory::container_allocator_free();
+	{
+		DeadlineQueue<Hash16, Memory::ContainerAllocator<Hash16>> queue;
+		for (uint32_t i = 0; i < 1000; ++i) {
+			queue.schedule(make_key(i), (double)(i % 37));
+		}
+		Hash16 key;
+		size_t popped = 0;
+		while (queue.pop_due(1000.0, key)) {
+			++popped;
+		}
+		TEST_ASSERT_EQUAL_size_t(1000, popped);
+	}
+	TEST_ASSERT_TRUE(Memory::container_allocator_alloc() > alloc_before);
+	TEST_ASSERT_EQUAL_size_t(Memory::container_allocator_alloc() - alloc_before, Memory::container_allocator_free() - free_before);
+}
+
+// Cost per jobs() tick of finding the few expired entries in a large table: full sweep (as jobs()
+// used to do) vs popping due deadlines
+void test_benchmark() {
+#ifdef ARDUINO
+	const size_t sizes[] = {1000};
+#else
+	const size_t sizes[] = {1000, 10000, 100000};
+#endif
+	for (size_t size : sizes) {
+		std::map<Hash16, double> table;
+		DeadlineQueue<Hash16> queue;
+		for (uint32_t i = 0; i < size; ++i) {
+			// deadlines spread over 1000 ticks
+			double deadline = (double)(i % 1000) + 0.5;
+			table[make_key(i)] = deadline;
+			queue.schedule(make_key(i), deadline);
+		}
+		const size_t ticks = 100;
+
+		uint64_t start = test_micros();
+		size_t swept = 0;
+		for (size_t tick = 0; tick < ticks; ++tick) {
+			double now = (double)tick + 1.0;
+			std::vector<Hash16> stale;
+			for (const auto& entry : table) {
+				if (now > entry.second) {
+					stale.push_back(entry.first);
+				}
+			}
+			swept += stale.size();
+			// leave entries in place so every sweep sees the full table
+		}
+		uint64_t sweep_us = test_micros() - start;
+
+		start = test_micros();
+		size_t popped = 0;
+		for (size_t tick = 0; tick < ticks; ++tick) {
+			double now = (double)tick + 1.0;
+			Hash16 key;
+			while (queue.pop_due(now, key)) {
+				if (table.count(key) > 0) {
+					++popped;
+				}
+			}
+		}
+		uint64_t queue_us = test_micros() - start;
+
+		TEST_ASSERT_EQUAL_size_t(size / 1000 * ticks, popped);
+		TEST_ASSERT_TRUE(swept >= popped);
+		printf("%7zu entries: sweep %9.1f us/tick, deadline queue %7.1f us/tick\n", size,
+			(double)sweep_us / ticks, (double)queue_us / ticks);
+	}
+}
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_empty_state);
+	RUN_TEST(test_pops_in_deadline_order);
+	RUN_TEST(test_pops_only_due);
+	RUN_TEST(test_equal_deadlines_are_fifo);
+	RUN_TEST(test_lazy_revalidation);
+	RUN_TEST(test_prune);
+	RUN_TEST(test_container_allocator);
+	RUN_TEST(test_benchmark);
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
@@ -0,0 +1,203 @@
+#include <unity.h>
+
+#include "microReticulum/Interface.h"
+#include "microReticulum/Transport.h"
+#include "microReticulum/Utilities/OS.h"
+#include "microReticulum/Log.h"
+#include "microReticulum/Bytes.h"
+
+#include <vector>
+#include <string.h>
+
+using RNS::Bytes;
+using RNS::Interface;
+using RNS::Transport;
+using RNS::Utilities::OS;
+using namespace RNS::Type::Interface;
+
+class TestInterface : public RNS::InterfaceImpl {
+public:
+	TestInterface(const char* name) : RNS::InterfaceImpl(name) {}
+	std::vector<Bytes> _sent;
+protected:
+	virtual bool send_outgoing(const Bytes& data) {
+		_sent.push_back(data);
+		return true;
+	}
+};
+
+// Packed packet with the given header fields, tagged with marker after the context byte
+static Bytes make_raw(uint8_t packet_type, uint8_t destination_type, uint8_t context, uint8_t marker, size_t size = 100, bool header_2 = false) {
+	Bytes raw;
+	uint8_t* data = raw.writable(size);
+	memset(data, 0, size);
+	data[0] = (header_2 ? 0x40 : 0x00) | (destination_type << 2) | packet_type;
+	size_t context_offset = header_2 ? 34 : 18;
+	data[context_offset] = context;
+	data[context_offset + 1] = marker;
+	return raw;
+}
+
+static uint8_t marker(const Bytes& raw) {
+	return raw.data()[19];
+}
+
+void test_egress_classes() {
+	namespace Packet = RNS::Type::Packet;
+	namespace Destination = RNS::Type::Destination;
+	TEST_ASSERT_EQUAL_INT(EGRESS_ANNOUNCE, Transport::egress_class_of(make_raw(Packet::ANNOUNCE, Destination::SINGLE, Packet::CONTEXT_NONE, 0)));
+	TEST_ASSERT_EQUAL_INT(EGRESS_ANNOUNCE, Transport::egress_class_of(make_raw(Packet::ANNOUNCE, Destination::SINGLE, Packet::PATH_RESPONSE, 0, 200, true)));
+	TEST_ASSERT_EQUAL_INT(EGRESS_LINK_CONTROL, Transport::egress_class_of(make_raw(Packet::LINKREQUEST, Destination::SINGLE, Packet::CONTEXT_NONE, 0)));
+	TEST_ASSERT_EQUAL_INT(EGRESS_LINK_CONTROL, Transport::egress_class_of(make_raw(Packet::PROOF, Destination::LINK, Packet::LRPROOF, 0)));
+	TEST_ASSERT_EQUAL_INT(EGRESS_LINK_CONTROL, Transport::egress_class_of(make_raw(Packet::DATA, Destination::LINK, Packet::KEEPALIVE, 0, 20)));
+	TEST_ASSERT_EQUAL_INT(EGRESS_LINK_CONTROL, Transport::egress_class_of(make_raw(Packet::DATA, Destination::LINK, Packet::LRRTT, 0, 60, true)));
+	TEST_ASSERT_EQUAL_INT(EGRESS_LINK_DATA, Transport::egress_class_of(make_raw(Packet::DATA, Destination::LINK, Packet::RESOURCE, 0)));
+	TEST_ASSERT_EQUAL_INT(EGRESS_LINK_DATA, Transport::egress_class_of(make_raw(Packet::DATA, Destination::SINGLE, Packet::CONTEXT_NONE, 0)));
+	TEST_ASSERT_EQUAL_INT(EGRESS_LINK_DATA, Transport::egress_class_of(make_raw(Packet::DATA, Destination::PLAIN, Packet::CONTEXT_NONE, 0)));
+	TEST_ASSERT_EQUAL_INT(EGRESS_LINK_DATA, Transport::egress_class_of(Bytes("short")));
+}
+
+void test_egress_unshaped() {
+	TestInterface* impl = new TestInterface("unshaped");
+	Interface interface(impl);
+	interface.bitrate(8000);
+	TEST_ASSERT_FALSE(interface.egress_shaping());
+	TEST_ASSERT_TRUE(interface.queue_outgoing(make_raw(RNS::Type::Packet::ANNOUNCE, 0, 0, 1), EGRESS_ANNOUNCE));
+	TEST_ASSERT_EQUAL_size_t(1, impl->_sent.size());
+	TEST_ASSERT_EQUAL_size_t(0, interface.egress_queued());
+	TEST_ASSERT_TRUE(interface.egress_ready_at() == 0);
+}
+
+void test_egress_priority_and_rate() {
+	TestInterface* impl = new TestInterface("shaped");
+	Interface interface(impl);
+	// 1000 bytes/s with room for two 100 byte packets at once
+	interface.bitrate(8000);
+	interface.egress_shaping(true, 200);
+	TEST_ASSERT_TRUE(interface.egress_shaping());
+	TEST_ASSERT_EQUAL_UINT32(200, interface.egress_burst());
+
+	double start = OS::time();
+	TEST_ASSERT_TRUE(interface.queue_outgoing(make_raw(RNS::Type::Packet::ANNOUNCE, 0, 0, 1), EGRESS_ANNOUNCE));
+	TEST_ASSERT_TRUE(interface.queue_outgoing(make_raw(RNS::Type::Packet::ANNOUNCE, 0, 0, 2), EGRESS_ANNOUNCE));
+	// Burst used up, the rest is held
+	TEST_ASSERT_EQUAL_size_t(2, impl->_sent.size());
+	TEST_ASSERT_TRUE(interface.queue_outgoing(make_raw(RNS::Type::Packet::ANNOUNCE, 0, 0, 3), EGRESS_ANNOUNCE));
+	TEST_ASSERT_TRUE(interface.queue_outgoing(make_raw(RNS::Type::Packet::DATA, 0, 0, 4), EGRESS_PATH_REQUEST));
+	TEST_ASSERT_TRUE(interface.queue_outgoing(make_raw(RNS::Type::Packet::DATA, 0, 0, 5), EGRESS_LINK_DATA));
+	TEST_ASSERT_TRUE(interface.queue_outgoing(make_raw(RNS::Type::Packet::PROOF, 0, 0, 6), EGRESS_LINK_CONTROL));
+	TEST_ASSERT_EQUAL_size_t(2, impl->_sent.size());
+	TEST_ASSERT_EQUAL_size_t(4, interface.egress_queued());
+	TEST_ASSERT_EQUAL_size_t(1, interface.egress_queued(EGRESS_ANNOUNCE));
+	double ready_at = interface.egress_ready_at();
+	TEST_ASSERT_TRUE(ready_at > start && ready_at < start + 0.15);
+
+	// Held packets go out highest class first, one per 100 ms
+	double deadline = start + 5.0;
+	while (interface.egress_queued() > 0 && OS::time() < deadline) {
+		interface.process_egress();
+		OS::sleep(0.005);
+	}
+	double elapsed = OS::time() - start;
+	TEST_ASSERT_EQUAL_size_t(6, impl->_sent.size());
+	const uint8_t expected[] = {1, 2, 6, 5, 4, 3};
+	for (size_t i = 0; i < 6; ++i) {
+		TEST_ASSERT_EQUAL_UINT8(expected[i], marker(impl->_sent[i]));
+	}
+	TEST_ASSERT_TRUE(elapsed >= 0.35);
+	TEST_ASSERT_TRUE(interface.egress_ready_at() == 0);
+}
+
+void test_egress_drops() {
+	TestInterface* impl = new TestInterface("dropping");
+	Interface interface(impl);
+	interface.bitrate(800);
+	interface.egress_shaping(true, 100);
+	for (size_t i = 0; i < EGRESS_QUEUE_MAX + 4; ++i) {
+		interface.queue_outgoing(make_raw(RNS::Type::Packet::ANNOUNCE, 0, 0, (uint8_t)i), EGRESS_ANNOUNCE);
+	}
+	// One fit the burst, the class queue filled and the rest were dropped
+	TEST_ASSERT_EQUAL_size_t(1, impl->_sent.size());
+	TEST_ASSERT_EQUAL_size_t(EGRESS_QUEUE_MAX, interface.egress_queued(EGRESS_ANNOUNCE));
+	TEST_ASSERT_EQUAL_size_t(3, interface.egress_dropped(EGRESS_ANNOUNCE));
+	TEST_ASSERT_EQUAL_size_t(3, interface.egress_dropped());
+
+	// Other classes have their own queues
+	TEST_ASSERT_TRUE(interface.queue_outgoing(make_raw(RNS::Type::Packet::PROOF, 0, 0, 99), EGRESS_LINK_CONTROL));
+	TEST_ASSERT_EQUAL_size_t(0, interface.egress_dropped(EGRESS_LINK_CONTROL));
+
+	// Turning shaping off sends everything held
+	interface.egress_shaping(false);
+	TEST_ASSERT_EQUAL_size_t(0, interface.egress_queued());
+	TEST_ASSERT_EQUAL_size_t(EGRESS_QUEUE_MAX + 2, impl->_sent.size());
+	TEST_ASSERT_EQUAL_UINT8(99, marker(impl->_sent[1]));
+}
+
+void test_transmit_shaped() {
+	TestInterface* impl = new TestInterface("transmit");
+	Interface interface(impl);
+	interface.bitrate(8000);
+	interface.egress_shaping(true, 100);
+	Transport::register_interface(interface);
+
+	TEST_ASSERT_TRUE(Transport::transmit(interface, make_raw(RNS::Type::Packet::ANNOUNCE, 0, 0, 1)));
+	TEST_ASSERT_TRUE(Transport::transmit(interface, make_raw(RNS::Type::Packet::ANNOUNCE, 0, 0, 2)));
+	TEST_ASSERT_TRUE(Transport::transmit(interface, make_raw(RNS::Type::Packet::DATA, RNS::Type::Destination::LINK, RNS::Type::Packet::KEEPALIVE, 3)));
+	TEST_ASSERT_EQUAL_size_t(1, impl->_sent.size());
+	TEST_ASSERT_EQUAL_size_t(1, interface.egress_queued(EGRESS_LINK_CONTROL));
+
+	// Transport wakes up for held packets and sends them when flushing interfaces
+	TEST_ASSERT_TRUE(Transport::next_loop_time() <= interface.egress_ready_at());
+	double deadline = OS::time() + 5.0;
+	while (interface.egress_queued() > 0 && OS::time() < deadline) {
+		Transport::flush_interfaces();
+		OS::sleep(0.005);
+	}
+	TEST_ASSERT_EQUAL_size_t(3, impl->_sent.size());
+	TEST_ASSERT_EQUAL_UINT8(3, marker(impl->_sent[1]));
+	TEST_ASSERT_EQUAL_UINT8(2, marker(impl->_sent[2]));
+
+	Transport::deregister_interface(interface);
+}
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_egress_classes);
+	RUN_TEST(test_egress_unshaped);
+	RUN_TEST(test_egress_priority_and_rate);
+	RUN_TEST(test_egress_drops);
+	RUN_TEST(test_transmit_shaped);
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	RNS::loglevel(RNS::LOG_WARNING);
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
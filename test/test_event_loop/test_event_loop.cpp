@@ -0,0 +1,168 @@
+#include <unity.h>
+
+#include "microReticulum/Utilities/EventLoop.h"
+#include "microReticulum/Utilities/OS.h"
+
+#include <vector>
+#include <stdio.h>
+#ifndef ARDUINO
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+#endif
+
+using RNS::Utilities::EventLoop;
+
+#if RNS_EVENT_LOOP
+static double elapsed_since(const std::chrono::steady_clock::time_point& start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void test_wait_times_out() {
+	TEST_ASSERT_TRUE(EventLoop::open());
+	auto start = std::chrono::steady_clock::now();
+	TEST_ASSERT_FALSE(EventLoop::wait(0.05));
+	double elapsed = elapsed_since(start);
+	TEST_ASSERT_TRUE(elapsed >= 0.045);
+	TEST_ASSERT_TRUE(elapsed < 0.5);
+
+	// Zero timeout only polls
+	start = std::chrono::steady_clock::now();
+	TEST_ASSERT_FALSE(EventLoop::wait(0));
+	TEST_ASSERT_TRUE(elapsed_since(start) < 0.01);
+}
+
+void test_watched_fd_wakes() {
+	int fds[2];
+	TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+	TEST_ASSERT_TRUE(EventLoop::watch(fds[0]));
+	TEST_ASSERT_TRUE(EventLoop::watching(fds[0]));
+	// watching twice is harmless
+	TEST_ASSERT_TRUE(EventLoop::watch(fds[0]));
+	TEST_ASSERT_EQUAL_size_t(1, EventLoop::watched().size());
+	TEST_ASSERT_FALSE(EventLoop::wait(0.01));
+
+	ssize_t written = 0;
+	std::thread writer([&fds, &written]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		char c = 'x';
+		written = write(fds[1], &c, 1);
+	});
+	auto start = std::chrono::steady_clock::now();
+	TEST_ASSERT_TRUE(EventLoop::wait(5.0));
+	double elapsed = elapsed_since(start);
+	writer.join();
+	TEST_ASSERT_EQUAL_INT(1, written);
+	TEST_ASSERT_TRUE(elapsed < 1.0);
+	printf("woke %.3f ms after waiting for a 20 ms delayed write\n", elapsed * 1000.0);
+
+	// Level-triggered, stays ready until drained
+	TEST_ASSERT_TRUE(EventLoop::wait(1.0));
+	char c;
+	TEST_ASSERT_EQUAL_INT(1, read(fds[0], &c, 1));
+	TEST_ASSERT_FALSE(EventLoop::wait(0.01));
+
+	EventLoop::unwatch(fds[0]);
+	TEST_ASSERT_FALSE(EventLoop::watching(fds[0]));
+	TEST_ASSERT_EQUAL_INT(1, write(fds[1], &c, 1));
+	TEST_ASSERT_FALSE(EventLoop::wait(0.01));
+	close(fds[0]);
+	close(fds[1]);
+}
+
+void test_wake_from_thread() {
+	std::thread waker([]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		EventLoop::wake();
+	});
+	auto start = std::chrono::steady_clock::now();
+	TEST_ASSERT_TRUE(EventLoop::wait(5.0));
+	TEST_ASSERT_TRUE(elapsed_since(start) < 1.0);
+	waker.join();
+	// wake was consumed
+	TEST_ASSERT_FALSE(EventLoop::wait(0.01));
+
+	// Wakes before a wait, or several at once, make only the next wait return early
+	EventLoop::wake();
+	EventLoop::wake();
+	EventLoop::wake();
+	TEST_ASSERT_TRUE(EventLoop::wait(1.0));
+	TEST_ASSERT_FALSE(EventLoop::wait(0.01));
+}
+
+void test_wake_storm() {
+	// Many producers waking a consumer that keeps re-waiting must never leave a wake stranded
+	const int WAKERS = 4;
+	const int WAKES = 10000;
+	std::vector<std::thread> wakers;
+	for (int i = 0; i < WAKERS; ++i) {
+		wakers.emplace_back([]() {
+			for (int n = 0; n < WAKES; ++n) {
+				EventLoop::wake();
+			}
+		});
+	}
+	for (auto& waker : wakers) {
+		waker.join();
+	}
+	TEST_ASSERT_TRUE(EventLoop::wait(1.0));
+	TEST_ASSERT_FALSE(EventLoop::wait(0.01));
+	EventLoop::wake();
+	TEST_ASSERT_TRUE(EventLoop::wait(1.0));
+}
+
+void test_close_and_reopen() {
+	EventLoop::close();
+	TEST_ASSERT_EQUAL_size_t(0, EventLoop::watched().size());
+	// wake while closed is dropped
+	EventLoop::wake();
+	TEST_ASSERT_TRUE(EventLoop::open());
+	TEST_ASSERT_FALSE(EventLoop::wait(0.01));
+	EventLoop::wake();
+	TEST_ASSERT_TRUE(EventLoop::wait(1.0));
+	EventLoop::close();
+}
+#endif
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+#if RNS_EVENT_LOOP
+	RUN_TEST(test_wait_times_out);
+	RUN_TEST(test_watched_fd_wakes);
+	RUN_TEST(test_wake_from_thread);
+	RUN_TEST(test_wake_storm);
+	RUN_TEST(test_close_and_reopen);
+#endif
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
@@ -0,0 +1,333 @@
+#include <unity.h>
+
+#include "microReticulum/Bytes.h"
+#include "microReticulum/HashKey.h"
+#include "microReticulum/Utilities/FlatMap.h"
+#include "microReticulum/Utilities/Memory.h"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <functional>
+#include <stdio.h>
+#include <string.h>
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+using RNS::Bytes;
+using RNS::Hash16;
+using RNS::Utilities::FlatMap;
+using RNS::Utilities::Memory;
+
+using HashFlatMap = FlatMap<Hash16, int>;
+
+// Shaped like the Transport forwarding entries (const members, handle member) so relocation must go
+// through move-construction
+struct Entry {
+	Entry(double timestamp, const Bytes& next_hop) : _timestamp(timestamp), _next_hop(next_hop) {}
+	double _timestamp = 0;
+	const Bytes _next_hop;
+};
+
+#ifdef ARDUINO
+uint64_t test_micros() {
+	return micros();
+}
+#else
+uint64_t test_micros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+// Distinct, uniformly distributed keys like real destination hashes and link ids
+static Hash16 make_key(uint32_t n) {
+	uint8_t data[Hash16::SIZE];
+	uint64_t x = (uint64_t)n + 1;
+	for (size_t i = 0; i < sizeof(data); i += 8) {
+		// splitmix64
+		x += UINT64_C(0x9E3779B97F4A7C15);
+		uint64_t z = x;
+		z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+		z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+		z ^= z >> 31;
+		memcpy(data + i, &z, 8);
+	}
+	return Hash16(data, sizeof(data));
+}
+
+void test_empty_state() {
+	HashFlatMap m;
+	TEST_ASSERT_TRUE(m.empty());
+	TEST_ASSERT_EQUAL_size_t(0, m.size());
+	TEST_ASSERT_EQUAL_size_t(0, m.bucket_count());
+	TEST_ASSERT_TRUE(m.find(make_key(1)) == m.end());
+	TEST_ASSERT_TRUE(m.begin() == m.end());
+	TEST_ASSERT_EQUAL_size_t(0, m.count(make_key(1)));
+	TEST_ASSERT_EQUAL_size_t(0, m.erase(make_key(1)));
+	m.clear();
+	TEST_ASSERT_TRUE(m.empty());
+}
+
+void test_insert_find_erase() {
+	HashFlatMap m;
+	auto r1 = m.insert({make_key(1), 10});
+	TEST_ASSERT_TRUE(r1.second);
+	TEST_ASSERT_EQUAL_INT(10, r1.first->second);
+	auto r2 = m.insert({make_key(1), 20});
+	TEST_ASSERT_FALSE(r2.second);
+	TEST_ASSERT_EQUAL_INT(10, r2.first->second);
+	TEST_ASSERT_EQUAL_size_t(1, m.size());
+
+	auto r3 = m.emplace(make_key(2), 30);
+	TEST_ASSERT_TRUE(r3.second);
+	TEST_ASSERT_EQUAL_size_t(2, m.size());
+
+	// lookup directly with a Bytes hash as Transport does
+	Bytes hash = make_key(2).bytes();
+	auto it = m.find(hash);
+	TEST_ASSERT_TRUE(it != m.end());
+	TEST_ASSERT_EQUAL_INT(30, it->second);
+	TEST_ASSERT_EQUAL_size_t(1, m.count(hash));
+
+	TEST_ASSERT_EQUAL_size_t(1, m.erase(make_key(1)));
+	TEST_ASSERT_EQUAL_size_t(0, m.erase(make_key(1)));
+	TEST_ASSERT_TRUE(m.find(make_key(1)) == m.end());
+	TEST_ASSERT_EQUAL_size_t(1, m.size());
+}
+
+void test_subscript() {
+	HashFlatMap m;
+	m[make_key(1)] = 5;
+	m[make_key(1)] += 1;
+	TEST_ASSERT_EQUAL_INT(6, m[make_key(1)]);
+	TEST_ASSERT_EQUAL_INT(0, m[make_key(2)]);
+	TEST_ASSERT_EQUAL_size_t(2, m.size());
+}
+
+void test_growth_keeps_entries() {
+	HashFlatMap m;
+	const int count = 5000;
+	for (int i = 0; i < count; ++i) {
+		TEST_ASSERT_TRUE(m.insert({make_key(i), i}).second);
+	}
+	TEST_ASSERT_EQUAL_size_t(count, m.size());
+	TEST_ASSERT_TRUE(m.load_factor() <= 0.875f);
+	for (int i = 0; i < count; ++i) {
+		auto it = m.find(make_key(i));
+		TEST_ASSERT_TRUE(it != m.end());
+		TEST_ASSERT_EQUAL_INT(i, it->second);
+	}
+	TEST_ASSERT_TRUE(m.find(make_key(count)) == m.end());
+
+	size_t visited = 0;
+	for (const auto& [key, value] : m) {
+		(void)key;
+		(void)value;
+		++visited;
+	}
+	TEST_ASSERT_EQUAL_size_t(count, visited);
+}
+
+void test_weak_hash() {
+	// all keys collide into long probe runs, table must still grow and resolve them
+	struct ZeroHash {
+		size_t operator()(const Hash16&) const { return 0; }
+	};
+	FlatMap<Hash16, int, ZeroHash> m;
+	for (int i = 0; i < 100; ++i) {
+		m.insert({make_key(i), i});
+	}
+	TEST_ASSERT_EQUAL_size_t(100, m.size());
+	for (int i = 0; i < 100; ++i) {
+		TEST_ASSERT_EQUAL_INT(i, m.find(make_key(i))->second);
+	}
+	for (int i = 0; i < 100; i += 2) {
+		TEST_ASSERT_EQUAL_size_t(1, m.erase(make_key(i)));
+	}
+	for (int i = 0; i < 100; ++i) {
+		TEST_ASSERT_EQUAL_size_t((i % 2) ? 1 : 0, m.count(make_key(i)));
+	}
+}
+
+void test_erase_while_iterating() {
+	// same pattern as the Transport cull loops that erase stale entries in place
+	HashFlatMap m;
+	for (int i = 0; i < 1000; ++i) {
+		m.insert({make_key(i), i});
+	}
+	size_t visited = 0;
+	for (auto it = m.begin(); it != m.end(); ) {
+		++visited;
+		if (it->second % 3 == 0) {
+			it = m.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+	TEST_ASSERT_EQUAL_size_t(1000, visited);
+	TEST_ASSERT_EQUAL_size_t(666, m.size());
+	for (int i = 0; i < 1000; ++i) {
+		TEST_ASSERT_EQUAL_size_t((i % 3 == 0) ? 0 : 1, m.count(make_key(i)));
+	}
+}
+
+void test_against_reference() {
+	// randomized operations mirrored into std::map
+	FlatMap<Hash16, Entry> m;
+	std::map<Hash16, double> reference;
+	uint32_t seed = 12345;
+	for (int i = 0; i < 20000; ++i) {
+		seed = seed * 1103515245 + 12345;
+		uint32_t n = (seed >> 8) % 2000;
+		Hash16 key = make_key(n);
+		if ((seed & 0x3) == 0) {
+			TEST_ASSERT_EQUAL_size_t(reference.erase(key), m.erase(key));
+		}
+		else {
+			bool inserted = m.insert({key, Entry((double)i, key.bytes())}).second;
+			TEST_ASSERT_EQUAL(reference.insert({key, (double)i}).second, inserted);
+		}
+	}
+	TEST_ASSERT_EQUAL_size_t(reference.size(), m.size());
+	for (const auto& [key, timestamp] : reference) {
+		auto it = m.find(key);
+		TEST_ASSERT_TRUE(it != m.end());
+		TEST_ASSERT_TRUE(timestamp == it->second._timestamp);
+		TEST_ASSERT_TRUE(it->second._next_hop == key.bytes());
+	}
+}
+
+void test_copy_and_move() {
+	FlatMap<Hash16, Entry> m;
+	for (int i = 0; i < 100; ++i) {
+		m.insert({make_key(i), Entry((double)i, make_key(i).bytes())});
+	}
+	FlatMap<Hash16, Entry> copy(m);
+	TEST_ASSERT_EQUAL_size_t(100, copy.size());
+	FlatMap<Hash16, Entry> moved(std::move(m));
+	TEST_ASSERT_EQUAL_size_t(100, moved.size());
+	TEST_ASSERT_TRUE(m.empty());
+	TEST_ASSERT_TRUE(m.begin() == m.end());
+	m = moved;
+	TEST_ASSERT_EQUAL_size_t(100, m.size());
+	for (int i = 0; i < 100; ++i) {
+		TEST_ASSERT_TRUE((double)i == copy.find(make_key(i))->second._timestamp);
+		TEST_ASSERT_TRUE((double)i == m.find(make_key(i))->second._timestamp);
+	}
+}
+
+void test_container_allocator() {
+	using PoolMap = FlatMap<Hash16, int, std::hash<Hash16>, std::equal_to<Hash16>, Memory::ContainerAllocator<std::pair<Hash16, int>>>;
+	size_t alloc_count = Memory::container_allocator_alloc();
+	size_t free_count = Memory::container_allocator_free();
+	{
+		PoolMap m;
+		for (int i = 0; i < 1000; ++i) {
+			m[make_key(i)] = i;
+		}
+		TEST_ASSERT_EQUAL_size_t(1000, m.size());
+		TEST_ASSERT_EQUAL_INT(500, m.find(make_key(500))->second);
+	}
+	// slot array came from (and was returned to) the container allocator
+	size_t allocs = Memory::container_allocator_alloc() - alloc_count;
+	TEST_ASSERT_TRUE(allocs > 0);
+	TEST_ASSERT_EQUAL_size_t(allocs, Memory::container_allocator_free() - free_count);
+}
+
+// Insert, find (hit) and erase throughput at a given table size
+template <typename Map>
+static void benchmark_map(const char* name, const std::vector<Hash16>& keys) {
+	Map map;
+	uint64_t start = test_micros();
+	for (const Hash16& key : keys) {
+		map.insert({key, Entry(1.0, Bytes())});
+	}
+	uint64_t insert_time = test_micros() - start;
+
+	size_t found = 0;
+	start = test_micros();
+	for (const Hash16& key : keys) {
+		found += map.count(key);
+	}
+	uint64_t find_time = test_micros() - start;
+	TEST_ASSERT_EQUAL_size_t(keys.size(), found);
+
+	start = test_micros();
+	for (const Hash16& key : keys) {
+		map.erase(key);
+	}
+	uint64_t erase_time = test_micros() - start;
+	TEST_ASSERT_EQUAL_size_t(0, map.size());
+
+	double count = (double)keys.size();
+	printf("%-20s %7zu entries: insert %7.1f ns/op, find %7.1f ns/op, erase %7.1f ns/op\n", name, keys.size(),
+		(double)insert_time * 1000.0 / count, (double)find_time * 1000.0 / count, (double)erase_time * 1000.0 / count);
+}
+
+void test_benchmark() {
+#ifdef ARDUINO
+	const size_t sizes[] = {1000};
+#else
+	const size_t sizes[] = {1000, 10000, 100000};
+#endif
+	for (size_t size : sizes) {
+		std::vector<Hash16> keys;
+		keys.reserve(size);
+		for (size_t i = 0; i < size; ++i) {
+			keys.push_back(make_key((uint32_t)i));
+		}
+		benchmark_map<std::map<Hash16, Entry>>("std::map", keys);
+		benchmark_map<std::unordered_map<Hash16, Entry>>("std::unordered_map", keys);
+		benchmark_map<FlatMap<Hash16, Entry>>("FlatMap", keys);
+		benchmark_map<FlatMap<Hash16, Entry, std::hash<Hash16>, std::equal_to<Hash16>, Memory::ContainerAllocator<std::pair<Hash16, Entry>>>>("FlatMap (pool)", keys);
+	}
+}
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_empty_state);
+	RUN_TEST(test_insert_find_erase);
+	RUN_TEST(test_subscript);
+	RUN_TEST(test_growth_keeps_entries);
+	RUN_TEST(test_weak_hash);
+	RUN_TEST(test_erase_while_iterating);
+	RUN_TEST(test_against_reference);
+	RUN_TEST(test_copy_and_move);
+	RUN_TEST(test_container_allocator);
+	RUN_TEST(test_benchmark);
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
@@ -0,0 +1,349 @@
+#include <unity.h>
+
+#include <microStore/Adapters/UniversalFileSystem.h>
+
+#include "Bytes.h"
+#include "Packet.h"
+#include "Link.h"
+#include "Destination.h"
+#include "Identity.h"
+#include "Interface.h"
+#include "Reticulum.h"
+#include "Transport.h"
+
+#include <vector>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <stdio.h>
+#include <string.h>
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+// All handle types must be cheaply movable so containers relocate them (and return-by-value hands them off)
+// without touching the shared refcount
+static_assert(std::is_nothrow_move_constructible<RNS::Bytes>::value, "Bytes must be nothrow move constructible");
+static_assert(std::is_nothrow_move_assignable<RNS::Bytes>::value, "Bytes must be nothrow move assignable");
+static_assert(std::is_nothrow_move_constructible<RNS::BytesView>::value, "BytesView must be nothrow move constructible");
+static_assert(std::is_nothrow_move_constructible<RNS::Packet>::value, "Packet must be nothrow move constructible");
+static_assert(std::is_nothrow_move_assignable<RNS::Packet>::value, "Packet must be nothrow move assignable");
+static_assert(std::is_nothrow_move_constructible<RNS::PacketReceipt>::value, "PacketReceipt must be nothrow move constructible");
+static_assert(std::is_nothrow_move_constructible<RNS::Link>::value, "Link must be nothrow move constructible");
+static_assert(std::is_nothrow_move_assignable<RNS::Link>::value, "Link must be nothrow move assignable");
+static_assert(std::is_nothrow_move_constructible<RNS::Destination>::value, "Destination must be nothrow move constructible");
+static_assert(std::is_nothrow_move_assignable<RNS::Destination>::value, "Destination must be nothrow move assignable");
+static_assert(std::is_nothrow_move_constructible<RNS::Identity>::value, "Identity must be nothrow move constructible");
+static_assert(std::is_nothrow_move_assignable<RNS::Identity>::value, "Identity must be nothrow move assignable");
+static_assert(std::is_nothrow_move_constructible<RNS::Interface>::value, "Interface must be nothrow move constructible");
+static_assert(std::is_nothrow_move_assignable<RNS::Interface>::value, "Interface must be nothrow move assignable");
+// Bytes is a value type and carries no vtable
+static_assert(!std::is_polymorphic<RNS::Bytes>::value, "Bytes must not be polymorphic");
+
+#ifdef ARDUINO
+uint64_t test_micros() {
+	return micros();
+}
+#else
+uint64_t test_micros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+void testMoveBytes() {
+
+	// shared data is handed over by pointer
+	std::string large(RNS::Bytes::INLINE_CAPACITY * 2, 'x');
+	RNS::Bytes bytes1(large);
+	const uint8_t* data = bytes1.data();
+	RNS::Bytes bytes2(std::move(bytes1));
+	TEST_ASSERT_EQUAL_PTR(data, bytes2.data());
+	TEST_ASSERT_EQUAL_size_t(large.size(), bytes2.size());
+	TEST_ASSERT_EQUAL_size_t(0, bytes1.size());
+	TEST_ASSERT_FALSE(bytes1);
+
+	// moved-from object is reusable
+	bytes1 = "reuse";
+	TEST_ASSERT_EQUAL_size_t(5, bytes1.size());
+	TEST_ASSERT_EQUAL_MEMORY("reuse", bytes1.data(), bytes1.size());
+
+	// inline data is carried along
+	RNS::Bytes bytes3;
+	bytes3 = std::move(bytes1);
+	TEST_ASSERT_EQUAL_size_t(5, bytes3.size());
+	TEST_ASSERT_EQUAL_MEMORY("reuse", bytes3.data(), bytes3.size());
+	TEST_ASSERT_EQUAL_size_t(0, bytes1.size());
+
+	// self-move leaves contents intact
+	RNS::Bytes& alias = bytes2;
+	bytes2 = std::move(alias);
+	TEST_ASSERT_EQUAL_size_t(large.size(), bytes2.size());
+
+	// moved data remains copy-on-write with any previous copies
+	RNS::Bytes copy(bytes2);
+	RNS::Bytes moved(std::move(bytes2));
+	moved.append("!");
+	TEST_ASSERT_EQUAL_size_t(large.size(), copy.size());
+	TEST_ASSERT_EQUAL_size_t(large.size() + 1, moved.size());
+}
+
+void testMoveHandles() {
+
+	RNS::Bytes raw("0123456789abcdef0123456789abcdef0123456789");
+	RNS::Packet packet1(raw);
+	const RNS::Bytes* object = &packet1.raw();
+	RNS::Packet packet2(std::move(packet1));
+	TEST_ASSERT_FALSE(packet1);
+	TEST_ASSERT_TRUE(packet2);
+	TEST_ASSERT_EQUAL_PTR(object, &packet2.raw());
+
+	RNS::Packet packet3({RNS::Type::NONE});
+	packet3 = std::move(packet2);
+	TEST_ASSERT_FALSE(packet2);
+	TEST_ASSERT_EQUAL_PTR(object, &packet3.raw());
+
+	RNS::Identity identity1(false);
+	RNS::Identity identity2(identity1);
+	RNS::Identity identity3(std::move(identity1));
+	TEST_ASSERT_FALSE(identity1);
+	TEST_ASSERT_FALSE(identity3 < identity2);
+	TEST_ASSERT_FALSE(identity2 < identity3);
+
+	RNS::Destination destination({RNS::Type::NONE});
+	RNS::Destination destination2(std::move(destination));
+	TEST_ASSERT_FALSE(destination2);
+
+	RNS::Link link({RNS::Type::NONE});
+	RNS::Link link2(std::move(link));
+	TEST_ASSERT_FALSE(link2);
+
+	RNS::Interface interface({RNS::Type::NONE});
+	RNS::Interface interface2(std::move(interface));
+	TEST_ASSERT_FALSE(interface2);
+}
+
+// Stages a forwarded packet handle typically passes through in Transport: queued for processing, taken
+// off the queue, returned by value from a helper, and filed into a table entry keyed by its hash.
+struct ForwardEntry {
+	RNS::Packet packet = {RNS::Type::NONE};
+	RNS::Bytes next_hop;
+};
+
+static RNS::Packet forward_pass_copy(const RNS::Packet& packet) {
+	RNS::Packet passed(packet);
+	return passed;
+}
+
+static RNS::Packet forward_pass_move(RNS::Packet&& packet) {
+	RNS::Packet passed(std::move(packet));
+	return passed;
+}
+
+static uint64_t forward_copy(const std::vector<RNS::Packet>& packets, const RNS::Bytes& next_hop) {
+	uint64_t start = test_micros();
+	std::vector<RNS::Packet> queue;
+	std::map<RNS::Bytes, ForwardEntry> table;
+	for (const RNS::Packet& packet : packets) {
+		// every step copies the handle (refcount increment now, decrement when the copy dies)
+		queue.push_back(packet);
+	}
+	for (const RNS::Packet& queued : queue) {
+		RNS::Packet packet = forward_pass_copy(queued);
+		ForwardEntry entry;
+		entry.packet = packet;
+		entry.next_hop = next_hop;
+		table.insert({packet.raw().left(16), entry});
+	}
+	queue.clear();
+	table.clear();
+	return test_micros() - start;
+}
+
+static uint64_t forward_move(std::vector<RNS::Packet>& packets, const RNS::Bytes& next_hop) {
+	uint64_t start = test_micros();
+	std::vector<RNS::Packet> queue;
+	std::map<RNS::Bytes, ForwardEntry> table;
+	for (RNS::Packet& packet : packets) {
+		// ownership of the handle is handed along, refcount is never touched (including on queue growth)
+		queue.push_back(std::move(packet));
+	}
+	for (RNS::Packet& queued : queue) {
+		RNS::Packet packet = forward_pass_move(std::move(queued));
+		ForwardEntry entry;
+		RNS::Bytes key(packet.raw().left(16));
+		entry.packet = std::move(packet);
+		entry.next_hop = next_hop;
+		table.insert({std::move(key), std::move(entry)});
+	}
+	// hand the packets back so their destruction is not charged to this pipeline
+	size_t index = 0;
+	for (auto& item : table) {
+		packets[index++] = std::move(item.second.packet);
+	}
+	queue.clear();
+	table.clear();
+	return test_micros() - start;
+}
+
+void testForwardBenchmark() {
+
+#ifdef ARDUINO
+	const size_t count = 200;
+	const size_t rounds = 5;
+#else
+	const size_t count = 10000;
+	const size_t rounds = 10;
+#endif
+	RNS::Bytes next_hop("0123456789abcdef");
+
+	uint64_t copy_time = 0;
+	uint64_t move_time = 0;
+	for (size_t round = 0; round < rounds; ++round) {
+		std::vector<RNS::Packet> packets;
+		packets.reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			uint8_t raw[64] = {0};
+			memcpy(raw, &i, sizeof(i));
+			memcpy(raw + sizeof(i), &round, sizeof(round));
+			packets.push_back(RNS::Packet(RNS::Bytes(raw, sizeof(raw))));
+		}
+		copy_time += forward_copy(packets, next_hop);
+		move_time += forward_move(packets, next_hop);
+		// every packet made it through the move pipeline and was handed back
+		for (const RNS::Packet& packet : packets) {
+			TEST_ASSERT_TRUE(packet);
+		}
+	}
+
+	// synthetic stand-in for the forwarding path, timings only
+	printf("handle pipeline (copy): %.1f ns/packet\n", (double)copy_time * 1000.0 / (double)(count * rounds));
+	printf("handle pipeline (move): %.1f ns/packet\n", (double)move_time * 1000.0 / (double)(count * rounds));
+}
+
+#ifdef RNS_DEBUG_METRICS
+class ForwardInterface : public RNS::InterfaceImpl {
+public:
+	ForwardInterface(const char* name) : RNS::InterfaceImpl(name) {
+		_IN = true;
+		_OUT = true;
+	}
+	virtual bool send_outgoing(const RNS::Bytes& data) {
+		++_sent;
+		InterfaceImpl::handle_outgoing(data);
+		return true;
+	}
+	size_t _sent = 0;
+};
+
+// Counts Packet and Interface handle copies while Transport forwards packets it is the designated next
+// hop for. Two refcount increments per packet are left: the receiving interface stamped on the packet
+// and the route copied out of the path cache. Reading the route twice and copying its interface out of
+// it made that four.
+void testForwardHandleCounts() {
+
+#ifdef ARDUINO
+	const size_t count = 20;
+#else
+	const size_t count = 200;
+#endif
+
+	microStore::FileSystem filesystem{microStore::Adapters::UniversalFileSystem()};
+	filesystem.init();
+	RNS::Utilities::OS::register_filesystem(filesystem);
+
+	ForwardInterface* toward_impl = new ForwardInterface("TowardInterface");
+	RNS::Interface toward(toward_impl);
+	RNS::Interface from(new ForwardInterface("FromInterface"));
+	RNS::Transport::register_interface(toward);
+	RNS::Transport::register_interface(from);
+
+	RNS::Identity transport_identity;
+	RNS::Transport::identity(transport_identity);
+	RNS::Reticulum reticulum;
+	reticulum.transport_enabled(true);
+	reticulum.start();
+
+	// Path to a remote destination, learned from its announce arriving on toward
+	RNS::Identity remote_identity;
+	RNS::Destination remote(remote_identity, RNS::Type::Destination::IN, RNS::Type::Destination::SINGLE, "test", "forward");
+	RNS::Packet announce = remote.announce(RNS::Bytes(), false, {RNS::Type::NONE}, {RNS::Type::NONE}, false);
+	announce.pack();
+	// Must deregister destination so that the ANNOUNCE appears to be from a remote node
+	RNS::Transport::deregister_destination(remote);
+	toward.handle_incoming(announce.raw());
+	TEST_ASSERT_TRUE(RNS::Transport::has_path(remote.hash()));
+
+	// Packets for it arriving on from with us as the next hop
+	RNS::Destination outbound(remote_identity, RNS::Type::Destination::OUT, RNS::Type::Destination::SINGLE, "test", "forward");
+	std::vector<RNS::Bytes> raws;
+	for (size_t i = 0; i < count; ++i) {
+		RNS::Packet packet(outbound, RNS::Bytes((const uint8_t*)&i, sizeof(i)));
+		packet.header_type(RNS::Type::Packet::HEADER_2)
+			.transport_type(RNS::Type::Transport::TRANSPORT)
+			.transport_id(transport_identity.hash())
+			.create_receipt(false);
+		packet.pack();
+		raws.push_back(packet.raw());
+	}
+
+	size_t sent = toward_impl->_sent;
+	uint32_t copies = RNS::Packet::handle_copies() + RNS::Interface::handle_copies();
+	uint32_t moves = RNS::Packet::handle_moves() + RNS::Interface::handle_moves();
+	for (const RNS::Bytes& raw : raws) {
+		from.handle_incoming(raw);
+		RNS::Transport::flush_interfaces();
+	}
+	copies = RNS::Packet::handle_copies() + RNS::Interface::handle_copies() - copies;
+	moves = RNS::Packet::handle_moves() + RNS::Interface::handle_moves() - moves;
+
+	// every packet went out toward the destination
+	TEST_ASSERT_EQUAL_size_t(count, toward_impl->_sent - sent);
+	printf("forward path: %.1f handle copies/packet, %.1f moves/packet\n", (double)copies / count, (double)moves / count);
+	TEST_ASSERT_LESS_OR_EQUAL_UINT32(2 * count, copies);
+
+	RNS::Transport::deregister_interface(from);
+	RNS::Transport::deregister_interface(toward);
+}
+#endif
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+	RUN_TEST(testMoveBytes);
+	RUN_TEST(testMoveHandles);
+	RUN_TEST(testForwardBenchmark);
+#ifdef RNS_DEBUG_METRICS
+	RUN_TEST(testForwardHandleCounts);
+#endif
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
@@ -0,0 +1,236 @@
+#include <unity.h>
+
+#include "microReticulum/Transport.h"
+#include "microReticulum/Interface.h"
+#include "microReticulum/Identity.h"
+#include "microReticulum/Cryptography/HKDF.h"
+#include "microReticulum/Log.h"
+#include "microReticulum/Bytes.h"
+
+#include <stdio.h>
+#include <string.h>
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+using RNS::Bytes;
+using RNS::Interface;
+using RNS::Transport;
+
+class TestInterface : public RNS::InterfaceImpl {
+public:
+	TestInterface(const char* name) : RNS::InterfaceImpl(name) {}
+protected:
+	virtual bool send_outgoing(const Bytes& data) { return true; }
+};
+
+static Bytes make_bytes(size_t size, uint8_t seed) {
+	Bytes bytes;
+	uint8_t* data = bytes.writable(size);
+	for (size_t i = 0; i < size; ++i) {
+		data[i] = (uint8_t)(seed + i * 31);
+	}
+	return bytes;
+}
+
+// Header with the IFAC flag clear, as packed by Packet
+static Bytes make_packet(size_t size, uint8_t seed) {
+	Bytes raw = make_bytes(size, seed);
+	raw.writable(size)[0] &= 0x7f;
+	return raw;
+}
+
+// Straight transcription of the reference Transport.transmit() masking
+static Bytes reference_mask(const Interface& interface, const Bytes& raw) {
+	size_t ifac_size = interface.ifac_size();
+	Bytes ifac = interface.ifac_identity().sign(raw).right(ifac_size);
+	Bytes mask = RNS::Cryptography::hkdf(raw.size() + ifac_size, ifac, interface.ifac_key());
+	Bytes new_raw;
+	new_raw.append((uint8_t)(raw.data()[0] | 0x80));
+	new_raw.append(raw.data()[1]);
+	new_raw += ifac;
+	new_raw.append(raw.data() + 2, raw.size() - 2);
+	Bytes masked_raw;
+	for (size_t i = 0; i < new_raw.size(); ++i) {
+		uint8_t byte = new_raw.data()[i];
+		if (i == 0) {
+			masked_raw.append((uint8_t)((byte ^ mask.data()[i]) | 0x80));
+		}
+		else if (i == 1 || i > ifac_size + 1) {
+			masked_raw.append((uint8_t)(byte ^ mask.data()[i]));
+		}
+		else {
+			masked_raw.append(byte);
+		}
+	}
+	return masked_raw;
+}
+
+void test_salted_hkdf_matches_hkdf() {
+	const size_t lengths[] = {1, 31, 32, 33, 64, 65, 500, 1064};
+	const size_t salt_sizes[] = {0, 16, 64, 65, 100};
+	Bytes derive_from = make_bytes(16, 7);
+	for (size_t salt_size : salt_sizes) {
+		Bytes salt = (salt_size > 0) ? make_bytes(salt_size, (uint8_t)salt_size) : Bytes(Bytes::NONE);
+		RNS::Cryptography::SaltedHKDF hkdf(salt);
+		TEST_ASSERT_TRUE((bool)hkdf);
+		for (size_t length : lengths) {
+			Bytes expected = RNS::Cryptography::hkdf(length, derive_from, salt);
+			Bytes derived;
+			hkdf.derive(derived.writable(length), length, derive_from.data(), derive_from.size());
+			TEST_ASSERT_EQUAL_size_t(length, expected.size());
+			TEST_ASSERT_EQUAL_MEMORY(expected.data(), derived.data(), length);
+		}
+	}
+}
+
+void test_ifac_matches_reference() {
+	Interface interface(new TestInterface("ifac"));
+	interface.ifac("testnet", "secret passphrase", 16);
+	TEST_ASSERT_TRUE((bool)interface.ifac_identity());
+	TEST_ASSERT_EQUAL_size_t(64, interface.ifac_key().size());
+	TEST_ASSERT_EQUAL_size_t(64, interface.ifac_signature().size());
+
+	const size_t sizes[] = {3, 19, 20, 83, 500};
+	for (size_t size : sizes) {
+		Bytes raw = make_packet(size, (uint8_t)size);
+		Bytes masked;
+		TEST_ASSERT_TRUE(Transport::ifac_mask(interface, raw, masked));
+		Bytes expected = reference_mask(interface, raw);
+		TEST_ASSERT_EQUAL_size_t(expected.size(), masked.size());
+		TEST_ASSERT_EQUAL_MEMORY(expected.data(), masked.data(), expected.size());
+		TEST_ASSERT_EQUAL_UINT8(0x80, masked.data()[0] & 0x80);
+
+		Bytes unmasked;
+		TEST_ASSERT_TRUE(Transport::ifac_unmask(interface, masked, unmasked));
+		TEST_ASSERT_TRUE(unmasked == raw);
+	}
+
+	// Either of network name and passphrase alone, and smaller codes
+	Interface netname_only(new TestInterface("netname"));
+	netname_only.ifac("testnet", nullptr, 8);
+	Bytes raw = make_packet(100, 1);
+	Bytes masked;
+	TEST_ASSERT_TRUE(Transport::ifac_mask(netname_only, raw, masked));
+	TEST_ASSERT_EQUAL_size_t(raw.size() + 8, masked.size());
+	TEST_ASSERT_TRUE(masked == reference_mask(netname_only, raw));
+}
+
+void test_ifac_rejects() {
+	Interface interface(new TestInterface("ifac"));
+	interface.ifac("testnet", "secret passphrase");
+	TEST_ASSERT_EQUAL_UINT8(RNS::InterfaceImpl::DEFAULT_IFAC_SIZE, interface.ifac_size());
+	Interface other(new TestInterface("other"));
+	other.ifac("testnet", "other passphrase");
+
+	Bytes raw = make_packet(120, 3);
+	Bytes masked;
+	TEST_ASSERT_TRUE(Transport::ifac_mask(interface, raw, masked));
+	Bytes unmasked;
+
+	// Different access code
+	TEST_ASSERT_FALSE(Transport::ifac_unmask(other, masked, unmasked));
+
+	// Tampered payload, header or code
+	const size_t positions[] = {1, 2, 17, 18, 60, 135};
+	for (size_t position : positions) {
+		Bytes tampered(masked.data(), masked.size());
+		tampered.writable(tampered.size())[position] ^= 0x01;
+		TEST_ASSERT_FALSE(Transport::ifac_unmask(interface, tampered, unmasked));
+	}
+
+	// IFAC flag clear, or too short to carry a code
+	TEST_ASSERT_FALSE(Transport::ifac_unmask(interface, raw, unmasked));
+	Bytes truncated(masked.data(), 2 + interface.ifac_size());
+	TEST_ASSERT_FALSE(Transport::ifac_unmask(interface, truncated, unmasked));
+
+	// Bad configuration
+	Interface invalid(new TestInterface("invalid"));
+	bool thrown = false;
+	try {
+		invalid.ifac(nullptr, nullptr);
+	}
+	catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	TEST_ASSERT_TRUE(thrown);
+	TEST_ASSERT_FALSE((bool)invalid.ifac_identity());
+}
+
+void test_ifac_benchmark() {
+	Interface interface(new TestInterface("ifac"));
+	interface.ifac("testnet", "secret passphrase");
+	const size_t sizes[] = {64, 500};
+	const int ROUNDS = 2000;
+	for (size_t size : sizes) {
+		Bytes raw = make_packet(size, 9);
+		Bytes masked;
+		Bytes unmasked;
+
+		// Signing dominates, so the masking itself is measured separately against the reference way
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < ROUNDS; ++i) {
+			Transport::ifac_mask(interface, raw, masked);
+			Transport::ifac_unmask(interface, masked, unmasked);
+		}
+		double ifac_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+		TEST_ASSERT_TRUE(unmasked == raw);
+
+		Bytes mask;
+		Bytes ifac = masked.mid(2, interface.ifac_size());
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < ROUNDS; ++i) {
+			interface.ifac_hkdf().derive(mask.writable(masked.size()), masked.size(), ifac.data(), ifac.size());
+		}
+		double mask_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < ROUNDS; ++i) {
+			mask = RNS::Cryptography::hkdf(masked.size(), ifac, interface.ifac_key());
+		}
+		double hkdf_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+
+		printf("%4zu byte packet: mask+unmask %7.2f us/packet, mask derivation %6.2f us (hkdf() %6.2f us)\n", size, ifac_us, mask_us, hkdf_us);
+	}
+}
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_salted_hkdf_matches_hkdf);
+	RUN_TEST(test_ifac_matches_reference);
+	RUN_TEST(test_ifac_rejects);
+	RUN_TEST(test_ifac_benchmark);
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	RNS::loglevel(RNS::LOG_WARNING);
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
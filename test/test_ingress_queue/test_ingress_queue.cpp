@@ -0,0 +1,228 @@
+#include <unity.h>
+
+#include "microReticulum/Bytes.h"
+#include "microReticulum/Utilities/MpscRing.h"
+
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#ifndef ARDUINO
+#include <atomic>
+#include <chrono>
+#include <thread>
+#endif
+
+using RNS::Bytes;
+using RNS::Utilities::MpscRing;
+
+// Frame payload identifies its producer and per-producer sequence number
+struct Frame {
+	Bytes _raw;
+};
+
+static Frame make_frame(uint32_t producer, uint32_t sequence) {
+	uint8_t data[8];
+	memcpy(data, &producer, sizeof(producer));
+	memcpy(data + 4, &sequence, sizeof(sequence));
+	Frame frame;
+	frame._raw = Bytes(data, sizeof(data));
+	return frame;
+}
+
+static void parse_frame(const Frame& frame, uint32_t& producer, uint32_t& sequence) {
+	TEST_ASSERT_EQUAL_size_t(8, frame._raw.size());
+	memcpy(&producer, frame._raw.data(), sizeof(producer));
+	memcpy(&sequence, frame._raw.data() + 4, sizeof(sequence));
+}
+
+void test_capacity_rounding() {
+	MpscRing<Frame> ring1(1);
+	TEST_ASSERT_EQUAL_size_t(2, ring1.capacity());
+	MpscRing<Frame> ring32(32);
+	TEST_ASSERT_EQUAL_size_t(32, ring32.capacity());
+	MpscRing<Frame> ring33(33);
+	TEST_ASSERT_EQUAL_size_t(64, ring33.capacity());
+	TEST_ASSERT_TRUE(ring33.empty());
+}
+
+void test_fifo_single_thread() {
+	MpscRing<Frame> ring(8);
+	Frame frame;
+	TEST_ASSERT_FALSE(ring.try_pop(frame));
+	// several laps around the ring
+	uint32_t next_push = 0;
+	uint32_t next_pop = 0;
+	for (int round = 0; round < 10; ++round) {
+		for (int i = 0; i < 5; ++i) {
+			TEST_ASSERT_TRUE(ring.try_push(make_frame(0, next_push++)));
+		}
+		while (ring.try_pop(frame)) {
+			uint32_t producer, sequence;
+			parse_frame(frame, producer, sequence);
+			TEST_ASSERT_EQUAL_UINT32(next_pop++, sequence);
+		}
+	}
+	TEST_ASSERT_EQUAL_UINT32(50, next_pop);
+	TEST_ASSERT_EQUAL_UINT32(50, ring.pushed());
+	TEST_ASSERT_EQUAL_UINT32(50, ring.popped());
+	TEST_ASSERT_EQUAL_UINT32(0, ring.dropped());
+	TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_tail_drop() {
+	MpscRing<Frame> ring(4);
+	for (uint32_t i = 0; i < 4; ++i) {
+		TEST_ASSERT_TRUE(ring.try_push(make_frame(0, i)));
+	}
+	// Full, newest frames are refused and counted
+	Frame extra = make_frame(0, 99);
+	TEST_ASSERT_FALSE(ring.try_push(std::move(extra)));
+	TEST_ASSERT_FALSE(ring.try_push(make_frame(0, 100)));
+	TEST_ASSERT_EQUAL_UINT32(2, ring.dropped());
+	TEST_ASSERT_EQUAL_UINT32(4, ring.pushed());
+	// refused frame is left with the producer
+	TEST_ASSERT_EQUAL_size_t(8, extra._raw.size());
+
+	Frame frame;
+	uint32_t producer, sequence;
+	TEST_ASSERT_TRUE(ring.try_pop(frame));
+	parse_frame(frame, producer, sequence);
+	TEST_ASSERT_EQUAL_UINT32(0, sequence);
+	TEST_ASSERT_EQUAL_size_t(4, ring.high_watermark());
+
+	// Room again for one
+	TEST_ASSERT_TRUE(ring.try_push(make_frame(0, 4)));
+	TEST_ASSERT_FALSE(ring.try_push(make_frame(0, 5)));
+	for (uint32_t i = 1; i <= 4; ++i) {
+		TEST_ASSERT_TRUE(ring.try_pop(frame));
+		parse_frame(frame, producer, sequence);
+		TEST_ASSERT_EQUAL_UINT32(i, sequence);
+	}
+	TEST_ASSERT_FALSE(ring.try_pop(frame));
+	TEST_ASSERT_EQUAL_UINT32(3, ring.dropped());
+}
+
+#ifndef ARDUINO
+// Several producer threads push into a small ring while the consumer drains it concurrently.
+// With retry every frame must arrive exactly once and in order per producer, without retry the
+// frames that arrive must still be in order and arrived plus dropped must account for all of them.
+static void run_stress(bool retry) {
+	const uint32_t PRODUCERS = 4;
+	const uint32_t FRAMES = 50000;
+	MpscRing<Frame> ring(256);
+	std::atomic<uint32_t> finished{0};
+	std::atomic<uint32_t> refused{0};
+
+	std::vector<std::thread> producers;
+	for (uint32_t p = 0; p < PRODUCERS; ++p) {
+		producers.emplace_back([&, p]() {
+			for (uint32_t i = 0; i < FRAMES; ++i) {
+				Frame frame = make_frame(p, i);
+				while (!ring.try_push(std::move(frame))) {
+					refused.fetch_add(1, std::memory_order_relaxed);
+					if (!retry) break;
+					std::this_thread::yield();
+				}
+			}
+			finished.fetch_add(1);
+		});
+	}
+
+	std::vector<int64_t> last(PRODUCERS, -1);
+	uint32_t received = 0;
+	bool ordered = true;
+	auto start = std::chrono::steady_clock::now();
+	Frame frame;
+	for (;;) {
+		if (ring.try_pop(frame)) {
+			uint32_t producer, sequence;
+			parse_frame(frame, producer, sequence);
+			if (producer >= PRODUCERS || (int64_t)sequence <= last[producer]) {
+				ordered = false;
+			}
+			else {
+				last[producer] = sequence;
+			}
+			++received;
+			continue;
+		}
+		if (finished.load() == PRODUCERS && ring.empty()) {
+			break;
+		}
+		std::this_thread::yield();
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	for (auto& producer : producers) {
+		producer.join();
+	}
+
+	TEST_ASSERT_TRUE(ordered);
+	TEST_ASSERT_EQUAL_UINT32(received, ring.popped());
+	TEST_ASSERT_EQUAL_UINT32(received, ring.pushed());
+	TEST_ASSERT_EQUAL_UINT32(refused.load(), ring.dropped());
+	if (retry) {
+		TEST_ASSERT_EQUAL_UINT32(PRODUCERS * FRAMES, received);
+		for (uint32_t p = 0; p < PRODUCERS; ++p) {
+			TEST_ASSERT_EQUAL_INT64(FRAMES - 1, last[p]);
+		}
+	}
+	else {
+		TEST_ASSERT_EQUAL_UINT32(PRODUCERS * FRAMES, received + ring.dropped());
+	}
+	TEST_ASSERT_TRUE(ring.high_watermark() <= ring.capacity());
+	printf("%s: %u frames received, %u dropped, high watermark %zu, %.1f frames/ms\n",
+		retry ? "retry" : "drop", received, ring.dropped(), ring.high_watermark(),
+		(double)received * 1000.0 / (double)(elapsed > 0 ? elapsed : 1));
+}
+
+void test_multi_producer_stress_retry() {
+	run_stress(true);
+}
+
+void test_multi_producer_stress_drop() {
+	run_stress(false);
+}
+#endif
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_capacity_rounding);
+	RUN_TEST(test_fifo_single_thread);
+	RUN_TEST(test_tail_drop);
+#ifndef ARDUINO
+	RUN_TEST(test_multi_producer_stress_retry);
+	RUN_TEST(test_multi_producer_stress_drop);
+#endif
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
@@ -0,0 +1,181 @@
+#include <unity.h>
+
+#include "microReticulum/Interfaces/LocalInterface.h"
+#include "microReticulum/Transport.h"
+#include "microReticulum/Utilities/OS.h"
+#include "microReticulum/Log.h"
+#include "microReticulum/Bytes.h"
+
+#include <string>
+#include <string.h>
+#ifndef ARDUINO
+#include <unistd.h>
+#endif
+
+using RNS::Bytes;
+using RNS::Interface;
+using RNS::Transport;
+
+#if RNS_TCP_INTERFACE
+// Counts received frames instead of passing them on to transport, and exposes sending
+class TestLocalClientInterface : public RNS::Interfaces::LocalClientInterface {
+public:
+	using LocalClientInterface::LocalClientInterface;
+	inline bool send(const Bytes& data) { return send_outgoing(data); }
+	size_t _received = 0;
+	Bytes _last;
+protected:
+	virtual void handle_incoming(const Bytes& data) {
+		++_received;
+		_last = data;
+	}
+};
+
+class TestLocalServerInterface : public RNS::Interfaces::LocalServerInterface {
+public:
+	using LocalServerInterface::LocalServerInterface;
+protected:
+	virtual RNS::Interfaces::TCPClientInterface* spawn(int socket, const char* host, int port) {
+		return new TestLocalClientInterface("spawned", socket, instance_name().c_str(), this->port(), accepted());
+	}
+};
+
+// Instance names are per process so concurrent test runs don't meet on the same socket
+static std::string test_instance_name() {
+	return "test-" + std::to_string((long)getpid());
+}
+
+static void pump(Interface& server, Interface& first, Interface& second) {
+	server.loop();
+	first.loop();
+	second.loop();
+	for (Interface spawned : static_cast<TestLocalServerInterface*>(server.get())->spawned_interfaces()) {
+		spawned.loop();
+	}
+}
+
+static bool pump_until(Interface& server, Interface& first, Interface& second, double timeout, bool (*done)(Interface&)) {
+	double deadline = RNS::Utilities::OS::time() + timeout;
+	while (!done(server)) {
+		if (RNS::Utilities::OS::time() > deadline) {
+			return false;
+		}
+		pump(server, first, second);
+	}
+	return true;
+}
+
+void test_local_shared_instance_clients() {
+	std::string instance_name = test_instance_name();
+	TestLocalServerInterface* server_impl = new TestLocalServerInterface("server", instance_name.c_str(), 0);
+	Interface server(server_impl);
+	TEST_ASSERT_TRUE(server.start());
+	TEST_ASSERT_TRUE(server.is_local_shared_instance());
+	Transport::register_interface(server);
+
+	// Only one program can share an instance under a name
+	Interface second_server(new RNS::Interfaces::LocalServerInterface("second", instance_name.c_str(), server_impl->port()));
+	RNS::loglevel(RNS::LOG_NONE);
+	TEST_ASSERT_FALSE(second_server.start());
+	RNS::loglevel(RNS::LOG_WARNING);
+
+	TestLocalClientInterface* first_impl = new TestLocalClientInterface("first", instance_name.c_str(), server_impl->port());
+	Interface first(first_impl);
+	TestLocalClientInterface* second_impl = new TestLocalClientInterface("second", instance_name.c_str(), server_impl->port());
+	Interface second(second_impl);
+	TEST_ASSERT_TRUE(first.is_connected_to_shared_instance());
+	TEST_ASSERT_TRUE(Transport::interface_to_shared_instance(first));
+	TEST_ASSERT_EQUAL_FLOAT(RNS::Interfaces::LocalClientInterface::RECONNECT_WAIT, first_impl->reconnect_wait());
+	TEST_ASSERT_TRUE(first.start());
+	TEST_ASSERT_TRUE(second.start());
+
+	// Spawned interfaces are registered as local clients, with distinct hashes even without peer addresses
+	TEST_ASSERT_TRUE(pump_until(server, first, second, 5.0, [](Interface& server) {
+		return static_cast<TestLocalServerInterface*>(server.get())->spawned_interfaces().size() == 2;
+	}));
+	const std::vector<Interface>& spawned = server_impl->spawned_interfaces();
+	TEST_ASSERT_TRUE(spawned[0].toString() != spawned[1].toString());
+	TEST_ASSERT_TRUE(Transport::is_local_client_interface(spawned[0]));
+	TEST_ASSERT_TRUE(Transport::is_local_client_interface(spawned[1]));
+	TEST_ASSERT_FALSE(Transport::is_local_client_interface(first));
+	TEST_ASSERT_EQUAL_size_t(2, Transport::local_client_interfaces().size());
+	TEST_ASSERT_TRUE(Transport::local_client_interfaces().count(spawned[0]) == 1);
+
+	// Frames pass both ways
+	Bytes payload("local shared instance payload");
+	TEST_ASSERT_TRUE(first_impl->connected());
+	TEST_ASSERT_TRUE(first_impl->send(payload));
+	Interface spawned_first(spawned[0]);
+	Interface spawned_second(spawned[1]);
+	TestLocalClientInterface* spawned_first_impl = static_cast<TestLocalClientInterface*>(spawned_first.get());
+	TestLocalClientInterface* spawned_second_impl = static_cast<TestLocalClientInterface*>(spawned_second.get());
+	double deadline = RNS::Utilities::OS::time() + 5.0;
+	while (spawned_first_impl->_received + spawned_second_impl->_received < 1 && RNS::Utilities::OS::time() < deadline) {
+		pump(server, first, second);
+	}
+	TestLocalClientInterface* receiver = (spawned_first_impl->_received > 0) ? spawned_first_impl : spawned_second_impl;
+	TEST_ASSERT_EQUAL_size_t(1, receiver->_received);
+	TEST_ASSERT_TRUE(receiver->_last == payload);
+	TEST_ASSERT_TRUE(receiver->send(payload));
+	deadline = RNS::Utilities::OS::time() + 5.0;
+	while (first_impl->_received < 1 && RNS::Utilities::OS::time() < deadline) {
+		pump(server, first, second);
+	}
+	TEST_ASSERT_EQUAL_size_t(1, first_impl->_received);
+	TEST_ASSERT_EQUAL_size_t(0, second_impl->_received);
+
+	// A client going away leaves the local client set
+	second.detach();
+	TEST_ASSERT_TRUE(pump_until(server, first, second, 5.0, [](Interface& server) {
+		return static_cast<TestLocalServerInterface*>(server.get())->spawned_interfaces().size() == 1;
+	}));
+	TEST_ASSERT_EQUAL_size_t(1, Transport::local_client_interfaces().size());
+
+	// And all of them with the server
+	first.detach();
+	server.detach();
+	TEST_ASSERT_EQUAL_size_t(0, Transport::local_client_interfaces().size());
+	Transport::deregister_interface(server);
+	TEST_ASSERT_EQUAL_size_t(0, Transport::get_interfaces().size());
+}
+#endif
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+#if RNS_TCP_INTERFACE
+	RUN_TEST(test_local_shared_instance_clients);
+#endif
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	RNS::loglevel(RNS::LOG_WARNING);
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
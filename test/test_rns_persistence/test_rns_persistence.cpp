@@ -8,6 +8,7 @@
 #include "microReticulum/Bytes.h"
 #include "microReticulum/Utilities/OS.h"
 #include "microReticulum/Utilities/Persistence.h"
+#include "microReticulum/Persistence/PathCache.h"
 
 #include <map>
 #include <vector>
@@ -140,6 +141,175 @@ void testDeserializeEmptyDestinationTable() {
 	TEST_ASSERT_EQUAL_size_t(0, destination_table.size());
 }
 
+void testRouteSummaryCodec() {
+	HEAD("testRouteSummaryCodec", RNS::LOG_TRACE);
+
+	RNS::Interface test_interface(new TestInterface());
+	RNS::Transport::register_interface(test_interface);
+
+	RNS::Persistence::DestinationEntry entry;
+	entry._timestamp = 1.5;
+	entry._expires = 2.5;
+	entry._hops = 4;
+	entry._received_from.assignHex("0123456789abcdef0123456789abcdef");
+	entry._receiving_interface = test_interface;
+	RNS::Persistence::RouteSummary summary(entry);
+
+	std::vector<uint8_t> data = microStore::Codec<RNS::Persistence::RouteSummary>::encode(summary);
+	TEST_ASSERT_EQUAL_size_t(RNS::Persistence::RouteSummary::ENCODED_SIZE, data.size());
+
+	RNS::Persistence::RouteSummary decoded;
+	TEST_ASSERT_TRUE(microStore::Codec<RNS::Persistence::RouteSummary>::decode(data, decoded));
+	TEST_ASSERT_TRUE(decoded._timestamp == 1.5);
+	TEST_ASSERT_TRUE(decoded._expires == 2.5);
+	TEST_ASSERT_EQUAL_UINT8(4, decoded._hops);
+	TEST_ASSERT_TRUE(decoded._received_from.bytes() == entry._received_from);
+	TEST_ASSERT_TRUE(decoded.receiving_interface() == test_interface);
+
+	// truncated record is rejected, empty summary encodes to nothing
+	data.pop_back();
+	TEST_ASSERT_FALSE(microStore::Codec<RNS::Persistence::RouteSummary>::decode(data, decoded));
+	TEST_ASSERT_EQUAL_size_t(0, microStore::Codec<RNS::Persistence::RouteSummary>::encode(RNS::Persistence::RouteSummary()).size());
+
+	RNS::Transport::deregister_interface(test_interface);
+}
+
+void testPathCache() {
+	HEAD("testPathCache", RNS::LOG_TRACE);
+
+	RNS::Interface test_interface(new TestInterface());
+	RNS::Transport::register_interface(test_interface);
+
+#if defined(RNS_USE_FS) && RNS_PERSIST_PATHS
+	RNS::Persistence::PathStore store(4096, 2);
+	store.init(RNS::Utilities::OS::get_filesystem(), "./test_path_cache/", false, 0, 0);
+	store.clear();
+	RNS::Persistence::PathStore route_store(1024, 2);
+	route_store.init(RNS::Utilities::OS::get_filesystem(), "./test_route_cache/", false, 0, 0);
+	route_store.clear();
+#else
+	RNS::Persistence::PathStore store;
+	RNS::Persistence::PathStore route_store;
+#endif
+	RNS::Persistence::CachedPathTable table(store, route_store, 2);
+	TEST_ASSERT_EQUAL_size_t(2, table.capacity());
+
+	RNS::Bytes received;
+	received.assignHex("deadbeefdeadbeefdeadbeefdeadbeef");
+	auto make_entry = [&](double timestamp, double expires) {
+		RNS::Persistence::DestinationEntry entry;
+		entry._timestamp = timestamp;
+		entry._expires = expires;
+		entry._hops = 3;
+		entry._received_from = received;
+		entry._receiving_interface = test_interface;
+		RNS::Bytes raw;
+		raw.assignHex("0100aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa00b10bb10b");
+		entry._announce_packet = RNS::Packet(raw);
+		return entry;
+	};
+	RNS::Bytes one;
+	one.assignHex("11111111111111111111111111111111");
+	RNS::Bytes two;
+	two.assignHex("22222222222222222222222222222222");
+	RNS::Bytes three;
+	three.assignHex("33333333333333333333333333333333");
+	double future = RNS::Utilities::OS::time() + 3600;
+
+	// put writes through and leaves the decoded entry cached
+	TEST_ASSERT_TRUE(table.put(one, make_entry(1.0, future)));
+	TEST_ASSERT_TRUE(table.put(two, make_entry(2.0, future)));
+	RNS::Persistence::DestinationEntry entry;
+	TEST_ASSERT_TRUE(table.get(one, entry));
+	TEST_ASSERT_TRUE(entry._timestamp == 1.0);
+	TEST_ASSERT_TRUE(table.exists(two));
+	TEST_ASSERT_EQUAL_UINT32(1, table.hits());
+	TEST_ASSERT_EQUAL_UINT32(0, table.misses());
+
+	// referenced entry gets a second chance, unreferenced one is evicted
+	TEST_ASSERT_TRUE(table.put(three, make_entry(3.0, future)));
+	TEST_ASSERT_EQUAL_UINT32(1, table.evictions());
+	TEST_ASSERT_TRUE(table.get(one, entry));
+	TEST_ASSERT_EQUAL_UINT32(2, table.hits());
+	// evicted entry is decoded from the store again
+	TEST_ASSERT_TRUE(table.get(two, entry));
+	TEST_ASSERT_TRUE(entry._timestamp == 2.0);
+	TEST_ASSERT_EQUAL_UINT32(1, table.misses());
+
+	// update replaces cached copy
+	TEST_ASSERT_TRUE(table.put(two, make_entry(4.0, future)));
+	TEST_ASSERT_TRUE(table.get(two, entry));
+	TEST_ASSERT_TRUE(entry._timestamp == 4.0);
+
+	// hits are served from the cache without probing the store
+	TEST_ASSERT_TRUE(RNS::Persistence::NewPathTable(store).remove(two));
+	uint32_t hits = table.hits();
+	TEST_ASSERT_TRUE(table.get(two, entry));
+	TEST_ASSERT_TRUE(entry._timestamp == 4.0);
+	TEST_ASSERT_EQUAL_UINT32(hits + 1, table.hits());
+	TEST_ASSERT_TRUE(table.put(two, make_entry(4.0, future)));
+
+	// remove writes through
+	TEST_ASSERT_TRUE(table.remove(two));
+	TEST_ASSERT_FALSE(table.exists(two));
+	TEST_ASSERT_FALSE(table.get(two, entry));
+
+	// expired entry is dropped from the cache
+	TEST_ASSERT_TRUE(table.put(one, make_entry(5.0, RNS::Utilities::OS::time() - 1)));
+	uint32_t misses = table.misses();
+	table.get(one, entry);
+	TEST_ASSERT_EQUAL_UINT32(1, table.expirations());
+	TEST_ASSERT_EQUAL_UINT32(misses + 1, table.misses());
+
+	// invalidation forces a reload from the store
+	table.invalidate();
+	misses = table.misses();
+	TEST_ASSERT_TRUE(table.get(three, entry));
+	TEST_ASSERT_TRUE(entry._timestamp == 3.0);
+	TEST_ASSERT_EQUAL_UINT32(misses + 1, table.misses());
+
+	// routing fields of a cached entry are served from its slot
+	misses = table.misses();
+	hits = table.hits();
+	RNS::Persistence::RouteSummary route;
+	TEST_ASSERT_TRUE(table.get_route(three, route));
+	TEST_ASSERT_TRUE(route);
+	TEST_ASSERT_EQUAL_UINT8(3, route._hops);
+	TEST_ASSERT_TRUE(route._timestamp == 3.0);
+	TEST_ASSERT_TRUE(route._received_from.bytes() == received);
+	TEST_ASSERT_TRUE(route.receiving_interface() == test_interface);
+	TEST_ASSERT_EQUAL_UINT32(hits + 1, table.hits());
+	TEST_ASSERT_EQUAL_UINT32(misses, table.misses());
+	TEST_ASSERT_FALSE(table.get_route(two, route));
+
+	// a miss reads just the summary and caches it, the full entry is decoded when asked for
+	table.invalidate();
+	misses = table.misses();
+	TEST_ASSERT_TRUE(table.get_route(three, route));
+	TEST_ASSERT_TRUE(route._timestamp == 3.0);
+	TEST_ASSERT_EQUAL_UINT32(misses + 1, table.misses());
+	hits = table.hits();
+	TEST_ASSERT_TRUE(table.get_route(three, route));
+	TEST_ASSERT_EQUAL_UINT8(3, route._hops);
+	TEST_ASSERT_EQUAL_UINT32(hits + 1, table.hits());
+	TEST_ASSERT_TRUE(table.get(three, entry));
+	TEST_ASSERT_TRUE(entry._timestamp == 3.0);
+	TEST_ASSERT_EQUAL_UINT32(misses + 2, table.misses());
+	TEST_ASSERT_TRUE(table.get(three, entry));
+	TEST_ASSERT_EQUAL_UINT32(hits + 2, table.hits());
+
+	// missing summary is backfilled from the full entry
+	table.invalidate();
+	TEST_ASSERT_TRUE(RNS::Persistence::RouteTable(route_store).remove(three));
+	TEST_ASSERT_TRUE(table.get_route(three, route));
+	TEST_ASSERT_TRUE(route._timestamp == 3.0);
+	TEST_ASSERT_TRUE(RNS::Persistence::RouteTable(route_store).exists(three));
+
+	store.clear();
+	route_store.clear();
+	RNS::Transport::deregister_interface(test_interface);
+}
+
 
 void setUp(void) {
 	// set stuff up here before each test
@@ -161,6 +331,8 @@ int runUnityTests(void) {
 	RUN_TEST(testSerializeDestinationTable);
 	RUN_TEST(testDeserializeDestinationTable);
 	RUN_TEST(testDeserializeEmptyDestinationTable);
+	RUN_TEST(testRouteSummaryCodec);
+	RUN_TEST(testPathCache);
 
 	// Suite-level teardown
 	RNS::Utilities::OS::remove_file(test_path_table_path);
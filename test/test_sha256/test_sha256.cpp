@@ -0,0 +1,325 @@
+#include <unity.h>
+
+#include "microReticulum/Cryptography/Hashes.h"
+#include "microReticulum/Cryptography/SHA256Backend.h"
+#include "microReticulum/Cryptography/HMAC.h"
+#include "microReticulum/Cryptography/HKDF.h"
+#include "microReticulum/Log.h"
+#include "microReticulum/Bytes.h"
+
+#include <SHA256.h>
+
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+using RNS::Bytes;
+namespace Cryptography = RNS::Cryptography;
+
+#ifdef ARDUINO
+uint64_t test_micros() {
+	return micros();
+}
+#else
+uint64_t test_micros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+static const Cryptography::sha256_backend BACKENDS[] = {
+	Cryptography::SHA256_BACKEND_PORTABLE,
+	Cryptography::SHA256_BACKEND_SHANI,
+	Cryptography::SHA256_BACKEND_ARMV8,
+};
+
+static Bytes make_bytes(size_t size, uint32_t seed) {
+	Bytes bytes;
+	uint8_t* data = bytes.writable(size);
+	for (size_t i = 0; i < size; ++i) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (uint8_t)(seed >> 16);
+	}
+	return bytes;
+}
+
+static Bytes hex(const char* hex) {
+	Bytes bytes;
+	bytes.assignHex(hex);
+	return bytes;
+}
+
+void test_known_vectors() {
+	Cryptography::sha256_backend active = Cryptography::sha256_active_backend();
+	for (Cryptography::sha256_backend backend : BACKENDS) {
+		if (!Cryptography::sha256_use_backend(backend)) {
+			continue;
+		}
+		TEST_ASSERT_TRUE(Cryptography::sha256(Bytes("")) == hex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+		TEST_ASSERT_TRUE(Cryptography::sha256(Bytes("abc")) == hex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+		TEST_ASSERT_TRUE(Cryptography::sha256(Bytes("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")) == hex("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+
+		// One million times 'a', fed in uneven pieces
+		Cryptography::SHA256Context context;
+		std::vector<uint8_t> a(1000, 'a');
+		size_t fed = 0;
+		for (size_t piece = 1; fed < 1000000; piece = (piece * 7 + 3) % 1000 + 1) {
+			size_t size = (piece < 1000000 - fed) ? piece : 1000000 - fed;
+			context.update(a.data(), size);
+			fed += size;
+		}
+		uint8_t digest[32];
+		context.finalize(digest);
+		TEST_ASSERT_TRUE(Bytes(digest, 32) == hex("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+	}
+	Cryptography::sha256_use_backend(active);
+}
+
+// Every backend against the Crypto library implementation, across block and padding boundaries
+void test_backends_match() {
+	Cryptography::sha256_backend active = Cryptography::sha256_active_backend();
+	TEST_ASSERT_TRUE(Cryptography::sha256_backend_supported(Cryptography::SHA256_BACKEND_PORTABLE));
+	size_t tested = 0;
+	for (Cryptography::sha256_backend backend : BACKENDS) {
+		if (!Cryptography::sha256_use_backend(backend)) {
+			TEST_ASSERT_FALSE(Cryptography::sha256_backend_supported(backend));
+			continue;
+		}
+		TEST_ASSERT_EQUAL_INT(backend, Cryptography::sha256_active_backend());
+		printf("sha256 backend: %s\n", Cryptography::sha256_backend_name(backend));
+		for (size_t size = 0; size <= 300; ++size) {
+			Bytes data = make_bytes(size, (uint32_t)size);
+			SHA256 reference;
+			reference.update(data.data(), data.size());
+			uint8_t expected[32];
+			reference.finalize(expected, sizeof(expected));
+
+			TEST_ASSERT_EQUAL_MEMORY(expected, Cryptography::sha256(data).data(), 32);
+
+			// Same data in two and three pieces
+			size_t split = size / 3;
+			TEST_ASSERT_EQUAL_MEMORY(expected, Cryptography::sha256(data.view().left(split), data.view().mid(split)).data(), 32);
+			Cryptography::SHA256Context context;
+			context.update(data.data(), split);
+			context.update(data.data() + split, split);
+			context.update(data.data() + 2 * split, size - 2 * split);
+			uint8_t digest[32];
+			context.finalize(digest);
+			TEST_ASSERT_EQUAL_MEMORY(expected, digest, 32);
+		}
+		++tested;
+	}
+	TEST_ASSERT_TRUE(tested >= 1);
+	Cryptography::sha256_use_backend(active);
+}
+
+// HMAC and HKDF are built on the backend too (RFC 4231 case 2, RFC 5869 case 3)
+void test_hmac_hkdf_vectors() {
+	Cryptography::sha256_backend active = Cryptography::sha256_active_backend();
+	for (Cryptography::sha256_backend backend : BACKENDS) {
+		if (!Cryptography::sha256_use_backend(backend)) {
+			continue;
+		}
+		Cryptography::KeyedHMAC hmac(Bytes("Jefe"));
+		Bytes message("what do ya want for nothing?");
+		uint8_t digest[32];
+		hmac.digest(digest, message.data(), message.size());
+		TEST_ASSERT_TRUE(Bytes(digest, 32) == hex("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"));
+
+		Bytes ikm = hex("0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b");
+		TEST_ASSERT_TRUE(Cryptography::hkdf(42, ikm) == hex("8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d9d201395faa4b61a96c8"));
+	}
+	Cryptography::sha256_use_backend(active);
+}
+
+static const Cryptography::sha256_lanes_backend LANES_BACKENDS[] = {
+	Cryptography::SHA256_LANES_SERIAL,
+	Cryptography::SHA256_LANES_AVX2,
+};
+
+// Batches of mixed lengths, with and without a suffix, against hashing each message on its own
+void test_many_match() {
+	Cryptography::sha256_lanes_backend active = Cryptography::sha256_lanes_active_backend();
+	TEST_ASSERT_TRUE(Cryptography::sha256_lanes_backend_supported(Cryptography::SHA256_LANES_SERIAL));
+	Bytes suffix = make_bytes(4, 99);
+	for (Cryptography::sha256_lanes_backend backend : LANES_BACKENDS) {
+		if (!Cryptography::sha256_lanes_use_backend(backend)) {
+			TEST_ASSERT_FALSE(Cryptography::sha256_lanes_backend_supported(backend));
+			continue;
+		}
+		TEST_ASSERT_EQUAL_INT(backend, Cryptography::sha256_lanes_active_backend());
+		printf("sha256 lanes backend: %s\n", Cryptography::sha256_lanes_backend_name(backend));
+		for (size_t count = 0; count <= 40; count += (count < 10 ? 1 : 15)) {
+			std::vector<Bytes> messages;
+			std::vector<const uint8_t*> data;
+			std::vector<size_t> sizes;
+			for (size_t i = 0; i < count; ++i) {
+				// lengths across the block and padding boundaries, and all equal but the last
+				size_t size = (count % 2) ? (i * 37 + count) % 300 : (i + 1 < count ? 464 : 100);
+				messages.push_back(make_bytes(size, (uint32_t)(i + count)));
+			}
+			for (const Bytes& message : messages) {
+				data.push_back(message.data());
+				sizes.push_back(message.size());
+			}
+			std::vector<uint8_t> digests(count * 32 + 1, 0xaa);
+			Cryptography::sha256_many(digests.data(), data.data(), sizes.data(), count);
+			for (size_t i = 0; i < count; ++i) {
+				TEST_ASSERT_EQUAL_MEMORY(Cryptography::sha256(messages[i]).data(), digests.data() + 32 * i, 32);
+			}
+			Cryptography::sha256_many(digests.data(), data.data(), sizes.data(), count, suffix.data(), suffix.size());
+			for (size_t i = 0; i < count; ++i) {
+				TEST_ASSERT_EQUAL_MEMORY(Cryptography::sha256(messages[i].view(), suffix.view()).data(), digests.data() + 32 * i, 32);
+			}
+			TEST_ASSERT_EQUAL_UINT8(0xaa, digests[count * 32]);
+		}
+	}
+	Cryptography::sha256_lanes_use_backend(active);
+}
+
+// Lanes outside the mask must be left alone
+void test_lanes_mask() {
+	Cryptography::sha256_lanes_backend active = Cryptography::sha256_lanes_active_backend();
+	Bytes block = make_bytes(64, 5);
+	for (Cryptography::sha256_lanes_backend backend : LANES_BACKENDS) {
+		if (!Cryptography::sha256_lanes_use_backend(backend)) {
+			continue;
+		}
+		uint32_t state[8][Cryptography::SHA256_LANES];
+		const uint8_t* blocks[Cryptography::SHA256_LANES];
+		for (size_t lane = 0; lane < Cryptography::SHA256_LANES; ++lane) {
+			for (int i = 0; i < 8; ++i) {
+				state[i][lane] = (uint32_t)(lane * 8 + i);
+			}
+			blocks[lane] = (lane % 3 == 0) ? nullptr : block.data();
+		}
+		const uint32_t mask = 0xb6;	// lanes 1, 2, 4, 5 and 7
+		Cryptography::sha256_blocks_lanes(state, blocks, mask);
+		for (size_t lane = 0; lane < Cryptography::SHA256_LANES; ++lane) {
+			uint32_t expected[8];
+			for (int i = 0; i < 8; ++i) {
+				expected[i] = (uint32_t)(lane * 8 + i);
+			}
+			if (mask & (1u << lane)) {
+				Cryptography::sha256_blocks(expected, block.data(), 1);
+			}
+			for (int i = 0; i < 8; ++i) {
+				TEST_ASSERT_EQUAL_UINT32(expected[i], state[i][lane]);
+			}
+		}
+	}
+	Cryptography::sha256_lanes_use_backend(active);
+}
+
+void test_benchmark() {
+	Cryptography::sha256_backend active = Cryptography::sha256_active_backend();
+	const size_t sizes[] = {32, 500, 16384};
+#ifdef ARDUINO
+	const size_t total = 256 * 1024;
+#else
+	const size_t total = 32 * 1024 * 1024;
+#endif
+	for (size_t size : sizes) {
+		Bytes data = make_bytes(size, 1);
+		uint8_t digest[32];
+		size_t rounds = total / size;
+
+		// Crypto library for comparison
+		uint64_t start = test_micros();
+		for (size_t i = 0; i < rounds; ++i) {
+			SHA256 reference;
+			reference.update(data.data(), data.size());
+			reference.finalize(digest, sizeof(digest));
+		}
+		uint64_t elapsed = test_micros() - start;
+		printf("%5zu bytes: %-9s %8.1f MB/s %8.3f us/hash\n", size, "library", (double)(rounds * size) / (elapsed > 0 ? elapsed : 1), (double)elapsed / rounds);
+
+		for (Cryptography::sha256_backend backend : BACKENDS) {
+			if (!Cryptography::sha256_use_backend(backend)) {
+				continue;
+			}
+			start = test_micros();
+			for (size_t i = 0; i < rounds; ++i) {
+				Cryptography::SHA256Context context;
+				context.update(data.data(), data.size());
+				context.finalize(digest);
+			}
+			elapsed = test_micros() - start;
+			printf("%5zu bytes: %-9s %8.1f MB/s %8.3f us/hash\n", size, Cryptography::sha256_backend_name(backend), (double)(rounds * size) / (elapsed > 0 ? elapsed : 1), (double)elapsed / rounds);
+		}
+	}
+
+	// Resource map hashes, parts of a 4 MiB resource each followed by the 4 byte random hash
+	const size_t part_size = 464;
+	const size_t parts = 4 * 1024 * 1024 / part_size;
+	Bytes resource = make_bytes(parts * part_size, 2);
+	Bytes random_hash = make_bytes(4, 3);
+	std::vector<const uint8_t*> data(parts);
+	std::vector<size_t> part_sizes(parts, part_size);
+	for (size_t i = 0; i < parts; ++i) {
+		data[i] = resource.data() + i * part_size;
+	}
+	std::vector<uint8_t> digests(parts * 32);
+	Cryptography::sha256_lanes_backend active_lanes = Cryptography::sha256_lanes_active_backend();
+	for (Cryptography::sha256_backend backend : BACKENDS) {
+		if (!Cryptography::sha256_use_backend(backend)) {
+			continue;
+		}
+		for (Cryptography::sha256_lanes_backend lanes : LANES_BACKENDS) {
+			if (!Cryptography::sha256_lanes_use_backend(lanes)) {
+				continue;
+			}
+			uint64_t start = test_micros();
+			Cryptography::sha256_many(digests.data(), data.data(), part_sizes.data(), parts, random_hash.data(), random_hash.size());
+			uint64_t elapsed = test_micros() - start;
+			printf("%zu map hashes: %-8s %-6s %8.1f MB/s %8.3f ms\n", parts, Cryptography::sha256_backend_name(backend), Cryptography::sha256_lanes_backend_name(lanes), (double)(parts * part_size) / (elapsed > 0 ? elapsed : 1), (double)elapsed / 1000);
+		}
+	}
+	Cryptography::sha256_lanes_use_backend(active_lanes);
+	Cryptography::sha256_use_backend(active);
+}
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_known_vectors);
+	RUN_TEST(test_backends_match);
+	RUN_TEST(test_hmac_hkdf_vectors);
+	RUN_TEST(test_many_match);
+	RUN_TEST(test_lanes_mask);
+	RUN_TEST(test_benchmark);
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	RNS::loglevel(RNS::LOG_WARNING);
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
@@ -0,0 +1,387 @@
+#include <unity.h>
+
+#include "microReticulum/Interfaces/HDLC.h"
+#include "microReticulum/Interfaces/TCPInterface.h"
+#include "microReticulum/Utilities/OS.h"
+#include "microReticulum/Log.h"
+#include "microReticulum/Bytes.h"
+
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+using RNS::Bytes;
+using RNS::Interface;
+using RNS::Interfaces::HDLC;
+
+// Payload carries its sequence number and is otherwise derived from it, with plenty of bytes that
+// need escaping
+static Bytes make_payload(uint32_t sequence) {
+	size_t size = 20 + (sequence * 131) % 1200;
+	Bytes payload;
+	uint8_t* data = payload.writable(size);
+	memcpy(data, &sequence, sizeof(sequence));
+	for (size_t i = sizeof(sequence); i < size; ++i) {
+		uint8_t byte = (uint8_t)(sequence + i * 7);
+		if (i % 5 == 0) byte = HDLC::FLAG;
+		if (i % 7 == 0) byte = HDLC::ESC;
+		data[i] = byte;
+	}
+	return payload;
+}
+
+static bool check_payload(const Bytes& payload, uint32_t& sequence) {
+	if (payload.size() < sizeof(sequence)) {
+		return false;
+	}
+	memcpy(&sequence, payload.data(), sizeof(sequence));
+	return payload == make_payload(sequence);
+}
+
+void test_hdlc_frame() {
+	// Matches the reference HDLC.escape(), ESC is escaped before FLAG
+	const uint8_t data[] = {0x01, HDLC::FLAG, 0x02, HDLC::ESC, 0x03};
+	const uint8_t expected[] = {HDLC::FLAG, 0x01, HDLC::ESC, 0x5E, 0x02, HDLC::ESC, 0x5D, 0x03, HDLC::FLAG};
+	Bytes frame;
+	HDLC::frame(data, sizeof(data), frame);
+	TEST_ASSERT_EQUAL_size_t(sizeof(expected), frame.size());
+	TEST_ASSERT_EQUAL_MEMORY(expected, frame.data(), sizeof(expected));
+
+	// Worst case doubles in size
+	Bytes flags;
+	memset(flags.writable(100), HDLC::FLAG, 100);
+	TEST_ASSERT_EQUAL_size_t(HDLC::max_framed_size(100), HDLC::frame(flags).size());
+}
+
+void test_hdlc_deframe_chunked() {
+	std::vector<Bytes> payloads;
+	Bytes stream("noise before the first flag");
+	for (uint32_t i = 0; i < 200; ++i) {
+		payloads.push_back(make_payload(i));
+		stream.append(HDLC::frame(payloads.back()));
+	}
+
+	// Any chunking of the stream yields the same frames, including splits inside escape sequences
+	const size_t chunk_sizes[] = {1, 2, 3, 7, 64, 1500, stream.size()};
+	for (size_t chunk_size : chunk_sizes) {
+		HDLC::Deframer deframer(262144);
+		size_t received = 0;
+		bool matched = true;
+		for (size_t offset = 0; offset < stream.size(); offset += chunk_size) {
+			size_t size = std::min(chunk_size, stream.size() - offset);
+			deframer.feed(stream.data() + offset, size, [&](const Bytes& frame) {
+				if (received >= payloads.size() || frame != payloads[received]) {
+					matched = false;
+				}
+				++received;
+			});
+		}
+		TEST_ASSERT_TRUE(matched);
+		TEST_ASSERT_EQUAL_size_t(payloads.size(), received);
+		TEST_ASSERT_EQUAL_size_t(payloads.size(), deframer.frames());
+	}
+}
+
+void test_hdlc_deframe_limits() {
+	HDLC::Deframer deframer(64);
+	std::vector<Bytes> frames;
+	auto collect = [&](const Bytes& frame) { frames.push_back(frame); };
+
+	// Frames no longer than the header minimum are ignored, like the reference
+	Bytes runt(HDLC::frame(Bytes("short")));
+	deframer.feed(runt, collect);
+	TEST_ASSERT_EQUAL_size_t(0, frames.size());
+
+	// Oversized frames are dropped without disturbing the next one
+	Bytes big;
+	memset(big.writable(100), 0x42, 100);
+	Bytes ok("a frame that is long enough to pass");
+	Bytes stream(HDLC::frame(big));
+	stream.append(HDLC::frame(ok));
+	deframer.feed(stream, collect);
+	TEST_ASSERT_EQUAL_size_t(1, frames.size());
+	TEST_ASSERT_TRUE(frames[0] == ok);
+	TEST_ASSERT_EQUAL_size_t(1, deframer.dropped());
+
+	// Back to back frames share their flag
+	frames.clear();
+	Bytes shared;
+	shared.append(HDLC::FLAG);
+	shared.append(ok);
+	shared.append(HDLC::FLAG);
+	shared.append(ok);
+	shared.append(HDLC::FLAG);
+	deframer.feed(shared, collect);
+	TEST_ASSERT_EQUAL_size_t(2, frames.size());
+}
+
+void test_hdlc_deframe_reuses_buffer() {
+	HDLC::Deframer deframer(4096);
+	Bytes stream;
+	for (uint32_t i = 0; i < 10; ++i) {
+		stream.append(HDLC::frame(make_payload(i)));
+	}
+
+	// Frames nobody keeps are assembled in the same buffer, once it has grown to the largest frame
+	std::vector<const uint8_t*> buffers;
+	deframer.feed(stream, [&](const Bytes& frame) {});
+	deframer.feed(stream, [&](const Bytes& frame) { buffers.push_back(frame.data()); });
+	TEST_ASSERT_EQUAL_size_t(10, buffers.size());
+	for (const uint8_t* buffer : buffers) {
+		TEST_ASSERT_TRUE(buffer == buffers[0]);
+	}
+
+	// Frames that are kept stay intact while later frames are assembled
+	std::vector<Bytes> kept;
+	deframer.feed(stream, [&](const Bytes& frame) { kept.push_back(frame); });
+	TEST_ASSERT_EQUAL_size_t(10, kept.size());
+	for (uint32_t i = 0; i < 10; ++i) {
+		TEST_ASSERT_TRUE(kept[i] == make_payload(i));
+	}
+}
+
+#if RNS_TCP_INTERFACE
+// Counts and checks received frames instead of passing them on to transport, and exposes sending
+class TestTCPClientInterface : public RNS::Interfaces::TCPClientInterface {
+public:
+	using TCPClientInterface::TCPClientInterface;
+	inline bool send(const Bytes& data) { return send_outgoing(data); }
+	size_t _received = 0;
+	size_t _received_bytes = 0;
+	size_t _errors = 0;
+	uint32_t _next_sequence = 0;
+protected:
+	virtual void handle_incoming(const Bytes& data) {
+		uint32_t sequence;
+		if (!check_payload(data, sequence) || sequence != _next_sequence) {
+			++_errors;
+		}
+		_next_sequence = sequence + 1;
+		++_received;
+		_received_bytes += data.size();
+	}
+};
+
+class TestTCPServerInterface : public RNS::Interfaces::TCPServerInterface {
+public:
+	using TCPServerInterface::TCPServerInterface;
+protected:
+	virtual RNS::Interfaces::TCPClientInterface* spawn(int socket, const char* host, int port) {
+		return new TestTCPClientInterface("spawned", socket, host, port);
+	}
+};
+
+static void pump(Interface& server, Interface& client) {
+	server.loop();
+	client.loop();
+	for (Interface spawned : static_cast<TestTCPServerInterface*>(server.get())->spawned_interfaces()) {
+		spawned.loop();
+	}
+}
+
+static TestTCPClientInterface* spawned_client(Interface& server) {
+	auto& spawned = static_cast<TestTCPServerInterface*>(server.get())->spawned_interfaces();
+	if (spawned.size() != 1) {
+		return nullptr;
+	}
+	Interface interface(spawned[0]);
+	return static_cast<TestTCPClientInterface*>(interface.get());
+}
+
+static bool pump_until(Interface& server, Interface& client, double timeout, bool (*done)(Interface&, Interface&)) {
+	double deadline = RNS::Utilities::OS::time() + timeout;
+	while (!done(server, client)) {
+		if (RNS::Utilities::OS::time() > deadline) {
+			return false;
+		}
+		pump(server, client);
+	}
+	return true;
+}
+
+static bool is_connected(Interface& server, Interface& client) {
+	TestTCPClientInterface* spawned = spawned_client(server);
+	return spawned != nullptr && spawned->connected() && static_cast<TestTCPClientInterface*>(client.get())->connected();
+}
+
+void test_tcp_loopback_sustained() {
+	const uint32_t FRAMES = 20000;
+	const uint32_t BURST = 64;
+
+	TestTCPServerInterface* server_impl = new TestTCPServerInterface("server", "127.0.0.1", 0);
+	Interface server(server_impl);
+	TEST_ASSERT_TRUE(server.start());
+	TEST_ASSERT_TRUE(server_impl->port() > 0);
+	TEST_ASSERT_TRUE(server.poll_fd() >= 0);
+
+	TestTCPClientInterface* client_impl = new TestTCPClientInterface("client", "127.0.0.1", server_impl->port());
+	Interface client(client_impl);
+	TEST_ASSERT_TRUE(client.start());
+	TEST_ASSERT_TRUE(pump_until(server, client, 5.0, is_connected));
+	TestTCPClientInterface* spawned_impl = spawned_client(server);
+	TEST_ASSERT_NOT_NULL(spawned_impl);
+	TEST_ASSERT_FALSE(spawned_impl->initiator());
+	Interface spawned(server_impl->spawned_interfaces()[0]);
+	TEST_ASSERT_TRUE(spawned.parent_interface() && *spawned.parent_interface() == server);
+
+	// Both nodes stream at each other at once
+	auto start = std::chrono::steady_clock::now();
+	size_t sent_bytes = 0;
+	uint32_t sent = 0;
+	bool stalled = false;
+	while (sent < FRAMES && !stalled) {
+		for (uint32_t i = 0; i < BURST && sent < FRAMES; ++i, ++sent) {
+			Bytes payload = make_payload(sent);
+			double deadline = RNS::Utilities::OS::time() + 5.0;
+			// A backed up socket refuses frames once the transmit buffer is full, wait for it to drain
+			while (!stalled && !client_impl->send(payload)) {
+				stalled = RNS::Utilities::OS::time() > deadline;
+				pump(server, client);
+			}
+			while (!stalled && !spawned_impl->send(payload)) {
+				stalled = RNS::Utilities::OS::time() > deadline;
+				pump(server, client);
+			}
+			sent_bytes += payload.size();
+		}
+		pump(server, client);
+	}
+	TEST_ASSERT_FALSE(stalled);
+	double deadline = RNS::Utilities::OS::time() + 10.0;
+	while ((client_impl->_received < FRAMES || spawned_impl->_received < FRAMES) && RNS::Utilities::OS::time() < deadline) {
+		server.flush();
+		client.flush();
+		pump(server, client);
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	TEST_ASSERT_EQUAL_size_t(FRAMES, client_impl->_received);
+	TEST_ASSERT_EQUAL_size_t(FRAMES, spawned_impl->_received);
+	TEST_ASSERT_EQUAL_size_t(0, client_impl->_errors);
+	TEST_ASSERT_EQUAL_size_t(0, spawned_impl->_errors);
+	TEST_ASSERT_EQUAL_size_t(sent_bytes, client_impl->_received_bytes);
+	TEST_ASSERT_EQUAL_size_t(sent_bytes, spawned_impl->_received_bytes);
+
+	// Per-peer counters, with the spawned interface's traffic also attributed to the server
+	TEST_ASSERT_EQUAL_size_t(FRAMES, client.tx());
+	TEST_ASSERT_EQUAL_size_t(sent_bytes, client.txbytes());
+	TEST_ASSERT_EQUAL_size_t(FRAMES, spawned.tx());
+	TEST_ASSERT_EQUAL_size_t(sent_bytes, spawned.txbytes());
+	TEST_ASSERT_EQUAL_size_t(sent_bytes, server.txbytes());
+	TEST_ASSERT_EQUAL_size_t(0, client_impl->deframer().dropped());
+	TEST_ASSERT_EQUAL_size_t(0, client_impl->tx_pending());
+
+	printf("%u frames each way, %.1f MB/s per direction\n", FRAMES, (double)sent_bytes / elapsed / 1e6);
+
+	// Spawned interface goes away with its connection
+	client.stop();
+	TEST_ASSERT_TRUE(pump_until(server, client, 5.0, [](Interface& server, Interface&) {
+		return static_cast<TestTCPServerInterface*>(server.get())->spawned_interfaces().empty();
+	}));
+	server.stop();
+}
+
+void test_tcp_reconnect_backoff() {
+	// Find a free port, then leave it closed for now
+	TestTCPServerInterface* server_impl = new TestTCPServerInterface("server", "127.0.0.1", 0);
+	Interface server(server_impl);
+	TEST_ASSERT_TRUE(server.start());
+	int port = server_impl->port();
+	server.stop();
+
+	TestTCPClientInterface* client_impl = new TestTCPClientInterface("client", "127.0.0.1", port);
+	Interface client(client_impl);
+	client_impl->reconnect_wait(0.02, 0.08);
+	TEST_ASSERT_TRUE(client.start());
+	// Waiting to reconnect leaves nothing to watch
+	double deadline = RNS::Utilities::OS::time() + 5.0;
+	while (client_impl->reconnects() < 3 && RNS::Utilities::OS::time() < deadline) {
+		client.loop();
+	}
+	TEST_ASSERT_TRUE(client_impl->reconnects() >= 3);
+	TEST_ASSERT_FALSE(client.online());
+	TEST_ASSERT_EQUAL_FLOAT(0.08, client_impl->reconnect_wait());
+
+	// Picks up the server once it's there
+	server_impl->bind_port(port);
+	TEST_ASSERT_TRUE(server.start());
+	TEST_ASSERT_TRUE(pump_until(server, client, 5.0, is_connected));
+	TEST_ASSERT_TRUE(client.online());
+	TEST_ASSERT_EQUAL_FLOAT(0.02, client_impl->reconnect_wait());
+
+	// And again after losing it, starting clean on the new connection
+	server.stop();
+	deadline = RNS::Utilities::OS::time() + 5.0;
+	while (client.online() && RNS::Utilities::OS::time() < deadline) {
+		client.loop();
+	}
+	TEST_ASSERT_FALSE(client.online());
+	TEST_ASSERT_EQUAL_INT(RNS::InterfaceImpl::POLL_IDLE, client.poll_fd());
+	TEST_ASSERT_TRUE(server.start());
+	TEST_ASSERT_TRUE(pump_until(server, client, 5.0, is_connected));
+	TEST_ASSERT_TRUE(client_impl->send(make_payload(0)));
+	TEST_ASSERT_TRUE(pump_until(server, client, 5.0, [](Interface& server, Interface&) {
+		TestTCPClientInterface* spawned = spawned_client(server);
+		return spawned != nullptr && spawned->_received == 1;
+	}));
+	TEST_ASSERT_EQUAL_size_t(0, spawned_client(server)->_errors);
+
+	// Detached interfaces stay down
+	client.detach();
+	size_t reconnects = client_impl->reconnects();
+	deadline = RNS::Utilities::OS::time() + 0.2;
+	while (RNS::Utilities::OS::time() < deadline) {
+		client.loop();
+	}
+	TEST_ASSERT_EQUAL_size_t(reconnects, client_impl->reconnects());
+	server.stop();
+}
+#endif
+
+
+void setUp(void) {
+	// set stuff up here before each test
+}
+
+void tearDown(void) {
+	// clean stuff up here after each test
+}
+
+int runUnityTests(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_hdlc_frame);
+	RUN_TEST(test_hdlc_deframe_chunked);
+	RUN_TEST(test_hdlc_deframe_limits);
+	RUN_TEST(test_hdlc_deframe_reuses_buffer);
+#if RNS_TCP_INTERFACE
+	RUN_TEST(test_tcp_loopback_sustained);
+	RUN_TEST(test_tcp_reconnect_backoff);
+#endif
+	return UNITY_END();
+}
+
+// For native dev-platform or for some embedded frameworks
+int main(void) {
+	RNS::loglevel(RNS::LOG_WARNING);
+	return runUnityTests();
+}
+
+#ifdef ARDUINO
+// For Arduino framework
+void setup() {
+	// Wait ~2 seconds before the Unity test runner
+	// establishes connection with a board Serial interface
+	delay(2000);
+
+	runUnityTests();
+}
+void loop() {}
+#endif
+
+// For ESP-IDF framework
+void app_main() {
+	runUnityTests();
+}
@@ -312,7 +312,7 @@ void test_send_receive_stress() {
 
 void test_interleaved_send_and_jobs() {
 	// Interleave packet sends with Transport::jobs() to stress the
-	// _jobs_locked/_jobs_running coordination and receipt processing
+	// _jobs_locked coordination and receipt processing
 	initRNS();
 
 	for (int round = 0; round < 20; round++) {
@@ -624,6 +624,100 @@ void test_receipt_timeout_handler_capture() {
 }
 #endif
 
+void test_receipt_table_capacity() {
+	// Receipts over capacity are culled on the next receipts check, the
+	// rest stay indexed by truncated packet hash until they time out.
+	initRNS();
+
+	RNS::Identity remote_id(true);
+	RNS::Destination unreachable_dest(remote_id, RNS::Type::Destination::OUT,
+		RNS::Type::Destination::SINGLE, "test", "unreachable_capacity");
+
+	const int NUM_PACKETS = RNS::Type::Transport::MAX_RECEIPTS + 10;
+	std::vector<RNS::PacketReceipt> receipts;
+	for (int i = 0; i < NUM_PACKETS; i++) {
+		RNS::Bytes payload("Capacity packet " + std::to_string(i));
+		RNS::Packet packet(unreachable_dest, payload);
+		packet.send();
+		RNS::PacketReceipt receipt = packet.receipt();
+		TEST_ASSERT_TRUE(receipt);
+		receipt.set_timeout(60);
+		TEST_ASSERT_EQUAL_size_t(1, RNS::Transport::receipts().count(receipt.truncated_hash()));
+		receipts.push_back(receipt);
+	}
+
+	RNS::Utilities::OS::sleep(1.5);
+	test_reticulum.loop();
+
+	TEST_ASSERT_EQUAL_size_t(RNS::Type::Transport::MAX_RECEIPTS, RNS::Transport::receipts().size());
+	int culled = 0;
+	for (auto& receipt : receipts) {
+		if (receipt.status() == RNS::Type::PacketReceipt::CULLED) {
+			TEST_ASSERT_EQUAL_size_t(0, RNS::Transport::receipts().count(receipt.truncated_hash()));
+			++culled;
+		}
+		else {
+			TEST_ASSERT_EQUAL_INT(RNS::Type::PacketReceipt::SENT, receipt.status());
+		}
+	}
+	TEST_ASSERT_EQUAL_INT(10, culled);
+
+	// Conclude the rest so later tests start with an empty table
+	for (auto& receipt : receipts) {
+		receipt.set_timeout(0);
+	}
+	RNS::Utilities::OS::sleep(1.5);
+	test_reticulum.loop();
+	TEST_ASSERT_EQUAL_size_t(0, RNS::Transport::receipts().size());
+}
+
+void test_interface_ids() {
+	// Registered interfaces get an interned id that resolves back to them,
+	// ids go stale once the interface is deregistered.
+	initRNS();
+
+	TEST_ASSERT_TRUE(in_interface.id() != 0);
+	TEST_ASSERT_TRUE(out_interface.id() != 0);
+	TEST_ASSERT_TRUE(in_interface.id() != out_interface.id());
+	TEST_ASSERT_TRUE(RNS::Transport::find_interface_from_id(in_interface.id()) == in_interface);
+	TEST_ASSERT_TRUE(RNS::Transport::find_interface_from_hash(in_interface.get_hash()) == in_interface);
+	// Truncated hashes (as persisted with path entries) resolve too
+	TEST_ASSERT_TRUE(RNS::Transport::find_interface_from_hash(in_interface.get_hash().left(16)) == in_interface);
+	TEST_ASSERT_FALSE(RNS::Transport::find_interface_from_id(0));
+
+	RNS::Interface temp_interface(new InInterface("TempInterface"));
+	RNS::Transport::register_interface(temp_interface);
+	RNS::InterfaceId stale_id = temp_interface.id();
+	TEST_ASSERT_TRUE(stale_id != 0);
+	TEST_ASSERT_TRUE(RNS::Transport::find_interface_from_id(stale_id) == temp_interface);
+
+	RNS::Transport::deregister_interface(temp_interface);
+	TEST_ASSERT_EQUAL_UINT16(0, temp_interface.id());
+	TEST_ASSERT_FALSE(RNS::Transport::find_interface_from_id(stale_id));
+
+	// Re-registering reuses the slot under a new generation
+	RNS::Transport::register_interface(temp_interface);
+	TEST_ASSERT_TRUE(temp_interface.id() != 0);
+	TEST_ASSERT_TRUE(temp_interface.id() != stale_id);
+	TEST_ASSERT_FALSE(RNS::Transport::find_interface_from_id(stale_id));
+	TEST_ASSERT_TRUE(RNS::Transport::find_interface_from_id(temp_interface.id()) == temp_interface);
+	RNS::Transport::deregister_interface(temp_interface);
+
+	// Once every id is taken further interfaces are refused rather than registered without one
+	std::vector<RNS::Interface> fill_interfaces;
+	for (size_t i = 0; fill_interfaces.size() < RNS::Transport::MAX_INTERFACE_SLOTS + 1; ++i) {
+		fill_interfaces.push_back(RNS::Interface(new InInterface(("FillInterface" + std::to_string(i)).c_str())));
+		RNS::Transport::register_interface(fill_interfaces.back());
+	}
+	RNS::Interface& refused_interface = fill_interfaces.back();
+	TEST_ASSERT_EQUAL_UINT16(0, refused_interface.id());
+	TEST_ASSERT_FALSE(RNS::Transport::find_interface_from_hash(refused_interface.get_hash()));
+	for (RNS::Interface& interface : fill_interfaces) {
+		RNS::Transport::deregister_interface(interface);
+	}
+	TEST_ASSERT_TRUE(RNS::Transport::find_interface_from_id(in_interface.id()) == in_interface);
+}
+
 // ============================================================================
 // Test runner
 // ============================================================================
@@ -659,6 +753,8 @@ int runUnityTests(void) {
 	RUN_TEST(test_prioritize_interfaces);
 	RUN_TEST(test_incoming_announce_over_limit);
 	//RUN_TEST(test_incoming_announce_stress);
+	RUN_TEST(test_receipt_table_capacity);
+	RUN_TEST(test_interface_ids);
 
 #if RNS_NEIGHBOR_PROBING
 	RUN_TEST(test_receipt_timeout_handler_capture);